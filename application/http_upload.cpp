@@ -5,8 +5,7 @@
 #include "HttpContext.h"
 #include "Logger.h"
 #include "FileUploadContext.h"
-#include "FileDownContext.h"
-#include "src/inc/Db.h"
+#include "src/inc/DbPool.h"
 #include "src/inc/Util.h"
 #include "src/inc/FilenameMap.h"
 #include "src/inc/AuthHandler.h"
@@ -14,10 +13,17 @@
 #include "src/inc/FileHandler.h"
 #include "src/inc/ShareHandler.h"
 #include "src/inc/UserHandler.h"
+#include "src/inc/ResumableUploadHandler.h"
+#include "src/inc/BlobStore.h"
+#include "src/inc/FdCache.h"
+#include "src/inc/ContentCache.h"
+#include "src/inc/StaticAssets.h"
 #include "src/inc/Router.h"
-#include "src/inc/Db.h"
 #include "src/inc/HttpUtil.h"
 #include "Connection.h"
+#include "BlockingExecutor.h"
+#include "Metrics.h"
+#include "RateLimiter.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
 #include <nlohmann/json.hpp>
@@ -31,6 +37,8 @@
 #include <experimental/filesystem>
 #include <vector>
 #include <cstdio>
+#include <cstdlib>
+#include <thread>
 #include <unistd.h>
 #include <mysql/mysql.h>
 
@@ -43,18 +51,31 @@ private:
     std::string uploadDir_;   // 上传目录
     std::string mappingFile_; // 文件名映射文件
     FilenameMap filenameMap_; // 文件名映射
-    // 数据库封装
-    Db db_;
+    // 数据库连接池
+    DbPool db_;
+    FdCache fdCache_;            // 下载与静态资源共用的打开文件缓存
+    ContentCache contentCache_;  // 热点小文件的内容缓存
+    StaticAssets staticAssets_;  // 预加载、预压缩的静态资源
+    ShardedBlobStore blobStore_; // 内容寻址存储（扇出目录布局）
+    std::thread migrator_;       // 平铺布局的在线迁移
+    int metricsCollector_ = 0;   // 缓存统计的指标收集器
+    std::string sessionKeysPath_; // 会话令牌密钥文件，为空时不签发令牌
     AuthHandler auth_;     // 认证与会话
     StaticHandler static_; // 静态资源
     FileHandler file_;     // 文件相关处理（list/delete/...）
     ShareHandler share_;   // 分享相关处理
     UserHandler user_;     // 用户相关处理（搜索等）
+    ResumableUploadHandler resumable_; // 断点续传上传
 
     Router router_;
 
-    // 初始化数据库连接
-    bool initDatabase() { return db_.connect(); }
+    // 建立连接池中的所有连接；失败的连接在借出或探活时重连
+    bool initDatabase()
+    {
+        size_t connected = db_.ConnectAll();
+        LOG_INFO << "DbPool: " << connected << "/" << db_.Size() << " connections established";
+        return connected > 0;
+    }
 
     // 关闭数据库连接
     void closeDatabase() { /* Db 析构自动关闭 */ }
@@ -62,18 +83,25 @@ private:
     // 直接使用各 Handler/Repository 进行数据访问
 
 public:
-    HttpUploadHandler(int numThreads,
+    HttpUploadHandler(int dbConnections,
                       const std::string &dbHost = "localhost",
                       const std::string &dbUser = "root",
                       const std::string &dbPassword = "123456",
                       const std::string &dbName = "file_manager",
                       unsigned int dbPort = 3306)
         : uploadDir_("uploads"), mappingFile_("uploads/filename_mapping.json"), 
-        filenameMap_(mappingFile_), db_(dbHost, dbUser, dbPassword, dbName, dbPort), 
-        auth_(db_), file_(db_, auth_, filenameMap_, uploadDir_), 
-        share_(db_, auth_, static_, uploadDir_), user_(db_, auth_)
+        filenameMap_(mappingFile_), db_(dbHost, dbUser, dbPassword, dbName, dbPort, static_cast<size_t>(dbConnections)), 
+        staticAssets_(StaticHandler::staticDir()), blobStore_(uploadDir_ + "/blobs", uploadDir_),
+        auth_(db_), static_(&staticAssets_, &fdCache_), file_(db_, auth_, filenameMap_, blobStore_, contentCache_, uploadDir_), 
+        share_(db_, auth_, static_, blobStore_, contentCache_, uploadDir_), user_(db_, auth_),
+        resumable_(auth_, file_, uploadDir_)
     {
-        (void)numThreads; // 线程池已移除，参数保留以兼容构造调用
+        blobStore_.SetFdCache(&fdCache_);
+        file_.SetMaxUploadBytes(16ULL << 30); // 单文件上限 16GB
+        size_t assets = staticAssets_.Load();
+        StaticAssets::Stats as = staticAssets_.GetStats();
+        LOG_INFO << "StaticAssets: " << assets << " assets from " << staticAssets_.Dir() << ", " << as.identityBytes
+                 << " bytes, " << as.compressedBytes << " bytes compressed";
 
         // 创建上传目录
         if (!fs::exists(uploadDir_))
@@ -96,11 +124,121 @@ public:
 
     ~HttpUploadHandler()
     {
+        if (metricsCollector_)
+            Metrics::RemoveCollector(metricsCollector_);
+        if (migrator_.joinable())
+            migrator_.join();
         // 保存文件名映射
         filenameMap_.save();
         closeDatabase();
     }
 
+    // 启动依赖事件循环的后台任务（过期上传会话清理、无引用内容回收、静态目录监视），访问数据库的路由交给 server 的阻塞任务执行器
+    void start(EventLoop *loop, HttpServer *server)
+    {
+        router_.SetServer(server);
+        file_.SetExecutor(server->GetBlockingExecutor());
+        resumable_.start(loop);
+        loop->RunEvery(600.0, [this]() { file_.collectBlobs(); });
+        // 空闲连接每 30 秒探活一次；ping 可能阻塞，放到执行器上，队列满时跳过本轮
+        loop->RunEvery(30.0, [this, server]() {
+            if (BlockingExecutor *executor = server->GetBlockingExecutor())
+                executor->Submit("db_health_check", [this]() { db_.HealthCheck(); });
+            else
+                db_.HealthCheck();
+        });
+        // 会话缓存每 10 秒提前刷新即将到期的常用会话并清理到期条目；启用令牌时同时重读密钥文件（轮换）并同步撤销集合
+        // 查库放到执行器上，队列满时跳过本轮；没有执行器时只清理
+        loop->RunEvery(10.0, [this, server]() {
+            if (BlockingExecutor *executor = server->GetBlockingExecutor())
+                executor->Submit("session_refresh", [this]() {
+                    auth_.refreshSessions();
+                    auth_.sessionCache().Evict();
+                    if (!sessionKeysPath_.empty())
+                    {
+                        auth_.sessionTokens().LoadKeys(sessionKeysPath_);
+                        auth_.syncRevokedTokens();
+                    }
+                });
+            else
+                auth_.sessionCache().Evict();
+        });
+        fdCache_.Watch(loop, StaticHandler::staticDir());
+        staticAssets_.Watch(loop);
+        loop->RunEvery(300.0, [this, server]() {
+            FdCache::Stats st = fdCache_.GetStats();
+            if (st.hits + st.misses > 0)
+                LOG_INFO << "FdCache: " << st.entries << " open, hits " << st.hits << ", misses " << st.misses
+                         << ", hit rate " << st.HitRate() << ", evictions " << st.evictions << ", invalidations " << st.invalidations;
+            ContentCache::Stats cs = contentCache_.GetStats();
+            if (cs.hits + cs.misses > 0)
+                LOG_INFO << "ContentCache: " << cs.entries << " files, " << cs.bytes << " bytes, hits " << cs.hits << ", misses " << cs.misses
+                         << ", hit rate " << cs.HitRate() << ", loads " << cs.loads << ", rejections " << cs.rejections << ", evictions " << cs.evictions;
+            StaticAssets::Stats as = staticAssets_.GetStats();
+            if (as.served + as.notModified > 0)
+                LOG_INFO << "StaticAssets: " << as.assets << " assets, served " << as.served << ", not modified " << as.notModified
+                         << ", reloads " << as.reloads;
+            SessionCache::Stats ss = auth_.sessionCache().GetStats();
+            if (ss.hits + ss.negativeHits + ss.misses > 0)
+                LOG_INFO << "SessionCache: " << ss.entries << " sessions, hits " << ss.hits << ", negative hits " << ss.negativeHits
+                         << ", misses " << ss.misses << ", hit rate " << ss.HitRate() << ", overflow " << ss.overflow;
+            SessionTokens::Stats ts = auth_.sessionTokens().GetStats();
+            if (ts.valid + ts.invalid + ts.expired + ts.revoked > 0)
+                LOG_INFO << "SessionTokens: " << ts.keys << " keys, valid " << ts.valid << ", invalid " << ts.invalid << ", expired " << ts.expired
+                         << ", revoked " << ts.revoked << ", revocation entries " << ts.revokedEntries;
+            if (const BlockingExecutor *executor = server->GetBlockingExecutor())
+            {
+                for (const auto &kv : executor->GetStats())
+                    LOG_INFO << "Blocking " << kv.first << ": executed " << kv.second.executed << ", rejected " << kv.second.rejected
+                             << ", avg wait " << kv.second.AvgWaitMs() << " ms, max wait " << kv.second.maxWaitMs << " ms";
+            }
+        });
+        // 各缓存已自行维护计数，抓取 /metrics 时读取
+        metricsCollector_ = Metrics::AddCollector([this](Metrics::Writer &writer) {
+            FdCache::Stats st = fdCache_.GetStats();
+            ContentCache::Stats cs = contentCache_.GetStats();
+            StaticAssets::Stats as = staticAssets_.GetStats();
+            writer.Counter("cache_hits_total", "Cache lookups served from memory", {{"cache", "fd"}}, static_cast<double>(st.hits));
+            writer.Counter("cache_hits_total", "Cache lookups served from memory", {{"cache", "content"}}, static_cast<double>(cs.hits));
+            writer.Counter("cache_misses_total", "Cache lookups that went to disk", {{"cache", "fd"}}, static_cast<double>(st.misses));
+            writer.Counter("cache_misses_total", "Cache lookups that went to disk", {{"cache", "content"}}, static_cast<double>(cs.misses));
+            writer.Counter("cache_evictions_total", "Entries evicted for capacity", {{"cache", "fd"}}, static_cast<double>(st.evictions));
+            writer.Counter("cache_evictions_total", "Entries evicted for capacity", {{"cache", "content"}}, static_cast<double>(cs.evictions));
+            writer.Gauge("cache_entries", "Entries currently cached", {{"cache", "fd"}}, static_cast<double>(st.entries));
+            writer.Gauge("cache_entries", "Entries currently cached", {{"cache", "content"}}, static_cast<double>(cs.entries));
+            writer.Gauge("cache_entries", "Entries currently cached", {{"cache", "static"}}, static_cast<double>(as.assets));
+            writer.Gauge("cache_entries", "Entries currently cached", {{"cache", "session"}}, static_cast<double>(auth_.sessionCache().GetStats().entries));
+            writer.Gauge("cache_bytes", "Bytes held in memory by the cache", {{"cache", "content"}}, static_cast<double>(cs.bytes));
+            writer.Gauge("cache_bytes", "Bytes held in memory by the cache", {{"cache", "static"}}, static_cast<double>(as.identityBytes + as.compressedBytes));
+            writer.Counter("static_assets_served_total", "Static asset responses with a body", {}, static_cast<double>(as.served));
+            writer.Counter("static_assets_not_modified_total", "Static asset requests answered with 304", {}, static_cast<double>(as.notModified));
+        });
+        // 旧的平铺文件在后台迁入扇出目录，迁移期间按新旧路径都能访问
+        migrator_ = std::thread([this]() { migrateLayout(2); });
+    }
+
+    // 载入会话令牌签名密钥，之后登录签发无状态令牌；密钥文件每 10 秒检查一次，追加新密钥即完成轮换
+    bool enableSessionTokens(const std::string &path)
+    {
+        int keys = auth_.sessionTokens().LoadKeys(path);
+        if (keys < 0)
+        {
+            LOG_ERROR << "会话令牌密钥文件无效: " << path;
+            return false;
+        }
+        sessionKeysPath_ = path;
+        LOG_INFO << "SessionTokens: " << keys << " keys loaded from " << path;
+        return true;
+    }
+
+    // 把平铺布局下的文件迁入扇出目录，可在服务运行中执行
+    void migrateLayout(int threads)
+    {
+        LayoutMigrator::Stats st = LayoutMigrator(blobStore_).Run(threads);
+        if (st.moved > 0 || st.skipped > 0 || st.failed > 0)
+            LOG_INFO << "Layout migration: moved " << st.moved << ", skipped " << st.skipped << ", failed " << st.failed;
+    }
+
     void onConnection(const std::shared_ptr<Connection> &conn)
     {
         if (conn->GetState() == connectionState::Connected)
@@ -131,9 +269,10 @@ public:
 
         try
         {
-            // 交给路由分发
-            if (router_.dispatch(conn, req, resp))
-                return true;
+            // 交给路由分发；处理器返回 false 表示响应稍后异步发送（流式上传、阻塞任务执行器）
+            bool sync = true;
+            if (router_.dispatch(conn, req, resp, sync))
+                return sync;
 
             // 未找到匹配的路由，返回404
             LOG_WARN << "No matching route found for " << path;
@@ -149,14 +288,24 @@ public:
         }
     }
 
-private:
-    // 旧版上传逻辑已移除，现统一走 FileHandler::handleUpload
-
-    bool handleListFiles(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+    // 请求体到达前的路由预检（Expect: 100-continue），返回 false 时 resp 为拒绝响应
+    bool BodyPrecheck(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
     {
-        return file_.handleListFiles(conn, req, resp);
+        try
+        {
+            return router_.precheck(conn, req, resp);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR << "Error checking request: " << e.what();
+            sendError(resp, "Internal Server Error", HttpStatusCode::InternalServerError, conn);
+            return false;
+        }
     }
 
+private:
+    // 旧版上传逻辑已移除，现统一走 FileHandler::handleUpload
+
     bool handleDownload(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) { return file_.handleDownload(conn, req, resp); }
 
     bool handleDelete(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
@@ -187,7 +336,9 @@ private:
 private:
     void initRoutes()
     {
-        registerRoutes(router_, static_, auth_, file_, share_, user_);
+        registerRoutes(router_, static_, auth_, file_, share_, user_, resumable_);
+        if (router_.FallbackCount() > 0)
+            LOG_WARN << router_.FallbackCount() << " routes use regex matching";
     }
 
     // 路由注册已迁移至 Router
@@ -195,15 +346,30 @@ private:
     // 简单转发包装已移除，直接在 Routes 中绑定到各 Handler
 };
 
-int main()
+int main(int argc, char **argv)
 {
     Logger::SetLogLevel(Logger::INFO);
+    // --migrate-layout [线程数]：只迁移存储布局后退出（不启动服务、不连接数据库）
+    if (argc > 1 && std::string(argv[1]) == "--migrate-layout")
+    {
+        int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+        ShardedBlobStore store("uploads/blobs", "uploads");
+        LayoutMigrator::Stats st = LayoutMigrator(store).Run(threads);
+        std::cout << "moved " << st.moved << ", skipped " << st.skipped << ", failed " << st.failed << std::endl;
+        return st.failed == 0 ? 0 : 1;
+    }
     EventLoop loop;
     // 监听 0.0.0.0 以便通过 localhost(127.0.0.1) 或本机 IP 访问
     HttpServer server(&loop, "0.0.0.0", 8080, false);
 
-    // 创建HTTP处理器
-    auto handler = std::make_shared<HttpUploadHandler>(4);
+    const int reactorThreads = static_cast<int>(std::thread::hardware_concurrency());
+    const int blockingThreads = 8;
+    // 创建HTTP处理器；每个 sub-reactor 线程与执行器线程各有一个数据库连接
+    auto handler = std::make_shared<HttpUploadHandler>(reactorThreads + blockingThreads);
+    // --session-keys <文件>：登录改为签发无状态令牌（可选）
+    for (int i = 1; i + 1 < argc; ++i)
+        if (std::string(argv[i]) == "--session-keys" && !handler->enableSessionTokens(argv[i + 1]))
+            return 1;
 
     // 设置连接回调
     server.SetOnConnectionCallback(
@@ -219,7 +385,32 @@ int main()
             return handler->HttpCallback(conn, req, resp);
         });
 
-    server.SetThreadNums(std::thread::hardware_concurrency());
+    // 大文件上传、断点续传 PATCH 与分片 PUT 的请求体按分片交给业务流式写盘
+    server.SetBodyStreamingFilter(
+        [](const HttpRequest &req)
+        {
+            return (req.GetMethod() == HttpMethod::kPost && req.GetUrl() == "/upload") || ResumableUploadHandler::isStreamingRequest(req);
+        });
+    // 上传类请求在请求体到达前鉴权、检查大小与剩余空间，拒绝时不再读取请求体；预检查会话可能访问数据库，在阻塞执行器上执行
+    server.SetBodyPrecheck(
+        [handler](const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+        {
+            return handler->BodyPrecheck(conn, req, resp);
+        });
+    // 数据库查询在独立的工作线程上执行；排队超过上限时直接回 503
+    server.SetBlockingExecutor(blockingThreads, 1024);
+    server.EnableMetrics(); // GET /metrics
+    // 限流在路由之前执行，超速请求回 429，不查数据库；会话规则另有按 IP 的总量规则兜底（会话 ID 可伪造）
+    RateLimiter *limiter = server.EnableRateLimit();
+    limiter->AddRule("per_ip", HttpMethod::kInvalid, "", 100, 200);
+    limiter->AddRule("login", HttpMethod::kPost, "/login", 1, 5);
+    limiter->AddRule("register", HttpMethod::kPost, "/register", 0.2, 3);
+    limiter->AddRule("files", HttpMethod::kGet, "/files", 5, 20, RateLimiter::kSession);
+    limiter->AddRule("share_info", HttpMethod::kGet, "/share/info/*", 2, 20);
+    limiter->AddRule("user_search", HttpMethod::kGet, "/users/search", 2, 10, RateLimiter::kSession);
+    handler->start(&loop, &server);
+
+    server.SetThreadNums(reactorThreads);
     std::cout << "HTTP upload server is running on port 8080..." << std::endl;
     std::cout << "Please visit http://localhost:8080" << std::endl;
     server.start();
@@ -2,6 +2,28 @@
 #include "inc/HttpUtil.h"
 #include "Logger.h"
 
+namespace
+{
+const int64_t kSessionLifetimeSeconds = 7LL * 24 * 3600;                     // 与 saveSession 中的 INTERVAL 7 DAY 一致，令牌同样有效 7 天
+const int64_t kSessionLifetimeNanos = kSessionLifetimeSeconds * 1000000000LL;
+const int64_t kRefreshAheadNanos = 20LL * 1000000000LL;                      // 缓存到期前 20 秒内的常用会话提前刷新
+const int64_t kRevokedSyncOverlap = 60;                                      // 同步窗口向前重叠 60 秒，容纳提交较晚的登出
+
+// 查 sessions 表：找到返回 1，不存在或已过期返回 0，查询失败返回 -1
+int loadSession(DbPool &db, const std::string &sessionId, SessionCache::Session &session, int64_t &ttlNanos)
+{
+    DbPool::Stmt st = db.prepare("SELECT user_id, username, TIMESTAMPDIFF(SECOND, NOW(), expire_time) FROM sessions WHERE session_id = ? AND expire_time > NOW()");
+    if (!st || !st->query(sessionId))
+        return -1;
+    if (!st->fetch())
+        return 0;
+    session.userId = st->getInt(0);
+    session.username = st->getString(1);
+    ttlNanos = st->getInt64(2) * 1000000000LL;
+    return 1;
+}
+} // namespace
+
 bool AuthHandler::handleRegister(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
 {
     try
@@ -16,24 +38,25 @@ bool AuthHandler::handleRegister(const std::shared_ptr<Connection> &conn, HttpRe
             return true;
         }
         std::string hashed = PseudoSha256(password);
-        std::string check = "SELECT id FROM users WHERE username = '" + db_.escape(username) + "'";
-        MYSQL_RES *r = db_.query(check);
-        if (r && mysql_num_rows(r) > 0)
         {
-            mysql_free_result(r);
-            sendError(resp, "用户名已存在", BadRequest, conn);
-            return true;
+            DbPool::Stmt check = db_.prepare("SELECT id FROM users WHERE username = ?");
+            if (check && check->query(username) && check->rowCount() > 0)
+            {
+                sendError(resp, "用户名已存在", BadRequest, conn);
+                return true;
+            }
         }
 
-        if (r)
-            mysql_free_result(r);
-        std::string ins = "INSERT INTO users (username, password, email) VALUES ('" + db_.escape(username) + "', '" + db_.escape(hashed) + "', " + (email.empty() ? "NULL" : "'" + db_.escape(email) + "'") + ")";
-        if (!db_.exec(ins))
+        std::optional<std::string> emailOpt;
+        if (!email.empty())
+            emailOpt = email;
+        DbPool::Stmt ins = db_.prepare("INSERT INTO users (username, password, email) VALUES (?, ?, ?)");
+        if (!ins || !ins->execute(username, hashed, emailOpt))
         {
             sendError(resp, "注册失败，请稍后重试", InternalServerError, conn);
             return true;
         }
-        int userId = static_cast<int>(db_.insertId());
+        int userId = static_cast<int>(ins->insertId());
         json out = {{"code", 0}, {"message", "注册成功"}, {"userId", userId}};
         sendJson(resp, out, conn);
         return true;
@@ -59,23 +82,26 @@ bool AuthHandler::handleLogin(const std::shared_ptr<Connection> &conn, HttpReque
             return true;
         }
         std::string hashed = PseudoSha256(password);
-        std::string q = "SELECT id, username FROM users WHERE username = '" + db_.escape(username) + "' AND password = '" + db_.escape(hashed) + "'";
-        MYSQL_RES *r = db_.query(q);
-        if (!r || mysql_num_rows(r) == 0)
+        int userId;
+        std::string name;
         {
-            if (r)
-                mysql_free_result(r);
-            sendError(resp, "用户名或密码错误", HttpStatusCode::Unauthorized, conn);
-            return true;
+            DbPool::Stmt st = db_.prepare("SELECT id, username FROM users WHERE username = ? AND password = ?");
+            if (!st || !st->query(username, hashed) || !st->fetch())
+            {
+                sendError(resp, "用户名或密码错误", HttpStatusCode::Unauthorized, conn);
+                return true;
+            }
+            userId = st->getInt(0);
+            name = st->getString(1);
+        }
+        std::string sessionId = tokens_.Issue(userId, name, kSessionLifetimeSeconds); // 未载入签名密钥时为空
+        if (sessionId.empty())
+        {
+            sessionId = generateSessionId();
+            saveSession(sessionId, userId, name);
         }
-        MYSQL_ROW row = mysql_fetch_row(r);
-        int userId = std::stoi(row[0]);
-        std::string name = row[1];
-        std::string sessionId = generateSessionId();
-        saveSession(sessionId, userId, name);
         json out = {{"code", 0}, {"message", "登录成功"}, {"sessionId", sessionId}, {"userId", userId}, {"username", name}};
         sendJson(resp, out, conn);
-        mysql_free_result(r);
         return true;
     }
     catch (const std::exception &e)
@@ -104,18 +130,39 @@ bool AuthHandler::validateSession(const std::string &sessionId, int &userId, std
 {
     if (sessionId.empty())
         return false;
-    std::string q = "SELECT user_id, username FROM sessions WHERE session_id = '" + db_.escape(sessionId) + "' AND expire_time > NOW()";
-    MYSQL_RES *r = db_.query(q);
-    if (!r || mysql_num_rows(r) == 0)
+    if (SessionTokens::LooksLikeToken(sessionId))
     {
-        if (r)
-            mysql_free_result(r);
+        SessionTokens::Claims claims;
+        if (tokens_.Verify(sessionId, &claims) != SessionTokens::kValid)
+            return false;
+        userId = claims.userId;
+        username = claims.username;
+        return true;
+    }
+    SessionCache::Session session;
+    switch (sessions_.Get(sessionId, &session))
+    {
+    case SessionCache::kHit:
+        userId = session.userId;
+        username = session.username;
+        return true;
+    case SessionCache::kUnknown:
         return false;
+    case SessionCache::kMiss:
+        break;
     }
-    MYSQL_ROW row = mysql_fetch_row(r);
-    userId = std::stoi(row[0]);
-    username = row[1];
-    mysql_free_result(r);
+    int64_t ttlNanos = 0;
+    int found = loadSession(db_, sessionId, session, ttlNanos);
+    if (found < 0)
+        return false; // 查询失败不做否定缓存
+    if (found == 0)
+    {
+        sessions_.PutUnknown(sessionId);
+        return false;
+    }
+    sessions_.Put(sessionId, session, ttlNanos);
+    userId = session.userId;
+    username = session.username;
     return true;
 }
 
@@ -123,8 +170,70 @@ void AuthHandler::endSession(const std::string &sessionId)
 {
     if (sessionId.empty())
         return;
-    std::string q = "DELETE FROM sessions WHERE session_id = '" + db_.escape(sessionId) + "'";
-    db_.exec(q);
+    if (SessionTokens::LooksLikeToken(sessionId))
+    {
+        // 本节点立即失效，其他节点在下一次 syncRevokedTokens 后失效；过期或伪造的令牌无需记录
+        SessionTokens::Claims claims;
+        SessionTokens::Result r = tokens_.Verify(sessionId, &claims);
+        if (r != SessionTokens::kValid && r != SessionTokens::kRevoked)
+            return;
+        tokens_.Revoke(claims.tokenId, claims.expires);
+        DbPool::Stmt st = db_.prepare("INSERT IGNORE INTO revoked_tokens (token_id, expire_time) VALUES (?, FROM_UNIXTIME(?))");
+        if (st)
+            st->execute(claims.tokenId, claims.expires);
+        return;
+    }
+    sessions_.Revoke(sessionId); // 先让缓存失效，删除完成前到达的请求也不再放行
+    DbPool::Stmt st = db_.prepare("DELETE FROM sessions WHERE session_id = ?");
+    if (st)
+        st->execute(sessionId);
+}
+
+size_t AuthHandler::refreshSessions(size_t limit)
+{
+    size_t refreshed = 0;
+    for (const std::string &id : sessions_.Expiring(kRefreshAheadNanos, limit))
+    {
+        SessionCache::Session session;
+        int64_t ttlNanos = 0;
+        int found = loadSession(db_, id, session, ttlNanos);
+        if (found < 0)
+            break; // 数据库不可用，本轮放弃，条目到期后由请求同步查库
+        if (found == 0)
+            sessions_.PutUnknown(id);
+        else
+            sessions_.Put(id, session, ttlNanos);
+        ++refreshed;
+    }
+    return refreshed;
+}
+
+size_t AuthHandler::syncRevokedTokens()
+{
+    int64_t dbNow = 0;
+    {
+        DbPool::Stmt st = db_.prepare("SELECT UNIX_TIMESTAMP()");
+        if (!st || !st->query() || !st->fetch())
+            return 0;
+        dbNow = st->getInt64(0);
+    }
+    size_t added = 0;
+    {
+        DbPool::Stmt st = db_.prepare("SELECT token_id, UNIX_TIMESTAMP(expire_time) FROM revoked_tokens WHERE revoked_at >= FROM_UNIXTIME(?) AND expire_time > NOW()");
+        if (!st || !st->query(revokedSyncedAt_.load()))
+            return 0;
+        while (st->fetch())
+        {
+            tokens_.Revoke(st->getString(0), st->getInt64(1));
+            ++added;
+        }
+    }
+    revokedSyncedAt_.store(dbNow > kRevokedSyncOverlap ? dbNow - kRevokedSyncOverlap : 0);
+    tokens_.PurgeRevoked();
+    DbPool::Stmt purge = db_.prepare("DELETE FROM revoked_tokens WHERE expire_time < NOW() LIMIT 1000");
+    if (purge)
+        purge->execute();
+    return added;
 }
 
 std::string AuthHandler::generateSessionId()
@@ -135,10 +244,8 @@ std::string AuthHandler::generateSessionId()
 void AuthHandler::saveSession(const std::string &sessionId, int userId, const std::string &username)
 {
     // 设置会话过期时间，例如 7 天后；与 validateSession 中 expire_time > NOW() 保持一致
-    std::string query =
-        "INSERT INTO sessions (session_id, user_id, username, expire_time) VALUES ('" +
-        db_.escape(sessionId) + "', " + std::to_string(userId) + ", '" + db_.escape(username) +
-        "', NOW() + INTERVAL 7 DAY)";
-    db_.exec(query);
+    DbPool::Stmt st = db_.prepare("INSERT INTO sessions (session_id, user_id, username, expire_time) VALUES (?, ?, ?, NOW() + INTERVAL 7 DAY)");
+    if (st && st->execute(sessionId, userId, username))
+        sessions_.Save(sessionId, {userId, username}, kSessionLifetimeNanos); // 写穿，登录后的第一个请求不查库
 }
 
@@ -0,0 +1,86 @@
+#include "Base64Url.h"
+#include <stdint.h>
+
+namespace
+{
+const char kBase64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+int DecodeChar(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '-')
+        return 62;
+    if (c == '_')
+        return 63;
+    return -1;
+}
+} // namespace
+
+std::string EncodeBase64Url(const void *bytes, size_t len)
+{
+    const uint8_t *data = static_cast<const uint8_t *>(bytes);
+    std::string out;
+    out.reserve((len * 4 + 2) / 3);
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += kBase64Url[v >> 18];
+        out += kBase64Url[(v >> 12) & 63];
+        out += kBase64Url[(v >> 6) & 63];
+        out += kBase64Url[v & 63];
+    }
+    if (len - i == 1)
+    {
+        uint32_t v = data[i] << 16;
+        out += kBase64Url[v >> 18];
+        out += kBase64Url[(v >> 12) & 63];
+    }
+    else if (len - i == 2)
+    {
+        uint32_t v = (data[i] << 16) | (data[i + 1] << 8);
+        out += kBase64Url[v >> 18];
+        out += kBase64Url[(v >> 12) & 63];
+        out += kBase64Url[(v >> 6) & 63];
+    }
+    return out;
+}
+
+bool DecodeBase64Url(const char *s, size_t len, char *out, size_t cap, size_t *outLen)
+{
+    if (len % 4 == 1 || len * 3 / 4 > cap)
+        return false;
+    size_t n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        int v = DecodeChar(s[i]);
+        if (v < 0)
+            return false;
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out[n++] = static_cast<char>((acc >> bits) & 0xff);
+        }
+    }
+    *outLen = n;
+    return (acc & ((1u << bits) - 1)) == 0; // 末尾多余的位必须为 0，同一内容只有一种写法
+}
+
+bool DecodeBase64Url(const std::string &s, std::string *out)
+{
+    out->resize(s.size() * 3 / 4 + 1);
+    size_t len = 0;
+    if (!DecodeBase64Url(s.data(), s.size(), &(*out)[0], out->size(), &len))
+        return false;
+    out->resize(len);
+    return true;
+}
@@ -0,0 +1,293 @@
+#include "BlobStore.h"
+#include "FdCache.h"
+#include "Sha256.h"
+#include "Logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace
+{
+    void MakeDirs(const std::string &path)
+    {
+        for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+            ::mkdir(path.substr(0, pos).c_str(), 0755);
+        ::mkdir(path.c_str(), 0755);
+    }
+
+    bool StatRegular(const std::string &path, uint64_t *size)
+    {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            return false;
+        if (size)
+            *size = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    bool HasSuffix(const std::string &s, const char *suffix)
+    {
+        size_t n = strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+} // namespace
+
+ShardedBlobStore::ShardedBlobStore(const std::string &root, const std::string &legacyDir) : root_(root), legacyDir_(legacyDir)
+{
+    MakeDirs(root_ + "/.trash");
+}
+
+std::string ShardedBlobStore::ShardOf(const std::string &key)
+{
+    std::string h = Sha256::HexOf(key.data(), key.size());
+    return h.substr(0, 2) + "/" + h.substr(2, 2);
+}
+
+std::string ShardedBlobStore::BlobPath(const std::string &hash) const
+{
+    // 摘要本身已均匀分布，直接取前缀
+    return root_ + "/" + hash.substr(0, 2) + "/" + hash.substr(2, 2) + "/" + hash;
+}
+
+std::string ShardedBlobStore::LegacyPath(const std::string &serverFilename) const
+{
+    return legacyDir_ + "/" + ShardOf(serverFilename) + "/" + serverFilename;
+}
+
+std::string ShardedBlobStore::TrashPathFor(const std::string &hash) const
+{
+    return root_ + "/.trash/" + hash;
+}
+
+bool ShardedBlobStore::MoveInto(const std::string &src, const std::string &dst)
+{
+    if (::rename(src.c_str(), dst.c_str()) == 0)
+        return true;
+    if (errno != ENOENT)
+        return false;
+    // 分片目录按需创建
+    MakeDirs(dst.substr(0, dst.rfind('/')));
+    return ::rename(src.c_str(), dst.c_str()) == 0;
+}
+
+bool ShardedBlobStore::Resolve(const std::string &serverFilename, const std::string &hash, std::string *path, uint64_t *size) const
+{
+    std::string sharded = hash.empty() ? LegacyPath(serverFilename) : BlobPath(hash);
+    if (StatRegular(sharded, size))
+    {
+        *path = sharded;
+        return true;
+    }
+    // 尚未迁移的平铺文件
+    std::string flat = hash.empty() ? FlatLegacyPath(serverFilename) : FlatBlobPath(hash);
+    if (StatRegular(flat, size))
+    {
+        *path = flat;
+        return true;
+    }
+    // 两次 stat 之间恰好被迁移
+    if (StatRegular(sharded, size))
+    {
+        *path = sharded;
+        return true;
+    }
+    return false;
+}
+
+bool ShardedBlobStore::Exists(const std::string &hash) const
+{
+    return StatRegular(BlobPath(hash), nullptr) || StatRegular(FlatBlobPath(hash), nullptr);
+}
+
+std::shared_ptr<const CachedFile> ShardedBlobStore::Open(const std::string &serverFilename, const std::string &hash) const
+{
+    if (!cache_)
+    {
+        std::string path;
+        return Resolve(serverFilename, hash, &path, nullptr) ? FdCache::OpenFile(path) : nullptr;
+    }
+    // 热点文件直接命中，不做 stat
+    std::string sharded = hash.empty() ? LegacyPath(serverFilename) : BlobPath(hash);
+    if (std::shared_ptr<const CachedFile> file = cache_->Get(sharded))
+        return file;
+    std::string flat = hash.empty() ? FlatLegacyPath(serverFilename) : FlatBlobPath(hash);
+    if (std::shared_ptr<const CachedFile> file = cache_->Get(flat))
+        return file;
+    std::string path;
+    if (!Resolve(serverFilename, hash, &path, nullptr))
+        return nullptr;
+    return cache_->Open(path);
+}
+
+void ShardedBlobStore::InvalidateCached(const std::string &sharded, const std::string &flat)
+{
+    // 在删除/移走之后调用：与之交错的 Open 要么被这里移除，要么因代数变化不会放入缓存
+    // 已在发送的连接持有自己的引用，不受影响
+    if (cache_)
+    {
+        cache_->Invalidate(sharded);
+        cache_->Invalidate(flat);
+    }
+}
+
+bool ShardedBlobStore::Adopt(const std::string &srcPath, const std::string &hash)
+{
+    if (Exists(hash))
+    {
+        ::unlink(srcPath.c_str()); // 重复内容，丢弃本次写入的副本
+        return true;
+    }
+    // 并发上传同一内容时两次 rename 互相覆盖，内容一致，结果仍正确
+    std::string path = BlobPath(hash);
+    if (!MoveInto(srcPath, path))
+    {
+        LOG_ERROR << "BlobStore adopt " << srcPath << " -> " << path << " failed, errno: " << errno;
+        return false;
+    }
+    return true;
+}
+
+bool ShardedBlobStore::RemoveLegacy(const std::string &serverFilename)
+{
+    bool removed = ::unlink(LegacyPath(serverFilename).c_str()) == 0 || ::unlink(FlatLegacyPath(serverFilename).c_str()) == 0;
+    InvalidateCached(LegacyPath(serverFilename), FlatLegacyPath(serverFilename));
+    return removed;
+}
+
+bool ShardedBlobStore::BeginCollect(const std::string &hash)
+{
+    std::string trash = TrashPathFor(hash);
+    bool moved = ::rename(BlobPath(hash).c_str(), trash.c_str()) == 0 || ::rename(FlatBlobPath(hash).c_str(), trash.c_str()) == 0;
+    InvalidateCached(BlobPath(hash), FlatBlobPath(hash));
+    return moved;
+}
+
+void ShardedBlobStore::FinishCollect(const std::string &hash, bool unreferenced)
+{
+    std::string trash = TrashPathFor(hash);
+    if (unreferenced)
+    {
+        ::unlink(trash.c_str());
+        return;
+    }
+    // 回收期间被重新引用：移回原处（若新上传已放入同内容文件，覆盖也无妨）
+    if (!MoveInto(trash, BlobPath(hash)))
+        LOG_ERROR << "BlobStore restore " << hash << " failed, errno: " << errno;
+}
+
+LayoutMigrator::Stats LayoutMigrator::Run(int threads, size_t batchSize)
+{
+    struct Item
+    {
+        std::string src; // 平铺路径
+        std::string dst; // 扇出路径
+        bool blob;       // 内容文件或 legacy 文件
+    };
+    typedef std::vector<Item> Batch;
+    if (threads < 1)
+        threads = 1;
+    if (batchSize == 0)
+        batchSize = 1;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Batch> queue;
+    bool scanning = true;
+    std::atomic<size_t> moved(0), skipped(0), failed(0);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&]() {
+            while (true)
+            {
+                Batch batch;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() { return !queue.empty() || !scanning; });
+                    if (queue.empty())
+                        return;
+                    batch = std::move(queue.front());
+                    queue.pop_front();
+                }
+                cv.notify_all(); // 唤醒等待队列腾出空间的扫描线程
+                for (const auto &item : batch)
+                {
+                    if (StatRegular(item.dst, nullptr))
+                    {
+                        // 内容文件同名即同内容，删除平铺副本；legacy 文件名唯一，保留待人工处理
+                        if (item.blob)
+                            ::unlink(item.src.c_str());
+                        ++skipped;
+                    }
+                    else if (ShardedBlobStore::MoveInto(item.src, item.dst))
+                        ++moved;
+                    else if (errno != ENOENT) // 期间被删除或回收不算失败
+                    {
+                        LOG_WARN << "Migrate " << item.src << " failed, errno: " << errno;
+                        ++failed;
+                    }
+                }
+            }
+        });
+    }
+
+    // 边扫描边分批投递，队列深度受限，百万级目录也不必一次性读入全部文件名
+    auto submit = [&](Batch &batch) {
+        if (batch.empty())
+            return;
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return queue.size() < static_cast<size_t>(threads) * 2; });
+        queue.push_back(std::move(batch));
+        batch.clear();
+        cv.notify_all();
+    };
+    auto scan = [&](const std::string &dir, bool blobs) {
+        DIR *d = ::opendir(dir.c_str());
+        if (!d)
+            return;
+        Batch batch;
+        while (struct dirent *e = ::readdir(d))
+        {
+            std::string name = e->d_name;
+            if (name.empty() || name[0] == '.')
+                continue;
+            if (e->d_type != DT_REG && e->d_type != DT_UNKNOWN)
+                continue; // 分片目录等
+            if (blobs ? !Sha256::ValidHex(name) : (HasSuffix(name, ".json") || HasSuffix(name, ".part") || HasSuffix(name, ".tmp")))
+                continue;
+            std::string src = dir + "/" + name;
+            if (e->d_type == DT_UNKNOWN && !StatRegular(src, nullptr))
+                continue;
+            batch.push_back(Item{src, blobs ? store_.BlobPath(name) : store_.LegacyPath(name), blobs});
+            if (batch.size() >= batchSize)
+                submit(batch);
+        }
+        submit(batch);
+        ::closedir(d);
+    };
+    scan(store_.Root(), true);
+    scan(store_.LegacyDir(), false);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        scanning = false;
+    }
+    cv.notify_all();
+    for (auto &t : workers)
+        t.join();
+
+    Stats stats;
+    stats.moved = moved.load();
+    stats.skipped = skipped.load();
+    stats.failed = failed.load();
+    return stats;
+}
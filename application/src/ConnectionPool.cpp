@@ -0,0 +1,191 @@
+#include "ConnectionPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+// 本线程上次借到的槽位；只记一个池，进程里通常只有一个连接池
+struct Home
+{
+    const ConnectionPool *pool = nullptr;
+    size_t index = 0;
+};
+thread_local Home t_home;
+} // namespace
+
+ConnectionPool::Lease &ConnectionPool::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        pool_ = other.pool_;
+        index_ = other.index_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+void ConnectionPool::Lease::Release()
+{
+    if (!pool_)
+        return;
+    pool_->inUse_.Add(-1);
+    pool_->Return(index_);
+    pool_ = nullptr;
+}
+
+ConnectionPool::ConnectionPool(const std::string &name, size_t size)
+    : name_(name), slots_(size ? size : 1),
+      wait_(Metrics::GetHistogram("connection_pool_acquire_wait_seconds", "Time spent waiting for a pooled connection", {{"pool", name}})),
+      inUse_(Metrics::GetGauge("connection_pool_in_use", "Pooled connections currently checked out", {{"pool", name}})),
+      timeouts_(Metrics::GetCounter("connection_pool_acquire_timeouts_total", "Acquire calls that timed out with every connection busy", {{"pool", name}})),
+      reconnectsOk_(Metrics::GetCounter("connection_pool_reconnects_total", "Attempts to re-establish a broken connection", {{"pool", name}, {"result", "ok"}})),
+      reconnectsFailed_(Metrics::GetCounter("connection_pool_reconnects_total", "Attempts to re-establish a broken connection", {{"pool", name}, {"result", "failed"}}))
+{
+}
+
+void ConnectionPool::SetReconnectBackoff(int minMs, int maxMs)
+{
+    minBackoff_ = static_cast<int64_t>(minMs) * 1000000;
+    maxBackoff_ = static_cast<int64_t>(std::max(minMs, maxMs)) * 1000000;
+}
+
+// 先读一次，槽位被占用时不做 CAS，避免在争用的缓存行上反复写
+bool ConnectionPool::TryTake(size_t index)
+{
+    std::atomic<bool> &busy = slots_[index].busy;
+    bool expected = false;
+    return !busy.load(std::memory_order_relaxed) && busy.compare_exchange_strong(expected, true);
+}
+
+bool ConnectionPool::TakeAny(size_t *index)
+{
+    size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+        size_t candidate = (start + i) % slots_.size();
+        if (TryTake(candidate))
+        {
+            *index = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+ConnectionPool::Lease ConnectionPool::Acquire(int timeoutMs)
+{
+    int64_t start = Metrics::NowNanos();
+    size_t index = t_home.index;
+    // 池析构后新池可能分配在同一地址，下标仍须检查
+    bool taken = (t_home.pool == this && index < slots_.size() && TryTake(index)) || TakeAny(&index);
+    if (!taken)
+    {
+        // waiters_ 先于扫描增加、归还先清 busy 再读 waiters_（都是顺序一致的原子操作），两边至少有一方看到对方；
+        // 通知在锁内发出，扫描与进入等待之间不会丢失
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!(taken = TakeAny(&index)))
+        {
+            if (cv_.wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                taken = TakeAny(&index);
+                break;
+            }
+        }
+        waiters_.fetch_sub(1);
+    }
+    wait_.Record(static_cast<uint64_t>(Metrics::NowNanos() - start));
+    if (!taken)
+    {
+        timeouts_.Inc();
+        return Lease();
+    }
+    inUse_.Add(1);
+    t_home.pool = this;
+    t_home.index = index;
+    Revive(index, false);
+    return Lease(this, index);
+}
+
+void ConnectionPool::Return(size_t index)
+{
+    Slot &slot = slots_[index];
+    slot.connected.store(IsConnected(index), std::memory_order_relaxed);
+    slot.busy.store(false);
+    if (waiters_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+}
+
+void ConnectionPool::Revive(size_t index, bool force)
+{
+    if (IsConnected(index))
+        return;
+    Slot &slot = slots_[index];
+    int64_t now = Metrics::NowNanos();
+    if (!force && now < slot.retryAt)
+        return;
+    if (Connect(index))
+    {
+        reconnectsOk_.Inc();
+        slot.backoff = 0;
+        slot.retryAt = 0;
+        return;
+    }
+    reconnectsFailed_.Inc();
+    slot.backoff = std::min(std::max(slot.backoff * 2, minBackoff_), maxBackoff_);
+    slot.retryAt = now + slot.backoff;
+}
+
+size_t ConnectionPool::ConnectAll()
+{
+    size_t connected = 0;
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+        if (!TryTake(i))
+            continue;
+        if (Connect(i))
+            ++connected;
+        Return(i);
+    }
+    return connected;
+}
+
+size_t ConnectionPool::HealthCheck()
+{
+    size_t healthy = 0;
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+        if (!TryTake(i))
+        {
+            // 正在使用的连接由使用者发现断开，借出时重连
+            healthy += slots_[i].connected.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (!IsConnected(i) || !Ping(i))
+            Revive(i, true);
+        bool ok = IsConnected(i);
+        healthy += ok;
+        Return(i);
+    }
+    return healthy;
+}
+
+ConnectionPool::Stats ConnectionPool::GetStats() const
+{
+    Stats st;
+    st.size = slots_.size();
+    for (const Slot &slot : slots_)
+    {
+        st.inUse += slot.busy.load(std::memory_order_relaxed);
+        st.connected += slot.connected.load(std::memory_order_relaxed);
+    }
+    st.timeouts = timeouts_.Value();
+    st.reconnects = reconnectsOk_.Value();
+    st.reconnectFailures = reconnectsFailed_.Value();
+    return st;
+}
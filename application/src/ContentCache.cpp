@@ -0,0 +1,214 @@
+#include "ContentCache.h"
+#include "FdCache.h"
+#include "Logger.h"
+#include <errno.h>
+#include <unistd.h>
+
+namespace
+{
+    inline uint64_t Mix(uint64_t x)
+    {
+        // splitmix64 的混合函数
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    size_t RoundUpPow2(size_t n)
+    {
+        size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+} // namespace
+
+size_t ContentCache::KeyHash::operator()(const Key &k) const
+{
+    uint64_t h = Mix(static_cast<uint64_t>(k.ino) ^ (static_cast<uint64_t>(k.dev) << 32));
+    h = Mix(h ^ static_cast<uint64_t>(k.mtimeNs));
+    return static_cast<size_t>(Mix(h ^ k.size));
+}
+
+ContentCache::FrequencySketch::FrequencySketch(size_t width)
+    : table_(RoundUpPow2(width) * 4, 0), width_(RoundUpPow2(width)), sampleSize_(RoundUpPow2(width) * 10) {}
+
+size_t ContentCache::FrequencySketch::Index(uint64_t hash, int row) const
+{
+    static const uint64_t kSeeds[4] = {0x97cb3127ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL, 0x85ebca77c2b2ae63ULL};
+    return row * width_ + (Mix(hash + kSeeds[row]) & (width_ - 1));
+}
+
+void ContentCache::FrequencySketch::Increment(uint64_t hash)
+{
+    for (int row = 0; row < 4; ++row)
+    {
+        uint8_t &c = table_[Index(hash, row)];
+        if (c < 15)
+            ++c;
+    }
+    if (++additions_ >= sampleSize_)
+    {
+        for (auto &c : table_)
+            c >>= 1;
+        additions_ /= 2;
+    }
+}
+
+int ContentCache::FrequencySketch::Estimate(uint64_t hash) const
+{
+    int freq = 15;
+    for (int row = 0; row < 4; ++row)
+        freq = std::min<int>(freq, table_[Index(hash, row)]);
+    return freq;
+}
+
+ContentCache::ContentCache(size_t budget, size_t maxEntryBytes)
+    : budget_(budget), maxEntryBytes_(std::min(maxEntryBytes, budget)), protectedBudget_(budget / 5 * 4),
+      sketch_(std::max<size_t>(1024, budget / 4096)) {}
+
+ContentCache::Data ContentCache::Load(const CachedFile &file)
+{
+    std::string data(file.size, '\0');
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = ::pread(file.fd, &data[done], data.size() - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            LOG_WARN << "ContentCache read failed, errno: " << (n == 0 ? 0 : errno);
+            return nullptr; // 文件被截断或读错
+        }
+        done += static_cast<size_t>(n);
+    }
+    return std::make_shared<const std::string>(std::move(data));
+}
+
+bool ContentCache::Admit(uint64_t hash, size_t size) const
+{
+    if (probationBytes_ + protectedBytes_ + size <= budget_)
+        return true;
+    // 预算已满：与最先被淘汰的条目比较近期频率
+    const std::list<Entry> &victims = probation_.empty() ? protected_ : probation_;
+    if (victims.empty())
+        return true;
+    return sketch_.Estimate(hash) > sketch_.Estimate(victims.back().hash);
+}
+
+void ContentCache::Touch(std::list<Entry>::iterator it)
+{
+    if (it->protectedSeg)
+    {
+        protected_.splice(protected_.begin(), protected_, it);
+        return;
+    }
+    // 试用段中再次命中，晋升到保护段；保护段超出上限时把最久未用的降回试用段
+    size_t size = it->data->size();
+    probationBytes_ -= size;
+    protectedBytes_ += size;
+    it->protectedSeg = true;
+    protected_.splice(protected_.begin(), probation_, it);
+    while (protectedBytes_ > protectedBudget_ && protected_.size() > 1)
+    {
+        auto last = std::prev(protected_.end());
+        size_t n = last->data->size();
+        protectedBytes_ -= n;
+        probationBytes_ += n;
+        last->protectedSeg = false;
+        probation_.splice(probation_.begin(), protected_, last);
+    }
+}
+
+void ContentCache::EvictTo(size_t limit)
+{
+    while (probationBytes_ + protectedBytes_ > limit)
+    {
+        std::list<Entry> &from = probation_.empty() ? protected_ : probation_;
+        if (from.empty())
+            break;
+        Entry &victim = from.back();
+        (victim.protectedSeg ? protectedBytes_ : probationBytes_) -= victim.data->size();
+        index_.erase(victim.key);
+        from.pop_back(); // 正在发送的响应仍持有 data 的引用
+        ++evictions_;
+    }
+}
+
+void ContentCache::Insert(const Key &key, uint64_t hash, const Data &data)
+{
+    if (index_.count(key))
+        return;
+    EvictTo(budget_ - data->size());
+    probation_.push_front(Entry{key, hash, data, false});
+    probationBytes_ += data->size();
+    index_[key] = probation_.begin();
+}
+
+std::shared_ptr<const std::string> ContentCache::Get(const CachedFile &file)
+{
+    if (file.size == 0 || file.size > maxEntryBytes_)
+        return nullptr;
+    Key key{file.dev, file.ino, file.mtimeNs, file.size};
+    uint64_t hash = KeyHash()(key);
+
+    std::promise<Data> promise;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sketch_.Increment(hash);
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            ++hits_;
+            Touch(it->second);
+            return it->second->data;
+        }
+        ++misses_;
+        auto loading = loading_.find(key);
+        if (loading != loading_.end())
+        {
+            // 同一文件正在被其他线程读入，等待它的结果
+            std::shared_future<Data> future = loading->second;
+            lock.unlock();
+            return future.get();
+        }
+        // 门卫：只访问过一次的文件不读入，避免一次性的下载冲掉热点
+        if (sketch_.Estimate(hash) < 2)
+            return nullptr;
+        if (!Admit(hash, static_cast<size_t>(file.size)))
+        {
+            ++rejections_;
+            return nullptr;
+        }
+        loading_.emplace(key, promise.get_future().share());
+    }
+
+    Data data = Load(file);
+    ++loads_;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        loading_.erase(key);
+        if (data)
+            Insert(key, hash, data);
+    }
+    promise.set_value(data);
+    return data;
+}
+
+ContentCache::Stats ContentCache::GetStats() const
+{
+    Stats st;
+    st.hits = hits_.load();
+    st.misses = misses_.load();
+    st.loads = loads_.load();
+    st.rejections = rejections_.load();
+    st.evictions = evictions_.load();
+    std::unique_lock<std::mutex> lock(mutex_);
+    st.bytes = probationBytes_ + protectedBytes_;
+    st.entries = index_.size();
+    return st;
+}
@@ -1,6 +1,27 @@
 #include "./inc/Db.h"
 #include "Logger.h"
 #include <mysql/mysql.h>
+#include <mysql/errmsg.h>
+
+namespace
+{
+// 本线程最近一次语句的结果，在持锁执行语句时记录
+thread_local unsigned long long t_insertId = 0;
+thread_local unsigned long long t_affectedRows = 0;
+
+// "std::vector<FileRecord> FileRepository::listMyFiles(int)" -> "FileRepository::listMyFiles"
+std::string MethodName(const char *function)
+{
+    std::string name(function);
+    size_t paren = name.find('(');
+    if (paren != std::string::npos)
+        name.resize(paren);
+    size_t space = name.rfind(' ');
+    if (space != std::string::npos)
+        name.erase(0, space + 1);
+    return name;
+}
+} // namespace
 
 Db::Db(const std::string& host,
        const std::string& user,
@@ -10,6 +31,13 @@ Db::Db(const std::string& host,
     : mysql_(nullptr), host_(host), user_(user), password_(password), dbname_(dbname), port_(port) {}
 
 Db::~Db() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeLocked();
+}
+
+void Db::closeLocked() {
+    statements_.clear(); // 语句须在连接关闭之前关闭
+    lost_ = false;
     if (mysql_) {
         mysql_close(mysql_);
         mysql_ = nullptr;
@@ -17,41 +45,105 @@ Db::~Db() {
 }
 
 bool Db::connect() {
-    if(mysql_) return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (mysql_ && !lost_) return true;
+    closeLocked();
     mysql_ = mysql_init(nullptr);
     if (!mysql_) {
         LOG_ERROR << "MySQL init failed";
         return false;
     }
+    unsigned int timeout = 3; // 数据库不可达时重连不要长时间占住借到的连接
+    mysql_options(mysql_, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
     if(!mysql_real_connect(mysql_, host_.c_str(), user_.c_str(), password_.c_str(), dbname_.c_str(), port_, nullptr, 0)) {
         LOG_ERROR << "MySQL connect failed: " << mysql_error(mysql_);
-        mysql_close(mysql_);
-        mysql_ = nullptr;
+        closeLocked();
         return false;
     }
     if (mysql_set_character_set(mysql_, "utf8") != 0) {
         LOG_ERROR << "Set charset failed: " << mysql_error(mysql_);
+        closeLocked(); // escapeUtf8 依赖连接字符集为 utf8
         return false;
     }
     return true;
 }
 
-bool Db::exec(const std::string& sql) {
-    if (!mysql_) return false;
+bool Db::ping() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!mysql_ || lost_) return false;
+    if (mysql_ping(mysql_) != 0) {
+        LOG_WARN << "MySQL ping failed: " << mysql_error(mysql_);
+        lost_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool Db::execLocked(const std::string& sql) {
+    if (!mysql_ || lost_) return false;
     if (mysql_query(mysql_, sql.c_str()) != 0) {
+        unsigned int err = mysql_errno(mysql_);
         LOG_ERROR << "MySQL exec failed: " << mysql_error(mysql_);
+        if (err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST)
+            lost_ = true; // 连接已断开，下次借出时重连
         return false;
     }
+    t_insertId = mysql_insert_id(mysql_);
+    t_affectedRows = mysql_affected_rows(mysql_);
     return true;
 }
 
-MYSQL_RES* Db::query(const std::string& sql) {
-    if (!exec(sql)) return nullptr;
-    return mysql_store_result(mysql_);
+const Metrics::Histogram& Db::latencyLocked(const std::source_location& loc) {
+    auto it = latency_.find(loc.function_name());
+    if (it == latency_.end())
+        it = latency_.emplace(loc.function_name(), Metrics::GetHistogram("db_query_duration_seconds", "SQL statement execution time by calling repository method",
+                                                                         {{"method", MethodName(loc.function_name())}})).first;
+    return it->second;
+}
+
+bool Db::exec(const std::string& sql, std::source_location loc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t start = Metrics::NowNanos();
+    bool ok = execLocked(sql);
+    latencyLocked(loc).Record(static_cast<uint64_t>(Metrics::NowNanos() - start));
+    return ok;
+}
+
+Statement* Db::prepare(const std::string& sql, std::source_location loc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!mysql_ || lost_) return nullptr;
+    auto it = statements_.find(sql);
+    if (it == statements_.end()) {
+        MYSQL_STMT* stmt = mysql_stmt_init(mysql_);
+        if (!stmt) {
+            LOG_ERROR << "MySQL stmt init failed: " << mysql_error(mysql_);
+            return nullptr;
+        }
+        if (mysql_stmt_prepare(stmt, sql.data(), sql.size()) != 0) {
+            unsigned int err = mysql_stmt_errno(stmt);
+            LOG_ERROR << "MySQL prepare failed: " << mysql_stmt_error(stmt) << " (" << sql << ")";
+            mysql_stmt_close(stmt);
+            if (err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST)
+                lost_ = true;
+            return nullptr;
+        }
+        it = statements_.emplace(sql, std::make_unique<Statement>(*this, stmt)).first;
+    }
+    it->second->setLatency(&latencyLocked(loc));
+    return it->second.get();
+}
+
+MYSQL_RES* Db::query(const std::string& sql, std::source_location loc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t start = Metrics::NowNanos();
+    MYSQL_RES* res = execLocked(sql) ? mysql_store_result(mysql_) : nullptr;
+    latencyLocked(loc).Record(static_cast<uint64_t>(Metrics::NowNanos() - start));
+    return res;
 }
 
 std::string Db::escape(const std::string& s) {
-    if (!mysql_) return s;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!mysql_) return escapeUtf8(s);
     std::string out;
     out.resize(s.size() * 2 + 1);
     unsigned long len = mysql_real_escape_string(mysql_, &out[0], s.c_str(), s.size());
@@ -59,7 +151,28 @@ std::string Db::escape(const std::string& s) {
     return out;
 }
 
-unsigned long long Db::insertId() const {
-    if (!mysql_) return 0;
-    return mysql_insert_id(mysql_);
-}
\ No newline at end of file
+std::string Db::escapeUtf8(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 8);
+    for (char c : s) {
+        switch (c) {
+        case '\0': out += "\\0"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\\': out += "\\\\"; break;
+        case '\'': out += "\\'"; break;
+        case '"': out += "\\\""; break;
+        case '\032': out += "\\Z"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+unsigned long long Db::insertId() {
+    return t_insertId;
+}
+
+unsigned long long Db::affectedRows() {
+    return t_affectedRows;
+}
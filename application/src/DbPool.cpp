@@ -0,0 +1,40 @@
+#include "./inc/DbPool.h"
+#include "Logger.h"
+
+DbPool::DbPool(const std::string &host, const std::string &user, const std::string &password, const std::string &dbname, unsigned int port, size_t size)
+    : ConnectionPool("mysql", size)
+{
+    for (size_t i = 0; i < Size(); ++i)
+        conns_.push_back(std::make_unique<Db>(host, user, password, dbname, port));
+}
+
+DbPool::Lease DbPool::Acquire(int timeoutMs)
+{
+    ConnectionPool::Lease lease = ConnectionPool::Acquire(timeoutMs);
+    if (!lease)
+    {
+        LOG_ERROR << "DbPool: no connection available within " << timeoutMs << " ms";
+        return Lease(std::move(lease), nullptr);
+    }
+    Db *db = conns_[lease.Index()].get();
+    return Lease(std::move(lease), db);
+}
+
+bool DbPool::exec(const std::string &sql, std::source_location loc)
+{
+    Lease db = Acquire();
+    return db && db->exec(sql, loc);
+}
+
+MYSQL_RES *DbPool::query(const std::string &sql, std::source_location loc)
+{
+    Lease db = Acquire();
+    return db ? db->query(sql, loc) : nullptr;
+}
+
+DbPool::Stmt DbPool::prepare(const std::string &sql, std::source_location loc)
+{
+    Lease db = Acquire();
+    Statement *stmt = db ? db->prepare(sql, loc) : nullptr;
+    return Stmt(std::move(db), stmt);
+}
@@ -0,0 +1,117 @@
+#include "DirWatcher.h"
+#include "Channel.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include <dirent.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+DirWatcher::DirWatcher(EventLoop *loop, ChangeCallback onChange, ResetCallback onReset)
+    : loop_(loop), onChange_(std::move(onChange)), onReset_(std::move(onReset)) {}
+
+DirWatcher::~DirWatcher()
+{
+    if (channel_)
+    {
+        channel_->disableAll();
+        loop_->removeChannel(channel_.get());
+    }
+    if (inotifyFd_ >= 0)
+        ::close(inotifyFd_);
+}
+
+bool DirWatcher::Watch(const std::string &dir)
+{
+    if (inotifyFd_ < 0)
+    {
+        inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ < 0)
+        {
+            LOG_ERROR << "DirWatcher inotify_init1 failed, errno: " << errno;
+            return false;
+        }
+        channel_.reset(new Channel(loop_, inotifyFd_));
+        channel_->setReadCallback(std::bind(&DirWatcher::HandleInotify, this));
+        channel_->enableReading(true); // ET，HandleInotify 读到 EAGAIN
+    }
+    size_t before = watches_.size();
+    AddWatch(dir);
+    return watches_.size() > before;
+}
+
+void DirWatcher::AddWatch(const std::string &dir)
+{
+    const uint32_t mask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                          IN_CREATE | IN_DELETE_SELF | IN_ONLYDIR;
+    int wd = ::inotify_add_watch(inotifyFd_, dir.c_str(), mask);
+    if (wd < 0)
+    {
+        LOG_WARN << "DirWatcher watch " << dir << " failed, errno: " << errno;
+        return;
+    }
+    watches_[wd] = dir;
+    DIR *d = ::opendir(dir.c_str());
+    if (!d)
+        return;
+    while (struct dirent *e = ::readdir(d))
+    {
+        std::string name = e->d_name;
+        if (name == "." || name == "..")
+            continue;
+        if (e->d_type == DT_DIR)
+            AddWatch(dir + "/" + name);
+    }
+    ::closedir(d);
+}
+
+void DirWatcher::HandleInotify()
+{
+    alignas(struct inotify_event) char buf[16 * 1024];
+    while (true)
+    {
+        ssize_t n = ::read(inotifyFd_, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            break; // EAGAIN：本轮事件读完
+        }
+        for (char *p = buf; p < buf + n;)
+        {
+            struct inotify_event *ev = reinterpret_cast<struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                // 事件丢失，无法知道哪些文件变了
+                onReset_();
+                continue;
+            }
+            auto it = watches_.find(ev->wd);
+            if (it == watches_.end())
+                continue;
+            if (ev->mask & IN_IGNORED)
+            {
+                watches_.erase(it);
+                continue;
+            }
+            if (ev->len == 0)
+                continue; // 目录自身的事件
+            std::string path = it->second + "/" + ev->name;
+            if (!(ev->mask & IN_ISDIR))
+            {
+                onChange_(path);
+            }
+            else if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                // 加入监视前已写入子目录的文件收不到事件
+                AddWatch(path);
+                onReset_();
+            }
+            else if (ev->mask & (IN_MOVED_FROM | IN_DELETE))
+            {
+                onReset_(); // 整个子目录被移走，其下的路径都已失效，按目录逐个处理不划算
+            }
+        }
+    }
+}
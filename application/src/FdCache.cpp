@@ -0,0 +1,156 @@
+#include "FdCache.h"
+#include "DirWatcher.h"
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+CachedFile::~CachedFile()
+{
+    ::close(fd);
+}
+
+FdCache::FdCache(size_t capacity, size_t shards)
+{
+    if (shards == 0)
+        shards = 1;
+    shardCapacity_ = capacity / shards > 0 ? capacity / shards : 1;
+    for (size_t i = 0; i < shards; ++i)
+        shards_.emplace_back(new Shard);
+}
+
+FdCache::~FdCache() = default;
+
+std::shared_ptr<const CachedFile> FdCache::OpenFile(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    int64_t mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return std::make_shared<CachedFile>(fd, static_cast<uint64_t>(st.st_size), mtimeNs, st.st_ino, st.st_dev);
+}
+
+FdCache::Shard &FdCache::ShardFor(const std::string &path)
+{
+    return *shards_[std::hash<std::string>()(path) % shards_.size()];
+}
+
+std::shared_ptr<const CachedFile> FdCache::Lookup(Shard &shard, const std::string &path)
+{
+    auto it = shard.index.find(path);
+    if (it == shard.index.end())
+        return nullptr;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return it->second->second;
+}
+
+std::shared_ptr<const CachedFile> FdCache::Get(const std::string &path)
+{
+    Shard &shard = ShardFor(path);
+    std::shared_ptr<const CachedFile> file;
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        file = Lookup(shard, path);
+    }
+    if (file)
+        ++hits_;
+    return file;
+}
+
+std::shared_ptr<const CachedFile> FdCache::Open(const std::string &path)
+{
+    Shard &shard = ShardFor(path);
+    uint64_t generation;
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        if (std::shared_ptr<const CachedFile> file = Lookup(shard, path))
+        {
+            ++hits_;
+            return file;
+        }
+        generation = shard.generation;
+    }
+    ++misses_;
+    // open 不持锁，同一文件的并发未命中各自打开，后放入的覆盖先放入的
+    std::shared_ptr<const CachedFile> file = OpenFile(path);
+    if (!file)
+        return nullptr;
+
+    std::shared_ptr<const CachedFile> evicted; // 在锁外释放（close）
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    if (shard.generation != generation)
+        return file; // open 期间有失效发生，可能正是这个文件，本次使用但不缓存
+    auto it = shard.index.find(path);
+    if (it != shard.index.end())
+    {
+        it->second->second = file;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return file;
+    }
+    shard.lru.emplace_front(path, file);
+    shard.index[path] = shard.lru.begin();
+    if (shard.lru.size() > shardCapacity_)
+    {
+        evicted = std::move(shard.lru.back().second);
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+        ++evictions_;
+    }
+    return file;
+}
+
+void FdCache::Invalidate(const std::string &path)
+{
+    Shard &shard = ShardFor(path);
+    std::shared_ptr<const CachedFile> removed;
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    ++shard.generation;
+    auto it = shard.index.find(path);
+    if (it == shard.index.end())
+        return;
+    removed = std::move(it->second->second);
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+    ++invalidations_;
+}
+
+void FdCache::Clear()
+{
+    for (auto &shard : shards_)
+    {
+        std::list<Entry> removed;
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        ++shard->generation;
+        invalidations_ += shard->lru.size();
+        removed.swap(shard->lru);
+        shard->index.clear();
+    }
+}
+
+FdCache::Stats FdCache::GetStats() const
+{
+    Stats st;
+    st.hits = hits_.load();
+    st.misses = misses_.load();
+    st.evictions = evictions_.load();
+    st.invalidations = invalidations_.load();
+    for (auto &shard : shards_)
+    {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        st.entries += shard->lru.size();
+    }
+    return st;
+}
+
+bool FdCache::Watch(EventLoop *loop, const std::string &dir)
+{
+    if (!watcher_)
+        watcher_.reset(new DirWatcher(loop, std::bind(&FdCache::Invalidate, this, std::placeholders::_1), std::bind(&FdCache::Clear, this)));
+    return watcher_->Watch(dir);
+}
@@ -1,14 +1,18 @@
 #include "inc/FileHandler.h"
 #include "Connection.h"
+#include "EventLoop.h"
+#include "HttpServer.h"
 #include "HttpUtil.h"
 #include "Util.h"
-#include "FileDownContext.h"
 #include "FileUploadContext.h"
+#include "MultipartParser.h"
+#include "Sha256.h"
 #include "FileRepository.h"
 #include "Logger.h"
 #include "RangeUtil.h"
 #include <nlohmann/json.hpp>
 #include <experimental/filesystem>
+#include <sys/statvfs.h>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
@@ -17,56 +21,87 @@
 using json = nlohmann::json;
 namespace fs = std::experimental::filesystem;
 
-FileHandler::FileHandler(Db &db, AuthHandler &auth, FilenameMap &fmap, const std::string &uploadDir)
-    : db_(db), auth_(auth), fmap_(fmap), uploadDir_(uploadDir), filesRepo_(db), sharesRepo_(db) {}
+FileHandler::FileHandler(DbPool &db, AuthHandler &auth, FilenameMap &fmap, BlobStore &blobStore, ContentCache &contentCache, const std::string &uploadDir)
+    : db_(db), auth_(auth), fmap_(fmap), blobStore_(blobStore), contentCache_(contentCache), uploadDir_(uploadDir), filesRepo_(db), sharesRepo_(db), blobsRepo_(db) {}
 
-bool FileHandler::handleListFiles(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+Task<HttpResponse> FileHandler::handleListFiles(std::shared_ptr<Connection> conn, HttpRequest &req)
 {
+    HttpResponse resp(false);
     std::string sessionId = req.GetHeader("X-Session-ID");
-    int userId;
-    std::string username;
-    if (!auth_.validateSession(sessionId, userId, username))
+    // ?type=my|shared|all&sort=newest|oldest|name|name_desc|largest|smallest&limit=N&cursor=上一页返回的 nextCursor
+    FileListQuery::Type type;
+    FileListQuery::Sort sort;
+    int limit;
+    std::optional<FileListQuery::Cursor> cursor;
+    std::string cursorText = req.GetQueryValue("cursor");
+    if (!FileListQuery::ParseType(req.GetQueryValue("type"), &type) || !FileListQuery::ParseSort(req.GetQueryValue("sort"), &sort) ||
+        !FileListQuery::ParseLimit(req.GetQueryValue("limit"), &limit))
     {
-        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
-        return true;
+        sendError(&resp, "无效的列表参数", HttpStatusCode::BadRequest, conn);
+        co_return resp;
+    }
+    if (!cursorText.empty())
+    {
+        cursor.emplace();
+        if (!FileListQuery::DecodeCursor(cursorText, sort, &*cursor))
+        {
+            sendError(&resp, "无效的翻页游标", HttpStatusCode::BadRequest, conn);
+            co_return resp;
+        }
+    }
+
+    // 会话校验与查询在执行器上一次完成（一页一条 SQL，分享信息随行取回），回到 loop 线程后只拼装 JSON
+    struct Listing
+    {
+        bool authed = false;
+        bool ok = false;
+        FilePage page;
+    };
+    Listing listing = co_await Offload(executor_, "GET /files", [this, sessionId, type, sort, limit, cursor]() {
+        Listing l;
+        int userId;
+        std::string username;
+        if (!auth_.validateSession(sessionId, userId, username))
+            return l;
+        l.authed = true;
+        l.ok = filesRepo_.listFiles(userId, type, sort, cursor ? &*cursor : nullptr, limit, l.page);
+        return l;
+    });
+    if (!listing.authed)
+    {
+        sendError(&resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        co_return resp;
+    }
+    if (!listing.ok)
+    {
+        sendError(&resp, "获取文件列表失败", HttpStatusCode::InternalServerError, conn);
+        co_return resp;
     }
 
-    std::string listType = req.GetQueryValue("type");
-    listType = listType == "" ? "my" : listType;
     json out;
     out["code"] = 0;
     out["message"] = "Success";
     json files = json::array();     // json数组，存储文件信息
-    std::vector<FileRow> rows;
-    if (listType == "my")
-        rows = filesRepo_.listMyFiles(userId);
-    else if (listType == "shared")
-        rows = filesRepo_.listSharedFiles(userId);
-    else if (listType == "all")
-        rows = filesRepo_.listAllFiles(userId);
-
-    for (const auto &fr : rows)
+    for (size_t i = 0; i < listing.page.rows.size(); ++i)
     {
+        const FileRow &fr = listing.page.rows[i];
+        const std::optional<ShareInfoRow> &si = listing.page.shares[i];
         json shareInfo = nullptr;
-        if (fr.isOwner)
+        if (si)
         {
-            auto si = filesRepo_.getShareInfo(fr.id);               // 获取分享信息
-            if (si)
+            shareInfo = {{"type", si->shareType}};
+            if (si->shareCode)
+                shareInfo["shareCode"] = *si->shareCode;
+            if (si->extractCode && si->shareType == "protected")
+                shareInfo["extractCode"] = *si->extractCode;
+            if (si->shareWithId && si->shareType == "user")
             {
-                shareInfo = {{"type", si->shareType}};
-                if (si->shareCode)
-                    shareInfo["shareCode"] = *si->shareCode;
-                if (si->extractCode && si->shareType == "protected")
-                    shareInfo["extractCode"] = *si->extractCode;
-                if (si->shareWithId && si->shareType == "user")
-                {
-                    shareInfo["sharedWithId"] = *si->shareWithId;
-                    if (si->sharedWithUsername)
-                        shareInfo["sharedWithUsername"] = *si->sharedWithUsername;
-                }
-                if (si->expireTime)
-                    shareInfo["expireTime"] = *si->expireTime;
+                shareInfo["sharedWithId"] = *si->shareWithId;
+                if (si->sharedWithUsername)
+                    shareInfo["sharedWithUsername"] = *si->sharedWithUsername;
             }
+            if (si->expireTime)
+                shareInfo["expireTime"] = *si->expireTime;
         }
         json fileInfo = {{"id", fr.id}, {"name", fr.filename}, {"originalName", fr.originalFilename}, {"size", fr.size}, {"type", fr.type}, {"createdAt", fr.createdAt}, {"isOwner", fr.isOwner}};
         if (shareInfo != nullptr)
@@ -74,8 +109,9 @@ bool FileHandler::handleListFiles(const std::shared_ptr<Connection> &conn, HttpR
         files.push_back(fileInfo);
     }
     out["files"] = files;
-    sendJson(resp, out, conn, HttpStatusCode::OK);
-    return true;
+    out["nextCursor"] = listing.page.nextCursor.empty() ? json(nullptr) : json(listing.page.nextCursor);
+    sendJson(&resp, out, conn, HttpStatusCode::OK);
+    co_return resp;
 }
 
 bool FileHandler::handleDelete(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
@@ -96,14 +132,13 @@ bool FileHandler::handleDelete(const std::shared_ptr<Connection> &conn, HttpRequ
         return true;
     }
     // 获取文件ID
-    std::string filepath = uploadDir_ + "/" + filename;
-    auto fileIdOpt = filesRepo_.getOwnedFileIdByServerFilename(filename, userId);
-    if (!fileIdOpt)
+    auto fileOpt = filesRepo_.getByServerFilename(filename);
+    if (!fileOpt || fileOpt->ownerId != userId)
     {
         sendError(resp, "文件不存在或无权限删除", HttpStatusCode::NotFound, conn);
         return true;
     }
-    int fileId = *fileIdOpt;
+    int fileId = fileOpt->id;
 
     // 删除文件记录
     if (!filesRepo_.deleteFileById(fileId))
@@ -112,13 +147,17 @@ bool FileHandler::handleDelete(const std::shared_ptr<Connection> &conn, HttpRequ
         return true;
     }
 
-    // 删除文件
-    if (access(filepath.c_str(), F_OK) == 0)
+    if (!fileOpt->contentHash.empty())
     {
-        if (unlink(filepath.c_str()) != 0)
-        {
-            LOG_WARN << "Failed to delete file: " << filepath;
-        }
+        // 内容可能被其他文件共享，只减引用，由回收任务删除无引用的内容
+        if (!blobsRepo_.release(fileOpt->contentHash))
+            LOG_WARN << "Failed to release blob: " << fileOpt->contentHash;
+    }
+    else
+    {
+        // 删除引入内容寻址之前上传的文件
+        if (!blobStore_.RemoveLegacy(filename))
+            LOG_WARN << "Failed to delete legacy file: " << filename;
     }
     fmap_.erase(filename);
     json out = {{"code", 0}, {"message", "success"}};
@@ -148,6 +187,7 @@ bool FileHandler::handleDownload(const std::shared_ptr<Connection> &conn, HttpRe
     std::string extractCode = req.GetQueryValue("extract_code"); // 提取码,私有时使用
     std::string serverFilename;
     std::string originalFilename;
+    std::string contentHash;
     int ownerId = 0;
     bool permitted = false;
 
@@ -162,6 +202,7 @@ bool FileHandler::handleDownload(const std::shared_ptr<Connection> &conn, HttpRe
         ShareRecord share = *shareOpt;
         serverFilename = share.serverFilename;
         originalFilename = share.originalFilename;
+        contentHash = share.contentHash;
         ownerId = share.fileOwnerId;
         if (serverFilename != filename)
         {
@@ -193,6 +234,7 @@ bool FileHandler::handleDownload(const std::shared_ptr<Connection> &conn, HttpRe
         }
         serverFilename = fileOpt->serverFilename;
         originalFilename = fileOpt->originalFilename;
+        contentHash = fileOpt->contentHash;
         ownerId = fileOpt->ownerId;
         permitted = (userId == ownerId);
     }
@@ -205,13 +247,13 @@ bool FileHandler::handleDownload(const std::shared_ptr<Connection> &conn, HttpRe
         return true;
     }
 
-    std::string filepath = uploadDir_ + "/" + serverFilename;
-    if (!fs::exists(filepath) || !fs::is_regular_file(filepath))
+    std::shared_ptr<const CachedFile> file = blobStore_.Open(serverFilename, contentHash);
+    if (!file)
     {
         sendError(resp, "文件不存在", HttpStatusCode::NotFound, conn);
         return true;
     }
-    uintmax_t fileSize = fs::file_size(filepath);
+    uint64_t fileSize = file->size;
 
     // 处理 HEAD 请求
     if (req.GetMethod() == HttpMethod::kHead)
@@ -219,11 +261,8 @@ bool FileHandler::handleDownload(const std::shared_ptr<Connection> &conn, HttpRe
         resp->SetStatusCode(HttpStatusCode::OK);
         resp->SetStatusMessage("OK");
         resp->SetContentType("application/octet-stream");
-        resp->AddHeader("Content-Length", std::to_string(fileSize));
+        resp->SetContentLength(static_cast<long long>(fileSize));
         resp->AddHeader("Accept-Ranges", "bytes");
-        resp->AddHeader("Connection", "close");
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection> &c)
-                                       { c->shutdown(); return true; });
         return true;
     }
 
@@ -236,194 +275,282 @@ bool FileHandler::handleDownload(const std::shared_ptr<Connection> &conn, HttpRe
         return true;
     }
 
-    std::shared_ptr<HttpContext> httpContext = conn->GetContext();
-    if (!httpContext)
-    {
-        sendError(resp, "Internal Server Error", HttpStatusCode::InternalServerError, conn);
-        return true;
-    }
-    std::shared_ptr<FileDownContext> downContext = httpContext->GetContext<FileDownContext>(); // 试图获取已有的下载上下文
-    if (!downContext)
-    {
-        downContext = std::make_shared<FileDownContext>(filepath, originalFilename);
-        httpContext->SetContext(downContext);
-        if (rs.isRange)
-        {
-            resp->SetStatusCode(HttpStatusCode::PartialContent);
-            resp->SetStatusMessage("Partial Content");
-            resp->AddHeader("Content-Range", "bytes " + std::to_string(rs.start) + "-" + std::to_string(rs.end) + "/" + std::to_string(fileSize));
-        }
-        else
-        {
-            resp->SetStatusCode(HttpStatusCode::OK);
-            resp->SetStatusMessage("OK");
-        }
-        resp->SetContentType("application/octet-stream");
-        resp->SetBodyType(HttpBodyType::HTML_TYPE);
-        resp->SetContentLength(fileSize);
-        resp->AddHeader("Content-Disposition", "attachment; filename=\"" + originalFilename + "\"");
-        resp->AddHeader("Accept-Ranges", "bytes");
-        resp->AddHeader("Connection", "keep-alive");
-        downContext->seekTo(rs.isRange ? rs.start : 0);
-    }
-    conn->setWriteCompleteCallback([downContext](const std::shared_ptr<Connection> &c)
-                                   {
-        std::string chunk; 
-        if (downContext->readNextChunk(chunk)) { c->Send(chunk); return true; }
-        c->shutdown(); 
-        return true; });
-
+    sendFile(resp, file, rs, originalFilename, conn, &contentCache_);
     return true;
 }
 
-bool FileHandler::handleUpload(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+bool FileHandler::checkUpload(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
 {
-    // 验证用户身份
     std::string sessionId = req.GetHeader("X-Session-ID");
     int userId;
     std::string username;
     if (!auth_.validateSession(sessionId, userId, username))
     {
         sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
-        return true;
+        return false;
+    }
+    std::shared_ptr<FileUploadContext> uploadContext = newUploadContext(conn, req, resp, userId);
+    if (!uploadContext)
+        return false;
+    // chunked 请求没有 Content-Length，大小只能在写盘时得知
+    uint64_t contentLength = std::strtoull(req.GetHeader("Content-Length").c_str(), nullptr, 10);
+    if (maxUploadBytes_ > 0 && contentLength > maxUploadBytes_)
+    {
+        sendError(resp, "文件过大", HttpStatusCode::PayloadTooLarge, conn);
+        return false;
+    }
+    struct statvfs vfs;
+    if (::statvfs(uploadDir_.c_str(), &vfs) == 0 && contentLength > static_cast<uint64_t>(vfs.f_bavail) * vfs.f_frsize)
+    {
+        LOG_WARN << "Upload rejected: " << contentLength << " bytes, " << static_cast<uint64_t>(vfs.f_bavail) * vfs.f_frsize << " bytes free in " << uploadDir_;
+        sendError(resp, "存储空间不足", HttpStatusCode::InsufficientStorage, conn);
+        return false;
+    }
+    // 上下文（带已校验的用户）留给 handleUpload，请求体到达后不再校验会话
+    conn->GetContext()->SetContext(uploadContext);
+    return true;
+}
+
+std::shared_ptr<FileUploadContext> FileHandler::newUploadContext(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp, int userId)
+{
+    std::string contentType = req.GetHeader("Content-Type");
+    if (contentType.empty())
+    {
+        sendError(resp, "Content-Type header is missing", HttpStatusCode::BadRequest, conn);
+        return nullptr;
     }
+    std::string boundary = MultipartParser::ExtractBoundary(contentType);
+    if (boundary.empty())
+    {
+        sendError(resp, "Invalid Content-Type", HttpStatusCode::BadRequest, conn);
+        return nullptr;
+    }
+    std::string headerFilename = req.GetHeader("X-File-Name");
+    uint64_t contentLength = std::strtoull(req.GetHeader("Content-Length").c_str(), nullptr, 10);
+    auto uploadContext = std::make_shared<FileUploadContext>(incomingDir(), boundary, headerFilename.empty() ? "" : UrlDecode(headerFilename), contentLength);
+    uploadContext->setUserId(userId);
+    return uploadContext;
+}
 
-    // 处理上传
+bool FileHandler::handleUpload(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
     auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
     if (!httpContext)
     {
         sendError(resp, "Internal Server Error", HttpStatusCode::InternalServerError, conn);
         return true;
     }
+    // 上传上下文由预检（在阻塞任务执行器上）创建，之后的分片不再查询会话；未配置预检时才由首个分片在此创建
     std::shared_ptr<FileUploadContext> uploadContext = httpContext->GetContext<FileUploadContext>();
-    // 初始化上传上下文
     if (!uploadContext)
     {
-        std::string contentType = req.GetHeader("Content-Type");
-        if (contentType.empty())
+        std::string sessionId = req.GetHeader("X-Session-ID");
+        int userId;
+        std::string username;
+        if (!auth_.validateSession(sessionId, userId, username))
         {
-            sendError(resp, "Content-Type header is missing", HttpStatusCode::BadRequest, conn);
+            sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
             return true;
         }
-        std::smatch m;
-        std::regex boundaryRegex("boundary=(.+)$");
-        if (!std::regex_search(contentType, m, boundaryRegex))
-        {
-            sendError(resp, "Invalid Content-Type", HttpStatusCode::BadRequest, conn);
+        uploadContext = newUploadContext(conn, req, resp, userId);
+        if (!uploadContext)
             return true;
-        }
-        std::string boundary = "--" + m[1].str();
-        std::string originalFilename;
-        std::string headerFilename = req.GetHeader("X-File-Name");
-        if (!headerFilename.empty())
-            originalFilename = UrlDecode(headerFilename);
-        else
-        {
-            std::string body = req.GetBody();
-            std::regex filenameRegex("Content-Disposition:.*filename=\"([^\"]+)\"");
-            if (std::regex_search(body, m, filenameRegex) && m[1].matched)
-                originalFilename = m[1].str();
-            else
-                originalFilename = "unknown_file";
-        }
-        std::string filename = UniqueFilename("upload");
-        std::string filepath = uploadDir_ + "/" + filename;
-        uploadContext = std::make_shared<FileUploadContext>(filepath, originalFilename);
         httpContext->SetContext(uploadContext);
-        uploadContext->setBoundary(boundary);
-        std::string body = req.GetBody();
-        size_t pos = body.find("\r\n\r\n");
-        if (pos != std::string::npos)
+    }
+
+    // 本次收到的请求体交给解析器，文件内容直接写盘
+    const std::string &body = req.GetBody();
+    bool ok = uploadContext->feed(body.data(), body.size());
+    req.SetBody("");
+    if (!ok)
+    {
+        LOG_WARN << "Upload rejected: " << uploadContext->getError();
+        httpContext->SetContext(std::shared_ptr<void>());
+        sendError(resp, "Invalid multipart body", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+
+    // 请求体尚未收完：写盘队列已满时暂停读取，队列回落后恢复
+    if (!httpContext->GetCompleteRequest())
+    {
+        if (uploadContext->backpressured() && conn->IsReading())
         {
-            pos += 4;
-            std::string endBoundary = boundary + "--";
-            size_t endPos = body.find(endBoundary);
-            if (endPos != std::string::npos)
-            {
-                if (endPos > 0)
-                    uploadContext->writeData(body.data() + pos, endPos - pos);
-                uploadContext->setState(FileUploadContext::State::kComplete);
-            }
-            else
-            {
-                if (pos < body.size())
-                    uploadContext->writeData(body.data() + pos, body.size() - pos);
-                uploadContext->setState(FileUploadContext::State::kExpectBoundary);
-            }
+            conn->StopReading();
+            std::weak_ptr<Connection> weakConn(conn);
+            EventLoop *loop = conn->GetLoop();
+            uploadContext->notifyWhenDrained([weakConn, loop]() {
+                loop->queueOneFunc([weakConn]() {
+                    if (auto c = weakConn.lock())
+                        c->StartReading();
+                });
+            });
         }
-        req.SetBody("");
+        return false;
     }
-    else   // 已有上传上下文，继续处理
+
+    // 请求体已全部到达但 multipart 未结束，视为格式错误
+    if (!uploadContext->isComplete())
+    {
+        httpContext->SetContext(std::shared_ptr<void>());
+        sendError(resp, "Incomplete multipart body", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+    if (uploadContext->getFiles().empty())
     {
-        std::string body = req.GetBody();
-        if (!body.empty())
+        httpContext->SetContext(std::shared_ptr<void>());
+        sendError(resp, "No file in request", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+
+    // 等所有文件 fdatasync + rename 完成后在执行器上入库，回到本连接的 loop 线程只发送响应
+    std::weak_ptr<Connection> weakConn(conn);
+    EventLoop *loop = conn->GetLoop();
+    bool close = resp->IsCloseConnection();
+    uploadContext->whenCommitted([this, weakConn, loop, uploadContext, close](bool ok) {
+        finishBlocking(weakConn, loop, "upload.register", close, [this, uploadContext, ok](HttpResponse *result) { registerUploads(*uploadContext, ok, result); });
+    });
+    return false;
+}
+
+void FileHandler::finishBlocking(const std::weak_ptr<Connection> &conn, EventLoop *loop, const std::string &name, bool close, std::function<void(HttpResponse *)> work)
+{
+    auto result = std::make_shared<HttpResponse>(close);
+    auto run = [conn, loop, name, result, work]() {
+        try
         {
-            switch (uploadContext->getState())
-            {
-            case FileUploadContext::State::kExpectBoundary:
-            {
-                std::string endBoundary = uploadContext->getBoundary() + "--";
-                size_t endPos = body.find(endBoundary);
-                if (endPos != std::string::npos)
-                {
-                    if (endPos > 0)
-                        uploadContext->writeData(body.data(), endPos);
-                    uploadContext->setState(FileUploadContext::State::kComplete);
-                    break;
-                }
-                size_t boundaryPos = body.find(uploadContext->getBoundary());
-                if (boundaryPos != std::string::npos)
-                {
-                    size_t contentStart = body.find("\r\n\r\n", boundaryPos);
-                    if (contentStart != std::string::npos)
-                    {
-                        contentStart += 4;
-                        if (boundaryPos > 0)
-                            uploadContext->writeData(body.data(), boundaryPos);
-                        uploadContext->setState(FileUploadContext::State::kExpectContent);
-                    }
-                }
-                else
-                {
-                    uploadContext->writeData(body.data(), body.size());
-                }
-                break;
-            }
-            case FileUploadContext::State::kExpectContent:
-            {
-                size_t boundaryPos = body.find(uploadContext->getBoundary());
-                if (boundaryPos != std::string::npos)
-                {
-                    uploadContext->writeData(body.data(), boundaryPos);
-                    uploadContext->setState(FileUploadContext::State::kExpectBoundary);
-                }
-                else
-                {
-                    uploadContext->writeData(body.data(), body.size());
-                }
-                break;
-            }
-            case FileUploadContext::State::kComplete:
-                break;
-            default:
-                break;
-            }
+            work(result.get());
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR << name << " failed: " << e.what();
+            sendError(result.get(), "Internal Server Error", HttpStatusCode::InternalServerError, nullptr);
         }
-        req.SetBody("");
+        loop->queueOneFunc([conn, result]() {
+            auto c = conn.lock();
+            std::shared_ptr<HttpContext> httpContext = c ? c->GetContext() : nullptr;
+            if (!httpContext || !httpContext->HasDeferredResponse())
+                return;
+            *httpContext->GetDeferredResponse() = *result;
+            httpContext->SetContext(std::shared_ptr<void>());
+            HttpServer::SendDeferredResponse(c);
+        });
+    };
+    // 数据已经落盘，不因队列满而丢弃，也不占用调用方（磁盘 I/O）线程
+    if (executor_ && executor_->SubmitUnbounded(name, run))
+        return;
+    loop->queueOneFunc(run); // 未设置执行器：与其他业务一样在 loop 线程完成
+}
+
+void FileHandler::registerUploads(const FileUploadContext &uploadContext, bool committed, HttpResponse *resp)
+{
+    if (!committed)
+    {
+        sendError(resp, "文件保存失败", HttpStatusCode::InternalServerError, nullptr);
+        return;
     }
-    // 检查上传是否完成
-    if (uploadContext->getState() == FileUploadContext::State::kComplete || httpContext->GetCompleteRequest())
+    json uploaded = json::array();
+    for (const auto &f : uploadContext.getFiles())
     {
-        std::string serverFilename = fs::path(uploadContext->getFilename()).filename().string();
-        std::string originalFilename = uploadContext->getOriginalFilename();
-        uintmax_t fileSize = uploadContext->getTotalBytes();
-        std::string fileType = FileTypeByExt(originalFilename);
-        auto fileIdOpt = filesRepo_.createFile(serverFilename, originalFilename, fileSize, fileType, userId);
+        // 对外的文件名仍是每次上传唯一的标识，实际内容按摘要存放
+        std::string serverFilename = fs::path(f.filename).filename().string();
+        auto fileIdOpt = registerUpload(f.filename, serverFilename, f.originalFilename, f.size, f.sha256, uploadContext.getUserId());
         int fileId = fileIdOpt.value_or(0);
-        json out = {{"code", 0}, {"message", "上传成功"}, {"fileId", fileId}, {"filename", serverFilename}, {"originalFilename", originalFilename}, {"size", fileSize}};
-        sendJson(resp, out, conn);
-        httpContext->SetContext(std::shared_ptr<void>());
+        uploaded.push_back({{"fileId", fileId}, {"filename", serverFilename}, {"originalFilename", f.originalFilename}, {"size", f.size}, {"sha256", f.sha256}});
+    }
+    // 顶层字段保持与单文件上传一致，多文件时附带 files 列表
+    json out = uploaded[0];
+    out["code"] = 0;
+    out["message"] = "上传成功";
+    if (uploaded.size() > 1)
+        out["files"] = uploaded;
+    sendJson(resp, out, nullptr);
+}
+
+std::optional<int> FileHandler::registerUpload(const std::string &path, const std::string &serverFilename, const std::string &originalFilename, uint64_t size, const std::string &sha256, int userId)
+{
+    // 先加引用再放入存储，保证回收任务不会删掉刚被引用的内容
+    if (!blobsRepo_.addRef(sha256, size))
+        return std::nullopt;
+    if (!blobStore_.Adopt(path, sha256))
+    {
+        blobsRepo_.release(sha256);
+        return std::nullopt;
+    }
+    auto fileIdOpt = filesRepo_.createFile(serverFilename, originalFilename, size, FileTypeByExt(originalFilename), userId, sha256);
+    if (!fileIdOpt)
+        blobsRepo_.release(sha256);
+    return fileIdOpt;
+}
+
+bool FileHandler::handleInstantUpload(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
         return true;
     }
-    return false;
-}
\ No newline at end of file
+    json body = json::parse(req.GetBody(), nullptr, false);
+    if (body.is_discarded() || !body.is_object() || !body.contains("sha256") || !body["sha256"].is_string() ||
+        !body.contains("size") || !body["size"].is_number_unsigned() || !body.contains("filename") || !body["filename"].is_string())
+    {
+        sendError(resp, "参数错误", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+    std::string sha256 = body["sha256"].get<std::string>();
+    uint64_t size = body["size"].get<uint64_t>();
+    std::string originalFilename = body["filename"].get<std::string>();
+    if (!Sha256::ValidHex(sha256) || originalFilename.empty())
+    {
+        sendError(resp, "参数错误", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+
+    // 内容不存在（或正被回收）时返回 404，客户端改走普通上传
+    if (!blobsRepo_.addRefIfExists(sha256, size))
+    {
+        sendError(resp, "内容不存在，请正常上传", HttpStatusCode::NotFound, conn);
+        return true;
+    }
+    if (!blobStore_.Exists(sha256))
+    {
+        blobsRepo_.release(sha256);
+        sendError(resp, "内容不存在，请正常上传", HttpStatusCode::NotFound, conn);
+        return true;
+    }
+    std::string serverFilename = UniqueFilename("upload");
+    auto fileIdOpt = filesRepo_.createFile(serverFilename, originalFilename, size, FileTypeByExt(originalFilename), userId, sha256);
+    if (!fileIdOpt)
+    {
+        blobsRepo_.release(sha256);
+        sendError(resp, "文件入库失败", HttpStatusCode::InternalServerError, conn);
+        return true;
+    }
+    json out = {{"code", 0}, {"message", "秒传成功"}, {"instant", true}, {"fileId", *fileIdOpt}, {"filename", serverFilename},
+                {"originalFilename", originalFilename}, {"size", size}, {"sha256", sha256}};
+    sendJson(resp, out, conn);
+    return true;
+}
+
+void FileHandler::collectBlobs(int graceSeconds)
+{
+    // 宽限期内的 0 引用内容保留，给秒传/重复上传复用的机会
+    size_t collected = 0;
+    for (const auto &hash : blobsRepo_.listUnreferenced(graceSeconds, 1000))
+    {
+        if (!blobStore_.BeginCollect(hash))
+        {
+            // 文件已不存在，只清理记录
+            blobsRepo_.removeIfUnreferenced(hash);
+            continue;
+        }
+        bool removed = blobsRepo_.removeIfUnreferenced(hash);
+        blobStore_.FinishCollect(hash, removed);
+        if (removed)
+            ++collected;
+    }
+    if (collected > 0)
+        LOG_INFO << "Collected " << collected << " unreferenced blobs";
+}
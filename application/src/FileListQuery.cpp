@@ -0,0 +1,172 @@
+#include "FileListQuery.h"
+#include "Base64Url.h"
+#include <stdlib.h>
+
+namespace
+{
+const char *kSortNames[] = {"newest", "oldest", "name", "name_desc", "largest", "smallest"};
+
+const char *Column(FileListQuery::Sort sort)
+{
+    switch (sort)
+    {
+    case FileListQuery::kNewest:
+    case FileListQuery::kOldest:
+        return "created_at";
+    case FileListQuery::kNameAsc:
+    case FileListQuery::kNameDesc:
+        return "original_filename";
+    case FileListQuery::kLargest:
+    case FileListQuery::kSmallest:
+        return "file_size";
+    }
+    return "created_at";
+}
+
+bool Descending(FileListQuery::Sort sort)
+{
+    return sort == FileListQuery::kNewest || sort == FileListQuery::kNameDesc || sort == FileListQuery::kLargest;
+}
+
+// 上一页最后一行之后：(col, id) 严格小于（降序）或大于（升序）游标；展开成 OR 以便按复合索引做范围扫描
+std::string After(const std::string &table, FileListQuery::Sort sort)
+{
+    std::string col = table + "." + Column(sort);
+    std::string id = table + ".id";
+    const char *op = Descending(sort) ? " < " : " > ";
+    std::string key = sort == FileListQuery::kLargest || sort == FileListQuery::kSmallest ? "CAST(? AS UNSIGNED)" : "?"; // 游标键以文本传入
+    return "(" + col + op + key + " OR (" + col + " = " + key + " AND " + id + op + "?))";
+}
+
+std::string OrderBy(const std::string &table, FileListQuery::Sort sort)
+{
+    const char *dir = Descending(sort) ? " DESC" : " ASC";
+    return " ORDER BY " + table + "." + Column(sort) + dir + ", " + table + ".id" + dir;
+}
+
+const char kSharedWithMe[] = "EXISTS (SELECT 1 FROM file_shares s2 WHERE s2.file_id = f.id AND (s2.shared_with_id = ? OR s2.share_type = 'public'))";
+} // namespace
+
+bool FileListQuery::ParseType(const std::string &s, Type *out)
+{
+    if (s.empty() || s == "my")
+        *out = kMine;
+    else if (s == "shared")
+        *out = kShared;
+    else if (s == "all")
+        *out = kAll;
+    else
+        return false;
+    return true;
+}
+
+bool FileListQuery::ParseSort(const std::string &s, Sort *out)
+{
+    if (s.empty())
+    {
+        *out = kNewest;
+        return true;
+    }
+    for (int i = 0; i <= kSmallest; ++i)
+    {
+        if (s == kSortNames[i])
+        {
+            *out = static_cast<Sort>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileListQuery::ParseLimit(const std::string &s, int *out)
+{
+    if (s.empty())
+    {
+        *out = kDefaultLimit;
+        return true;
+    }
+    if (s.size() > 9 || s.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    int n = atoi(s.c_str());
+    if (n <= 0)
+        return false;
+    *out = n > kMaxLimit ? kMaxLimit : n;
+    return true;
+}
+
+const char *FileListQuery::SortName(Sort sort)
+{
+    return kSortNames[sort];
+}
+
+std::string FileListQuery::EncodeCursor(Sort sort, const std::string &key, int id)
+{
+    std::string raw = std::string(SortName(sort)) + "\n" + std::to_string(id) + "\n" + key;
+    return EncodeBase64Url(raw.data(), raw.size());
+}
+
+bool FileListQuery::DecodeCursor(const std::string &s, Sort sort, Cursor *out)
+{
+    std::string raw;
+    if (s.size() > 2048 || !DecodeBase64Url(s, &raw))
+        return false;
+    size_t a = raw.find('\n');
+    size_t b = a == std::string::npos ? std::string::npos : raw.find('\n', a + 1);
+    if (b == std::string::npos || raw.compare(0, a, SortName(sort)) != 0 || b == a + 1 || b - a - 1 > 9)
+        return false;
+    std::string id = raw.substr(a + 1, b - a - 1);
+    if (id.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    out->id = atoi(id.c_str());
+    out->key = raw.substr(b + 1);
+    return true;
+}
+
+unsigned FileListQuery::KeyColumn(Sort sort)
+{
+    switch (sort)
+    {
+    case kNameAsc:
+    case kNameDesc:
+        return 2;
+    case kLargest:
+    case kSmallest:
+        return 3;
+    default:
+        return 5;
+    }
+}
+
+std::string FileListQuery::Sql(Type type, Sort sort, bool withCursor)
+{
+    static const char kFileColumns[] = "f.id, f.filename, f.original_filename, f.file_size, f.file_type, f.created_at, f.user_id";
+    std::string source;
+    std::string where;
+    switch (type)
+    {
+    case kMine:
+        source = "files f";
+        where = " WHERE f.user_id = ?";
+        break;
+    case kShared:
+        source = "files f";
+        where = std::string(" WHERE f.user_id != ? AND ") + kSharedWithMe;
+        break;
+    case kAll:
+    {
+        // 自己的与他人分享的两部分互不重叠，各自按索引取一页后合并，不用 OR 条件（无法走索引）也不会因多条分享产生重复行
+        std::string keyset = withCursor ? " AND " + After("f", sort) : std::string();
+        std::string mine = std::string("(SELECT ") + kFileColumns + " FROM files f WHERE f.user_id = ?" + keyset + OrderBy("f", sort) + " LIMIT ?)";
+        std::string shared = std::string("(SELECT ") + kFileColumns + " FROM files f WHERE f.user_id != ? AND " + kSharedWithMe + keyset + OrderBy("f", sort) + " LIMIT ?)";
+        source = "(" + mine + " UNION ALL " + shared + ") f";
+        withCursor = false; // 已在两部分内分别过滤
+        break;
+    }
+    }
+    if (withCursor)
+        where += " AND " + After("f", sort);
+    return std::string("SELECT ") + kFileColumns + ", fs.share_type, fs.shared_with_id, u.username, fs.share_code, fs.extract_code, fs.expire_time FROM " + source +
+           " LEFT JOIN file_shares fs ON fs.id = (SELECT MIN(s.id) FROM file_shares s WHERE s.file_id = f.id)"
+           " LEFT JOIN users u ON fs.shared_with_id = u.id" +
+           where + OrderBy("f", sort) + " LIMIT ?";
+}
@@ -1,38 +1,159 @@
 #include "FileUploadContext.h"
+#include "Util.h"
 #include "Logger.h"
+#include <unistd.h>
 
-FileUploadContext::FileUploadContext(const std::string &filename, const std::string &originalFilename)
-    : filename_(filename), originalFilename_(originalFilename), totalBytes_(0), state_(State::kExpectHeaders), boundary_("")
+FileUploadContext::FileUploadContext(const std::string &uploadDir, const std::string &boundary, const std::string &preferredName, uint64_t contentLength)
+    : uploadDir_(uploadDir), preferredName_(preferredName), contentLength_(contentLength), consumed_(0), io_(nullptr),
+      hashIo_(DiskIoThread::HashWorker()), parser_(boundary), commit_(std::make_shared<CommitState>()), fileBytes_(0), totalBytes_(0),
+      fieldBytes_(0), inFile_(false)
 {
     // 确保目录存在
-    fs::path filepath = fs::path(filename_).parent_path();
-    if (!fs::exists(filepath))
+    if (!fs::exists(uploadDir_))
     {
-        fs::create_directories(filepath);
-    }  
-    // 打开文件流
-    file_.open(filename_, std::ios::binary | std::ios::out);
-    if (!file_.is_open())
-    {
-        LOG_ERROR<<"Failed to open file: " << filename_ << " for writing";
+        fs::create_directories(uploadDir_);
     }
-    LOG_INFO << "Creating file: " << filename << ", original name: " << originalFilename;
+    io_ = DiskIoThread::ForPath(uploadDir_);
+    parser_.SetPartBeginCallback(std::bind(&FileUploadContext::onPartBegin, this, std::placeholders::_1));
+    parser_.SetPartDataCallback(std::bind(&FileUploadContext::onPartData, this, std::placeholders::_1, std::placeholders::_2));
+    parser_.SetPartEndCallback(std::bind(&FileUploadContext::onPartEnd, this));
 }
 
 FileUploadContext::~FileUploadContext()
 {
-    if(file_.is_open())
-    {
-        file_.close();
-    }
+    if (writer_)
+        writer_->Abort();
+    if (files_.empty())
+        return;
+    // 清理仍留在上传目录的文件（上传未完成或入库失败）；已入库的已移入内容存储。排在提交任务之后执行
+    std::vector<std::string> paths;
+    for (const auto &f : files_)
+        paths.push_back(f.filename);
+    io_->Submit([paths]() {
+        for (const auto &p : paths)
+            ::unlink(p.c_str());
+    });
+}
+
+bool FileUploadContext::feed(const char *data, size_t len)
+{
+    bool ok = parser_.Feed(data, len);
+    consumed_ += len;
+    return ok;
 }
 
 void FileUploadContext::writeData(const char *data, size_t len)
 {
-    if(file_.is_open())
+    if (writer_)
     {
-        file_.write(data, len);
-        file_.flush();
+        writer_->Append(data, len);
+        fileBytes_ += len;
         totalBytes_ += len;
     }
 }
+
+void FileUploadContext::whenCommitted(std::function<void(bool)> cb)
+{
+    // 请求体已解析完，files_ 不再增长；最后一个提交完成时把摘要填回 files_
+    std::function<void(bool)> run = [this, cb](bool ok) {
+        for (size_t i = 0; i < files_.size() && i < commit_->digests.size(); ++i)
+            files_[i].sha256 = commit_->digests[i];
+        cb(ok);
+    };
+    bool ready = false;
+    bool ok = true;
+    {
+        std::unique_lock<std::mutex> lock(commit_->mutex);
+        ready = commit_->pending == 0;
+        ok = commit_->ok;
+        if (!ready)
+            commit_->waiter = std::move(run);
+    }
+    if (ready)
+        run(ok);
+}
+
+void FileUploadContext::notifyWhenDrained(std::function<void()> cb)
+{
+    DiskIoThread *hash = hashIo_;
+    io_->NotifyWhenDrained([hash, cb]() { hash->NotifyWhenDrained(cb); });
+}
+
+bool FileUploadContext::onPartBegin(const MultipartParser::Part &part)
+{
+    inFile_ = part.isFile() && !part.filename.empty(); // 未选择文件时浏览器会发送空 filename
+    if (!inFile_)
+    {
+        fieldName_ = part.name;
+        fieldValue_.clear();
+        return true;
+    }
+    if (files_.empty() && !preferredName_.empty())
+        originalFilename_ = preferredName_;
+    else
+        originalFilename_ = part.filename;
+    filename_ = uploadDir_ + "/" + UniqueFilename("upload");
+    fileBytes_ = 0;
+    writer_ = std::make_shared<UploadWriter>(io_, filename_, filename_ + ".part");
+    // 剩余请求体长度是文件大小的上界，按它预分配，提交时截断
+    uint64_t remaining = contentLength_ > consumed_ ? contentLength_ - consumed_ : 0;
+    if (!writer_->Open(remaining))
+    {
+        writer_.reset();
+        return false;
+    }
+    writer_->EnableHash(hashIo_);
+    LOG_INFO << "Creating file: " << filename_ << ", original name: " << originalFilename_;
+    return true;
+}
+
+bool FileUploadContext::onPartData(const char *data, size_t len)
+{
+    if (inFile_)
+    {
+        writeData(data, len);
+        return !writer_->Failed();
+    }
+    fieldBytes_ += len;
+    if (fieldBytes_ > kMaxFieldBytes)
+        return false;
+    fieldValue_.append(data, len);
+    return true;
+}
+
+bool FileUploadContext::onPartEnd()
+{
+    if (!inFile_)
+    {
+        if (!fieldName_.empty())
+            fields_[fieldName_] = fieldValue_;
+        return true;
+    }
+    inFile_ = false;
+    size_t index = files_.size();
+    files_.push_back(UploadedFile{filename_, originalFilename_, fileBytes_, ""});
+    std::shared_ptr<CommitState> state = commit_;
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        ++state->pending;
+        state->digests.resize(index + 1);
+    }
+    std::shared_ptr<UploadWriter> writer = writer_;
+    writer_->Commit([state, writer, index](bool committed) {
+        std::function<void(bool)> waiter;
+        bool ok;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (!committed)
+                state->ok = false;
+            state->digests[index] = writer->Digest();
+            if (--state->pending == 0)
+                waiter.swap(state->waiter);
+            ok = state->ok;
+        }
+        if (waiter)
+            waiter(ok);
+    });
+    writer_.reset();
+    return true;
+}
@@ -0,0 +1,320 @@
+#include "MultipartParser.h"
+#include <algorithm>
+#include <string.h>
+#include <ctype.h>
+
+namespace
+{
+    std::string ToLower(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return s;
+    }
+
+    std::string Trim(const std::string &s)
+    {
+        size_t b = s.find_first_not_of(" \t");
+        if (b == std::string::npos)
+            return "";
+        size_t e = s.find_last_not_of(" \t");
+        return s.substr(b, e - b + 1);
+    }
+
+    // 解析 Content-Disposition/Content-Type 中的参数：key=value 或 key="value"
+    std::map<std::string, std::string> ParseParams(const std::string &value)
+    {
+        std::map<std::string, std::string> params;
+        size_t i = value.find(';');
+        while (i != std::string::npos && i < value.size())
+        {
+            ++i;
+            while (i < value.size() && (value[i] == ' ' || value[i] == '\t'))
+                ++i;
+            size_t eq = value.find('=', i);
+            size_t semi = value.find(';', i);
+            if (eq == std::string::npos || (semi != std::string::npos && semi < eq))
+            {
+                i = semi;
+                continue;
+            }
+            std::string key = ToLower(Trim(value.substr(i, eq - i)));
+            std::string val;
+            size_t j = eq + 1;
+            if (j < value.size() && value[j] == '"') // 带引号的值，支持反斜杠转义
+            {
+                ++j;
+                while (j < value.size() && value[j] != '"')
+                {
+                    if (value[j] == '\\' && j + 1 < value.size())
+                        ++j;
+                    val.push_back(value[j++]);
+                }
+                i = value.find(';', j);
+            }
+            else
+            {
+                i = value.find(';', j);
+                val = Trim(value.substr(j, i == std::string::npos ? std::string::npos : i - j));
+            }
+            params[key] = val;
+        }
+        return params;
+    }
+} // namespace
+
+MultipartParser::MultipartParser(const std::string &boundary)
+    : delimiter_("\r\n--" + boundary), state_(State::kPreamble), carry_("\r\n"), partCount_(0)
+{
+    // 第一个分隔符前没有 CRLF，预置到遗留区中即可与后续分隔符统一处理
+    size_t m = delimiter_.size();
+    for (size_t i = 0; i < 256; ++i)
+        skip_[i] = m;
+    for (size_t i = 0; i + 1 < m; ++i)
+        skip_[static_cast<unsigned char>(delimiter_[i])] = m - 1 - i;
+    if (boundary.empty())
+        Fail("empty boundary");
+}
+
+std::string MultipartParser::ExtractBoundary(const std::string &contentType)
+{
+    std::string lower = ToLower(contentType);
+    if (lower.compare(0, 10, "multipart/") != 0)
+        return "";
+    std::map<std::string, std::string> params = ParseParams(contentType);
+    auto it = params.find("boundary");
+    if (it == params.end() || it->second.empty() || it->second.size() > 200)
+        return "";
+    return it->second;
+}
+
+size_t MultipartParser::Search(const char *data, size_t len) const
+{
+    const size_t m = delimiter_.size();
+    const char *pat = delimiter_.data();
+    const unsigned char last = static_cast<unsigned char>(pat[m - 1]);
+    size_t i = 0;
+    while (i + m <= len)
+    {
+        unsigned char c = static_cast<unsigned char>(data[i + m - 1]);
+        if (c == last && memcmp(data + i, pat, m - 1) == 0)
+            return i;
+        i += skip_[c];
+    }
+    return len;
+}
+
+size_t MultipartParser::PartialSuffix(const char *data, size_t len) const
+{
+    size_t k = std::min(len, delimiter_.size() - 1);
+    for (; k > 0; --k)
+    {
+        const char *s = data + len - k;
+        if (*s == '\r' && memcmp(s, delimiter_.data(), k) == 0)
+            return k;
+    }
+    return 0;
+}
+
+bool MultipartParser::Feed(const char *data, size_t len)
+{
+    const char *p = data;
+    const char *end = data + len;
+    while (p < end)
+    {
+        bool ok = true;
+        switch (state_)
+        {
+        case State::kPreamble:
+        case State::kBody:
+            ok = ParseBody(p, end);
+            break;
+        case State::kBoundaryTail:
+            ok = ParseBoundaryTail(p, end);
+            break;
+        case State::kHeaders:
+            ok = ParseHeaders(p, end);
+            break;
+        case State::kEpilogue:
+            return true; // 结束分隔符后的内容直接忽略
+        case State::kError:
+            return false;
+        }
+        if (!ok)
+            return false;
+    }
+    return state_ != State::kError;
+}
+
+bool MultipartParser::ParseBody(const char *&p, const char *end)
+{
+    const size_t m = delimiter_.size();
+    if (!carry_.empty())
+    {
+        // 遗留字节 + 本分片开头的少量字节，检查跨分片的分隔符
+        size_t avail = end - p;
+        size_t need = std::min(avail, m - 1);
+        std::string window = carry_;
+        window.append(p, need);
+        size_t pos = Search(window.data(), window.size());
+        if (pos < carry_.size())
+        {
+            if (!EmitData(carry_.data(), pos))
+                return false;
+            p += pos + m - carry_.size();
+            carry_.clear();
+            return OnDelimiter();
+        }
+        if (need == avail && need < m - 1) // 数据太少，重新计算遗留区
+        {
+            size_t keep = PartialSuffix(window.data(), window.size());
+            if (!EmitData(window.data(), window.size() - keep))
+                return false;
+            carry_.assign(window.data() + window.size() - keep, keep);
+            p = end;
+            return true;
+        }
+        std::string flushed;
+        flushed.swap(carry_);
+        if (!EmitData(flushed.data(), flushed.size()))
+            return false;
+    }
+
+    size_t n = end - p;
+    size_t pos = Search(p, n);
+    if (pos < n)
+    {
+        if (!EmitData(p, pos))
+            return false;
+        p += pos + m;
+        return OnDelimiter();
+    }
+    size_t keep = PartialSuffix(p, n);
+    if (!EmitData(p, n - keep))
+        return false;
+    carry_.assign(end - keep, keep);
+    p = end;
+    return true;
+}
+
+bool MultipartParser::ParseBoundaryTail(const char *&p, const char *end)
+{
+    while (p < end)
+    {
+        char c = *p;
+        if (tail_.empty())
+        {
+            if (c == ' ' || c == '\t') // transport-padding
+            {
+                ++p;
+                continue;
+            }
+            if (c != '-' && c != '\r')
+                return Fail("invalid data after boundary");
+            tail_.push_back(c);
+            ++p;
+            continue;
+        }
+        ++p;
+        if (tail_[0] == '-' && c == '-') // 结束分隔符
+        {
+            state_ = State::kEpilogue;
+            p = end;
+            return true;
+        }
+        if (tail_[0] == '\r' && c == '\n')
+        {
+            state_ = State::kHeaders;
+            headerBuf_.clear();
+            return true;
+        }
+        return Fail("invalid data after boundary");
+    }
+    return true;
+}
+
+bool MultipartParser::ParseHeaders(const char *&p, const char *end)
+{
+    while (p < end)
+    {
+        headerBuf_.push_back(*p++);
+        size_t n = headerBuf_.size();
+        if (n >= 2 && headerBuf_[n - 1] == '\n' && headerBuf_[n - 2] == '\r')
+        {
+            // 空行结束头部；没有任何头部时只有一个 CRLF
+            if (n == 2 || (n >= 4 && headerBuf_[n - 3] == '\n' && headerBuf_[n - 4] == '\r'))
+                return ParsePartHeaders();
+        }
+        if (n > kMaxHeaderBytes)
+            return Fail("part header too large");
+    }
+    return true;
+}
+
+bool MultipartParser::ParsePartHeaders()
+{
+    part_ = Part();
+    size_t start = 0;
+    while (start < headerBuf_.size())
+    {
+        size_t eol = headerBuf_.find("\r\n", start);
+        if (eol == std::string::npos || eol == start)
+            break;
+        std::string line = headerBuf_.substr(start, eol - start);
+        start = eol + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            return Fail("malformed part header");
+        part_.headers[ToLower(Trim(line.substr(0, colon)))] = Trim(line.substr(colon + 1));
+    }
+    headerBuf_.clear();
+
+    auto cd = part_.headers.find("content-disposition");
+    if (cd != part_.headers.end())
+    {
+        std::map<std::string, std::string> params = ParseParams(cd->second);
+        auto it = params.find("name");
+        if (it != params.end())
+            part_.name = it->second;
+        it = params.find("filename");
+        if (it != params.end())
+        {
+            part_.filename = it->second;
+            part_.hasFilename = true;
+        }
+    }
+    auto ct = part_.headers.find("content-type");
+    if (ct != part_.headers.end())
+        part_.contentType = ct->second;
+
+    ++partCount_;
+    state_ = State::kBody;
+    if (onPartBegin_ && !onPartBegin_(part_))
+        return Fail("aborted by part begin callback");
+    return true;
+}
+
+bool MultipartParser::EmitData(const char *data, size_t len)
+{
+    if (state_ != State::kBody || len == 0) // 前导内容直接丢弃
+        return true;
+    if (onPartData_ && !onPartData_(data, len))
+        return Fail("aborted by part data callback");
+    return true;
+}
+
+bool MultipartParser::OnDelimiter()
+{
+    bool inPart = (state_ == State::kBody);
+    state_ = State::kBoundaryTail;
+    tail_.clear();
+    if (inPart && onPartEnd_ && !onPartEnd_())
+        return Fail("aborted by part end callback");
+    return true;
+}
+
+bool MultipartParser::Fail(const std::string &msg)
+{
+    state_ = State::kError;
+    error_ = msg;
+    return false;
+}
@@ -0,0 +1,611 @@
+#include "inc/ResumableUploadHandler.h"
+#include "Connection.h"
+#include "EventLoop.h"
+#include "HttpServer.h"
+#include "HttpContext.h"
+#include "HttpUtil.h"
+#include "UploadWriter.h"
+#include "Sha256.h"
+#include "Util.h"
+#include "Logger.h"
+#include <nlohmann/json.hpp>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+namespace
+{
+    bool ParseUint64(const std::string &s, uint64_t &out)
+    {
+        if (s.empty() || s[0] < '0' || s[0] > '9')
+            return false;
+        char *end = nullptr;
+        errno = 0;
+        unsigned long long v = std::strtoull(s.c_str(), &end, 10);
+        if (errno != 0 || *end != '\0')
+            return false;
+        out = static_cast<uint64_t>(v);
+        return true;
+    }
+
+    const uint64_t kMinPartSize = 1024 * 1024; // 分片最小 1MB（最后一片除外）
+    const uint64_t kMaxParts = 10000;
+
+    // 在 I/O 线程上分段读取并计算文件摘要，每段一个任务，不长时间独占磁盘线程
+    void HashFileAsync(DiskIoThread *io, const std::string &path, std::function<void(bool, const std::string &)> done)
+    {
+        struct HashJob
+        {
+            int fd = -1;
+            Sha256 hasher;
+            std::vector<char> buf;
+            ~HashJob()
+            {
+                if (fd >= 0)
+                    ::close(fd);
+            }
+        };
+        auto job = std::make_shared<HashJob>();
+        auto step = std::make_shared<std::function<void()>>();
+        *step = [io, path, job, step, done]() {
+            if (job->fd < 0)
+            {
+                job->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                job->buf.resize(8 * 1024 * 1024);
+                if (job->fd < 0)
+                {
+                    *step = nullptr; // 打破自引用
+                    done(false, "");
+                    return;
+                }
+            }
+            ssize_t n = ::read(job->fd, job->buf.data(), job->buf.size());
+            if (n > 0)
+            {
+                job->hasher.Update(job->buf.data(), static_cast<size_t>(n));
+                io->Submit(*step);
+                return;
+            }
+            *step = nullptr; // 打破自引用（正在执行的是投递时的副本）
+            if (n < 0)
+                done(false, "");
+            else
+                done(true, job->hasher.HexDigest());
+        };
+        io->Submit(*step);
+    }
+
+    // 409/400 等需要告知客户端当前偏移的错误
+    void sendOffsetError(HttpResponse *resp, const std::string &message, int code, uint64_t offset, const std::shared_ptr<Connection> &conn)
+    {
+        sendError(resp, message, code, conn);
+        resp->AddHeader("Upload-Offset", std::to_string(offset));
+    }
+} // namespace
+
+ResumableUploadHandler::ResumableUploadHandler(AuthHandler &auth, FileHandler &fileHandler, const std::string &uploadDir, int64_t sessionTtl)
+    : auth_(auth), fileHandler_(fileHandler), store_(uploadDir + "/.resumable", sessionTtl)
+{
+    store_.load();
+}
+
+void ResumableUploadHandler::start(EventLoop *loop, double expiryInterval)
+{
+    store_.startExpiry(loop, expiryInterval);
+}
+
+bool ResumableUploadHandler::isStreamingRequest(const HttpRequest &req)
+{
+    return (req.GetMethod() == HttpMethod::kPatch || req.GetMethod() == HttpMethod::kPut) && req.GetUrl().compare(0, 9, "/uploads/") == 0;
+}
+
+std::shared_ptr<UploadSession> ResumableUploadHandler::ownedSession(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp, int userId)
+{
+    std::string id = req.GetPathParam("id");
+    std::shared_ptr<UploadSession> session;
+    if (UploadSessionStore::validId(id))
+        session = store_.get(id);
+    if (!session || session->userId != userId)
+    {
+        sendError(resp, "上传会话不存在或已过期", HttpStatusCode::NotFound, conn);
+        return nullptr;
+    }
+    return session;
+}
+
+bool ResumableUploadHandler::checkPatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return false;
+    }
+    auto session = ownedSession(conn, req, resp, userId);
+    if (!session)
+        return false;
+    uint64_t contentLength = 0;
+    if (session->isMultipart() || !ParseUint64(req.GetHeader("Content-Length"), contentLength) || contentLength > session->size)
+    {
+        sendError(resp, "请求体长度无效", HttpStatusCode::BadRequest, conn);
+        return false;
+    }
+    keepPrecheckUser(conn, userId);
+    return true;
+}
+
+bool ResumableUploadHandler::checkPart(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return false;
+    }
+    auto session = ownedSession(conn, req, resp, userId);
+    if (!session)
+        return false;
+    uint64_t index = 0;
+    uint64_t contentLength = 0;
+    if (!session->isMultipart() || !ParseUint64(req.GetPathParam("part"), index) || index >= session->partCount() ||
+        !ParseUint64(req.GetHeader("Content-Length"), contentLength) || contentLength != session->partLength(index))
+    {
+        sendError(resp, "分片序号或长度无效", HttpStatusCode::BadRequest, conn);
+        return false;
+    }
+    keepPrecheckUser(conn, userId);
+    return true;
+}
+
+void ResumableUploadHandler::keepPrecheckUser(const std::shared_ptr<Connection> &conn, int userId)
+{
+    // 请求体到达后 handlePatch/handlePutPart 沿用这次校验的结果
+    auto patch = std::make_shared<ResumablePatchContext>();
+    patch->userId = userId;
+    conn->GetContext()->SetContext(patch);
+}
+
+bool ResumableUploadHandler::requestUser(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp, int &userId)
+{
+    std::shared_ptr<HttpContext> httpContext = conn->GetContext();
+    std::shared_ptr<ResumablePatchContext> precheck = httpContext->GetContext<ResumablePatchContext>();
+    httpContext->SetContext(std::shared_ptr<void>()); // 预检结果只用于本次请求
+    if (precheck)
+    {
+        userId = precheck->userId;
+        return true;
+    }
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return false;
+    }
+    return true;
+}
+
+bool ResumableUploadHandler::handleCreate(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return true;
+    }
+
+    json body = json::parse(req.GetBody(), nullptr, false);
+    if (body.is_discarded() || !body.is_object() || !body.contains("filename") || !body.contains("size") ||
+        !body["filename"].is_string() || !body["size"].is_number_unsigned())
+    {
+        sendError(resp, "参数错误", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+    std::string filename = body["filename"].get<std::string>();
+    uint64_t size = body["size"].get<uint64_t>();
+    std::string sha256 = body.value("sha256", "");
+    if (filename.empty() || size == 0)
+    {
+        sendError(resp, "文件名或大小无效", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+    if (!sha256.empty() && !Sha256::ValidHex(sha256))
+    {
+        sendError(resp, "sha256 必须为 64 位小写十六进制", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+    uint64_t partSize = 0;
+    if (body.contains("partSize"))
+    {
+        // 指定分片大小即为并行分片上传
+        if (!body["partSize"].is_number_unsigned() || (partSize = body["partSize"].get<uint64_t>()) == 0 ||
+            (partSize < kMinPartSize && partSize < size) || (size + partSize - 1) / partSize > kMaxParts)
+        {
+            sendError(resp, "分片大小无效", HttpStatusCode::BadRequest, conn);
+            return true;
+        }
+    }
+
+    auto session = store_.create(userId, filename, size, sha256, partSize);
+    if (!session)
+    {
+        sendError(resp, "创建上传会话失败", HttpStatusCode::InternalServerError, conn);
+        return true;
+    }
+    LOG_INFO << "Resumable upload created: " << session->id << ", size: " << size << ", user: " << userId;
+    json out = {{"code", 0}, {"message", "success"}, {"uploadId", session->id}, {"offset", 0},
+                {"expiresAt", session->updatedAt + store_.ttl()}};
+    if (session->isMultipart())
+    {
+        out["partSize"] = session->partSize;
+        out["partCount"] = session->partCount();
+    }
+    sendJson(resp, out, conn);
+    resp->AddHeader("Location", "/uploads/" + session->id);
+    resp->AddHeader("Upload-Offset", "0");
+    return true;
+}
+
+bool ResumableUploadHandler::handleHead(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return true;
+    }
+    auto session = ownedSession(conn, req, resp, userId);
+    if (!session)
+        return true;
+
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetBodyType(HttpBodyType::HTML_TYPE);
+    resp->AddHeader("Upload-Offset", std::to_string(session->offset));
+    resp->AddHeader("Upload-Length", std::to_string(session->size));
+    resp->AddHeader("Cache-Control", "no-store");
+    if (session->isMultipart())
+        resp->AddHeader("Upload-Missing-Parts", UploadSessionStore::joinParts(store_.missingParts(session)));
+    return true;
+}
+
+bool ResumableUploadHandler::handleCancel(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return true;
+    }
+    auto session = ownedSession(conn, req, resp, userId);
+    if (!session)
+        return true;
+    if (!store_.acquire(session))
+    {
+        sendError(resp, "上传正在进行", HttpStatusCode::Conflict, conn);
+        return true;
+    }
+    store_.remove(session->id);
+    json out = {{"code", 0}, {"message", "success"}};
+    sendJson(resp, out, conn);
+    return true;
+}
+
+bool ResumableUploadHandler::handlePatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
+    if (!httpContext)
+    {
+        sendError(resp, "Internal Server Error", HttpStatusCode::InternalServerError, conn);
+        return true;
+    }
+    std::shared_ptr<ResumablePatchContext> patch = httpContext->GetContext<ResumablePatchContext>();
+    // 首个分片：鉴权（预检已做时沿用）并校验偏移，之后的分片直接写盘
+    if (!patch || !patch->writer)
+    {
+        int userId;
+        if (!requestUser(conn, req, resp, userId))
+            return true;
+        auto session = ownedSession(conn, req, resp, userId);
+        if (!session)
+            return true;
+        if (session->isMultipart())
+        {
+            sendError(resp, "分片上传会话请使用 PUT /uploads/<id>/parts/<n>", HttpStatusCode::BadRequest, conn);
+            return true;
+        }
+        if (req.GetHeader("Content-Type") != "application/offset+octet-stream")
+        {
+            sendError(resp, "Content-Type 必须为 application/offset+octet-stream", HttpStatusCode::BadRequest, conn);
+            return true;
+        }
+        uint64_t offset = 0;
+        uint64_t contentLength = 0;
+        if (!ParseUint64(req.GetHeader("Upload-Offset"), offset) || !ParseUint64(req.GetHeader("Content-Length"), contentLength))
+        {
+            sendError(resp, "缺少 Upload-Offset 或 Content-Length", HttpStatusCode::BadRequest, conn);
+            return true;
+        }
+        switch (store_.admitPatch(session, offset, contentLength))
+        {
+        case UploadSessionStore::kAdmitted:
+            break;
+        case UploadSessionStore::kBusy:
+            sendOffsetError(resp, "上传正在进行", HttpStatusCode::Conflict, session->offset, conn);
+            return true;
+        case UploadSessionStore::kOffsetMismatch:
+            sendOffsetError(resp, "偏移不匹配", HttpStatusCode::Conflict, session->offset, conn);
+            return true;
+        default:
+            sendOffsetError(resp, "数据超出文件大小", HttpStatusCode::BadRequest, session->offset, conn);
+            return true;
+        }
+
+        auto writer = std::make_shared<UploadWriter>(DiskIoThread::ForPath(store_.dir()), store_.dataPath(session->id), "");
+        if (!writer->Open(contentLength, offset, false))
+        {
+            store_.release(session, session->offset);
+            sendError(resp, "文件保存失败", HttpStatusCode::InternalServerError, conn);
+            return true;
+        }
+        patch = std::make_shared<ResumablePatchContext>();
+        patch->session = session;
+        patch->writer = writer;
+        patch->store = &store_;
+        patch->startOffset = offset;
+        httpContext->SetContext(patch);
+    }
+    return streamBody(conn, req, resp, patch);
+}
+
+bool ResumableUploadHandler::handlePutPart(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
+    if (!httpContext)
+    {
+        sendError(resp, "Internal Server Error", HttpStatusCode::InternalServerError, conn);
+        return true;
+    }
+    std::shared_ptr<ResumablePatchContext> patch = httpContext->GetContext<ResumablePatchContext>();
+    if (!patch || !patch->writer)
+    {
+        int userId;
+        if (!requestUser(conn, req, resp, userId))
+            return true;
+        auto session = ownedSession(conn, req, resp, userId);
+        if (!session)
+            return true;
+        uint64_t index = 0;
+        uint64_t contentLength = 0;
+        if (!session->isMultipart() || !ParseUint64(req.GetPathParam("part"), index) || index >= session->partCount())
+        {
+            sendError(resp, "分片序号无效", HttpStatusCode::BadRequest, conn);
+            return true;
+        }
+        // 分片必须整片上传，长度不符直接拒绝
+        if (!ParseUint64(req.GetHeader("Content-Length"), contentLength))
+        {
+            sendError(resp, "分片长度不匹配", HttpStatusCode::BadRequest, conn);
+            return true;
+        }
+        switch (store_.admitPart(session, index, contentLength))
+        {
+        case UploadSessionStore::kAdmitted:
+            break;
+        case UploadSessionStore::kBadLength:
+            sendError(resp, "分片长度不匹配", HttpStatusCode::BadRequest, conn);
+            return true;
+        default:
+            sendError(resp, "分片正在上传或会话已完成", HttpStatusCode::Conflict, conn);
+            return true;
+        }
+        // 每个分片独立 fd，pwrite 到预分配文件中的固定偏移，各连接互不影响
+        auto writer = std::make_shared<UploadWriter>(DiskIoThread::ForPath(store_.dir()), store_.dataPath(session->id), "");
+        if (!writer->Open(0, session->partOffset(index), false))
+        {
+            store_.releasePart(session, index, false);
+            sendError(resp, "文件保存失败", HttpStatusCode::InternalServerError, conn);
+            return true;
+        }
+        patch = std::make_shared<ResumablePatchContext>();
+        patch->session = session;
+        patch->writer = writer;
+        patch->store = &store_;
+        patch->startOffset = session->partOffset(index);
+        patch->part = static_cast<int64_t>(index);
+        httpContext->SetContext(patch);
+    }
+    return streamBody(conn, req, resp, patch);
+}
+
+bool ResumableUploadHandler::handleComplete(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::string sessionId = req.GetHeader("X-Session-ID");
+    int userId;
+    std::string username;
+    if (!auth_.validateSession(sessionId, userId, username))
+    {
+        sendError(resp, "未登录或会话已过期", HttpStatusCode::Unauthorized, conn);
+        return true;
+    }
+    auto session = ownedSession(conn, req, resp, userId);
+    if (!session)
+        return true;
+    if (!session->isMultipart())
+    {
+        sendError(resp, "不是分片上传会话", HttpStatusCode::BadRequest, conn);
+        return true;
+    }
+    std::vector<uint64_t> missing;
+    switch (store_.admitComplete(session, &missing))
+    {
+    case UploadSessionStore::kAdmitted:
+        break;
+    case UploadSessionStore::kBusy:
+        sendError(resp, "仍有分片正在上传", HttpStatusCode::Conflict, conn);
+        return true;
+    default:
+        sendError(resp, "分片不完整", HttpStatusCode::Conflict, conn);
+        resp->AddHeader("Upload-Missing-Parts", UploadSessionStore::joinParts(missing));
+        return true;
+    }
+    startComplete(conn, session, resp->IsCloseConnection());
+    return false;
+}
+
+bool ResumableUploadHandler::streamBody(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp, const std::shared_ptr<ResumablePatchContext> &patch)
+{
+    std::shared_ptr<HttpContext> httpContext = conn->GetContext();
+    const std::string &body = req.GetBody();
+    patch->writer->Append(body.data(), body.size());
+    req.SetBody("");
+    if (patch->writer->Failed())
+    {
+        httpContext->SetContext(std::shared_ptr<void>());
+        sendError(resp, "文件保存失败", HttpStatusCode::InternalServerError, conn);
+        return true;
+    }
+
+    // 请求体尚未收完：写盘队列已满时暂停读取，队列回落后恢复
+    if (!httpContext->GetCompleteRequest())
+    {
+        if (patch->writer->Backpressured() && conn->IsReading())
+        {
+            conn->StopReading();
+            std::weak_ptr<Connection> weakConn(conn);
+            EventLoop *loop = conn->GetLoop();
+            patch->writer->GetIoThread()->NotifyWhenDrained([weakConn, loop]() {
+                loop->queueOneFunc([weakConn]() {
+                    if (auto c = weakConn.lock())
+                        c->StartReading();
+                });
+            });
+        }
+        return false;
+    }
+
+    // 本次数据 fdatasync 后才推进偏移/标记分片完成，保证 HEAD 返回的状态一定已落盘
+    std::weak_ptr<Connection> weakConn(conn);
+    EventLoop *loop = conn->GetLoop();
+    patch->writer->Sync([this, weakConn, loop, patch](bool ok) {
+        loop->queueOneFunc([this, weakConn, patch, ok]() {
+            if (auto c = weakConn.lock())
+                finishPatch(c, patch, ok);
+        });
+    });
+    return false;
+}
+
+void ResumableUploadHandler::finishPatch(const std::shared_ptr<Connection> &conn, const std::shared_ptr<ResumablePatchContext> &patch, bool synced)
+{
+    std::shared_ptr<HttpContext> httpContext = conn->GetContext();
+    if (!httpContext || !httpContext->HasDeferredResponse())
+        return;
+    HttpResponse *resp = httpContext->GetDeferredResponse();
+    std::shared_ptr<UploadSession> session = patch->session;
+    patch->finished = true;
+    httpContext->SetContext(std::shared_ptr<void>());
+
+    if (patch->part >= 0)
+    {
+        store_.releasePart(session, static_cast<uint64_t>(patch->part), synced);
+        if (!synced)
+            sendError(resp, "文件保存失败", HttpStatusCode::InternalServerError, conn);
+        else
+        {
+            resp->SetStatusCode(HttpStatusCode::NoContent);
+            resp->SetStatusMessage("No Content");
+            resp->SetBodyType(HttpBodyType::HTML_TYPE);
+        }
+        HttpServer::SendDeferredResponse(conn);
+        return;
+    }
+
+    uint64_t offset = synced ? patch->startOffset + patch->writer->BytesAppended() : patch->startOffset;
+    ::truncate(store_.dataPath(session->id).c_str(), static_cast<off_t>(offset)); // 去掉预分配与未确认的尾部
+    bool complete = synced && offset == session->size;
+    store_.release(session, offset, complete); // 完成流程中保持占用，避免重复提交
+
+    if (complete)
+    {
+        startComplete(conn, session, resp->IsCloseConnection());
+        return;
+    }
+    if (!synced)
+        sendOffsetError(resp, "文件保存失败", HttpStatusCode::InternalServerError, offset, conn);
+    else
+    {
+        resp->SetStatusCode(HttpStatusCode::NoContent);
+        resp->SetStatusMessage("No Content");
+        resp->SetBodyType(HttpBodyType::HTML_TYPE);
+        resp->AddHeader("Upload-Offset", std::to_string(offset));
+    }
+    HttpServer::SendDeferredResponse(conn);
+}
+
+void ResumableUploadHandler::startComplete(const std::shared_ptr<Connection> &conn, const std::shared_ptr<UploadSession> &session, bool close)
+{
+    // 断点续传的数据可能跨越多次连接甚至重启，无法边收边算，完成时在 I/O 线程读回计算摘要，再到执行器上入库
+    std::weak_ptr<Connection> weakConn(conn);
+    EventLoop *loop = conn->GetLoop();
+    HashFileAsync(DiskIoThread::ForPath(store_.dir()), store_.dataPath(session->id), [this, weakConn, loop, session, close](bool ok, const std::string &sha256) {
+        fileHandler_.finishBlocking(weakConn, loop, "upload.complete", close, [this, weakConn, session, ok, sha256](HttpResponse *resp) {
+            if (weakConn.expired())
+                store_.release(session, session->offset); // 客户端已断开，不入库，重新 complete 即可
+            else
+                finishComplete(session, ok, sha256, resp);
+        });
+    });
+}
+
+void ResumableUploadHandler::finishComplete(const std::shared_ptr<UploadSession> &session, bool hashed, const std::string &sha256, HttpResponse *resp)
+{
+    if (!hashed)
+    {
+        store_.release(session, session->offset);
+        sendOffsetError(resp, "文件读取失败", HttpStatusCode::InternalServerError, session->offset, nullptr);
+    }
+    else if (!session->sha256.empty() && session->sha256 != sha256)
+    {
+        // 内容与声明的摘要不一致，数据已不可信，丢弃会话
+        LOG_WARN << "Resumable upload digest mismatch: " << session->id << ", expected " << session->sha256 << ", got " << sha256;
+        store_.remove(session->id);
+        sendError(resp, "文件摘要不匹配，请重新上传", HttpStatusCode::Conflict, nullptr);
+    }
+    else
+    {
+        std::string serverFilename = UniqueFilename("upload");
+        auto fileIdOpt = fileHandler_.registerUpload(store_.dataPath(session->id), serverFilename, session->filename, session->size, sha256, session->userId);
+        if (!fileIdOpt)
+        {
+            store_.release(session, session->offset); // 数据仍在会话目录，允许重试
+            sendOffsetError(resp, "文件入库失败", HttpStatusCode::InternalServerError, session->offset, nullptr);
+        }
+        else
+        {
+            store_.remove(session->id);
+            LOG_INFO << "Resumable upload completed: " << session->id << " -> " << serverFilename;
+            json out = {{"code", 0}, {"message", "上传成功"}, {"fileId", *fileIdOpt}, {"filename", serverFilename},
+                        {"originalFilename", session->filename}, {"size", session->size}, {"sha256", sha256}};
+            sendJson(resp, out, nullptr);
+            resp->AddHeader("Upload-Offset", std::to_string(session->size));
+        }
+    }
+}
@@ -1,61 +1,330 @@
 #include "Router.h"
-#include "HttpRequest.h"
-#include "HttpResponse.h"
-#include "Connection.h"
-#include <regex>
-#include "StaticHandler.h"
-#include "AuthHandler.h"
-#include "FileHandler.h"
-#include "ShareHandler.h"
-#include "UserHandler.h"
-
-void registerRoutes(
-    Router &router,
-    StaticHandler &staticHandler,
-    AuthHandler &authHandler,
-    FileHandler &fileHandler,
-    ShareHandler &shareHandler,
-    UserHandler &userHandler)
-{
-    // 公共路由（无需会话）
-    router.addRouteExact("/favicon.ico", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
-                         { return staticHandler.handleFavicon(c, r, s); });
-    router.addRouteExact("/register", HttpMethod::kPost, [&authHandler](auto &c, auto &r, auto *s)
-                         { return authHandler.handleRegister(c, r, s); });
-    router.addRouteExact("/login", HttpMethod::kPost, [&authHandler](auto &c, auto &r, auto *s)
-                         { return authHandler.handleLogin(c, r, s); });
-    router.addRouteExact("/", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
-                         { return staticHandler.handleIndex(c, r, s); });
-    router.addRouteExact("/index.html", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
-                         { return staticHandler.handleIndex(c, r, s); });
-    router.addRouteExact("/share.html", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
-                         { return staticHandler.handleIndex(c, r, s); });
-    router.addRouteRegex("/static/(.*)", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
-                         { return staticHandler.handleStaticAsset(c, r, s); }, {"path"});
-    router.addRouteExact("/register.html", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
-                         { return staticHandler.handleIndex(c, r, s); });
-    router.addRouteRegex("/share/([^/]+)", HttpMethod::kGet, [&shareHandler](auto &c, auto &r, auto *s)
-                         { return shareHandler.handleShareAccess(c, r, s); }, {"code"});
-    router.addRouteRegex("/share/download/([^/]+)", HttpMethod::kGet, [&shareHandler](auto &c, auto &r, auto *s)
-                         { return shareHandler.handleShareDownload(c, r, s); }, {"filename"});
-    router.addRouteRegex("/share/info/([^/]+)", HttpMethod::kGet, [&shareHandler](auto &c, auto &r, auto *s)
-                         { return shareHandler.handleShareInfo(c, r, s); }, {"code"});
-
-    // 需要会话验证的路由（具体校验放在 handler 内部）
-    router.addRouteExact("/upload", HttpMethod::kPost, [&fileHandler](auto &c, auto &r, auto *s)
-                         { return fileHandler.handleUpload(c, r, s); });
-    router.addRouteExact("/files", HttpMethod::kGet, [&fileHandler](auto &c, auto &r, auto *s)
-                         { return fileHandler.handleListFiles(c, r, s); });
-    router.addRouteRegex("/download/([^/]+)", HttpMethod::kHead, [&fileHandler](auto &c, auto &r, auto *s)
-                         { return fileHandler.handleDownload(c, r, s); }, {"filename"});
-    router.addRouteRegex("/download/([^/]+)", HttpMethod::kGet, [&fileHandler](auto &c, auto &r, auto *s)
-                         { return fileHandler.handleDownload(c, r, s); }, {"filename"});
-    router.addRouteRegex("/delete/([^/]+)", HttpMethod::kDelete, [&fileHandler](auto &c, auto &r, auto *s)
-                         { return fileHandler.handleDelete(c, r, s); }, {"filename"});
-    router.addRouteExact("/share", HttpMethod::kPost, [&shareHandler](auto &c, auto &r, auto *s)
-                         { return shareHandler.handleShareFile(c, r, s); });
-    router.addRouteExact("/users/search", HttpMethod::kGet, [&userHandler](auto &c, auto &r, auto *s)
-                         { return userHandler.handleSearchUsers(c, r, s); });
-    router.addRouteExact("/logout", HttpMethod::kPost, [&authHandler](auto &c, auto &r, auto *s)
-                         { return authHandler.handleLogout(c, r, s); });
+#include "HttpServer.h"
+#include <algorithm>
+#include <string.h>
+
+namespace
+{
+const char *MethodName(HttpMethod method)
+{
+    static const char *kNames[] = {"INVALID", "GET", "POST", "HEAD", "PUT", "DELETE", "PATCH"};
+    return kNames[method];
+}
+} // namespace
+
+Router::Slots::Slots()
+{
+    std::fill(endpoint, endpoint + kMethodCount, -1);
+}
+
+Router::Router() : nodes_(1)
+{
+}
+
+void Router::addRouteExact(const std::string &path, HttpMethod method, Handler handler, ExecMode mode)
+{
+    Endpoint ep{std::move(handler), {}, std::string(MethodName(method)) + " " + path, mode, nullptr, nullptr};
+    std::vector<Segment> segments;
+    if (path.empty() || path[0] != '/')
+    {
+        regexRoutes_.emplace_back(RegexRoute{std::regex("^" + escapeRegex(path) + "$"), method, AddEndpoint(std::move(ep))});
+        return;
+    }
+    size_t pos = 1;
+    while (true)
+    {
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos)
+            end = path.size();
+        segments.push_back(Segment{kStatic, path.substr(pos, end - pos)});
+        if (end == path.size())
+            break;
+        pos = end + 1;
+    }
+    Insert(segments, method, std::move(ep));
+}
+
+void Router::addRouteRegex(const std::string &pattern, HttpMethod method, Handler handler, const std::vector<std::string> &params, ExecMode mode)
+{
+    AddPattern(pattern, method, Endpoint{std::move(handler), params, std::string(MethodName(method)) + " " + pattern, mode, nullptr, nullptr});
+}
+
+void Router::addRouteCoroutine(const std::string &pattern, HttpMethod method, CoroutineHandler handler, const std::vector<std::string> &params)
+{
+    AddPattern(pattern, method, Endpoint{nullptr, params, std::string(MethodName(method)) + " " + pattern, kInline, std::move(handler), nullptr});
+}
+
+void Router::AddPattern(const std::string &pattern, HttpMethod method, Endpoint endpoint)
+{
+    std::vector<Segment> segments;
+    if (CompilePattern(pattern, segments))
+        Insert(segments, method, std::move(endpoint));
+    else
+        regexRoutes_.emplace_back(RegexRoute{std::regex(pattern), method, AddEndpoint(std::move(endpoint))});
+}
+
+int Router::AddEndpoint(Endpoint endpoint)
+{
+    size_t space = endpoint.name.find(' ');
+    endpoint.metrics = RouteMetrics::Get(endpoint.name.substr(0, space), endpoint.name.substr(space + 1));
+    endpoints_.push_back(std::move(endpoint));
+    return static_cast<int>(endpoints_.size()) - 1;
+}
+
+// 把 /uploads/([^/]+)/parts/([0-9]+) 这类模式拆成段；含其他正则语法时返回 false
+bool Router::CompilePattern(const std::string &pattern, std::vector<Segment> &segments)
+{
+    std::string p = pattern;
+    if (!p.empty() && p.front() == '^')
+        p.erase(0, 1);
+    if (!p.empty() && p.back() == '$')
+        p.pop_back();
+    if (p.empty() || p[0] != '/')
+        return false;
+
+    static const std::pair<const char *, SegmentKind> kCaptures[] = {{"([^/]+)", kSegment}, {"([0-9]+)", kDigits}, {"(.*)", kRest}};
+    int captures = 0;
+    size_t pos = 1;
+    while (true)
+    {
+        // 捕获组里可能含 '/'，先按整段比对
+        size_t end = std::string::npos;
+        for (const auto &cap : kCaptures)
+        {
+            size_t len = strlen(cap.first);
+            if (p.compare(pos, len, cap.first) == 0 && (pos + len == p.size() || p[pos + len] == '/'))
+            {
+                end = pos + len;
+                segments.push_back(Segment{cap.second, ""});
+                break;
+            }
+        }
+        if (end == std::string::npos)
+        {
+            end = std::min(p.find('/', pos), p.size());
+            std::string seg = p.substr(pos, end - pos);
+            if (seg.find_first_of(".+*?^$()[]{}|\\") != std::string::npos)
+                return false;
+            segments.push_back(Segment{kStatic, seg});
+        }
+        else if (++captures > kMaxParams || (segments.back().kind == kRest && end != p.size()))
+        {
+            return false;
+        }
+        if (end == p.size())
+            break;
+        pos = end + 1;
+    }
+    return true;
+}
+
+int Router::Child(int node, const Segment &seg)
+{
+    int next = -1;
+    if (seg.kind == kStatic)
+    {
+        auto &statics = nodes_[node].statics;
+        auto it = std::lower_bound(statics.begin(), statics.end(), seg.text,
+                                   [](const std::pair<std::string, int> &a, const std::string &b) { return a.first < b; });
+        if (it != statics.end() && it->first == seg.text)
+            return it->second;
+        next = static_cast<int>(nodes_.size());
+        statics.insert(it, std::make_pair(seg.text, next));
+    }
+    else
+    {
+        int &slot = seg.kind == kDigits ? nodes_[node].digits : nodes_[node].segment;
+        if (slot >= 0)
+            return slot;
+        next = slot = static_cast<int>(nodes_.size());
+    }
+    nodes_.emplace_back(); // 放在最后：扩容会使上面的引用失效
+    return next;
+}
+
+void Router::Insert(const std::vector<Segment> &segments, HttpMethod method, Endpoint endpoint)
+{
+    int node = 0;
+    bool rest = false;
+    for (const Segment &seg : segments)
+    {
+        if (seg.kind == kRest)
+        {
+            rest = true;
+            break;
+        }
+        node = Child(node, seg);
+    }
+    int &slot = rest ? nodes_[node].rest.endpoint[method] : nodes_[node].here.endpoint[method];
+    if (slot >= 0)
+        return; // 与原先按注册顺序匹配一致：先注册的生效
+    slot = AddEndpoint(std::move(endpoint));
+}
+
+// pos 指向当前段的开头（前一个 '/' 之后），返回命中的 endpoints_ 下标，未命中返回 -1
+int Router::Match(int node, std::string_view path, size_t pos, HttpMethod method, Captures &caps) const
+{
+    const Node &n = nodes_[node];
+    size_t end = path.find('/', pos);
+    bool last = end == std::string_view::npos;
+    if (last)
+        end = path.size();
+    std::string_view seg = path.substr(pos, end - pos);
+
+    auto descend = [&](int child) {
+        return last ? nodes_[child].here.endpoint[method] : Match(child, path, end + 1, method, caps);
+    };
+
+    auto it = std::lower_bound(n.statics.begin(), n.statics.end(), seg,
+                               [](const std::pair<std::string, int> &a, std::string_view b) { return std::string_view(a.first) < b; });
+    if (it != n.statics.end() && it->first == seg)
+    {
+        int found = descend(it->second);
+        if (found >= 0)
+            return found;
+    }
+    if (!seg.empty() && caps.count < kMaxParams)
+    {
+        bool digits = n.digits >= 0 && std::all_of(seg.begin(), seg.end(), [](char c) { return c >= '0' && c <= '9'; });
+        for (int child : {digits ? n.digits : -1, n.segment})
+        {
+            if (child < 0)
+                continue;
+            caps.values[caps.count++] = seg;
+            int found = descend(child);
+            if (found >= 0)
+                return found;
+            --caps.count;
+        }
+    }
+    if (n.rest.endpoint[method] >= 0 && caps.count < kMaxParams)
+    {
+        caps.values[caps.count++] = path.substr(pos);
+        return n.rest.endpoint[method];
+    }
+    return -1;
+}
+
+bool Router::dispatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const
+{
+    bool sync;
+    return dispatch(conn, req, resp, sync);
+}
+
+bool Router::dispatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp, bool &sync) const
+{
+    const Endpoint *ep = Lookup(req);
+    if (!ep)
+        return false;
+    sync = Invoke(*ep, conn, req, resp);
+    return true;
+}
+
+bool Router::precheck(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const
+{
+    const Endpoint *ep = Lookup(req);
+    return !ep || !ep->preCheck || ep->preCheck(conn, req, resp);
+}
+
+bool Router::setPreCheck(const std::string &pattern, HttpMethod method, PreCheck check)
+{
+    std::string name = std::string(MethodName(method)) + " " + pattern;
+    for (Endpoint &ep : endpoints_)
+    {
+        if (ep.name == name)
+        {
+            ep.preCheck = std::move(check);
+            return true;
+        }
+    }
+    return false;
+}
+
+const Router::Endpoint *Router::Lookup(HttpRequest &req) const
+{
+    const std::string &path = req.GetUrl();
+    HttpMethod method = req.GetMethod();
+    if (method < 0 || method >= kMethodCount)
+        return nullptr;
+
+    if (!path.empty() && path[0] == '/')
+    {
+        Captures caps;
+        int found = Match(0, path, 1, method, caps);
+        if (found >= 0)
+        {
+            const Endpoint &ep = endpoints_[found];
+            req.ClearPathParams();
+            for (size_t i = 0; i < ep.params.size() && static_cast<int>(i) < caps.count; ++i)
+                req.SetPathParam(ep.params[i], caps.values[i]);
+            req.SetRoute(ep.metrics);
+            return &ep;
+        }
+    }
+
+    for (const auto &route : regexRoutes_)
+    {
+        if (route.method != method)
+            continue;
+        std::smatch matches;
+        if (std::regex_match(path, matches, route.pattern))
+        {
+            const Endpoint &ep = endpoints_[route.endpoint];
+            // 提取路径参数
+            std::map<std::string, std::string> params;
+            for (size_t i = 0; i < ep.params.size() && i + 1 < matches.size(); ++i)
+            {
+                params[ep.params[i]] = matches[i + 1];
+            }
+            req.SetPathParam(params);
+            req.SetRoute(ep.metrics);
+            return &ep;
+        }
+    }
+    return nullptr;
+}
+
+bool Router::Invoke(const Endpoint &ep, const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const
+{
+    if (ep.coroutine)
+    {
+        if (server_)
+            return server_->RunCoroutine(conn, resp, ep.coroutine(conn, req));
+        *resp = HttpResponse::MakeSimple(resp->IsCloseConnection(), HttpStatusCode::InternalServerError, "Internal Server Error", "500 Internal Server Error\n");
+        return true;
+    }
+    if (ep.mode == kBlocking && server_)
+        return server_->RunBlocking(ep.name, conn, req, resp, ep.handler);
+    return ep.handler(conn, req, resp);
+}
+
+std::string Router::escapeRegex(const std::string &str)
+{
+    std::string result;
+    result.reserve(str.size() * 2);
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '.':
+        case '+':
+        case '*':
+        case '?':
+        case '^':
+        case '$':
+        case '(':
+        case ')':
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+        case '|':
+        case '\\':
+            result += '\\';
+            [[fallthrough]];
+        default:
+            result += c;
+        }
+    }
+    return result;
 }
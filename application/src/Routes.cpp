@@ -0,0 +1,83 @@
+#include "Router.h"
+#include "StaticHandler.h"
+#include "AuthHandler.h"
+#include "FileHandler.h"
+#include "ShareHandler.h"
+#include "UserHandler.h"
+#include "ResumableUploadHandler.h"
+
+void registerRoutes(
+    Router &router,
+    StaticHandler &staticHandler,
+    AuthHandler &authHandler,
+    FileHandler &fileHandler,
+    ShareHandler &shareHandler,
+    UserHandler &userHandler,
+    ResumableUploadHandler &resumableHandler)
+{
+    // 访问数据库的路由标记为 kBlocking，在工作线程执行；流式请求体（上传、PATCH、分片）与需要再次异步的处理器留在 loop 线程
+    // 协程路由自行把查询交给执行器（Offload）
+    // 公共路由（无需会话）
+    router.addRouteExact("/favicon.ico", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
+                         { return staticHandler.handleFavicon(c, r, s); });
+    router.addRouteExact("/register", HttpMethod::kPost, [&authHandler](auto &c, auto &r, auto *s)
+                         { return authHandler.handleRegister(c, r, s); }, Router::kBlocking);
+    router.addRouteExact("/login", HttpMethod::kPost, [&authHandler](auto &c, auto &r, auto *s)
+                         { return authHandler.handleLogin(c, r, s); }, Router::kBlocking);
+    router.addRouteExact("/", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
+                         { return staticHandler.handleIndex(c, r, s); });
+    router.addRouteExact("/index.html", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
+                         { return staticHandler.handleIndex(c, r, s); });
+    router.addRouteExact("/share.html", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
+                         { return staticHandler.handleIndex(c, r, s); });
+    router.addRouteRegex("/static/(.*)", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
+                         { return staticHandler.handleStaticAsset(c, r, s); }, {"path"});
+    router.addRouteExact("/register.html", HttpMethod::kGet, [&staticHandler](auto &c, auto &r, auto *s)
+                         { return staticHandler.handleIndex(c, r, s); });
+    router.addRouteRegex("/share/([^/]+)", HttpMethod::kGet, [&shareHandler](auto &c, auto &r, auto *s)
+                         { return shareHandler.handleShareAccess(c, r, s); }, {"code"}, Router::kBlocking);
+    router.addRouteRegex("/share/download/([^/]+)", HttpMethod::kGet, [&shareHandler](auto &c, auto &r, auto *s)
+                         { return shareHandler.handleShareDownload(c, r, s); }, {"filename"}, Router::kBlocking);
+    router.addRouteRegex("/share/info/([^/]+)", HttpMethod::kGet, [&shareHandler](auto &c, auto &r, auto *s)
+                         { return shareHandler.handleShareInfo(c, r, s); }, {"code"}, Router::kBlocking);
+
+    // 需要会话验证的路由（具体校验放在 handler 内部）
+    router.addRouteExact("/upload", HttpMethod::kPost, [&fileHandler](auto &c, auto &r, auto *s)
+                         { return fileHandler.handleUpload(c, r, s); });
+    router.addRouteExact("/upload/instant", HttpMethod::kPost, [&fileHandler](auto &c, auto &r, auto *s)
+                         { return fileHandler.handleInstantUpload(c, r, s); }, Router::kBlocking);
+    router.addRouteExact("/uploads", HttpMethod::kPost, [&resumableHandler](auto &c, auto &r, auto *s)
+                         { return resumableHandler.handleCreate(c, r, s); }, Router::kBlocking);
+    router.addRouteRegex("/uploads/([^/]+)", HttpMethod::kHead, [&resumableHandler](auto &c, auto &r, auto *s)
+                         { return resumableHandler.handleHead(c, r, s); }, {"id"}, Router::kBlocking);
+    router.addRouteRegex("/uploads/([^/]+)", HttpMethod::kPatch, [&resumableHandler](auto &c, auto &r, auto *s)
+                         { return resumableHandler.handlePatch(c, r, s); }, {"id"});
+    router.addRouteRegex("/uploads/([^/]+)/parts/([0-9]+)", HttpMethod::kPut, [&resumableHandler](auto &c, auto &r, auto *s)
+                         { return resumableHandler.handlePutPart(c, r, s); }, {"id", "part"});
+    router.addRouteRegex("/uploads/([^/]+)/complete", HttpMethod::kPost, [&resumableHandler](auto &c, auto &r, auto *s)
+                         { return resumableHandler.handleComplete(c, r, s); }, {"id"});
+    router.addRouteRegex("/uploads/([^/]+)", HttpMethod::kDelete, [&resumableHandler](auto &c, auto &r, auto *s)
+                         { return resumableHandler.handleCancel(c, r, s); }, {"id"}, Router::kBlocking);
+    router.addRouteCoroutine("/files", HttpMethod::kGet, [&fileHandler](std::shared_ptr<Connection> c, HttpRequest &r)
+                             { return fileHandler.handleListFiles(std::move(c), r); });
+    router.addRouteRegex("/download/([^/]+)", HttpMethod::kHead, [&fileHandler](auto &c, auto &r, auto *s)
+                         { return fileHandler.handleDownload(c, r, s); }, {"filename"}, Router::kBlocking);
+    router.addRouteRegex("/download/([^/]+)", HttpMethod::kGet, [&fileHandler](auto &c, auto &r, auto *s)
+                         { return fileHandler.handleDownload(c, r, s); }, {"filename"}, Router::kBlocking);
+    router.addRouteRegex("/delete/([^/]+)", HttpMethod::kDelete, [&fileHandler](auto &c, auto &r, auto *s)
+                         { return fileHandler.handleDelete(c, r, s); }, {"filename"}, Router::kBlocking);
+    router.addRouteExact("/share", HttpMethod::kPost, [&shareHandler](auto &c, auto &r, auto *s)
+                         { return shareHandler.handleShareFile(c, r, s); }, Router::kBlocking);
+    router.addRouteExact("/users/search", HttpMethod::kGet, [&userHandler](auto &c, auto &r, auto *s)
+                         { return userHandler.handleSearchUsers(c, r, s); }, Router::kBlocking);
+    router.addRouteExact("/logout", HttpMethod::kPost, [&authHandler](auto &c, auto &r, auto *s)
+                         { return authHandler.handleLogout(c, r, s); }, Router::kBlocking);
+
+    // 大请求体在到达前预检（Expect: 100-continue），会话无效或超出上限时直接拒绝
+    router.setPreCheck("/upload", HttpMethod::kPost, [&fileHandler](auto &c, auto &r, auto *s)
+                       { return fileHandler.checkUpload(c, r, s); });
+    router.setPreCheck("/uploads/([^/]+)", HttpMethod::kPatch, [&resumableHandler](auto &c, auto &r, auto *s)
+                       { return resumableHandler.checkPatch(c, r, s); });
+    router.setPreCheck("/uploads/([^/]+)/parts/([0-9]+)", HttpMethod::kPut, [&resumableHandler](auto &c, auto &r, auto *s)
+                       { return resumableHandler.checkPart(c, r, s); });
+}
@@ -0,0 +1,157 @@
+#include "SessionCache.h"
+#include <algorithm>
+#include <mutex>
+#include <time.h>
+
+namespace
+{
+const int64_t kSecond = 1000000000LL;
+} // namespace
+
+SessionCache::SessionCache(size_t maxEntries, int maxAge, int negativeTtl, size_t shards)
+    : shards_(shards ? shards : 1), maxPerShard_((maxEntries + shards_.size() - 1) / shards_.size()),
+      maxAge_(maxAge * kSecond), negativeTtl_(negativeTtl * kSecond),
+      hits_(Metrics::GetCounter("session_cache_lookups_total", "Session validations by cache outcome", {{"result", "hit"}})),
+      negativeHits_(Metrics::GetCounter("session_cache_lookups_total", "Session validations by cache outcome", {{"result", "negative"}})),
+      misses_(Metrics::GetCounter("session_cache_lookups_total", "Session validations by cache outcome", {{"result", "miss"}}))
+{
+}
+
+int64_t SessionCache::Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * kSecond + ts.tv_nsec;
+}
+
+SessionCache::Result SessionCache::Get(const std::string &id, Session *out, int64_t nowNanos)
+{
+    Shard &shard = ShardOf(id);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(id);
+        if (it != shard.entries.end() && nowNanos < it->second.cacheUntil)
+        {
+            const Entry &e = it->second;
+            if (e.state != kValid || nowNanos >= e.sessionUntil)
+            {
+                negativeHits_.Inc();
+                return kUnknown;
+            }
+            *out = e.session;
+            if (!e.used.load(std::memory_order_relaxed))
+                it->second.used.store(true, std::memory_order_relaxed);
+            hits_.Inc();
+            return kHit;
+        }
+    }
+    misses_.Inc();
+    return kMiss;
+}
+
+SessionCache::Entry *SessionCache::Slot(Shard &shard, const std::string &id)
+{
+    auto it = shard.entries.find(id);
+    if (it != shard.entries.end())
+        return &it->second;
+    if (shard.entries.size() >= maxPerShard_)
+    {
+        overflow_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &shard.entries.try_emplace(id).first->second;
+}
+
+void SessionCache::Store(const std::string &id, State state, const Session *session, int64_t cacheTtl, int64_t sessionTtl, int64_t nowNanos, bool overrideRevoked)
+{
+    Shard &shard = ShardOf(id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    Entry *e = Slot(shard, id);
+    if (!e)
+        return;
+    if (!overrideRevoked && e->state == kRevoked && nowNanos < e->cacheUntil)
+        return;
+    e->state = state;
+    e->session = session ? *session : Session();
+    e->cacheUntil = nowNanos + cacheTtl;
+    e->sessionUntil = nowNanos + sessionTtl;
+    e->used.store(false, std::memory_order_relaxed);
+}
+
+void SessionCache::Put(const std::string &id, const Session &session, int64_t ttlNanos, int64_t nowNanos)
+{
+    if (ttlNanos <= 0)
+        PutUnknown(id, nowNanos);
+    else
+        Store(id, kValid, &session, std::min(ttlNanos, maxAge_), ttlNanos, nowNanos, false);
+}
+
+void SessionCache::PutUnknown(const std::string &id, int64_t nowNanos)
+{
+    Store(id, kAbsent, nullptr, negativeTtl_, 0, nowNanos, false);
+}
+
+void SessionCache::Save(const std::string &id, const Session &session, int64_t ttlNanos, int64_t nowNanos)
+{
+    Store(id, kValid, &session, std::min(ttlNanos, maxAge_), ttlNanos, nowNanos, true);
+}
+
+void SessionCache::Revoke(const std::string &id, int64_t nowNanos)
+{
+    Store(id, kRevoked, nullptr, maxAge_, 0, nowNanos, true);
+}
+
+std::vector<std::string> SessionCache::Expiring(int64_t withinNanos, size_t limit, int64_t nowNanos)
+{
+    std::vector<std::string> out;
+    for (Shard &shard : shards_)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto &kv : shard.entries)
+        {
+            const Entry &e = kv.second;
+            if (e.state == kValid && e.used.load(std::memory_order_relaxed) && e.cacheUntil <= nowNanos + withinNanos && e.sessionUntil > e.cacheUntil)
+            {
+                out.push_back(kv.first);
+                if (out.size() >= limit)
+                    return out;
+            }
+        }
+    }
+    return out;
+}
+
+size_t SessionCache::Evict(int64_t nowNanos)
+{
+    size_t removed = 0;
+    for (Shard &shard : shards_)
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.entries.begin(); it != shard.entries.end();)
+        {
+            if (it->second.cacheUntil <= nowNanos)
+            {
+                it = shard.entries.erase(it);
+                ++removed;
+            }
+            else
+                ++it;
+        }
+    }
+    return removed;
+}
+
+SessionCache::Stats SessionCache::GetStats() const
+{
+    Stats st;
+    st.hits = hits_.Value();
+    st.negativeHits = negativeHits_.Value();
+    st.misses = misses_.Value();
+    st.overflow = overflow_.load(std::memory_order_relaxed);
+    for (const Shard &shard : shards_)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        st.entries += shard.entries.size();
+    }
+    return st;
+}
@@ -0,0 +1,274 @@
+#include "SessionTokens.h"
+#include "Base64Url.h"
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <sys/stat.h>
+#include <time.h>
+
+namespace
+{
+const char kPrefix[] = "t1.";
+const size_t kMaxTokenSize = 512;
+
+bool ValidKeyId(const std::string &id)
+{
+    if (id.empty() || id.size() > 32)
+        return false;
+    for (char c : id)
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_')
+            return false;
+    return true;
+}
+
+std::string NewTokenId()
+{
+    thread_local std::random_device rd;
+    uint8_t bytes[12];
+    for (size_t i = 0; i < sizeof(bytes); i += 4)
+    {
+        uint32_t v = rd();
+        for (size_t j = 0; j < 4; ++j)
+            bytes[i + j] = static_cast<uint8_t>(v >> (j * 8));
+    }
+    return EncodeBase64Url(bytes, sizeof(bytes)); // 16 个字符
+}
+
+// 解析十进制整数（可带负号），整段都必须是数字
+bool ParseInt64(const char *s, size_t begin, size_t end, int64_t *out)
+{
+    if (begin >= end || end - begin > 18)
+        return false;
+    bool negative = s[begin] == '-';
+    if (negative && ++begin == end)
+        return false;
+    int64_t v = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (s[i] < '0' || s[i] > '9')
+            return false;
+        v = v * 10 + (s[i] - '0');
+    }
+    *out = negative ? -v : v;
+    return true;
+}
+} // namespace
+
+SessionTokens::SessionTokens()
+    : valid_(Metrics::GetCounter("session_token_verifications_total", "Session token verifications by outcome", {{"result", "valid"}})),
+      invalid_(Metrics::GetCounter("session_token_verifications_total", "Session token verifications by outcome", {{"result", "invalid"}})),
+      expired_(Metrics::GetCounter("session_token_verifications_total", "Session token verifications by outcome", {{"result", "expired"}})),
+      revokedHits_(Metrics::GetCounter("session_token_verifications_total", "Session token verifications by outcome", {{"result", "revoked"}}))
+{
+}
+
+int64_t SessionTokens::Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec);
+}
+
+int SessionTokens::LoadKeys(const std::string &path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        return -1;
+    int64_t mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    {
+        std::shared_lock<std::shared_mutex> lock(keysMutex_);
+        if (mtime == keysMtime_)
+            return static_cast<int>(keys_.size());
+    }
+    std::ifstream in(path);
+    if (!in)
+        return -1;
+    std::map<std::string, Key> keys;
+    std::string active;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string id, secret;
+        if (!(fields >> id >> secret) || id[0] == '#' || !ValidKeyId(id))
+            continue;
+        keys.erase(id);
+        keys.emplace(id, Key(secret));
+        active = id;
+    }
+    if (keys.empty())
+        return -1;
+    std::unique_lock<std::shared_mutex> lock(keysMutex_);
+    keys_.swap(keys);
+    activeKey_ = active;
+    keysMtime_ = mtime;
+    return static_cast<int>(keys_.size());
+}
+
+bool SessionTokens::AddKey(const std::string &keyId, const std::string &secret)
+{
+    if (!ValidKeyId(keyId) || secret.empty())
+        return false;
+    std::unique_lock<std::shared_mutex> lock(keysMutex_);
+    keys_.erase(keyId);
+    keys_.emplace(keyId, Key(secret));
+    activeKey_ = keyId;
+    return true;
+}
+
+bool SessionTokens::RemoveKey(const std::string &keyId)
+{
+    std::unique_lock<std::shared_mutex> lock(keysMutex_);
+    if (keys_.erase(keyId) == 0)
+        return false;
+    if (activeKey_ == keyId)
+        activeKey_ = keys_.empty() ? std::string() : keys_.rbegin()->first; // 退回到 ID 最大的密钥
+    return true;
+}
+
+bool SessionTokens::Enabled() const
+{
+    std::shared_lock<std::shared_mutex> lock(keysMutex_);
+    return !activeKey_.empty();
+}
+
+std::optional<HmacSha256> SessionTokens::KeyState(std::string *keyId) const
+{
+    std::shared_lock<std::shared_mutex> lock(keysMutex_);
+    if (keyId->empty())
+        *keyId = activeKey_;
+    auto it = keys_.find(*keyId);
+    if (it == keys_.end())
+        return std::nullopt;
+    return it->second.hmac;
+}
+
+std::string SessionTokens::Issue(int userId, const std::string &username, int64_t ttlSeconds, int64_t now) const
+{
+    std::string keyId;
+    std::optional<HmacSha256> hmac = KeyState(&keyId);
+    if (!hmac)
+        return std::string();
+    std::string payload = std::to_string(userId) + ":" + std::to_string(now + ttlSeconds) + ":" + NewTokenId() + ":" + username;
+    std::string token = kPrefix + keyId + "." + EncodeBase64Url(payload.data(), payload.size());
+    uint8_t mac[HmacSha256::kMacSize];
+    hmac->Update(token.data(), token.size());
+    hmac->Final(mac);
+    token += '.';
+    token += EncodeBase64Url(mac, sizeof(mac));
+    return token;
+}
+
+SessionTokens::Result SessionTokens::Count(Result r) const
+{
+    switch (r)
+    {
+    case kValid:
+        valid_.Inc();
+        break;
+    case kInvalid:
+        invalid_.Inc();
+        break;
+    case kExpired:
+        expired_.Inc();
+        break;
+    case kRevoked:
+        revokedHits_.Inc();
+        break;
+    }
+    return r;
+}
+
+SessionTokens::Result SessionTokens::Verify(const std::string &token, Claims *claims, int64_t now) const
+{
+    if (!LooksLikeToken(token) || token.size() > kMaxTokenSize)
+        return Count(kInvalid);
+    size_t keyEnd = token.find('.', 3);
+    size_t payloadEnd = keyEnd == std::string::npos ? std::string::npos : token.find('.', keyEnd + 1);
+    if (payloadEnd == std::string::npos || token.find('.', payloadEnd + 1) != std::string::npos)
+        return Count(kInvalid);
+
+    // 先验签名，通过后才解析载荷
+    std::string keyId = token.substr(3, keyEnd - 3);
+    std::optional<HmacSha256> hmac = keyId.empty() ? std::nullopt : KeyState(&keyId);
+    if (!hmac)
+        return Count(kInvalid);
+    char mac[HmacSha256::kMacSize + 2];
+    size_t macLen = 0;
+    if (!DecodeBase64Url(token.data() + payloadEnd + 1, token.size() - payloadEnd - 1, mac, sizeof(mac), &macLen) || macLen != HmacSha256::kMacSize)
+        return Count(kInvalid);
+    uint8_t expected[HmacSha256::kMacSize];
+    hmac->Update(token.data(), payloadEnd);
+    hmac->Final(expected);
+    if (!HmacSha256::Equal(expected, reinterpret_cast<const uint8_t *>(mac), sizeof(expected)))
+        return Count(kInvalid);
+
+    char payload[kMaxTokenSize];
+    size_t len = 0;
+    if (!DecodeBase64Url(token.data() + keyEnd + 1, payloadEnd - keyEnd - 1, payload, sizeof(payload), &len))
+        return Count(kInvalid);
+    const char *end = payload + len;
+    const char *a = std::find(static_cast<const char *>(payload), end, ':');
+    const char *b = a == end ? end : std::find(a + 1, end, ':');
+    const char *c = b == end ? end : std::find(b + 1, end, ':');
+    int64_t userId = 0, expires = 0;
+    if (c == end || !ParseInt64(payload, 0, a - payload, &userId) || !ParseInt64(payload, a + 1 - payload, b - payload, &expires))
+        return Count(kInvalid);
+    if (now >= expires)
+        return Count(kExpired);
+    claims->userId = static_cast<int>(userId);
+    claims->expires = expires;
+    claims->tokenId.assign(b + 1, c);
+    claims->username.assign(c + 1, end);
+    claims->keyId = keyId;
+    {
+        std::shared_lock<std::shared_mutex> lock(revokedMutex_);
+        if (!revoked_.empty() && revoked_.count(claims->tokenId))
+            return Count(kRevoked);
+    }
+    return Count(kValid);
+}
+
+void SessionTokens::Revoke(const std::string &tokenId, int64_t expires)
+{
+    std::unique_lock<std::shared_mutex> lock(revokedMutex_);
+    int64_t &until = revoked_[tokenId];
+    if (expires > until)
+        until = expires;
+}
+
+size_t SessionTokens::PurgeRevoked(int64_t now)
+{
+    std::unique_lock<std::shared_mutex> lock(revokedMutex_);
+    size_t removed = 0;
+    for (auto it = revoked_.begin(); it != revoked_.end();)
+    {
+        if (it->second <= now)
+        {
+            it = revoked_.erase(it);
+            ++removed;
+        }
+        else
+            ++it;
+    }
+    return removed;
+}
+
+SessionTokens::Stats SessionTokens::GetStats() const
+{
+    Stats st;
+    st.valid = valid_.Value();
+    st.invalid = invalid_.Value();
+    st.expired = expired_.Value();
+    st.revoked = revokedHits_.Value();
+    {
+        std::shared_lock<std::shared_mutex> lock(keysMutex_);
+        st.keys = keys_.size();
+    }
+    std::shared_lock<std::shared_mutex> lock(revokedMutex_);
+    st.revokedEntries = revoked_.size();
+    return st;
+}
@@ -0,0 +1,312 @@
+#include "Sha256.h"
+#include <atomic>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_HAVE_SHANI 1
+#endif
+
+namespace
+{
+    const uint32_t kRoundConstants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    inline uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    inline uint32_t LoadBe32(const uint8_t *p)
+    {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    inline void StoreBe32(uint8_t *p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    void CompressPortable(uint32_t state[8], const uint8_t *blocks, size_t count)
+    {
+        uint32_t w[64];
+        for (size_t blk = 0; blk < count; ++blk, blocks += Sha256::kBlockSize)
+        {
+            for (int i = 0; i < 16; ++i)
+                w[i] = LoadBe32(blocks + i * 4);
+            for (int i = 16; i < 64; ++i)
+            {
+                uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; ++i)
+            {
+                uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + kRoundConstants[i] + w[i];
+                uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+    }
+
+#ifdef SHA256_HAVE_SHANI
+    // SHA-NI：每条 sha256rnds2 完成两轮，消息扩展由 sha256msg1/msg2 完成
+    __attribute__((target("sha,sse4.1,ssse3"))) void CompressShaNi(uint32_t state[8], const uint8_t *blocks, size_t count)
+    {
+        const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+        // 状态重排为指令要求的 ABEF / CDGH
+        __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xB1);
+        __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1B);
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+        for (size_t blk = 0; blk < count; ++blk, blocks += Sha256::kBlockSize)
+        {
+            __m128i abefSave = state0;
+            __m128i cdghSave = state1;
+            __m128i m[4];
+#pragma GCC unroll 16
+            for (int g = 0; g < 16; ++g) // 每组 4 轮
+            {
+                __m128i &cur = m[g & 3];
+                if (g < 4)
+                    cur = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + g * 16)), byteSwap);
+                __m128i msg = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<const __m128i *>(&kRoundConstants[g * 4])));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+                if (g >= 3 && g <= 14)
+                {
+                    __m128i &next = m[(g + 1) & 3];
+                    next = _mm_add_epi32(next, _mm_alignr_epi8(cur, m[(g + 3) & 3], 4));
+                    next = _mm_sha256msg2_epu32(next, cur);
+                }
+                state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+                if (g >= 1 && g <= 12)
+                {
+                    __m128i &prev = m[(g + 3) & 3];
+                    prev = _mm_sha256msg1_epu32(prev, cur);
+                }
+            }
+            state0 = _mm_add_epi32(state0, abefSave);
+            state1 = _mm_add_epi32(state1, cdghSave);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);
+        state1 = _mm_shuffle_epi32(state1, 0xB1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), _mm_blend_epi16(tmp, state1, 0xF0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), _mm_alignr_epi8(state1, tmp, 8));
+    }
+
+    bool CpuHasShaNi()
+    {
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        bool sse41 = (ecx & bit_SSE4_1) != 0;
+        bool ssse3 = (ecx & bit_SSSE3) != 0;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return false;
+        return sse41 && ssse3 && (ebx & bit_SHA) != 0;
+    }
+#else
+    bool CpuHasShaNi() { return false; }
+#endif
+
+    typedef void (*CompressFunc)(uint32_t state[8], const uint8_t *blocks, size_t count);
+
+    CompressFunc SelectCompress(bool allowHardware)
+    {
+#ifdef SHA256_HAVE_SHANI
+        if (allowHardware && CpuHasShaNi())
+            return CompressShaNi;
+#endif
+        return CompressPortable;
+    }
+
+    std::atomic<CompressFunc> g_compress(SelectCompress(true)); // 启动时按 CPU 选定
+} // namespace
+
+Sha256::Sha256()
+{
+    Reset();
+}
+
+void Sha256::Reset()
+{
+    static const uint32_t kInit[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(state_, kInit, sizeof(state_));
+    bufferLen_ = 0;
+    totalLen_ = 0;
+}
+
+void Sha256::Compress(const uint8_t *blocks, size_t count)
+{
+    g_compress.load(std::memory_order_relaxed)(state_, blocks, count);
+}
+
+void Sha256::Update(const void *data, size_t len)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    totalLen_ += len;
+    if (bufferLen_ > 0)
+    {
+        size_t n = kBlockSize - bufferLen_ < len ? kBlockSize - bufferLen_ : len;
+        memcpy(buffer_ + bufferLen_, p, n);
+        bufferLen_ += n;
+        p += n;
+        len -= n;
+        if (bufferLen_ < kBlockSize)
+            return;
+        Compress(buffer_, 1);
+        bufferLen_ = 0;
+    }
+    // 整块直接从输入压缩，不经过缓冲区
+    size_t blocks = len / kBlockSize;
+    if (blocks > 0)
+    {
+        Compress(p, blocks);
+        p += blocks * kBlockSize;
+        len -= blocks * kBlockSize;
+    }
+    if (len > 0)
+    {
+        memcpy(buffer_, p, len);
+        bufferLen_ = len;
+    }
+}
+
+void Sha256::Final(uint8_t digest[kDigestSize])
+{
+    uint64_t bits = totalLen_ * 8;
+    uint8_t pad[kBlockSize * 2];
+    size_t padLen = (bufferLen_ < 56 ? 56 : 120) - bufferLen_;
+    memset(pad, 0, sizeof(pad));
+    pad[0] = 0x80;
+    for (int i = 0; i < 8; ++i)
+        pad[padLen + i] = static_cast<uint8_t>(bits >> (56 - i * 8));
+    Update(pad, padLen + 8);
+    for (int i = 0; i < 8; ++i)
+        StoreBe32(digest + i * 4, state_[i]);
+}
+
+std::string Sha256::HexDigest()
+{
+    uint8_t digest[kDigestSize];
+    Final(digest);
+    return Hex(digest, kDigestSize);
+}
+
+std::string Sha256::Hex(const uint8_t *data, size_t len)
+{
+    static const char kDigits[] = "0123456789abcdef";
+    std::string out(len * 2, '0');
+    for (size_t i = 0; i < len; ++i)
+    {
+        out[i * 2] = kDigits[data[i] >> 4];
+        out[i * 2 + 1] = kDigits[data[i] & 0x0f];
+    }
+    return out;
+}
+
+std::string Sha256::HexOf(const void *data, size_t len)
+{
+    Sha256 h;
+    h.Update(data, len);
+    return h.HexDigest();
+}
+
+bool Sha256::ValidHex(const std::string &hex)
+{
+    if (hex.size() != kDigestSize * 2)
+        return false;
+    for (char c : hex)
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+            return false;
+    return true;
+}
+
+const char *Sha256::Implementation()
+{
+    return g_compress.load() == CompressPortable ? "portable" : "sha-ni";
+}
+
+bool Sha256::SetHardwareAcceleration(bool enable)
+{
+    g_compress.store(SelectCompress(enable));
+    return g_compress.load() != CompressPortable;
+}
+
+HmacSha256::HmacSha256(const std::string &key)
+{
+    uint8_t block[Sha256::kBlockSize];
+    memset(block, 0, sizeof(block));
+    if (key.size() > Sha256::kBlockSize)
+    {
+        Sha256 h;
+        h.Update(key.data(), key.size());
+        h.Final(block);
+    }
+    else
+        memcpy(block, key.data(), key.size());
+    uint8_t pad[Sha256::kBlockSize];
+    for (size_t i = 0; i < sizeof(pad); ++i)
+        pad[i] = block[i] ^ 0x36;
+    innerKeyed_.Update(pad, sizeof(pad));
+    for (size_t i = 0; i < sizeof(pad); ++i)
+        pad[i] = block[i] ^ 0x5c;
+    outerKeyed_.Update(pad, sizeof(pad));
+    inner_ = innerKeyed_;
+}
+
+void HmacSha256::Update(const void *data, size_t len)
+{
+    inner_.Update(data, len);
+}
+
+void HmacSha256::Final(uint8_t mac[kMacSize])
+{
+    uint8_t digest[Sha256::kDigestSize];
+    inner_.Final(digest);
+    Sha256 outer = outerKeyed_;
+    outer.Update(digest, sizeof(digest));
+    outer.Final(mac);
+    inner_ = innerKeyed_;
+}
+
+void HmacSha256::Compute(const std::string &key, const void *data, size_t len, uint8_t mac[kMacSize])
+{
+    HmacSha256 h(key);
+    h.Update(data, len);
+    h.Final(mac);
+}
+
+bool HmacSha256::Equal(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; ++i)
+        diff |= a[i] ^ b[i];
+    return diff == 0;
+}
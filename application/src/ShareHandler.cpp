@@ -2,7 +2,6 @@
 #include "inc/Util.h"
 #include "inc/HttpUtil.h"
 #include "inc/RangeUtil.h"
-#include "inc/FileDownContext.h"
 #include <regex>
 #include <experimental/filesystem>
 #include <nlohmann/json.hpp>
@@ -239,13 +238,13 @@ bool ShareHandler::handleShareDownload(const std::shared_ptr<Connection> &conn,
     }
 
     // 构建分享文件下载的回复信息
-    std::string filepath = uploadDir + "/" + rec.serverFilename;
-    if (!fs::exists(filepath) || !fs::is_regular_file(filepath))
+    std::shared_ptr<const CachedFile> file = blobStore_.Open(rec.serverFilename, rec.contentHash);
+    if (!file)
     {
         sendError(resp, "文件不存在", HttpStatusCode::NotFound, conn);
         return true;
     }
-    uintmax_t fileSize = fs::file_size(filepath);
+    uint64_t fileSize = file->size;
     if (req.GetMethod() == HttpMethod::kHead)
     {
         resp->SetStatusCode(HttpStatusCode::OK);
@@ -253,8 +252,6 @@ bool ShareHandler::handleShareDownload(const std::shared_ptr<Connection> &conn,
         resp->SetContentType("application/octet-stream");
         resp->SetContentLength(fileSize);
         resp->AddHeader("Accept-Ranges", "bytes");
-        resp->AddHeader("Connection", "close");
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection> &c){ c->shutdown(); return true; });
         return true;
     }
     // 处理 Range 请求
@@ -264,38 +261,7 @@ bool ShareHandler::handleShareDownload(const std::shared_ptr<Connection> &conn,
         sendError(resp, "Range Not Satisfiable", HttpStatusCode::RangeNotSatisfiable, conn);
         return true;
     }
-    auto httpContext = conn->GetContext();
-    if (!httpContext)
-    {
-        sendError(resp, "Internal Server Error", HttpStatusCode::InternalServerError, conn);
-        return true;
-    }
-    std::shared_ptr<FileDownContext> downContext = httpContext->GetContext<FileDownContext>();
-    if (!downContext)
-    {
-        downContext = std::make_shared<FileDownContext>(filepath, rec.originalFilename);
-        httpContext->SetContext(downContext);
-        if (rs.isRange)
-        {
-            resp->SetStatusCode(HttpStatusCode::PartialContent);
-            resp->SetStatusMessage("Partial Content");
-            resp->AddHeader("Content-Range", "bytes " + std::to_string(rs.start) + "-" + std::to_string(rs.end) + "/" + std::to_string(fileSize));
-        }
-        else
-        {
-            resp->SetStatusCode(HttpStatusCode::OK);
-            resp->SetStatusMessage("OK");
-        }
-        resp->SetContentType("application/octet-stream");
-        resp->SetBodyType(HTML_TYPE);
-        resp->SetContentLength(fileSize);
-        resp->AddHeader("Content-Disposition", "attachment; filename=\"" + rec.originalFilename + "\"");
-        resp->AddHeader("Accept-Ranges", "bytes");
-        resp->AddHeader("Connection", "keep-alive");
-        downContext->seekTo(rs.isRange ? rs.start : 0);
-    }
-    conn->setWriteCompleteCallback([downContext](const std::shared_ptr<Connection> &c)
-                                   { std::string chunk; if (downContext->readNextChunk(chunk)) { c->Send(chunk); return true; } c->shutdown(); return true; });
+    sendFile(resp, file, rs, rec.originalFilename, conn, &contentCache_);
     return true;
 }
 
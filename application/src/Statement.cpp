@@ -0,0 +1,214 @@
+#include "./inc/Statement.h"
+#include "./inc/Db.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <cstring>
+#include <mysql/errmsg.h>
+
+namespace
+{
+const unsigned long kInitialTextBuffer = 64; // 多数列（用户名、文件名、日期）放得下，更长的在 fetch 中扩容
+
+bool IsIntegerType(enum_field_types type)
+{
+    return type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_LONG || type == MYSQL_TYPE_INT24 || type == MYSQL_TYPE_LONGLONG;
+}
+} // namespace
+
+Statement::Statement(Db &db, MYSQL_STMT *stmt) : db_(db), stmt_(stmt)
+{
+    size_t count = mysql_stmt_param_count(stmt_);
+    params_.resize(count);
+    paramInts_.resize(count);
+    paramLengths_.resize(count);
+    std::memset(params_.data(), 0, sizeof(MYSQL_BIND) * count);
+    bindResult();
+}
+
+Statement::~Statement()
+{
+    mysql_stmt_close(stmt_);
+}
+
+void Statement::bindResult()
+{
+    MYSQL_RES *meta = mysql_stmt_result_metadata(stmt_);
+    if (!meta)
+        return; // 不返回结果集的语句
+    unsigned int count = mysql_num_fields(meta);
+    MYSQL_FIELD *fields = mysql_fetch_fields(meta);
+    columns_.resize(count);
+    results_.resize(count);
+    std::memset(results_.data(), 0, sizeof(MYSQL_BIND) * count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Column &c = columns_[i];
+        MYSQL_BIND &b = results_[i];
+        c.integer = IsIntegerType(fields[i].type);
+        if (c.integer)
+        {
+            b.buffer_type = MYSQL_TYPE_LONGLONG;
+            b.buffer = &c.value;
+            b.is_unsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+        }
+        else
+        {
+            c.text.resize(kInitialTextBuffer);
+            b.buffer_type = MYSQL_TYPE_STRING;
+            b.buffer = c.text.data();
+            b.buffer_length = static_cast<unsigned long>(c.text.size());
+        }
+        b.length = &c.length;
+        b.is_null = &c.isNull;
+        b.error = &c.error;
+    }
+    mysql_free_result(meta);
+}
+
+void Statement::bindInt(size_t i, int64_t v, bool isUnsigned)
+{
+    paramInts_[i] = v;
+    MYSQL_BIND &b = params_[i];
+    b.buffer_type = MYSQL_TYPE_LONGLONG;
+    b.buffer = &paramInts_[i];
+    b.is_unsigned = isUnsigned;
+    b.length = nullptr;
+}
+
+void Statement::bindText(size_t i, const char *data, size_t size)
+{
+    paramLengths_[i] = static_cast<unsigned long>(size);
+    MYSQL_BIND &b = params_[i];
+    b.buffer_type = MYSQL_TYPE_STRING;
+    b.buffer = const_cast<char *>(data); // 只在本次执行期间引用调用方的字符串
+    b.buffer_length = static_cast<unsigned long>(size);
+    b.length = &paramLengths_[i];
+}
+
+void Statement::bindParam(size_t i, const char *v)
+{
+    bindText(i, v, std::strlen(v));
+}
+
+void Statement::bindParam(size_t i, std::nullopt_t)
+{
+    MYSQL_BIND &b = params_[i];
+    b.buffer_type = MYSQL_TYPE_NULL;
+    b.buffer = nullptr;
+    b.length = nullptr;
+}
+
+bool Statement::paramCountMismatch(size_t given)
+{
+    LOG_ERROR << "MySQL statement expects " << params_.size() << " parameters, got " << given;
+    return false;
+}
+
+void Statement::fail(const char *what)
+{
+    unsigned int err = mysql_stmt_errno(stmt_);
+    LOG_ERROR << "MySQL " << what << " failed: " << mysql_stmt_error(stmt_);
+    if (err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST)
+        db_.markLost(); // 借出时重连，语句缓存随连接重建
+}
+
+bool Statement::run(bool store)
+{
+    if (hasResult_)
+    {
+        mysql_stmt_free_result(stmt_);
+        hasResult_ = false;
+    }
+    int64_t start = Metrics::NowNanos();
+    bool ok = (params_.empty() || !mysql_stmt_bind_param(stmt_, params_.data())) && mysql_stmt_execute(stmt_) == 0;
+    if (ok && store)
+    {
+        ok = (results_.empty() || !mysql_stmt_bind_result(stmt_, results_.data())) && mysql_stmt_store_result(stmt_) == 0;
+        hasResult_ = ok;
+    }
+    if (latency_)
+        latency_->Record(static_cast<uint64_t>(Metrics::NowNanos() - start));
+    if (!ok)
+        fail("statement execute");
+    return ok;
+}
+
+bool Statement::fetch()
+{
+    if (!hasResult_)
+        return false;
+    int rc = mysql_stmt_fetch(stmt_);
+    if (rc == MYSQL_DATA_TRUNCATED)
+    {
+        // 超出缓冲的字符串列：扩容后单独取这一列，再把新缓冲绑定给后续行
+        for (unsigned int i = 0; i < columns_.size(); ++i)
+        {
+            Column &c = columns_[i];
+            if (c.integer || c.isNull || c.length <= c.text.size())
+                continue;
+            c.text.resize(c.length);
+            MYSQL_BIND &b = results_[i];
+            b.buffer = c.text.data();
+            b.buffer_length = static_cast<unsigned long>(c.text.size());
+            if (mysql_stmt_fetch_column(stmt_, &b, i, 0) != 0)
+            {
+                fail("fetch column");
+                return false;
+            }
+        }
+        mysql_stmt_bind_result(stmt_, results_.data());
+        return true;
+    }
+    if (rc == 1)
+        fail("fetch");
+    return rc == 0;
+}
+
+uint64_t Statement::rowCount() const
+{
+    return hasResult_ ? mysql_stmt_num_rows(stmt_) : 0;
+}
+
+uint64_t Statement::insertId() const
+{
+    return mysql_stmt_insert_id(stmt_);
+}
+
+uint64_t Statement::affectedRows() const
+{
+    return mysql_stmt_affected_rows(stmt_);
+}
+
+int64_t Statement::getInt64(unsigned col) const
+{
+    const Column &c = columns_[col];
+    if (c.isNull)
+        return 0;
+    if (c.integer)
+        return c.value;
+    return std::strtoll(std::string(c.text.data(), c.length).c_str(), nullptr, 10); // DECIMAL、SUM() 等以文本返回的数值
+}
+
+std::string Statement::getString(unsigned col) const
+{
+    const Column &c = columns_[col];
+    if (c.isNull)
+        return std::string();
+    if (c.integer)
+        return std::to_string(c.value);
+    return std::string(c.text.data(), c.length);
+}
+
+std::optional<int> Statement::getOptionalInt(unsigned col) const
+{
+    if (columns_[col].isNull)
+        return std::nullopt;
+    return getInt(col);
+}
+
+std::optional<std::string> Statement::getOptionalString(unsigned col) const
+{
+    if (columns_[col].isNull)
+        return std::nullopt;
+    return getString(col);
+}
@@ -0,0 +1,380 @@
+#include "StaticAssets.h"
+#include "DirWatcher.h"
+#include "EventLoop.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Logger.h"
+#include "Sha256.h"
+#include <brotli/encode.h>
+#include <zlib.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+    bool ReadWhole(const std::string &path, size_t size, std::string &out)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        out.assign(size, '\0');
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t n = ::read(fd, &out[done], size - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += static_cast<size_t>(n);
+        }
+        ::close(fd);
+        out.resize(done); // 读取期间被截断时以实际读到的为准，随后的 inotify 事件会再次加载
+        return true;
+    }
+
+    std::shared_ptr<const std::string> Gzip(const std::string &in)
+    {
+        z_stream zs{};
+        if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) // 15 + 16：gzip 封装
+            return nullptr;
+        std::string out(deflateBound(&zs, in.size()), '\0');
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+        zs.avail_out = static_cast<uInt>(out.size());
+        int rc = deflate(&zs, Z_FINISH);
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        if (rc != Z_STREAM_END)
+            return nullptr;
+        return std::make_shared<const std::string>(std::move(out));
+    }
+
+    std::shared_ptr<const std::string> Brotli(const std::string &in, bool text)
+    {
+        size_t outSize = BrotliEncoderMaxCompressedSize(in.size());
+        if (outSize == 0)
+            return nullptr;
+        std::string out(outSize, '\0');
+        if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, text ? BROTLI_MODE_TEXT : BROTLI_MODE_GENERIC,
+                                   in.size(), reinterpret_cast<const uint8_t *>(in.data()), &outSize, reinterpret_cast<uint8_t *>(&out[0])))
+            return nullptr;
+        out.resize(outSize);
+        return std::make_shared<const std::string>(std::move(out));
+    }
+
+    // 图片（除 svg 与 ico）、字体、压缩包本身已压缩，再压只浪费 CPU
+    bool Compressible(const std::string &contentType)
+    {
+        return contentType.compare(0, 5, "text/") == 0 || contentType == "application/javascript" ||
+               contentType == "application/json" || contentType == "image/svg+xml" || contentType == "image/x-icon";
+    }
+
+    std::string Trim(const std::string &s)
+    {
+        size_t b = s.find_first_not_of(" \t");
+        if (b == std::string::npos)
+            return "";
+        size_t e = s.find_last_not_of(" \t");
+        return s.substr(b, e - b + 1);
+    }
+} // namespace
+
+StaticAssets::StaticAssets(const std::string &dir, size_t maxFileBytes)
+    : dir_(dir), maxFileBytes_(maxFileBytes) {}
+
+StaticAssets::~StaticAssets() = default;
+
+std::string StaticAssets::ContentTypeOf(const std::string &path)
+{
+    static const std::unordered_map<std::string, std::string> mime = {
+        {".html", "text/html; charset=utf-8"},
+        {".js", "application/javascript"},
+        {".css", "text/css"},
+        {".json", "application/json"},
+        {".txt", "text/plain; charset=utf-8"},
+        {".xml", "text/xml; charset=utf-8"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".webp", "image/webp"},
+        {".svg", "image/svg+xml"},
+        {".ico", "image/x-icon"},
+        {".woff2", "font/woff2"}};
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.find('/', dot) != std::string::npos)
+        return "application/octet-stream";
+    auto it = mime.find(path.substr(dot));
+    return it != mime.end() ? it->second : "application/octet-stream";
+}
+
+std::shared_ptr<const StaticAsset> StaticAssets::LoadFile(const std::string &path) const
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) > maxFileBytes_)
+        return nullptr;
+    std::string data;
+    if (!ReadWhole(path, static_cast<size_t>(st.st_size), data))
+        return nullptr;
+
+    std::shared_ptr<StaticAsset> asset = std::make_shared<StaticAsset>();
+    asset->contentType = ContentTypeOf(path);
+    std::string tag = Sha256::HexOf(data.data(), data.size()).substr(0, 20);
+    asset->etag[StaticAsset::kIdentity] = "\"" + tag + "\"";
+    asset->etag[StaticAsset::kGzip] = "\"" + tag + "-gz\"";
+    asset->etag[StaticAsset::kBrotli] = "\"" + tag + "-br\"";
+    if (Compressible(asset->contentType) && data.size() > 256)
+    {
+        // 只保留确实更小的压缩版本
+        std::shared_ptr<const std::string> gz = Gzip(data);
+        if (gz && gz->size() < data.size())
+            asset->body[StaticAsset::kGzip] = gz;
+        std::shared_ptr<const std::string> br = Brotli(data, asset->contentType.compare(0, 5, "text/") == 0);
+        if (br && br->size() < data.size())
+            asset->body[StaticAsset::kBrotli] = br;
+    }
+    asset->body[StaticAsset::kIdentity] = std::make_shared<const std::string>(std::move(data));
+    return asset;
+}
+
+void StaticAssets::Scan(const std::string &dir, const std::string &prefix, AssetMap &assets) const
+{
+    DIR *d = ::opendir(dir.c_str());
+    if (!d)
+        return;
+    while (struct dirent *e = ::readdir(d))
+    {
+        std::string name = e->d_name;
+        if (name.empty() || name[0] == '.')
+            continue; // 跳过 . .. 与隐藏文件（编辑器的交换文件等）
+        std::string path = dir + "/" + name;
+        if (e->d_type == DT_DIR)
+            Scan(path, prefix + name + "/", assets);
+        else if (std::shared_ptr<const StaticAsset> asset = LoadFile(path))
+            assets[prefix + name] = asset;
+    }
+    ::closedir(d);
+}
+
+size_t StaticAssets::Load()
+{
+    AssetMap assets;
+    Scan(dir_, "", assets);
+    size_t n = assets.size();
+    std::unique_lock<std::mutex> lock(mutex_);
+    assets_.swap(assets);
+    return n; // 旧内容在锁外随 assets 析构释放
+}
+
+bool StaticAssets::Watch(EventLoop *loop)
+{
+    if (!watcher_)
+    {
+        loop_ = loop;
+        watcher_.reset(new DirWatcher(loop, std::bind(&StaticAssets::OnChange, this, std::placeholders::_1), [this]() {
+            reloadAll_ = true;
+            ScheduleFlush();
+        }));
+    }
+    return watcher_->Watch(dir_);
+}
+
+void StaticAssets::OnChange(const std::string &path)
+{
+    pending_.insert(path);
+    ScheduleFlush();
+}
+
+void StaticAssets::ScheduleFlush()
+{
+    // 写文件通常产生一连串事件，攒 100ms 后一次性重新加载
+    if (flushScheduled_)
+        return;
+    flushScheduled_ = true;
+    loop_->RunAfter(0.1, std::bind(&StaticAssets::FlushPending, this));
+}
+
+void StaticAssets::FlushPending()
+{
+    flushScheduled_ = false;
+    std::set<std::string> pending;
+    pending.swap(pending_);
+    if (reloadAll_)
+    {
+        reloadAll_ = false;
+        size_t n = Load();
+        ++reloads_;
+        LOG_INFO << "StaticAssets reloaded " << dir_ << ", " << n << " assets";
+        return;
+    }
+    for (const std::string &path : pending)
+    {
+        if (path.compare(0, dir_.size() + 1, dir_ + "/") != 0)
+            continue;
+        std::string rel = path.substr(dir_.size() + 1);
+        std::string name = rel.substr(rel.find_last_of('/') + 1);
+        if (name.empty() || name[0] == '.')
+            continue;
+        std::shared_ptr<const StaticAsset> asset = LoadFile(path);
+        std::shared_ptr<const StaticAsset> old;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto it = assets_.find(rel);
+            if (it != assets_.end())
+                old = it->second;
+            if (asset)
+                assets_[rel] = asset;
+            else if (it != assets_.end())
+                assets_.erase(it);
+        }
+        if (asset || old)
+            ++reloads_;
+    }
+}
+
+std::shared_ptr<const StaticAsset> StaticAssets::Find(const std::string &relPath) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = assets_.find(relPath);
+    return it == assets_.end() ? nullptr : it->second;
+}
+
+StaticAsset::Encoding StaticAssets::Negotiate(const std::string &acceptEncoding, const bool available[StaticAsset::kEncodingCount])
+{
+    // 各编码的 q 值，-1 表示未列出（取 * 的值）；identity 未列出时总是可接受
+    double q[StaticAsset::kEncodingCount] = {-1, -1, -1};
+    double star = -1;
+    size_t pos = 0;
+    while (pos <= acceptEncoding.size())
+    {
+        size_t comma = acceptEncoding.find(',', pos);
+        if (comma == std::string::npos)
+            comma = acceptEncoding.size();
+        std::string item = acceptEncoding.substr(pos, comma - pos);
+        pos = comma + 1;
+        double weight = 1.0;
+        size_t semi = item.find(';');
+        if (semi != std::string::npos)
+        {
+            size_t qpos = item.find("q=", semi);
+            if (qpos != std::string::npos)
+                weight = std::atof(item.c_str() + qpos + 2);
+            item = item.substr(0, semi);
+        }
+        item = Trim(item);
+        for (char &c : item)
+            c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+        if (item == "br")
+            q[StaticAsset::kBrotli] = weight;
+        else if (item == "gzip" || item == "x-gzip")
+            q[StaticAsset::kGzip] = weight;
+        else if (item == "identity")
+            q[StaticAsset::kIdentity] = weight;
+        else if (item == "*")
+            star = weight;
+    }
+    for (int i = StaticAsset::kGzip; i < StaticAsset::kEncodingCount; ++i)
+        if (q[i] < 0)
+            q[i] = star < 0 ? 0 : star;
+    if (q[StaticAsset::kIdentity] < 0)
+        q[StaticAsset::kIdentity] = 0.001; // 兜底
+
+    // q 相同时优先压缩率更高的编码
+    StaticAsset::Encoding best = StaticAsset::kIdentity;
+    double bestQ = 0;
+    const StaticAsset::Encoding order[] = {StaticAsset::kBrotli, StaticAsset::kGzip, StaticAsset::kIdentity};
+    for (StaticAsset::Encoding enc : order)
+    {
+        if (available[enc] && q[enc] > bestQ)
+        {
+            best = enc;
+            bestQ = q[enc];
+        }
+    }
+    return best;
+}
+
+bool StaticAssets::EtagMatches(const std::string &ifNoneMatch, const std::string &etag)
+{
+    std::string want = etag.compare(0, 2, "W/") == 0 ? etag.substr(2) : etag;
+    size_t pos = 0;
+    while (pos <= ifNoneMatch.size())
+    {
+        size_t comma = ifNoneMatch.find(',', pos);
+        if (comma == std::string::npos)
+            comma = ifNoneMatch.size();
+        std::string tag = Trim(ifNoneMatch.substr(pos, comma - pos));
+        pos = comma + 1;
+        if (tag == "*")
+            return true;
+        if (tag.compare(0, 2, "W/") == 0)
+            tag = tag.substr(2);
+        if (tag == want)
+            return true;
+    }
+    return false;
+}
+
+void StaticAssets::Respond(const StaticAsset &asset, const HttpRequest &req, HttpResponse *resp)
+{
+    bool available[StaticAsset::kEncodingCount];
+    bool compressed = false;
+    for (int i = 0; i < StaticAsset::kEncodingCount; ++i)
+    {
+        available[i] = asset.body[i] != nullptr;
+        compressed = compressed || (i != StaticAsset::kIdentity && available[i]);
+    }
+    StaticAsset::Encoding enc = compressed ? Negotiate(req.GetHeader("Accept-Encoding"), available) : StaticAsset::kIdentity;
+
+    resp->AddHeader("ETag", asset.etag[enc]);
+    resp->AddHeader("Cache-Control", "no-cache"); // 每次用 ETag 验证，修改后立即生效
+    if (compressed)
+        resp->AddHeader("Vary", "Accept-Encoding");
+
+    std::string ifNoneMatch = req.GetHeader("If-None-Match");
+    if (!ifNoneMatch.empty() && EtagMatches(ifNoneMatch, asset.etag[enc]))
+    {
+        ++notModified_;
+        resp->SetStatusCode(HttpStatusCode::NotModified);
+        resp->SetStatusMessage("Not Modified");
+        resp->SetBodyType(HTML_TYPE);
+        resp->SetBody("");
+        return;
+    }
+    ++served_;
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetContentType(asset.contentType);
+    if (enc == StaticAsset::kGzip)
+        resp->AddHeader("Content-Encoding", "gzip");
+    else if (enc == StaticAsset::kBrotli)
+        resp->AddHeader("Content-Encoding", "br");
+    resp->SetSharedBody(asset.body[enc]);
+}
+
+StaticAssets::Stats StaticAssets::GetStats() const
+{
+    Stats st;
+    st.reloads = reloads_.load();
+    st.served = served_.load();
+    st.notModified = notModified_.load();
+    std::unique_lock<std::mutex> lock(mutex_);
+    st.assets = assets_.size();
+    for (auto &kv : assets_)
+    {
+        st.identityBytes += kv.second->body[StaticAsset::kIdentity]->size();
+        for (int i = StaticAsset::kGzip; i < StaticAsset::kEncodingCount; ++i)
+            if (kv.second->body[i])
+                st.compressedBytes += kv.second->body[i]->size();
+    }
+    return st;
+}
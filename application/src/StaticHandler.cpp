@@ -1,143 +1,88 @@
 #include "inc/StaticHandler.h"
-#include <fstream>
 #include "Connection.h"
 #include "HttpResponse.h"
 #include "HttpRequest.h"
 
-bool StaticHandler::handleIndex(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+const std::string &StaticHandler::staticDir()
 {
-    resp->SetStatusCode(HttpStatusCode::OK);
-    resp->SetStatusMessage("OK");
-    resp->SetContentType("text/html; charset=utf-8");
-    resp->SetBodyType(HTML_TYPE);
+    static const std::string dir = []() {
+        std::string currentDir = __FILE__;                                                                 // 找到当前文件所在目录
+        std::string::size_type pos = currentDir.substr(0, currentDir.find_last_of("/")).find_last_of("/"); // 获取上上级目录
+        return currentDir.substr(0, pos) + "/static";
+    }();
+    return dir;
+}
 
-    std::string path = req.GetUrl();
-    std::string currentDir = __FILE__;                                                                 // 找到当前文件所在目录
-    std::string::size_type pos = currentDir.substr(0, currentDir.find_last_of("/")).find_last_of("/"); // 获取上上级目录
-    std::string projectRoot = currentDir.substr(0, pos);                                               // 获取项目根目录
-    std::string staticDir = projectRoot + "/static";
-    std::string filePath;
-    if (path == "/")
-        filePath = staticDir + "/index.html";
-    else if(path.find("/share/" == 0 || path == "/share.html"))
-        filePath = staticDir + "/share.html";
-    else
-        filePath = staticDir + "/index.html";
+std::shared_ptr<const CachedFile> StaticHandler::openFile(const std::string &path)
+{
+    return cache_ ? cache_->Open(path) : FdCache::OpenFile(path);
+}
 
-    std::ifstream file(filePath); // 打开静态文件
-    if (!file.is_open())
+void StaticHandler::serve(HttpRequest &req, HttpResponse *resp, const std::string &relPath)
+{
+    if (assets_)
+    {
+        if (std::shared_ptr<const StaticAsset> asset = assets_->Find(relPath))
+        {
+            assets_->Respond(*asset, req, resp);
+            return;
+        }
+    }
+    // 未预加载（过大或刚创建还未重新加载）：直接 sendfile
+    std::shared_ptr<const CachedFile> file = openFile(staticDir() + "/" + relPath);
+    if (!file)
     {
         resp->SetStatusCode(HttpStatusCode::NotFound);
         resp->SetStatusMessage("Not Found");
         resp->SetContentType("text/html; charset=utf-8");
+        resp->SetBodyType(HTML_TYPE);
         resp->SetBody("<h1>404 Not Found</h1>");
-        if (conn)
-            conn->setWriteCompleteCallback([](const std::shared_ptr<Connection> &c){ c->shutdown(); return true; });
-        return true;
+        return;
     }
-    std::string html((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    resp->SetCloseConnection(true);
-    resp->SetBody(html);
-    resp->SetContentLength(html.size());
-    if (conn)
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection> &c)
-                                       { c->shutdown(); return true; });
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetContentType(StaticAssets::ContentTypeOf(relPath));
+    resp->SetBodyType(FILE_TYPE);
+    resp->SetSharedFile(file->fd, file);
+    resp->SetContentLength(static_cast<long long>(file->size));
+}
+
+bool StaticHandler::handleIndex(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    const std::string &path = req.GetUrl();
+    if (path == "/")
+        serve(req, resp, "index.html");
+    else if (path.rfind("/share/", 0) == 0 || path == "/share.html")
+        serve(req, resp, "share.html");
+    else
+        serve(req, resp, path.substr(1)); // 路由只把 /index.html、/register.html 等固定页面交给这里
     return true;
 }
 
 bool StaticHandler::handleFavicon(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
 {
-    std::string currentDir = __FILE__;                                                                 // 找到当前文件所在目录
-    std::string::size_type pos = currentDir.substr(0, currentDir.find_last_of("/")).find_last_of("/"); // 获取上上级目录
-    std::string projectRoot = currentDir.substr(0, pos);                                               // 获取项目根目录
-    std::string staticDir = projectRoot + "/static";
-    std::string filePath = staticDir + "/favicon.ico";
-    std::ifstream file(filePath); // 打开静态文件
-    if (!file.is_open())
-    {
-        resp->SetStatusCode(HttpStatusCode::NotFound);
-        resp->SetStatusMessage("Not Found");
-        resp->SetContentType("text/html; charset=utf-8");
-        resp->SetBody("<h1>404 Not Found</h1>");
-    }
-    else
-    {
-        std::string iconData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()); // 读取图标数据
-        resp->SetStatusCode(HttpStatusCode::OK);
-        resp->SetStatusMessage("OK");
-        resp->SetContentType("image/x-icon");
-        resp->SetBody(iconData);
-        resp->SetContentLength(iconData.size());
-        resp->SetCloseConnection(true);
-    }
-    if (conn)
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection> &c){ c->shutdown(); return true; });
+    serve(req, resp, "favicon.ico");
     return true;
 }
 
 bool StaticHandler::handleStaticAsset(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
 {
     // 路径形如 /static/xxx
-    std::string path = req.GetUrl();
+    const std::string &path = req.GetUrl();
     if (path.rfind("/static/", 0) != 0) {
         resp->SetStatusCode(HttpStatusCode::NotFound);
         resp->SetStatusMessage("Not Found");
-        resp->AddHeader("Connection","close");
         resp->SetBody("");
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection>& c){ c->shutdown(); return true;});
         return true;
     }
-    std::string currentDir = __FILE__;
-    std::string::size_type pos = currentDir.find_last_of("/");
-    std::string projectRoot = currentDir.substr(0, pos);
-    std::string staticDir = projectRoot + "/static";
     std::string rel = path.substr(std::string("/static/").size());
     // 基本的路径穿越防护：禁止 ..
     if (rel.find("..") != std::string::npos) {
         resp->SetStatusCode(HttpStatusCode::Forbidden);
         resp->SetStatusMessage("Forbidden");
-        resp->AddHeader("Connection","close");
         resp->SetBody("");
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection>& c){ c->shutdown(); return true;});
         return true;
     }
-    std::string filePath = staticDir + "/" + rel;
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) {
-        resp->SetStatusCode(HttpStatusCode::NotFound);
-        resp->SetStatusMessage("Not Found");
-        resp->AddHeader("Connection","close");
-        resp->SetBody("");
-        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection>& c){ c->shutdown(); return true;});
-        return true;
-    }
-    // 简单的内容类型映射
-    static const std::unordered_map<std::string, std::string> mime = {
-        {".js", "application/javascript"},
-        {".css", "text/css"},
-        {".png", "image/png"},
-        {".jpg", "image/jpeg"},
-        {".jpeg", "image/jpeg"},
-        {".gif", "image/gif"},
-        {".svg", "image/svg+xml"},
-        {".ico", "image/x-icon"},
-        {".html", "text/html; charset=utf-8"},
-        {".json", "application/json"},
-        {".txt", "text/plain; charset=utf-8"},
-        {".xml", "text/xml; charset=utf-8"}
-    };
-    std::string ext;
-    auto dot = filePath.find_last_of('.');
-    if (dot != std::string::npos) ext = filePath.substr(dot);
-    auto it = mime.find(ext);
-    std::string ct = it != mime.end() ? it->second : "application/octet-stream";
-    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    resp->SetStatusCode(HttpStatusCode::OK);
-    resp->SetStatusMessage("OK");
-    resp->SetContentType(ct);
-    resp->SetContentLength(data.size());
-    resp->SetCloseConnection(true);
-    resp->SetBody(data);
-    conn->setWriteCompleteCallback([](const std::shared_ptr<Connection>& c){ c->shutdown(); return true;});
+    serve(req, resp, rel);
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,358 @@
+#include "UploadSessionStore.h"
+#include "UploadWriter.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "Util.h"
+#include <nlohmann/json.hpp>
+#include <experimental/filesystem>
+#include <fstream>
+#include <vector>
+#include <ctime>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+    uint64_t FileSizeOrZero(const std::string &path)
+    {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0)
+            return 0;
+        return static_cast<uint64_t>(st.st_size);
+    }
+} // namespace
+
+UploadSessionStore::UploadSessionStore(const std::string &dir, int64_t ttlSeconds)
+    : dir_(dir), ttl_(ttlSeconds) {}
+
+bool UploadSessionStore::validId(const std::string &id)
+{
+    if (id.empty() || id.size() > 64)
+        return false;
+    for (char c : id)
+        if (!isalnum(static_cast<unsigned char>(c)))
+            return false;
+    return true;
+}
+
+std::string UploadSessionStore::joinParts(const std::vector<uint64_t> &parts)
+{
+    std::string out;
+    for (uint64_t p : parts)
+    {
+        if (!out.empty())
+            out += ",";
+        out += std::to_string(p);
+    }
+    return out;
+}
+
+void UploadSessionStore::load()
+{
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto &entry : fs::directory_iterator(dir_, ec))
+    {
+        fs::path p = entry.path();
+        if (p.extension() != ".json")
+            continue;
+        try
+        {
+            std::ifstream in(p.string());
+            json j = json::parse(in);
+            auto s = std::make_shared<UploadSession>();
+            s->id = j.at("id").get<std::string>();
+            if (!validId(s->id))
+                continue;
+            s->userId = j.at("userId").get<int>();
+            s->filename = j.at("filename").get<std::string>();
+            s->size = j.at("size").get<uint64_t>();
+            s->sha256 = j.value("sha256", "");
+            s->createdAt = j.value("createdAt", static_cast<int64_t>(0));
+            s->updatedAt = j.value("updatedAt", s->createdAt);
+            s->partSize = j.value("partSize", static_cast<uint64_t>(0));
+            if (s->isMultipart())
+            {
+                // 写入中的分片未持久化为完成，重启后需重传
+                std::string parts = j.value("parts", "");
+                s->parts.assign(s->partCount(), UploadSession::kPartMissing);
+                for (size_t i = 0; i < parts.size() && i < s->parts.size(); ++i)
+                    if (parts[i] == '1')
+                    {
+                        s->parts[i] = UploadSession::kPartDone;
+                        s->offset += s->partLength(i);
+                    }
+            }
+            else
+                s->offset = std::min(FileSizeOrZero(dataPath(s->id)), s->size); // 以磁盘上的数据为准
+            sessions_[s->id] = s;
+        }
+        catch (const std::exception &e)
+        {
+            LOG_WARN << "Skip broken upload session " << p.string() << ": " << e.what();
+        }
+    }
+    LOG_INFO << "Loaded " << sessions_.size() << " resumable upload sessions";
+}
+
+void UploadSessionStore::startExpiry(EventLoop *loop, double interval)
+{
+    loop->RunEvery(interval, [this]() {
+        size_t n = expireStale();
+        if (n > 0)
+            LOG_INFO << "Expired " << n << " resumable upload sessions";
+    });
+}
+
+size_t UploadSessionStore::expireStale()
+{
+    int64_t now = static_cast<int64_t>(time(nullptr));
+    std::vector<std::string> expired;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto it = sessions_.begin(); it != sessions_.end();)
+        {
+            if (!it->second->busy && it->second->activeParts == 0 && now - it->second->updatedAt > ttl_)
+            {
+                expired.push_back(it->first);
+                it = sessions_.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+    for (const auto &id : expired)
+    {
+        ::unlink(metaPath(id).c_str());
+        ::unlink(dataPath(id).c_str());
+    }
+    return expired.size();
+}
+
+std::shared_ptr<UploadSession> UploadSessionStore::create(int userId, const std::string &filename, uint64_t size, const std::string &sha256, uint64_t partSize)
+{
+    auto s = std::make_shared<UploadSession>();
+    s->id = RandomString(32);
+    s->userId = userId;
+    s->filename = filename;
+    s->size = size;
+    s->sha256 = sha256;
+    s->partSize = partSize;
+    s->parts.assign(s->partCount(), UploadSession::kPartMissing);
+    s->createdAt = s->updatedAt = static_cast<int64_t>(time(nullptr));
+    if (s->isMultipart())
+    {
+        // 分片直接 pwrite 到各自偏移，按总大小一次性预分配，完成时无需拼接
+        int fd = ::open(dataPath(s->id).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return nullptr;
+        bool ok = ::fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0;
+        if (!ok && (errno == EOPNOTSUPP || errno == ENOSYS))
+            ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+        ::close(fd);
+        if (!ok)
+        {
+            LOG_ERROR << "Preallocate upload session " << s->id << " failed, errno: " << errno;
+            ::unlink(dataPath(s->id).c_str());
+            return nullptr;
+        }
+    }
+    else
+    {
+        // 先创建空数据文件，HEAD 与重启恢复都以它的长度为偏移
+        std::ofstream(dataPath(s->id), std::ios::binary | std::ios::trunc);
+    }
+    if (!writeMeta(*s))
+    {
+        ::unlink(dataPath(s->id).c_str());
+        return nullptr;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    sessions_[s->id] = s;
+    return s;
+}
+
+std::shared_ptr<UploadSession> UploadSessionStore::get(const std::string &id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    return it == sessions_.end() ? nullptr : it->second;
+}
+
+UploadSessionStore::Admission UploadSessionStore::admitPatch(const std::shared_ptr<UploadSession> &s, uint64_t offset, uint64_t length)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (s->busy || s->activeParts > 0)
+        return kBusy;
+    if (offset != s->offset)
+        return kOffsetMismatch;
+    if (length > s->size - offset)
+        return kBadLength;
+    s->busy = true;
+    return kAdmitted;
+}
+
+UploadSessionStore::Admission UploadSessionStore::admitPart(const std::shared_ptr<UploadSession> &s, uint64_t index, uint64_t length)
+{
+    if (index >= s->partCount() || length != s->partLength(index))
+        return kBadLength;
+    return acquirePart(s, index) ? kAdmitted : kBusy;
+}
+
+UploadSessionStore::Admission UploadSessionStore::admitComplete(const std::shared_ptr<UploadSession> &s, std::vector<uint64_t> *missing)
+{
+    if (!acquire(s))
+        return kBusy;
+    // 分片已写在最终位置：校验全部分片已落盘且文件长度正确即可，无需拷贝拼接
+    *missing = missingParts(s);
+    if (!missing->empty() || FileSizeOrZero(dataPath(s->id)) != s->size)
+    {
+        release(s, s->offset);
+        return kIncomplete;
+    }
+    return kAdmitted;
+}
+
+bool UploadSessionStore::acquire(const std::shared_ptr<UploadSession> &s)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (s->busy || s->activeParts > 0)
+        return false;
+    s->busy = true;
+    return true;
+}
+
+bool UploadSessionStore::acquirePart(const std::shared_ptr<UploadSession> &s, uint64_t index)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (s->busy || index >= s->parts.size() || s->parts[index] == UploadSession::kPartWriting)
+        return false;
+    if (s->parts[index] == UploadSession::kPartDone) // 允许重传已完成的分片
+        s->offset -= s->partLength(index);
+    s->parts[index] = UploadSession::kPartWriting;
+    ++s->activeParts;
+    return true;
+}
+
+void UploadSessionStore::releasePart(const std::shared_ptr<UploadSession> &s, uint64_t index, bool done)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        s->parts[index] = done ? UploadSession::kPartDone : UploadSession::kPartMissing;
+        if (done)
+            s->offset += s->partLength(index);
+        --s->activeParts;
+        s->updatedAt = static_cast<int64_t>(time(nullptr));
+    }
+    if (done)
+        persist(s);
+}
+
+std::vector<uint64_t> UploadSessionStore::missingParts(const std::shared_ptr<UploadSession> &s)
+{
+    std::vector<uint64_t> out;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < s->parts.size(); ++i)
+        if (s->parts[i] != UploadSession::kPartDone)
+            out.push_back(i);
+    return out;
+}
+
+void UploadSessionStore::release(const std::shared_ptr<UploadSession> &s, uint64_t newOffset, bool keepBusy)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        s->offset = newOffset;
+        s->updatedAt = static_cast<int64_t>(time(nullptr));
+        s->busy = keepBusy;
+    }
+    persist(s);
+}
+
+void UploadSessionStore::remove(const std::string &id)
+{
+    std::unique_lock<std::mutex> plock(persistMutex_); // 避免与并发的 persist 交错导致元数据复活
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sessions_.erase(id);
+    }
+    ::unlink(metaPath(id).c_str());
+    ::unlink(dataPath(id).c_str());
+}
+
+void UploadSessionStore::persist(const std::shared_ptr<UploadSession> &s)
+{
+    // 多个分片可能在不同线程同时完成：串行写入，并在持锁时取快照，保证后写入的状态更新
+    std::unique_lock<std::mutex> plock(persistMutex_);
+    UploadSession snapshot;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (sessions_.find(s->id) == sessions_.end()) // 已被删除
+            return;
+        snapshot = *s;
+    }
+    writeMeta(snapshot);
+}
+
+bool UploadSessionStore::writeMeta(const UploadSession &s)
+{
+    json j = {{"id", s.id}, {"userId", s.userId}, {"filename", s.filename}, {"size", s.size},
+              {"sha256", s.sha256}, {"createdAt", s.createdAt}, {"updatedAt", s.updatedAt}};
+    if (s.isMultipart())
+    {
+        std::string parts(s.parts.size(), '0');
+        for (size_t i = 0; i < s.parts.size(); ++i)
+            if (s.parts[i] == UploadSession::kPartDone)
+                parts[i] = '1';
+        j["partSize"] = s.partSize;
+        j["parts"] = parts;
+    }
+    std::string path = metaPath(s.id);
+    std::string tmp = path + ".tmp";
+    std::string data = j.dump();
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && ::fsync(fd) == 0;
+    if (fd >= 0)
+        ::close(fd);
+    // 先落盘再 rename，崩溃后看到的要么是旧元数据要么是新元数据
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        LOG_ERROR << "Failed to persist upload session " << s.id << ", errno: " << errno;
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+ResumablePatchContext::~ResumablePatchContext()
+{
+    if (finished || !writer)
+        return;
+    if (part >= 0)
+    {
+        // 分片不完整，等已提交的写入结束后标记为缺失，由客户端整片重传
+        UploadSessionStore *s = store;
+        std::shared_ptr<UploadSession> sess = session;
+        uint64_t index = static_cast<uint64_t>(part);
+        writer->Sync([s, sess, index](bool) { s->releasePart(sess, index, false); });
+        return;
+    }
+    // 连接中断或请求出错：已收到的数据落盘后记为新偏移，客户端可从这里续传
+    uint64_t end = startOffset + writer->BytesAppended();
+    std::string path = store->dataPath(session->id);
+    UploadSessionStore *s = store;
+    std::shared_ptr<UploadSession> sess = session;
+    uint64_t start = startOffset;
+    writer->Sync([s, sess, path, start, end](bool ok) {
+        uint64_t offset = ok ? end : start;
+        ::truncate(path.c_str(), static_cast<off_t>(offset)); // 丢弃未确认落盘的尾部
+        s->release(sess, offset);
+    });
+}
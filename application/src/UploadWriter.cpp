@@ -0,0 +1,381 @@
+#include "UploadWriter.h"
+#include "Logger.h"
+#include <map>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <linux/falloc.h>
+
+// rename 只有在所在目录落盘后才能在掉电后保留
+static bool SyncParentDir(const std::string &path)
+{
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+DiskIoThread::DiskIoThread(size_t maxQueueDepth)
+    : maxDepth_(maxQueueDepth == 0 ? 1 : maxQueueDepth), depth_(0), running_(true)
+{
+    thread_ = std::thread(std::bind(&DiskIoThread::ThreadFunc, this));
+}
+
+DiskIoThread::~DiskIoThread()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join(); // 退出前执行完剩余任务
+}
+
+DiskIoThread *DiskIoThread::ForPath(const std::string &path)
+{
+    static std::mutex mutex;
+    static std::map<dev_t, std::unique_ptr<DiskIoThread>> threads;
+    struct stat st;
+    dev_t dev = 0;
+    if (::stat(path.c_str(), &st) == 0)
+        dev = st.st_dev;
+    std::unique_lock<std::mutex> lock(mutex);
+    std::unique_ptr<DiskIoThread> &io = threads[dev];
+    if (!io)
+        io.reset(new DiskIoThread());
+    return io.get();
+}
+
+DiskIoThread *DiskIoThread::HashWorker()
+{
+    static std::vector<std::unique_ptr<DiskIoThread>> workers = []() {
+        // 开启 SHA-NI 时单核已可跟上一块磁盘的写入速度，线程数不必随核数增长
+        unsigned n = std::thread::hardware_concurrency() / 2;
+        n = std::max(1u, std::min(4u, n));
+        std::vector<std::unique_ptr<DiskIoThread>> v;
+        for (unsigned i = 0; i < n; ++i)
+            v.emplace_back(new DiskIoThread());
+        return v;
+    }();
+    static std::atomic<size_t> next(0);
+    return workers[next++ % workers.size()].get();
+}
+
+void DiskIoThread::Submit(std::function<void()> task)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        ++depth_;
+    }
+    cv_.notify_one();
+}
+
+bool DiskIoThread::Full() const
+{
+    return depth_.load() >= maxDepth_;
+}
+
+size_t DiskIoThread::QueueDepth() const
+{
+    return depth_.load();
+}
+
+void DiskIoThread::NotifyWhenDrained(std::function<void()> cb)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (depth_.load() > maxDepth_ / 2)
+        {
+            drainWaiters_.push_back(std::move(cb));
+            return;
+        }
+    }
+    cb(); // 已经回落，直接回调
+}
+
+void DiskIoThread::ThreadFunc()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (running_ && tasks_.empty())
+                cv_.wait(lock);
+            if (tasks_.empty())
+                break;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+
+        std::vector<std::function<void()>> waiters;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            --depth_;
+            if (!drainWaiters_.empty() && depth_.load() <= maxDepth_ / 2)
+                waiters.swap(drainWaiters_);
+        }
+        for (auto &cb : waiters)
+            cb();
+    }
+}
+
+UploadWriter::UploadWriter(DiskIoThread *io, const std::string &finalPath, const std::string &tmpPath)
+    : io_(io), finalPath_(finalPath), tmpPath_(tmpPath), fd_(-1), startOffset_(0), appended_(0), preallocated_(0),
+      current_{nullptr, 0}, failed_(false), finished_(false), hashIo_(nullptr) {}
+
+UploadWriter::~UploadWriter()
+{
+    // 所有任务都持有 shared_ptr，析构时 I/O 线程上已没有本对象的任务
+    if (fd_ >= 0)
+        ::close(fd_);
+    if (!finished_ && !tmpPath_.empty())
+        ::unlink(tmpPath_.c_str());
+    if (current_.data)
+        free(current_.data);
+    for (char *p : freeList_)
+        free(p);
+}
+
+bool UploadWriter::Open(uint64_t preallocate, uint64_t offset, bool truncate)
+{
+    const std::string &path = tmpPath_.empty() ? finalPath_ : tmpPath_;
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0)
+    {
+        LOG_ERROR << "UploadWriter open " << path << " failed, errno: " << errno;
+        failed_ = true;
+        return false;
+    }
+    startOffset_ = offset;
+    if (preallocate > 0)
+    {
+        // KEEP_SIZE 只分配磁盘块不改变文件长度，断点续传仍可用文件长度作为已写偏移
+        if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset), static_cast<off_t>(preallocate)) == 0)
+            preallocated_ = offset + preallocate;
+        else if (errno != EOPNOTSUPP && errno != ENOSYS)
+            LOG_WARN << "UploadWriter fallocate " << path << " failed, errno: " << errno;
+    }
+    return true;
+}
+
+void UploadWriter::EnableHash(DiskIoThread *hashThread)
+{
+    hashIo_ = hashThread;
+    hasher_.Reset();
+}
+
+void UploadWriter::NotifyWhenDrained(std::function<void()> cb)
+{
+    DiskIoThread *hash = hashIo_;
+    io_->NotifyWhenDrained([hash, cb]() {
+        if (hash)
+            hash->NotifyWhenDrained(cb);
+        else
+            cb();
+    });
+}
+
+UploadWriter::AlignedBuffer UploadWriter::AcquireBuffer()
+{
+    {
+        std::unique_lock<std::mutex> lock(freeMutex_);
+        if (!freeList_.empty())
+        {
+            char *p = freeList_.back();
+            freeList_.pop_back();
+            return AlignedBuffer{p, 0};
+        }
+    }
+    void *p = nullptr;
+    if (posix_memalign(&p, kAlignment, kBufferSize) != 0)
+        p = nullptr;
+    return AlignedBuffer{static_cast<char *>(p), 0};
+}
+
+void UploadWriter::ReleaseBuffer(char *data)
+{
+    std::unique_lock<std::mutex> lock(freeMutex_);
+    if (freeList_.size() < 8)
+        freeList_.push_back(data);
+    else
+        free(data);
+}
+
+void UploadWriter::Append(const char *data, size_t len)
+{
+    if (finished_ || fd_ < 0)
+        return;
+    while (len > 0)
+    {
+        if (!current_.data)
+        {
+            current_ = AcquireBuffer();
+            if (!current_.data)
+            {
+                failed_ = true;
+                return;
+            }
+        }
+        size_t n = std::min(len, kBufferSize - current_.len);
+        memcpy(current_.data + current_.len, data, n);
+        current_.len += n;
+        data += n;
+        len -= n;
+        appended_ += n;
+        if (current_.len == kBufferSize)
+            Flush();
+    }
+}
+
+void UploadWriter::Flush()
+{
+    if (!current_.data)
+        return;
+    if (current_.len == 0)
+        return;
+    auto self = shared_from_this();
+    AlignedBuffer buf = current_;
+    uint64_t offset = startOffset_ + appended_ - buf.len;
+    current_ = AlignedBuffer{nullptr, 0};
+    if (!hashIo_)
+    {
+        io_->Submit([self, buf, offset]() {
+            self->WriteBuffer(buf, offset);
+            self->ReleaseBuffer(buf.data);
+        });
+        return;
+    }
+    // 写盘与摘要并行读同一缓冲区
+    auto refs = std::make_shared<std::atomic<int>>(2);
+    hashIo_->Submit([self, buf, refs]() {
+        self->hasher_.Update(buf.data, buf.len);
+        self->UnrefBuffer(buf.data, refs);
+    });
+    io_->Submit([self, buf, offset, refs]() {
+        self->WriteBuffer(buf, offset);
+        self->UnrefBuffer(buf.data, refs);
+    });
+}
+
+void UploadWriter::UnrefBuffer(char *data, const std::shared_ptr<std::atomic<int>> &refs)
+{
+    if (--*refs == 0)
+        ReleaseBuffer(data);
+}
+
+void UploadWriter::WriteBuffer(AlignedBuffer buf, uint64_t offset)
+{
+    size_t written = 0;
+    while (!failed_ && written < buf.len)
+    {
+        ssize_t n = ::pwrite(fd_, buf.data + written, buf.len - written, static_cast<off_t>(offset + written));
+        if (n > 0)
+        {
+            written += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        LOG_ERROR << "UploadWriter pwrite " << finalPath_ << " failed, errno: " << errno;
+        failed_ = true;
+    }
+}
+
+void UploadWriter::Sync(DoneCallback done)
+{
+    Flush();
+    auto self = shared_from_this();
+    io_->Submit([self, done]() {
+        bool ok = !self->failed_ && ::fdatasync(self->fd_) == 0;
+        if (done)
+            done(ok);
+    });
+}
+
+void UploadWriter::Commit(DoneCallback done)
+{
+    if (finished_)
+        return;
+    Flush();
+    finished_ = true;
+    auto self = shared_from_this();
+    if (hashIo_)
+    {
+        // 摘要排在所有数据之后完成；写盘提交与摘要都结束后才回调
+        auto pending = std::make_shared<std::atomic<int>>(2);
+        auto result = std::make_shared<std::atomic<bool>>(true);
+        DoneCallback userDone = done;
+        done = [pending, result, userDone](bool ok) {
+            if (!ok)
+                result->store(false);
+            if (--*pending == 0 && userDone)
+                userDone(result->load());
+        };
+        hashIo_->Submit([self, done]() {
+            self->digest_ = self->hasher_.HexDigest();
+            done(true);
+        });
+    }
+    io_->Submit([self, done]() {
+        bool ok = !self->failed_ && self->fd_ >= 0;
+        uint64_t end = self->startOffset_ + self->appended_;
+        if (ok && self->preallocated_ > end && ::ftruncate(self->fd_, static_cast<off_t>(end)) != 0) // 释放多预分配的块
+            ok = false;
+        if (ok && ::fdatasync(self->fd_) != 0)
+            ok = false;
+        if (self->fd_ >= 0)
+        {
+            ::close(self->fd_);
+            self->fd_ = -1;
+        }
+        if (!self->tmpPath_.empty())
+        {
+            if (ok && ::rename(self->tmpPath_.c_str(), self->finalPath_.c_str()) != 0)
+                ok = false;
+            if (ok && !SyncParentDir(self->finalPath_))
+                ok = false;
+            if (!ok)
+                ::unlink(self->tmpPath_.c_str());
+        }
+        if (!ok)
+            LOG_ERROR << "UploadWriter commit " << self->finalPath_ << " failed, errno: " << errno;
+        if (done)
+            done(ok);
+    });
+}
+
+void UploadWriter::Abort()
+{
+    if (finished_)
+        return;
+    finished_ = true;
+    if (current_.data)
+    {
+        free(current_.data);
+        current_ = AlignedBuffer{nullptr, 0};
+    }
+    auto self = shared_from_this();
+    io_->Submit([self]() {
+        if (self->fd_ >= 0)
+        {
+            ::close(self->fd_);
+            self->fd_ = -1;
+        }
+        // 直接写目标文件时（断点续传的数据文件）保留已写入的数据，只删除临时文件
+        if (!self->tmpPath_.empty())
+            ::unlink(self->tmpPath_.c_str());
+    });
+}
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <memory>
 #include <nlohmann/json.hpp>
-#include "Db.h"
+#include "DbPool.h"
+#include "SessionCache.h"
+#include "SessionTokens.h"
 #include "Util.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
@@ -12,10 +15,11 @@
 using json = nlohmann::json;
 
 // 负责用户注册/登录/登出与会话校验
+// 会话有两种：sessions 表中的随机 ID（默认），或载入签名密钥后签发的无状态令牌（见 SessionTokens）；两种可同时校验
 class AuthHandler
 {
 public:
-    explicit AuthHandler(Db &db) : db_(db) {}
+    explicit AuthHandler(DbPool &db) : db_(db) {}
     ~AuthHandler() = default;
 
     // 处理 HTTP 路由
@@ -27,8 +31,19 @@ public:
     bool validateSession(const std::string &sessionId, int &userId, std::string &username); // 验证会话，获取用户ID和用户名
     void endSession(const std::string &sessionId);                                          // 结束会话
 
+    // 后台刷新会话缓存中即将到期的常用会话，返回刷新数；可能阻塞，在执行器线程上调用
+    size_t refreshSessions(size_t limit = 1000);
+    SessionCache &sessionCache() { return sessions_; }
+
+    // 从 revoked_tokens 表增量同步其他节点登出的令牌，并清理已到期的撤销记录；可能阻塞，在执行器线程上调用
+    size_t syncRevokedTokens();
+    SessionTokens &sessionTokens() { return tokens_; }
+
 private:
-    Db &db_;
+    DbPool &db_;
+    SessionCache sessions_; // validateSession 命中时不查库
+    SessionTokens tokens_;  // 有签发密钥时登录签发令牌
+    std::atomic<int64_t> revokedSyncedAt_{0}; // 上次同步时数据库的 UNIX_TIMESTAMP()
 
     std::string generateSessionId();                                                         // 生成会话 ID
     void saveSession(const std::string &sessionId, int userId, const std::string &username); // 保存会话
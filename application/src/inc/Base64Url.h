@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+// 无填充的 base64url（RFC 4648 §5）：会话令牌与文件列表游标使用，结果可直接放进 URL 与请求头
+std::string EncodeBase64Url(const void *data, size_t len);
+// 解码到调用方的缓冲（不分配内存）；非法字符、长度、末尾多余的位不为 0 或超出 cap 时返回 false
+bool DecodeBase64Url(const char *s, size_t len, char *out, size_t cap, size_t *outLen);
+bool DecodeBase64Url(const std::string &s, std::string *out);
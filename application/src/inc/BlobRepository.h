@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "DbPool.h"
+
+// blobs 表：内容摘要 -> 大小与引用计数
+class BlobsRepository
+{
+public:
+    explicit BlobsRepository(DbPool &db) : db_(db) {}
+
+    bool addRef(const std::string &hash, uint64_t size) // 新内容插入记录，已存在则引用 +1
+    {
+        DbPool::Stmt st = db_.prepare("INSERT INTO blobs (hash, size, ref_count) VALUES (?, ?, 1) ON DUPLICATE KEY UPDATE ref_count = ref_count + 1");
+        return st && st->execute(hash, size);
+    }
+
+    bool addRefIfExists(const std::string &hash, uint64_t size) // 秒传：内容已存在且大小一致时引用 +1
+    {
+        DbPool::Stmt st = db_.prepare("UPDATE blobs SET ref_count = ref_count + 1 WHERE hash = ? AND size = ?");
+        return st && st->execute(hash, size) && st->affectedRows() == 1;
+    }
+
+    bool release(const std::string &hash) // 引用 -1，归零的记录由回收任务稍后清理
+    {
+        DbPool::Stmt st = db_.prepare("UPDATE blobs SET ref_count = ref_count - 1 WHERE hash = ? AND ref_count > 0");
+        return st && st->execute(hash);
+    }
+
+    std::vector<std::string> listUnreferenced(int graceSeconds, int limit) // 引用为 0 且超过宽限期的内容
+    {
+        std::vector<std::string> out;
+        DbPool::Stmt st = db_.prepare("SELECT hash FROM blobs WHERE ref_count = 0 AND updated_at < NOW() - INTERVAL ? SECOND LIMIT ?");
+        if (!st || !st->query(graceSeconds, limit))
+            return out;
+        while (st->fetch())
+            if (!st->isNull(0))
+                out.push_back(st->getString(0));
+        return out;
+    }
+
+    bool removeIfUnreferenced(const std::string &hash) // 仍为 0 引用时删除记录，返回是否删除
+    {
+        DbPool::Stmt st = db_.prepare("DELETE FROM blobs WHERE hash = ? AND ref_count = 0");
+        return st && st->execute(hash) && st->affectedRows() == 1;
+    }
+
+private:
+    DbPool &db_;
+};
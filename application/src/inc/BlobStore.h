@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+#include "Macro.h"
+
+struct CachedFile;
+class FdCache;
+
+// 文件存储接口：FileHandler / ShareHandler 只通过它解析磁盘路径，不关心目录布局
+// 内容文件以 SHA-256 为键，相同内容只保存一份，引用计数记录在数据库 blobs 表；
+// legacy 文件是引入内容寻址前按服务端文件名保存的上传（files.content_hash 为空）
+class BlobStore
+{
+public:
+    DISALLOW_COPY_AND_MOVE(BlobStore);
+    BlobStore() = default;
+    virtual ~BlobStore() = default;
+
+    // 定位文件并取大小（一次 stat）；hash 为空时按 legacy 文件名查找，不存在返回 false
+    virtual bool Resolve(const std::string &serverFilename, const std::string &hash, std::string *path, uint64_t *size) const = 0;
+    virtual bool Exists(const std::string &hash) const = 0;
+    // 打开文件用于下载，路径同 Resolve；不存在返回 nullptr
+    virtual std::shared_ptr<const CachedFile> Open(const std::string &serverFilename, const std::string &hash) const = 0;
+
+    // 把已写好的文件移入存储；内容已存在时直接删除 src。调用前应先增加引用计数，避免与回收交错
+    virtual bool Adopt(const std::string &srcPath, const std::string &hash) = 0;
+    virtual bool RemoveLegacy(const std::string &serverFilename) = 0; // 删除 legacy 文件
+
+    // 惰性回收：先把文件移到回收目录，再删除数据库中引用为 0 的记录
+    // 记录删除成功则 FinishCollect(hash, true) 删除文件，否则（期间被重新引用）移回原处
+    virtual bool BeginCollect(const std::string &hash) = 0;
+    virtual void FinishCollect(const std::string &hash, bool unreferenced) = 0;
+};
+
+// 扇出目录布局：内容文件为 root/ab/cd/<hash>，legacy 文件按文件名摘要放在 legacyDir/ab/cd/<name>
+// 单个目录的文件数降到约总数 / 65536；旧的平铺文件在新路径不存在时仍可访问，由 LayoutMigrator 在线迁移
+class ShardedBlobStore : public BlobStore
+{
+public:
+    ShardedBlobStore(const std::string &root, const std::string &legacyDir);
+
+    // 下载经 fd 缓存打开文件；删除与回收时同步失效
+    void SetFdCache(FdCache *cache) { cache_ = cache; }
+
+    bool Resolve(const std::string &serverFilename, const std::string &hash, std::string *path, uint64_t *size) const override;
+    bool Exists(const std::string &hash) const override;
+    std::shared_ptr<const CachedFile> Open(const std::string &serverFilename, const std::string &hash) const override;
+    bool Adopt(const std::string &srcPath, const std::string &hash) override;
+    bool RemoveLegacy(const std::string &serverFilename) override;
+    bool BeginCollect(const std::string &hash) override;
+    void FinishCollect(const std::string &hash, bool unreferenced) override;
+
+    std::string BlobPath(const std::string &hash) const;           // 内容文件路径
+    std::string LegacyPath(const std::string &serverFilename) const; // legacy 文件路径
+    std::string FlatBlobPath(const std::string &hash) const { return root_ + "/" + hash; }
+    std::string FlatLegacyPath(const std::string &serverFilename) const { return legacyDir_ + "/" + serverFilename; }
+    const std::string &Root() const { return root_; }
+    const std::string &LegacyDir() const { return legacyDir_; }
+
+    static std::string ShardOf(const std::string &key); // "ab/cd"，取自 key 的 SHA-256
+    static bool MoveInto(const std::string &src, const std::string &dst); // rename，目标分片目录不存在时创建
+
+private:
+    std::string TrashPathFor(const std::string &hash) const;
+    void InvalidateCached(const std::string &sharded, const std::string &flat);
+
+    std::string root_;
+    std::string legacyDir_;
+    FdCache *cache_ = nullptr;
+};
+
+// 在线迁移：把平铺布局下的文件分批并行移入扇出目录，服务运行期间可执行
+// 只移动 root 下的内容文件与 legacyDir 下的普通文件（跳过隐藏文件、.json/.part/.tmp）
+class LayoutMigrator
+{
+public:
+    struct Stats
+    {
+        size_t moved = 0;   // 已迁移
+        size_t skipped = 0; // 目标已存在（重复内容已删除平铺副本）
+        size_t failed = 0;  // rename 失败
+    };
+
+    explicit LayoutMigrator(ShardedBlobStore &store) : store_(store) {}
+    Stats Run(int threads = 4, size_t batchSize = 1024);
+
+private:
+    ShardedBlobStore &store_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Macro.h"
+#include "Metrics.h"
+
+// 固定大小的连接池：N 个连接各由借到它的线程独占使用，Acquire 借出、Lease 析构时归还
+// 线程亲和：每个线程记住上次借到的槽位，下次先对它做一次 CAS；线程数不超过连接数时，各线程总是拿回自己的连接，借还都不加锁
+// 亲和槽位被占用时依次尝试其他槽位，全部占用才在条件变量上等待，超时返回空的 Lease
+// 断开的连接在借出时重连，失败后按指数退避，退避期内照常借出（语句快速失败）；HealthCheck 对空闲连接探活
+// 子类实现具体连接（见 DbPool）；与连接库无关，测试与基准用模拟连接
+// 指标：connection_pool_acquire_wait_seconds、connection_pool_in_use、connection_pool_acquire_timeouts_total、connection_pool_reconnects_total，标签 pool=name
+class ConnectionPool
+{
+public:
+    // 借到的槽位，析构时归还；空的 Lease 表示等待超时
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept : pool_(other.pool_), index_(other.index_) { other.pool_ = nullptr; }
+        Lease &operator=(Lease &&other) noexcept;
+        ~Lease() { Release(); }
+
+        explicit operator bool() const { return pool_ != nullptr; }
+        size_t Index() const { return index_; }
+        void Release();
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool *pool, size_t index) : pool_(pool), index_(index) {}
+        ConnectionPool *pool_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    struct Stats
+    {
+        size_t size = 0;
+        size_t inUse = 0;
+        size_t connected = 0;   // 最近一次归还或探活时处于连接状态的槽位数
+        uint64_t timeouts = 0;  // 等待超时的 Acquire
+        uint64_t reconnects = 0;
+        uint64_t reconnectFailures = 0;
+    };
+
+    DISALLOW_COPY_AND_MOVE(ConnectionPool);
+    ConnectionPool(const std::string &name, size_t size);
+    virtual ~ConnectionPool() = default;
+
+    Lease Acquire(int timeoutMs = 3000);
+    size_t HealthCheck(); // 对空闲连接探活，断开的重连（不受退避限制）；返回探活后可用的连接数
+    size_t ConnectAll();  // 依次建立所有连接，返回成功数；在使用之前调用
+
+    // 重连失败后的退避时间：从 minMs 起每次翻倍，最多 maxMs
+    void SetReconnectBackoff(int minMs, int maxMs);
+    size_t Size() const { return slots_.size(); }
+    Stats GetStats() const;
+
+protected:
+    // 以下由持有该槽位的线程调用（借出期间或 ConnectAll/HealthCheck 内）
+    virtual bool Connect(size_t index) = 0; // 建立（或重新建立）第 index 个连接
+    virtual bool Ping(size_t index) = 0;    // 探活；失败时应断开，使 IsConnected 返回 false
+    virtual bool IsConnected(size_t index) const = 0;
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<bool> busy{false};
+        std::atomic<bool> connected{false};
+        int64_t retryAt = 0; // 以下只由持有该槽位的线程读写
+        int64_t backoff = 0;
+    };
+
+    bool TryTake(size_t index);
+    bool TakeAny(size_t *index);
+    void Revive(size_t index, bool force);
+    void Return(size_t index); // 记录连接状态，清除占用标记，唤醒等待者
+
+    const std::string name_;
+    std::vector<Slot> slots_;
+    std::atomic<size_t> next_{0}; // 没有亲和槽位的线程从这里开始找，分散到不同槽位
+    std::atomic<int> waiters_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int64_t minBackoff_ = 1000000000LL;
+    int64_t maxBackoff_ = 30000000000LL;
+
+    Metrics::Histogram wait_;
+    Metrics::Gauge inUse_;
+    Metrics::Counter timeouts_;
+    Metrics::Counter reconnectsOk_;
+    Metrics::Counter reconnectsFailed_;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+#include "Macro.h"
+
+struct CachedFile;
+
+// 小文件内容缓存：热点文件（分享的图片、文档、静态资源）直接从内存回包，不再读盘
+// 条目是不可变的 shared_ptr<const std::string>，响应以 BUFFER_TYPE 引用它发送，不拷贝
+// 键为 (设备, inode, mtime, 大小)，文件被覆盖后键随之变化，旧内容不会再被命中，随后被淘汰
+// 淘汰用分段 LRU（试用段 / 保护段），准入用 TinyLFU：
+//   只访问过一次的文件不读入（直接 sendfile），预算已满时新文件的访问频率须高于被淘汰者才准入
+// 同一文件的并发未命中只读一次盘，其余请求等待这次读取的结果
+class ContentCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t loads = 0;      // 读盘次数
+        uint64_t rejections = 0; // 频率不足未准入
+        uint64_t evictions = 0;
+        size_t bytes = 0;
+        size_t entries = 0;
+        double HitRate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+    };
+
+    DISALLOW_COPY_AND_MOVE(ContentCache);
+    // budget 为缓存内容的总字节数上限，超过 maxEntryBytes 的文件不缓存
+    explicit ContentCache(size_t budget = 64 * 1024 * 1024, size_t maxEntryBytes = 1024 * 1024);
+
+    // 取文件内容，返回 nullptr 表示不缓存（过大、频率不足或读取失败），调用方直接发送文件
+    std::shared_ptr<const std::string> Get(const CachedFile &file);
+
+    Stats GetStats() const;
+    size_t Budget() const { return budget_; }
+
+private:
+    struct Key
+    {
+        dev_t dev;
+        ino_t ino;
+        int64_t mtimeNs;
+        uint64_t size;
+        bool operator==(const Key &o) const { return dev == o.dev && ino == o.ino && mtimeNs == o.mtimeNs && size == o.size; }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key &k) const;
+    };
+    struct Entry
+    {
+        Key key;
+        uint64_t hash;
+        std::shared_ptr<const std::string> data;
+        bool protectedSeg; // 是否在保护段
+    };
+    typedef std::shared_ptr<const std::string> Data;
+
+    // 计数最小草图（4 行 4 位计数器），估计近期访问频率；累计访问达到采样数后全部减半，让旧热度衰减
+    class FrequencySketch
+    {
+    public:
+        explicit FrequencySketch(size_t width);
+        void Increment(uint64_t hash);
+        int Estimate(uint64_t hash) const;
+
+    private:
+        size_t Index(uint64_t hash, int row) const;
+        std::vector<uint8_t> table_; // 每行 width 个计数器
+        size_t width_;
+        size_t additions_ = 0;
+        size_t sampleSize_;
+    };
+
+    bool Admit(uint64_t hash, size_t size) const;
+    void Insert(const Key &key, uint64_t hash, const Data &data);
+    void Touch(std::list<Entry>::iterator it);
+    void EvictTo(size_t limit);
+    static Data Load(const CachedFile &file);
+
+    const size_t budget_;
+    const size_t maxEntryBytes_;
+    const size_t protectedBudget_; // 保护段上限（预算的 80%）
+
+    mutable std::mutex mutex_;
+    std::list<Entry> probation_; // 试用段，头部最近使用
+    std::list<Entry> protected_; // 保护段：试用段中再次命中的条目
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    size_t probationBytes_ = 0;
+    size_t protectedBytes_ = 0;
+    FrequencySketch sketch_;
+    std::unordered_map<Key, std::shared_future<Data>, KeyHash> loading_; // 正在读盘的文件
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> loads_{0};
+    std::atomic<uint64_t> rejections_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
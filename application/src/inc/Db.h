@@ -1,9 +1,20 @@
 #pragma once
 
-// 数据库配置类
+// 一个 MySQL 连接；由 DbPool 借给线程独占使用，各调用仍持锁串行执行
+// 连接断开（服务端关闭、超时）后 isConnected 返回 false，再次 connect 时关闭旧句柄与其上的预处理语句并重新建立
+// prepare 按 SQL 文本缓存本连接上的预处理语句（见 Statement）
+// insertId/affectedRows 返回调用线程最近一次 exec/query 的结果，与语句在哪个连接上执行无关
+// 每条语句的执行时间按调用它的函数（仓储方法）记入 db_query_duration_seconds{method}，不含等锁时间
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <source_location>
 #include <string>
+#include <unordered_map>
 #include <mysql/mysql.h>
+#include "Metrics.h"
+#include "Statement.h"
 
 class Db
 {
@@ -11,17 +22,33 @@ public:
     Db(const std::string &host, const std::string &user, const std::string &password, const std::string &dbname, unsigned int port);
     ~Db();
 
-    bool connect();                           // 建立连接
-    bool exec(const std::string &sql);        // 执行 SQL 语句
-    MYSQL_RES *query(const std::string &sql); // 执行SQL语句并返回结果集
+    bool connect();                           // 建立连接；已连接时直接返回 true
+    bool ping();                              // 探活
+    bool exec(const std::string &sql, std::source_location loc = std::source_location::current());        // 执行 SQL 语句
+    MYSQL_RES *query(const std::string &sql, std::source_location loc = std::source_location::current()); // 执行SQL语句并返回结果集
     std::string escape(const std::string &s); // 转义字符串
+    // 取本连接上已准备的语句，首次使用时准备；失败返回 nullptr。执行时间记入调用 prepare 的函数
+    Statement *prepare(const std::string &sql, std::source_location loc = std::source_location::current());
 
-    unsigned long long insertId() const; // 最近一次插入的自增ID
+    // 按 utf8 转义，不需要连接：与 mysql_real_escape_string 在 utf8/utf8mb4 下的结果相同（多字节字符中不含 ASCII 字节）
+    static std::string escapeUtf8(const std::string &s);
+    static unsigned long long insertId();     // 本线程最近一次插入的自增ID
+    static unsigned long long affectedRows(); // 本线程最近一次 UPDATE/DELETE 影响的行数
 
-    bool isConnected() const { return mysql_ != nullptr; } // 是否已连接
+    bool isConnected() const { return mysql_ != nullptr && !lost_; } // 是否已连接
 
 private:
+    friend class Statement;
+    void markLost() { lost_ = true; } // 语句执行时发现连接已断开
+    bool execLocked(const std::string &sql); // 调用方持有 mutex_
+    void closeLocked();                      // 调用方持有 mutex_
+    const Metrics::Histogram &latencyLocked(const std::source_location &loc); // 调用方持有 mutex_
+
+    std::mutex mutex_;
+    std::map<const char *, Metrics::Histogram> latency_; // 调用点函数名 -> 直方图（函数名是静态字符串）
+    std::unordered_map<std::string, std::unique_ptr<Statement>> statements_; // SQL -> 本连接上的预处理语句
     MYSQL *mysql_;
+    bool lost_ = false; // 连接已断开，等待 connect 重建
     std::string host_;     // 主机
     std::string user_;     // 用户
     std::string password_; // 密码
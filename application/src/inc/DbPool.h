@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <source_location>
+#include <string>
+#include <vector>
+#include <mysql/mysql.h>
+#include "ConnectionPool.h"
+#include "Db.h"
+
+// MySQL 连接池：size 个 Db，借给线程独占使用（规则见 ConnectionPool），替代所有线程共用的单个连接
+// 大小取 sub-reactor 线程数 + 阻塞任务执行器线程数，每个可能访问数据库的线程都能拿回自己的连接
+// exec/query 每条语句借一个连接、执行完即归还：mysql_store_result 把结果集整个取到客户端，归还后仍可读取
+// 需要多条语句在同一连接上执行时用 Acquire 持有租约；仓储方法用 prepare 借连接并取其上缓存的预处理语句
+class DbPool : public ConnectionPool
+{
+public:
+    // 借到的连接，析构时归还；等待超时时为空
+    class Lease
+    {
+    public:
+        explicit operator bool() const { return static_cast<bool>(lease_); }
+        Db *operator->() const { return db_; }
+        Db &operator*() const { return *db_; }
+
+    private:
+        friend class DbPool;
+        Lease(ConnectionPool::Lease lease, Db *db) : lease_(std::move(lease)), db_(db) {}
+        ConnectionPool::Lease lease_;
+        Db *db_;
+    };
+
+    // 借到的连接上的预处理语句，析构时归还连接；借不到连接或准备失败时为空
+    class Stmt
+    {
+    public:
+        explicit operator bool() const { return stmt_ != nullptr; }
+        Statement *operator->() const { return stmt_; }
+        Statement &operator*() const { return *stmt_; }
+
+    private:
+        friend class DbPool;
+        Stmt(Lease lease, Statement *stmt) : lease_(std::move(lease)), stmt_(stmt) {}
+        Lease lease_;
+        Statement *stmt_;
+    };
+
+    DbPool(const std::string &host, const std::string &user, const std::string &password, const std::string &dbname, unsigned int port, size_t size);
+
+    Lease Acquire(int timeoutMs = 3000);
+    Stmt prepare(const std::string &sql, std::source_location loc = std::source_location::current());
+
+    bool exec(const std::string &sql, std::source_location loc = std::source_location::current());        // 借一个连接执行 SQL 语句
+    MYSQL_RES *query(const std::string &sql, std::source_location loc = std::source_location::current()); // 借一个连接执行并返回结果集
+    std::string escape(const std::string &s) { return Db::escapeUtf8(s); } // 连接均为 utf8，转义不必借连接
+    unsigned long long insertId() const { return Db::insertId(); }
+    unsigned long long affectedRows() const { return Db::affectedRows(); }
+
+protected:
+    bool Connect(size_t index) override { return conns_[index]->connect(); }
+    bool Ping(size_t index) override { return conns_[index]->ping(); }
+    bool IsConnected(size_t index) const override { return conns_[index]->isConnected(); }
+
+private:
+    std::vector<std::unique_ptr<Db>> conns_;
+};
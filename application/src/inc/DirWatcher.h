@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Macro.h"
+
+class EventLoop;
+class Channel;
+
+// 用 inotify 递归监视目录，在 loop 线程回调
+//   文件被修改、删除、移动：onChange(文件路径)
+//   事件队列溢出、子目录被创建/移入/移走：onReset()，监视范围内的任何文件都可能变了
+// 新建的子目录自动加入监视；DirWatcher 须在 loop 退出后析构
+class DirWatcher
+{
+public:
+    typedef std::function<void(const std::string &path)> ChangeCallback;
+    typedef std::function<void()> ResetCallback;
+
+    DISALLOW_COPY_AND_MOVE(DirWatcher);
+    DirWatcher(EventLoop *loop, ChangeCallback onChange, ResetCallback onReset);
+    ~DirWatcher();
+
+    // 在 loop 线程调用，dir 及其子目录都加入监视；失败返回 false
+    bool Watch(const std::string &dir);
+
+private:
+    void AddWatch(const std::string &dir);
+    void HandleInotify();
+
+    EventLoop *loop_;
+    ChangeCallback onChange_;
+    ResetCallback onReset_;
+    int inotifyFd_ = -1;
+    std::unique_ptr<Channel> channel_;
+    std::unordered_map<int, std::string> watches_; // wd -> 目录，只在 loop 线程访问
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+#include "Macro.h"
+
+class EventLoop;
+class DirWatcher;
+
+// 已打开的文件与 open 时的 stat 元数据
+// 以 shared_ptr 引用计数：被淘汰或失效后，正在 sendfile 的连接仍持有引用，发完才关闭 fd
+struct CachedFile
+{
+    DISALLOW_COPY_AND_MOVE(CachedFile);
+    CachedFile(int fd, uint64_t size, int64_t mtimeNs, ino_t ino, dev_t dev)
+        : fd(fd), size(size), mtimeNs(mtimeNs), ino(ino), dev(dev) {}
+    ~CachedFile();
+
+    const int fd;
+    const uint64_t size;
+    const int64_t mtimeNs; // 修改时间（纳秒）
+    const ino_t ino;
+    const dev_t dev;
+};
+
+// 按存储路径缓存打开的 fd 与 stat 信息，热点文件的下载免去每次的 stat + open
+// 分片 LRU，每片一把锁，总条目数有上限（fd 是稀缺资源）
+// 缓存不会自行发现文件变化：删除/覆盖文件的一方调用 Invalidate，静态目录等外部可修改的目录用 Watch（inotify）
+class FdCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;        // 需要 open 的查找
+        uint64_t evictions = 0;     // 超出容量被淘汰
+        uint64_t invalidations = 0; // 因删除/修改失效
+        size_t entries = 0;
+        double HitRate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+    };
+
+    DISALLOW_COPY_AND_MOVE(FdCache);
+    explicit FdCache(size_t capacity = 1024, size_t shards = 16);
+    ~FdCache();
+
+    // 只查缓存，未命中返回 nullptr（不计入 misses）
+    std::shared_ptr<const CachedFile> Get(const std::string &path);
+    // 未命中时 open + fstat 并放入缓存；不存在或不是普通文件返回 nullptr
+    std::shared_ptr<const CachedFile> Open(const std::string &path);
+    void Invalidate(const std::string &path);
+    void Clear();
+
+    // 用 inotify 监视目录（含子目录），其中文件被修改、删除、移动时失效对应条目
+    // 在 loop 线程调用；FdCache 须在 loop 退出后析构
+    bool Watch(EventLoop *loop, const std::string &dir);
+
+    Stats GetStats() const;
+
+    // 不经缓存打开文件
+    static std::shared_ptr<const CachedFile> OpenFile(const std::string &path);
+
+private:
+    typedef std::pair<std::string, std::shared_ptr<const CachedFile>> Entry;
+    struct Shard
+    {
+        std::mutex mutex;
+        std::list<Entry> lru; // 头部最近使用
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        uint64_t generation = 0; // 每次失效递增，防止 open 期间被删除的文件在失效后才放入缓存
+    };
+
+    Shard &ShardFor(const std::string &path);
+    std::shared_ptr<const CachedFile> Lookup(Shard &shard, const std::string &path);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shardCapacity_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> invalidations_{0};
+
+    std::unique_ptr<DirWatcher> watcher_;
+};
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <string>
-#include "Db.h"
+#include <functional>
+#include "DbPool.h"
 #include "AuthHandler.h"
 #include "FilenameMap.h"
 #include "HttpRequest.h"
@@ -10,14 +11,22 @@
 #include "FileRepository.h"
 #include "ShareRepository.h"
 #include "Connection.h"
+#include "FileUploadContext.h"
+#include "BlobRepository.h"
+#include "BlobStore.h"
+#include "ContentCache.h"
+#include "Coroutine.h"
 
 // 文件相关处理：先迁移 list/delete；后续再迁移 upload/download
 class FileHandler {
 public:
-    FileHandler(Db& db, AuthHandler& auth, FilenameMap& fmap, const std::string& uploadDir);
+    FileHandler(DbPool& db, AuthHandler& auth, FilenameMap& fmap, BlobStore& blobStore, ContentCache& contentCache, const std::string& uploadDir);
 
-    // 列出用户文件
-    bool handleListFiles(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+    // 查询数据库的协程使用的阻塞任务执行器；为空时在 loop 线程直接查询
+    void SetExecutor(BlockingExecutor* executor) { executor_ = executor; }
+
+    // 列出用户文件（协程：会话校验与查询在执行器上完成）
+    Task<HttpResponse> handleListFiles(std::shared_ptr<Connection> conn, HttpRequest& req);
 
     // 删除文件
     bool handleDelete(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
@@ -25,15 +34,46 @@ public:
     // 下载文件
     bool handleDownload(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
 
+    // 上传请求体到达前的预检：会话、Content-Type、单文件上限与上传目录剩余空间，失败时已填充错误响应
+    bool checkUpload(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+    // 单文件上传上限（字节），0 表示不限制
+    void SetMaxUploadBytes(uint64_t bytes) { maxUploadBytes_ = bytes; }
+
     // 上传文件
     bool handleUpload(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
 
+    // 秒传：客户端先提交摘要，内容已存在时直接登记，无需传输
+    bool handleInstantUpload(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 登记一份已在磁盘上的上传文件：移入内容存储并写入 files 表，失败返回 nullopt（文件未移动时仍在 path）
+    // 访问数据库，不在 loop 线程调用
+    std::optional<int> registerUpload(const std::string& path, const std::string& serverFilename, const std::string& originalFilename, uint64_t size, const std::string& sha256, int userId);
+
+    // 回收引用为 0 的内容（惰性 GC，由定时器驱动）
+    void collectBlobs(int graceSeconds = 3600);
+
+    // 上传收尾：work 在阻塞任务执行器上填充响应（入库等阻塞操作），再回到连接所属 loop 线程发送保存的延迟响应
+    // 可在任意线程调用；不受执行器队列上限限制，未设置执行器时在 loop 线程执行 work；连接已关闭时 work 照常执行，只丢弃响应
+    void finishBlocking(const std::weak_ptr<Connection>& conn, EventLoop* loop, const std::string& name, bool close, std::function<void(HttpResponse*)> work);
+
 private:
-    Db& db_;
+    // 根据会话创建上传上下文并记下用户，Content-Type 无效时填充错误响应并返回空
+    std::shared_ptr<FileUploadContext> newUploadContext(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp, int userId);
+    // 上传文件全部落盘后入库，结果填入 resp；在阻塞任务执行器上执行
+    void registerUploads(const FileUploadContext& uploadContext, bool committed, HttpResponse* resp);
+    // 上传暂存目录：写完后移入内容存储，不与待迁移的平铺文件混在一起
+    std::string incomingDir() const { return uploadDir_ + "/.incoming"; }
+
+    DbPool& db_;
     AuthHandler& auth_;
     FilenameMap& fmap_;
+    BlobStore& blobStore_;
+    ContentCache& contentCache_; // 热点小文件的内容
     std::string uploadDir_;
     FilesRepository filesRepo_;
     SharesRepository sharesRepo_; // 复用 Share 的判定逻辑与记录
+    BlobsRepository blobsRepo_;   // 内容引用计数
+    BlockingExecutor* executor_ = nullptr;
+    uint64_t maxUploadBytes_ = 0;
 };
 
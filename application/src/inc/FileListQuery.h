@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// GET /files 的分页查询（keyset 分页）：按列表类型与排序方式生成 SQL，编码/解码翻页游标
+// 游标记录上一页最后一行的排序键与文件 ID，下一页从其后开始，翻到多深都只扫描一页的索引范围，翻页期间增删文件不会重复或跳过
+// 同一个 SQL 同时取回每个文件的一条分享信息（LEFT JOIN，取 ID 最小的一条），不再逐行查询
+// 排序由 file_manager.sql 中的 (user_id, 排序列, id) 复合索引支撑
+class FileListQuery
+{
+public:
+    enum Type
+    {
+        kMine,   // 自己的文件
+        kShared, // 分享给自己的（指定用户或公开）他人文件
+        kAll,    // 两者合并
+    };
+
+    enum Sort
+    {
+        kNewest, // created_at 降序（默认）
+        kOldest,
+        kNameAsc, // original_filename
+        kNameDesc,
+        kLargest, // file_size
+        kSmallest,
+    };
+
+    static const int kDefaultLimit = 100;
+    static const int kMaxLimit = 500;
+
+    // 结果列：0 id, 1 filename, 2 original_filename, 3 file_size, 4 file_type, 5 created_at, 6 user_id,
+    // 7 share_type, 8 shared_with_id, 9 shared_with_username, 10 share_code, 11 extract_code, 12 expire_time
+    static const unsigned kShareColumn = 7;
+
+    struct Cursor
+    {
+        std::string key; // 排序列的值（文本形式）
+        int id = 0;
+    };
+
+    static bool ParseType(const std::string &s, Type *out); // ""/"my"、"shared"、"all"
+    static bool ParseSort(const std::string &s, Sort *out); // ""/"newest"、"oldest"、"name"、"name_desc"、"largest"、"smallest"
+    static bool ParseLimit(const std::string &s, int *out); // 空串取默认值，超过上限按上限
+    static const char *SortName(Sort sort);
+
+    static std::string EncodeCursor(Sort sort, const std::string &key, int id);
+    static bool DecodeCursor(const std::string &s, Sort sort, Cursor *out); // 排序方式与游标不符时返回 false
+    static unsigned KeyColumn(Sort sort);                                   // 排序键在结果列中的下标
+
+    // 参数依次为（LIMIT 取每页条数 + 1，多取的一行用于判断是否还有下一页）：
+    //   kMine:   user_id, [键, 键, id], limit
+    //   kShared: user_id, user_id, [键, 键, id], limit
+    //   kAll:    user_id, [键, 键, id], limit, user_id, user_id, [键, 键, id], limit, limit
+    static std::string Sql(Type type, Sort sort, bool withCursor);
+};
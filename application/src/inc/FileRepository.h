@@ -4,9 +4,8 @@
 #include <vector>
 #include <optional>
 #include <cstdint>
-#include <mysql/mysql.h>
-#include <optional>
-#include "Db.h"
+#include "DbPool.h"
+#include "FileListQuery.h"
 
 struct FileRow
 {
@@ -29,136 +28,86 @@ struct ShareInfoRow
     std::optional<std::string> expireTime;         // 过期时间
 };
 
+struct FilePage
+{
+    std::vector<FileRow> rows;
+    std::vector<std::optional<ShareInfoRow>> shares; // 与 rows 一一对应，只有自己的文件带分享信息
+    std::string nextCursor;                          // 下一页游标，为空表示已是最后一页
+};
+
 struct FileBasic
 {
     int id;                       // 文件ID
     std::string serverFilename;   // 服务器存储的文件名
     std::string originalFilename; // 原始文件名
     int ownerId;                  // 文件所有者ID
+    std::string contentHash;      // 内容摘要，为空表示旧文件（按 serverFilename 存放）
 };
 
 class FilesRepository
 {
 public:
-    explicit FilesRepository(Db &db) : db_(db) {}
+    explicit FilesRepository(DbPool &db) : db_(db) {}
 
-    std::vector<FileRow> listMyFiles(int userId) // 列出用户的文件
+    // 一页文件列表，分享信息在同一查询中取回（见 FileListQuery）；cursor 为空取第一页，查询失败返回 false
+    bool listFiles(int userId, FileListQuery::Type type, FileListQuery::Sort sort, const FileListQuery::Cursor *cursor, int limit, FilePage &page)
     {
-        std::vector<FileRow> out;
-        std::string q = "SELECT id, filename, original_filename, file_size, file_type, created_at FROM files WHERE user_id = " + std::to_string(userId);
-        if (MYSQL_RES *res = db_.query(q))
+        DbPool::Stmt st = db_.prepare(FileListQuery::Sql(type, sort, cursor != nullptr));
+        if (!st)
+            return false;
+        int fetch = limit + 1; // 多取一行判断是否还有下一页
+        bool ok = false;
+        switch (type)
         {
-            MYSQL_ROW row;
-            while ((row = mysql_fetch_row(res)))
-            {
-                FileRow fr;
-                fr.id = std::stoi(row[0]);
-                fr.filename = row[1] ? row[1] : "";
-                fr.originalFilename = row[2] ? row[2] : "";
-                fr.size = row[3] ? static_cast<uint64_t>(std::stoull(row[3])) : 0ULL;
-                fr.type = row[4] ? row[4] : "";
-                fr.createdAt = row[5] ? row[5] : "";
-                fr.isOwner = true; // 这里假设是所有者
-                out.push_back(std::move(fr));
-            }
-            mysql_free_result(res);
+        case FileListQuery::kMine:
+            ok = cursor ? st->query(userId, cursor->key, cursor->key, cursor->id, fetch) : st->query(userId, fetch);
+            break;
+        case FileListQuery::kShared:
+            ok = cursor ? st->query(userId, userId, cursor->key, cursor->key, cursor->id, fetch) : st->query(userId, userId, fetch);
+            break;
+        case FileListQuery::kAll:
+            ok = cursor ? st->query(userId, cursor->key, cursor->key, cursor->id, fetch, userId, userId, cursor->key, cursor->key, cursor->id, fetch, fetch)
+                        : st->query(userId, fetch, userId, userId, fetch, fetch);
+            break;
         }
-        return out;
-    }
-
-    std::vector<FileRow> listSharedFiles(int userId) // 列出共享给用户的文件
-    {
-        std::vector<FileRow> out;
-        std::string q = "SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, f.created_at "
-                        "FROM files f JOIN file_shares fs ON f.id = fs.file_id WHERE (fs.shared_with_id = " +
-                        std::to_string(userId) + " OR fs.share_type = 'public') AND f.user_id != " + std::to_string(userId);
-        if (MYSQL_RES *res = db_.query(q))
+        if (!ok)
+            return false;
+        std::string lastKey;
+        while (st->fetch())
         {
-            MYSQL_ROW row;
-            while ((row = mysql_fetch_row(res)))
+            if (static_cast<int>(page.rows.size()) == limit)
             {
-                FileRow fr;
-                fr.id = std::stoi(row[0]);
-                fr.filename = row[1] ? row[1] : "";
-                fr.originalFilename = row[2] ? row[2] : "";
-                fr.size = row[3] ? static_cast<uint64_t>(std::stoull(row[3])) : 0ULL;
-                fr.type = row[4] ? row[4] : "";
-                fr.createdAt = row[5] ? row[5] : "";
-                fr.isOwner = false; // 这里假设不是所有者
-                out.push_back(std::move(fr));
+                page.nextCursor = FileListQuery::EncodeCursor(sort, lastKey, page.rows.back().id);
+                break;
             }
-            mysql_free_result(res);
-        }
-        return out;
-    }
-
-    std::vector<FileRow> listAllFiles(int userId) // 列出所有文件（包括我的和共享的）
-    {
-        std::vector<FileRow> out;
-        std::string q =
-            "SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, f.created_at, CASE WHEN f.user_id = " + std::to_string(userId) + " THEN 1 ELSE 0 END as is_owner, u.username "
-            "FROM files f LEFT JOIN file_shares fs ON f.id = fs.file_id LEFT JOIN users u ON fs.shared_with_id = u.id "
-            "WHERE f.user_id = " + std::to_string(userId) + " OR fs.shared_with_id = " + std::to_string(userId) + " OR fs.share_type = 'public'";
-        if (MYSQL_RES *res = db_.query(q))
-        {
-            MYSQL_ROW row;
-            while ((row = mysql_fetch_row(res)))
+            FileRow fr = readFileRow(*st);
+            fr.isOwner = st->getInt(6) == userId;
+            std::optional<ShareInfoRow> share;
+            const unsigned c = FileListQuery::kShareColumn;
+            if (fr.isOwner && !st->isNull(c))
             {
-                FileRow fr;
-                fr.id = std::stoi(row[0]);
-                fr.filename = row[1] ? row[1] : "";
-                fr.originalFilename = row[2] ? row[2] : "";
-                fr.size = row[3] ? static_cast<uint64_t>(std::stoull(row[3])) : 0ULL;
-                fr.type = row[4] ? row[4] : "";
-                fr.createdAt = row[5] ? row[5] : "";
-                fr.isOwner = (row[6] && std::stoi(row[6]) == 1);
-                out.push_back(std::move(fr));
+                ShareInfoRow info{};
+                info.shareType = st->getString(c);
+                info.shareWithId = st->getOptionalInt(c + 1);
+                info.sharedWithUsername = st->getOptionalString(c + 2);
+                info.shareCode = st->getOptionalString(c + 3);
+                info.extractCode = st->getOptionalString(c + 4);
+                info.expireTime = st->getOptionalString(c + 5);
+                share = std::move(info);
             }
-            mysql_free_result(res);
-        }
-        return out;
-    }
-
-    std::optional<ShareInfoRow> getShareInfo(int fileId) // 获取文件的分享信息
-    {
-        std::string q =
-            "SELECT fs.share_type, fs.shared_with_id, u.username, fs.share_code, fs.extract_code, fs.expire_time "
-            "FROM file_shares fs LEFT JOIN users u ON fs.shared_with_id = u.id WHERE fs.file_id = " +
-            std::to_string(fileId) + " LIMIT 1";
-
-        ShareInfoRow info{};
-        MYSQL_RES *res = db_.query(q);
-        if (!res || mysql_num_rows(res) == 0)
-        {
-            if (res)
-                mysql_free_result(res);
-            return std::nullopt;
+            lastKey = st->getString(FileListQuery::KeyColumn(sort));
+            page.rows.push_back(std::move(fr));
+            page.shares.push_back(std::move(share));
         }
-
-        MYSQL_ROW row = mysql_fetch_row(res);
-        info.shareType = row[0] ? row[0] : "";
-        info.shareWithId = row[1] ? std::optional<int>(std::stoi(row[1])) : std::nullopt;
-        info.sharedWithUsername = row[2] ? std::optional<std::string>(row[2]) : std::nullopt;
-        info.shareCode = row[3] ? std::optional<std::string>(row[3]) : std::nullopt;
-        info.extractCode = row[4] ? std::optional<std::string>(row[4]) : std::nullopt;
-        info.expireTime = row[5] ? std::optional<std::string>(row[5]) : std::nullopt;
-        mysql_free_result(res);
-        return info;
+        return true;
     }
 
     std::optional<int> getOwnedFileIdByServerFilename(const std::string &serverFilename, int ownerId) // 根据服务器文件名和所有者ID获取文件ID
     {
-        std::string q = "SELECT id FROM files WHERE filename = '" + db_.escape(serverFilename) + "' AND user_id = " + std::to_string(ownerId) + " LIMIT 1";
-        MYSQL_RES *r = db_.query(q);
-        if (!r || mysql_num_rows(r) == 0)
-        {
-            if (r)
-                mysql_free_result(r);
+        DbPool::Stmt st = db_.prepare("SELECT id FROM files WHERE filename = ? AND user_id = ? LIMIT 1");
+        if (!st || !st->query(serverFilename, ownerId) || !st->fetch())
             return std::nullopt;
-        }
-        MYSQL_ROW row = mysql_fetch_row(r);
-        int id = row[0] ? std::stoi(row[0]) : 0;
-        mysql_free_result(r);
+        int id = st->getInt(0);
         if (id <= 0)
         {
             return std::nullopt;
@@ -168,21 +117,15 @@ public:
 
     std::optional<FileBasic> getByServerFilename(const std::string &serverFilename)     // 根据服务器文件名获取文件基本信息
     {
-        std::string q = "SELECT id, filename, original_filename, user_id FROM files WHERE filename='" + db_.escape(serverFilename) + "' LIMIT 1";
-        MYSQL_RES *r = db_.query(q);
-        if (!r || mysql_num_rows(r) == 0)
-        {
-            if (r)
-                mysql_free_result(r);
+        DbPool::Stmt st = db_.prepare("SELECT id, filename, original_filename, user_id, content_hash FROM files WHERE filename = ? LIMIT 1");
+        if (!st || !st->query(serverFilename) || !st->fetch())
             return std::nullopt;
-        }
-        MYSQL_ROW row = mysql_fetch_row(r);
         FileBasic f;
-        f.id = row[0] ? std::stoi(row[0]) : 0;
-        f.serverFilename = row[1] ? row[1] : "";
-        f.originalFilename = row[2] ? row[2] : "";
-        f.ownerId = row[3] ? std::stoi(row[3]) : 0;
-        mysql_free_result(r);
+        f.id = st->getInt(0);
+        f.serverFilename = st->getString(1);
+        f.originalFilename = st->getString(2);
+        f.ownerId = st->getInt(3);
+        f.contentHash = st->getString(4);
         if (f.id <= 0)
         {
             return std::nullopt;
@@ -190,26 +133,43 @@ public:
         return f;
     }
 
-    std::optional<int> createFile(const std::string &serverFilename, const std::string &originalFilename, uint64_t fileSize, const std::string& fileType, int userId)
+    // contentHash 非空表示内容保存在 BlobStore 中
+    std::optional<int> createFile(const std::string &serverFilename, const std::string &originalFilename, uint64_t fileSize, const std::string& fileType, int userId, const std::string &contentHash = "")
     {
-        std::string q = "INSERT INTO files (filename, original_filename, file_size, file_type, user_id) VALUES ('" +
-                        db_.escape(serverFilename) + "', '" + db_.escape(originalFilename) + "', " + std::to_string(fileSize) +
-                        ", '" + db_.escape(fileType) + "', " + std::to_string(userId) + ")";
-        if (!db_.exec(q))
+        DbPool::Stmt st = db_.prepare("INSERT INTO files (filename, original_filename, file_size, file_type, user_id, content_hash) VALUES (?, ?, ?, ?, ?, ?)");
+        std::optional<std::string> hash;
+        if (!contentHash.empty())
+            hash = contentHash;
+        if (!st || !st->execute(serverFilename, originalFilename, fileSize, fileType, userId, hash))
             return std::nullopt;
-        return static_cast<int>(db_.insertId());
+        return static_cast<int>(st->insertId());
     }
 
     bool deleteSharesByFileId(int fileId) // 删除文件的分享信息
     {
-        return db_.exec("DELETE FROM file_shares WHERE file_id = " + std::to_string(fileId));
+        DbPool::Stmt st = db_.prepare("DELETE FROM file_shares WHERE file_id = ?");
+        return st && st->execute(fileId);
     }
 
     bool deleteFileById(int fileId) // 根据文件ID删除文件
     {
-        return db_.exec("DELETE FROM files WHERE id = " + std::to_string(fileId));
+        DbPool::Stmt st = db_.prepare("DELETE FROM files WHERE id = ?");
+        return st && st->execute(fileId);
     }
 
 private:
-    Db &db_; // 数据库连接
-};
\ No newline at end of file
+    // 前 6 列：id, filename, original_filename, file_size, file_type, created_at
+    static FileRow readFileRow(const Statement &st)
+    {
+        FileRow fr;
+        fr.id = st.getInt(0);
+        fr.filename = st.getString(1);
+        fr.originalFilename = st.getString(2);
+        fr.size = st.getUInt64(3);
+        fr.type = st.getString(4);
+        fr.createdAt = st.getString(5);
+        return fr;
+    }
+
+    DbPool &db_; // 数据库连接
+};
@@ -1,43 +1,86 @@
 #pragma once
 
 #include <string>
+#include <map>
+#include <vector>
 #include <memory>
-#include <fstream>
+#include <mutex>
+#include <functional>
 #include <experimental/filesystem>
+#include "MultipartParser.h"
+#include "UploadWriter.h"
 
 namespace fs = std::experimental::filesystem;
 
-// 文件上传上下文
+// 文件上传上下文：流式解析 multipart 请求体，文件分段交给 UploadWriter 异步写盘并在摘要线程计算 SHA-256
 class FileUploadContext
 {
 public:
-    enum class State
+    struct UploadedFile
     {
-        kExpectHeaders,  // 等待头部
-        kExpectContent,  // 等待文件内容
-        kExpectBoundary, // 等待边界
-        kComplete        // 上传完成
+        std::string filename;         // 保存在服务器上的路径
+        std::string originalFilename; // 原始文件名
+        uintmax_t size;               // 文件大小
+        std::string sha256;           // 内容摘要（边接收边计算，提交完成后有效）
     };
 
-    FileUploadContext(const std::string &filename, const std::string &originalFilename);
+    static const size_t kMaxFieldBytes = 64 * 1024; // 普通字段累计上限
+
+    // preferredName 非空时作为第一个文件的原始文件名（对应 X-File-Name 头）
+    // contentLength 为请求体长度，用于文件预分配
+    FileUploadContext(const std::string &uploadDir, const std::string &boundary, const std::string &preferredName = "", uint64_t contentLength = 0);
     ~FileUploadContext();
 
+    bool feed(const char *data, size_t len); // 解析一段请求体，出错返回 false
     void writeData(const char *data, size_t len);
 
+    // 所有文件提交（fdatasync + rename）与摘要完成后回调，参数表示是否全部成功；在 I/O 或摘要线程执行
+    void whenCommitted(std::function<void(bool)> cb);
+    bool backpressured() const { return io_->Full() || hashIo_->Full(); } // 写盘或摘要队列已满
+    void notifyWhenDrained(std::function<void()> cb);                     // 两个队列都回落后回调
+
+    bool isComplete() const { return parser_.IsComplete(); }
+    const std::string &getError() const { return parser_.GetError(); }
     uintmax_t getTotalBytes() const { return totalBytes_; }
     const std::string &getFilename() const { return filename_; }
-    const std::string &getOriginalFilename() const { return originalFilename_; }
-
-    void setBoundary(const std::string &boundary) { boundary_ = boundary; }
-    const std::string &getBoundary() const { return boundary_; }
-    State getState() const { return state_; }
-    void setState(State state) { state_ = state; }
+    const std::vector<UploadedFile> &getFiles() const { return files_; }
+    const std::map<std::string, std::string> &getFields() const { return fields_; }
+    void setUserId(int userId) { userId_ = userId; } // 创建上下文时已校验的上传用户
+    int getUserId() const { return userId_; }
 
 private:
-    std::string filename_;         // 保存在服务器上的文件名
-    std::string originalFilename_; // 原始文件名
-    std::ofstream file_;           // 文件流对象
-    uintmax_t totalBytes_;         // 已写入的总字节数
-    State state_;                  // 当前状态
-    std::string boundary_;         // multipart边界
-};
\ No newline at end of file
+    // 各文件的提交进度，在 I/O / 摘要线程与 loop 线程间共享
+    struct CommitState
+    {
+        std::mutex mutex;
+        int pending = 0;                  // 尚未提交完成的文件数
+        bool ok = true;                   // 已完成的是否全部成功
+        std::vector<std::string> digests; // 按文件顺序的摘要
+        std::function<void(bool)> waiter; // whenCommitted 注册的回调
+    };
+
+    bool onPartBegin(const MultipartParser::Part &part);
+    bool onPartData(const char *data, size_t len);
+    bool onPartEnd();
+
+    std::string uploadDir_;                     // 上传目录
+    std::string preferredName_;                 // 客户端指定的文件名
+    uint64_t contentLength_;                    // 请求体长度
+    uint64_t consumed_;                         // 已喂给解析器的字节数
+    DiskIoThread *io_;                          // 上传目录所在磁盘的 I/O 线程
+    DiskIoThread *hashIo_;                      // 摘要线程
+    MultipartParser parser_;                    // multipart 解析器
+    std::string filename_;                      // 当前文件在服务器上的路径
+    std::string originalFilename_;              // 当前文件的原始文件名
+    std::shared_ptr<UploadWriter> writer_;      // 当前文件的写入器
+    std::shared_ptr<CommitState> commit_;       // 提交进度
+    uintmax_t fileBytes_;                       // 当前文件已写入字节数
+    uintmax_t totalBytes_;                      // 所有文件已写入的总字节数
+    std::string fieldName_;                     // 当前普通字段名
+    std::string fieldValue_;                    // 当前普通字段值
+    size_t fieldBytes_;                         // 普通字段累计字节数
+    bool inFile_;                               // 当前分段是否为文件
+    std::vector<UploadedFile> files_;           // 已完成的文件
+    std::map<std::string, std::string> fields_; // 普通字段
+    int userId_ = 0;                            // 上传用户
+};
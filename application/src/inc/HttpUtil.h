@@ -4,6 +4,9 @@
 #include <memory>
 #include "HttpResponse.h"
 #include "Connection.h"
+#include "RangeUtil.h"
+#include "FdCache.h"
+#include "ContentCache.h"
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
@@ -36,8 +39,12 @@ inline void sendError(HttpResponse* resp, const std::string &message, int code,
             case 401: resp->SetStatusMessage("Unauthorized"); break;
             case 403: resp->SetStatusMessage("Forbidden"); break;
             case 404: resp->SetStatusMessage("Not Found"); break;
+            case 413: resp->SetStatusMessage("Payload Too Large"); break;
             case 416: resp->SetStatusMessage("Range Not Satisfiable"); break;
+            case 429: resp->SetStatusMessage("Too Many Requests"); break;
             case 500: resp->SetStatusMessage("Internal Server Error"); break;
+            case 503: resp->SetStatusMessage("Service Unavailable"); break;
+            case 507: resp->SetStatusMessage("Insufficient Storage"); break;
             default: resp->SetStatusMessage("Error"); break;
         }
     } else {
@@ -47,8 +54,7 @@ inline void sendError(HttpResponse* resp, const std::string &message, int code,
     resp->SetBody(body);
     resp->SetBodyType(HTML_TYPE);
     resp->SetContentLength(static_cast<int>(body.size()));
-    resp->SetCloseConnection(true); // 保守：错误后关闭
-    if (conn) conn->setWriteCompleteCallback([](const std::shared_ptr<Connection>& c){ c->shutdown(); return true;});
+    // 请求已完整读入，错误响应不影响连接上的后续请求，是否关闭按客户端的 Connection 头决定
 }
 
 inline void sendJson(HttpResponse* resp, json &body, const std::shared_ptr<Connection> &conn, HttpStatusCode code = HttpStatusCode::OK) 
@@ -59,12 +65,35 @@ inline void sendJson(HttpResponse* resp, json &body, const std::shared_ptr<Conne
     resp->SetBody(body.dump());
     resp->SetBodyType(HTML_TYPE);
     resp->SetContentLength(static_cast<int>(body.dump().size()));
-    // 是否关闭连接由上层根据请求头决定；为兼容前端 fetch，这里也可选择保持连接
-    // 不强制添加 Connection: close 头，交由 HttpServer 根据 close_flag 决定
-    if (conn) conn->setWriteCompleteCallback([](const std::shared_ptr<Connection>& c){ c->shutdown(); return true;});
+    // 是否关闭连接由 HttpServer 根据请求的 Connection 头决定
 }
 
 
+// 文件下载响应：交给 HttpServer 按可写事件 sendfile 发送（零拷贝，只发 Range 指定的区间）
+// 发送期间连接持有 file 的引用，缓存淘汰不会关闭正在使用的 fd；热点小文件经 contentCache 直接从内存发送
+inline void sendFile(HttpResponse* resp, const std::shared_ptr<const CachedFile> &file, const HttpRange::RangeSpec &rs,
+                     const std::string &downloadName, const std::shared_ptr<Connection> &conn, ContentCache *contentCache = nullptr)
+{
+    if (rs.isRange) {
+        resp->SetStatusCode(HttpStatusCode::PartialContent);
+        resp->SetStatusMessage("Partial Content");
+        resp->SetContentRange(static_cast<long long>(rs.start), static_cast<long long>(rs.end), static_cast<long long>(file->size));
+    } else {
+        resp->SetStatusCode(HttpStatusCode::OK);
+        resp->SetStatusMessage("OK");
+    }
+    resp->SetContentType("application/octet-stream");
+    std::shared_ptr<const std::string> body = contentCache ? contentCache->Get(*file) : nullptr;
+    if (body) {
+        resp->SetSharedBody(body);
+    } else {
+        resp->SetBodyType(FILE_TYPE);
+        resp->SetSharedFile(file->fd, file);
+        resp->SetContentLength(static_cast<long long>(file->size));
+    }
+    resp->AddHeader("Content-Disposition", "attachment; filename=\"" + downloadName + "\"");
+    resp->AddHeader("Accept-Ranges", "bytes");
+}
 
 // inline void sendError(HttpResponse* resp, const std::string &message, int code, const std::shared_ptr<Connection> &conn) 
 // {
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <functional>
+#include <stdint.h>
+#include <stddef.h>
+
+// multipart/form-data 流式解析器
+// 使用 Boyer-Moore-Horspool 跳表查找 "\r\n--boundary"，分片之间只保留不超过分隔符长度的尾部数据，
+// 文件内容通过回调直接交给存储层，不在内存中累积整个请求体
+class MultipartParser
+{
+public:
+    struct Part
+    {
+        std::string name;                           // Content-Disposition 中的 name
+        std::string filename;                       // Content-Disposition 中的 filename，为空表示普通字段
+        std::string contentType;                    // 分段的 Content-Type
+        std::map<std::string, std::string> headers; // 分段头部，键为小写
+        bool isFile() const { return hasFilename; }
+        bool hasFilename = false;
+    };
+
+    // 回调返回 false 表示中止解析
+    typedef std::function<bool(const Part &)> PartBeginCallback;
+    typedef std::function<bool(const char *, size_t)> PartDataCallback;
+    typedef std::function<bool()> PartEndCallback;
+
+    enum class State
+    {
+        kPreamble,     // 第一个分隔符之前的内容，丢弃
+        kBoundaryTail, // 分隔符之后，等待 "\r\n" 或 "--"
+        kHeaders,      // 分段头部
+        kBody,         // 分段内容
+        kEpilogue,     // 结束分隔符之后的内容，丢弃
+        kError         // 解析出错
+    };
+
+    static const size_t kMaxHeaderBytes = 16 * 1024; // 单个分段头部的上限
+
+    explicit MultipartParser(const std::string &boundary); // boundary 不含前导 "--"
+
+    // 从 Content-Type 中取出 boundary 参数，失败返回空串
+    static std::string ExtractBoundary(const std::string &contentType);
+
+    void SetPartBeginCallback(const PartBeginCallback &cb) { onPartBegin_ = cb; }
+    void SetPartDataCallback(const PartDataCallback &cb) { onPartData_ = cb; }
+    void SetPartEndCallback(const PartEndCallback &cb) { onPartEnd_ = cb; }
+
+    // 喂入一段数据，出错返回 false；数据总是被全部消费
+    bool Feed(const char *data, size_t len);
+
+    bool IsComplete() const { return state_ == State::kEpilogue; }
+    bool HasError() const { return state_ == State::kError; }
+    const std::string &GetError() const { return error_; }
+    State GetState() const { return state_; }
+    size_t GetPartCount() const { return partCount_; }
+
+private:
+    size_t Search(const char *data, size_t len) const;        // BMH 查找分隔符，找不到返回 len
+    size_t PartialSuffix(const char *data, size_t len) const; // data 尾部可能是分隔符前缀的长度
+    bool ParseBody(const char *&p, const char *end);
+    bool ParseBoundaryTail(const char *&p, const char *end);
+    bool ParseHeaders(const char *&p, const char *end);
+    bool ParsePartHeaders();
+    bool EmitData(const char *data, size_t len);
+    bool OnDelimiter();
+    bool Fail(const std::string &msg);
+
+    std::string delimiter_; // "\r\n--" + boundary
+    size_t skip_[256];      // BMH 跳表
+    State state_;
+    std::string carry_;     // 上一分片末尾可能属于分隔符的字节
+    std::string headerBuf_; // 当前分段头部
+    std::string tail_;      // 分隔符后的 "--" / "\r\n"
+    Part part_;             // 当前分段
+    size_t partCount_;
+    std::string error_;
+
+    PartBeginCallback onPartBegin_;
+    PartDataCallback onPartData_;
+    PartEndCallback onPartEnd_;
+};
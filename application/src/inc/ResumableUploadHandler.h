@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include "AuthHandler.h"
+#include "FileHandler.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Connection.h"
+#include "UploadSessionStore.h"
+
+class EventLoop;
+
+// 断点续传上传（偏移协议）
+// POST /uploads 创建会话，PATCH /uploads/<id> 携带 Upload-Offset 追加数据，HEAD /uploads/<id> 查询已持久化偏移
+// 创建时指定 partSize 则为并行分片上传：多个连接并发 PUT 各分片，最后 POST /uploads/<id>/complete
+// 全部数据到达后文件转入上传目录并入库
+class ResumableUploadHandler {
+public:
+    ResumableUploadHandler(AuthHandler& auth, FileHandler& fileHandler, const std::string& uploadDir, int64_t sessionTtl = 24 * 3600);
+
+    // 在主 loop 上启动过期会话清理
+    void start(EventLoop* loop, double expiryInterval = 600.0);
+
+    // 创建上传会话
+    bool handleCreate(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 查询上传偏移
+    bool handleHead(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 追加数据（请求体按分片流式写盘）
+    bool handlePatch(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 并行分片上传：PUT /uploads/<id>/parts/<n> 写入第 n 片（各连接可并发）
+    bool handlePutPart(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 分片全部到达后校验并入库
+    bool handleComplete(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 取消上传
+    bool handleCancel(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 请求体到达前的预检：会话、归属与长度（只读会话中创建后不变的字段），失败时已填充错误响应
+    // 偏移与占用状态仍由 handlePatch/handlePutPart 在写盘前检查
+    bool checkPatch(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+    bool checkPart(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
+
+    // 是否为需要流式处理请求体的 PATCH/PUT 请求
+    static bool isStreamingRequest(const HttpRequest& req);
+
+private:
+    // 预检通过后把用户留在连接上下文中，请求体到达时不再校验会话
+    void keepPrecheckUser(const std::shared_ptr<Connection>& conn, int userId);
+    // 本次请求的用户：取预检留下的结果，没有预检时校验会话；失败时已填充错误响应
+    bool requestUser(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp, int& userId);
+    // 校验会话归属，失败时已填充错误响应
+    std::shared_ptr<UploadSession> ownedSession(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp, int userId);
+    // 请求体写盘，收完后异步 fdatasync 再回包
+    bool streamBody(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp, const std::shared_ptr<ResumablePatchContext>& patch);
+    // 本次 PATCH/分片数据落盘后更新偏移并回包，在连接所属 loop 线程执行
+    void finishPatch(const std::shared_ptr<Connection>& conn, const std::shared_ptr<ResumablePatchContext>& patch, bool synced);
+    // 全部数据到达（会话处于占用状态）：异步计算摘要，再在阻塞任务执行器上校验并入库，结果填入延迟响应
+    void startComplete(const std::shared_ptr<Connection>& conn, const std::shared_ptr<UploadSession>& session, bool close);
+    void finishComplete(const std::shared_ptr<UploadSession>& session, bool hashed, const std::string& sha256, HttpResponse* resp);
+
+    AuthHandler& auth_;
+    FileHandler& fileHandler_; // 入库走与普通上传相同的内容存储
+    UploadSessionStore store_;
+};
@@ -1,99 +1,143 @@
 #pragma once
+#include <functional>
+#include <memory>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <functional>
-#include <unordered_map>
 #include "HttpRequest.h"
 #include "HttpResponse.h"
 #include "Connection.h"
-#include "StaticHandler.h"
-#include "AuthHandler.h"
-#include "FileHandler.h"
-#include "ShareHandler.h"
-#include "UserHandler.h"
+#include "Coroutine.h"
+#include "HttpMetrics.h"
 
+class StaticHandler;
+class AuthHandler;
+class FileHandler;
+class ShareHandler;
+class UserHandler;
+class ResumableUploadHandler;
+class HttpServer;
+
+// 应用路由：注册时把路径编译进按段组织的前缀树，请求到来时逐段下降，不做正则匹配
+// 每个节点的静态子段有序存放（二分查找），参数段分为数字与任意非空两类，
+// 同一位置的优先级为 静态 > 数字参数 > 参数 > 通配剩余路径；叶子上按 HttpMethod 下标直接取处理器
+// addRouteRegex 只识别 ([^/]+)、([0-9]+) 与结尾的 (.*) 三种捕获，其余正则仍按注册顺序逐条匹配（在前缀树未命中之后）
+// 标记为 kBlocking 的路由（会查数据库的）经 HttpServer::RunBlocking 在工作线程执行，统计名为 "方法 路径模式"
+// 协程路由经 HttpServer::RunCoroutine 驱动，必须先 SetServer
+// 路由可挂请求体预检（setPreCheck），由 HttpServer 在请求体到达前调用，用于拒绝未登录或过大的上传
 class Router
 {
 public:
     using Handler = std::function<bool(const std::shared_ptr<Connection> &, HttpRequest &, HttpResponse *)>;
+    using CoroutineHandler = std::function<Task<HttpResponse>(std::shared_ptr<Connection>, HttpRequest &)>;
+    // 请求体预检：只有请求行与头部（路径参数已填好），返回 false 时 resp 为拒绝响应
+    using PreCheck = std::function<bool(const std::shared_ptr<Connection> &, HttpRequest &, HttpResponse *)>;
 
-    void addRouteExact(const std::string &path, HttpMethod method, Handler handler)
+    enum ExecMode
     {
-        std::string pattern = "^" + escapeRegex(path) + "$";
-        routes_.emplace_back(Route{std::regex(pattern), {}, std::move(handler), method});
-    }
+        kInline,  // 在 loop 线程直接执行
+        kBlocking // 交给阻塞任务执行器；处理器必须同步完成（返回 true）
+    };
+
+    Router();
+
+    void addRouteExact(const std::string &path, HttpMethod method, Handler handler, ExecMode mode = kInline);
+    void addRouteRegex(const std::string &pattern, HttpMethod method, Handler handler, const std::vector<std::string> &params, ExecMode mode = kInline);
+    // pattern 与 addRouteRegex 相同（纯静态路径亦可）
+    void addRouteCoroutine(const std::string &pattern, HttpMethod method, CoroutineHandler handler, const std::vector<std::string> &params = {});
+
+    // 给已注册的路由挂预检，pattern 与注册时相同；路由不存在返回 false
+    bool setPreCheck(const std::string &pattern, HttpMethod method, PreCheck check);
+
+    // kBlocking 路由交给 server 的执行器；未设置时在当前线程执行
+    void SetServer(HttpServer *server) { server_ = server; }
 
-    void addRouteRegex(const std::string &pattern, HttpMethod method, Handler handler,const std::vector<std::string> &params)
+    // 找到路由返回 true，sync 为处理器的返回值（false 表示响应稍后异步发送）
+    bool dispatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp, bool &sync) const;
+    // 同上，只关心是否找到路由
+    bool dispatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const;
+    // 执行匹配路由的预检（在 loop 线程同步执行）；未找到路由或路由没有预检时放行
+    bool precheck(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const;
+
+    // 未能编译进前缀树、仍按正则匹配的路由数
+    size_t FallbackCount() const { return regexRoutes_.size(); }
+
+    static const int kMaxParams = 8;
+
+private:
+    static const int kMethodCount = kPatch + 1;
+
+    enum SegmentKind
     {
-        routes_.emplace_back(Route{std::regex(pattern), params, std::move(handler), method});
-    }
+        kStatic,
+        kDigits,  // ([0-9]+)
+        kSegment, // ([^/]+)
+        kRest     // (.*)，只能在结尾
+    };
 
-    // 返回 true 表示找到并处理了路由
-    bool dispatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const
+    struct Segment
     {
-        const std::string &path = req.GetUrl();
-        for (const auto &route : routes_)
-        {
-            if (route.method != req.GetMethod())
-                continue;
-            std::smatch matches;
-            if (std::regex_match(path, matches, route.pattern))
-            {
-                // 提取路径参数
-                std::map<std::string, std::string> params;
-                for (size_t i = 0; i < route.params.size() && i + 1 < matches.size(); ++i)
-                {
-                    params[route.params[i]] = matches[i + 1];
-                }
-                req.SetPathParam(params);
-                return route.handler(conn, req, resp);
-            }
-        }
-        return false;
-    }
+        SegmentKind kind;
+        std::string text; // kStatic 时为段内容
+    };
 
-private:
-    struct Route
+    // 同一路径上的处理器，按 HttpMethod 下标存放 endpoints_ 中的位置，-1 表示未注册
+    struct Slots
+    {
+        int endpoint[kMethodCount];
+        Slots();
+    };
+
+    struct Node
+    {
+        std::vector<std::pair<std::string, int>> statics; // 段 -> 子节点下标，按段排序
+        int digits = -1;
+        int segment = -1;
+        Slots here; // 路径在本节点结束
+        Slots rest; // 从本节点起的剩余路径全部捕获
+    };
+
+    struct Endpoint
     {
-        std::regex pattern;
-        std::vector<std::string> params;
         Handler handler;
+        std::vector<std::string> params; // 按捕获顺序的参数名
+        std::string name;                // "方法 路径模式"
+        ExecMode mode;
+        CoroutineHandler coroutine;      // 非空时为协程路由，handler 不使用
+        PreCheck preCheck;               // 请求体预检，可为空
+        const RouteMetrics *metrics = nullptr; // 按路由模式统计的延迟，AddEndpoint 时设置
+    };
+
+    struct RegexRoute
+    {
+        std::regex pattern;
         HttpMethod method;
+        int endpoint; // endpoints_ 下标
     };
 
-    static std::string escapeRegex(const std::string &str)
+    struct Captures
     {
-        std::string result;
-        result.reserve(str.size() * 2);
-        for (char c : str)
-        {
-            switch (c)
-            {
-            case '.':
-            case '+':
-            case '*':
-            case '?':
-            case '^':
-            case '$':
-            case '(':
-            case ')':
-            case '[':
-            case ']':
-            case '{':
-            case '}':
-            case '|':
-            case '\\':
-                result += '\\';
-                [[fallthrough]];
-            default:
-                result += c;
-            }
-        }
-        return result;
-    }
-
-    std::vector<Route> routes_;
+        std::string_view values[kMaxParams];
+        int count = 0;
+    };
+
+    static bool CompilePattern(const std::string &pattern, std::vector<Segment> &segments);
+    void Insert(const std::vector<Segment> &segments, HttpMethod method, Endpoint endpoint);
+    int AddEndpoint(Endpoint endpoint);
+    void AddPattern(const std::string &pattern, HttpMethod method, Endpoint endpoint);
+    const Endpoint *Lookup(HttpRequest &req) const; // 匹配路由并填好路径参数
+    bool Invoke(const Endpoint &ep, const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const;
+    int Child(int node, const Segment &seg);
+    int Match(int node, std::string_view path, size_t pos, HttpMethod method, Captures &caps) const;
+
+    static std::string escapeRegex(const std::string &str);
+
+    std::vector<Node> nodes_; // nodes_[0] 为根，对应路径开头的 '/'
+    std::vector<Endpoint> endpoints_;
+    std::vector<RegexRoute> regexRoutes_;
+    HttpServer *server_ = nullptr;
 };
 
-void registerRoutes(Router &router, StaticHandler &staticHandler, AuthHandler &authHandler, FileHandler &fileHandler, ShareHandler &shareHandler, UserHandler &userHandler);
\ No newline at end of file
+void registerRoutes(Router &router, StaticHandler &staticHandler, AuthHandler &authHandler, FileHandler &fileHandler, ShareHandler &shareHandler, UserHandler &userHandler, ResumableUploadHandler &resumableHandler);
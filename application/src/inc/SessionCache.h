@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <shared_mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Macro.h"
+#include "Metrics.h"
+
+// sessions 表前的进程内缓存：AuthHandler::validateSession 命中时不访问数据库
+// 条目有效期取会话剩余时间（expire_time）与 maxAge 中较小者；maxAge 限制其他进程改动 sessions 表后本进程看到旧值的时间
+// 不存在的会话 ID 也缓存（negativeTtl），伪造或过期的 ID 反复请求不会每次查库
+// saveSession 写穿（直接放入），endSession 立即失效：失效的条目记为已撤销，保留 maxAge，
+// 期间从数据库读回的结果（与登出并发的查询、后台刷新）不会覆盖它，已登出的会话不会被读回缓存
+// 按会话 ID 的哈希分片，查找持分片的读锁
+// 指标：session_cache_lookups_total{result=hit|negative|miss}
+class SessionCache
+{
+public:
+    enum Result
+    {
+        kMiss,    // 未缓存或已过期，须查库
+        kHit,     // 有效会话
+        kUnknown, // 已知不存在、已过期或已登出
+    };
+
+    struct Session
+    {
+        int userId = 0;
+        std::string username;
+    };
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t negativeHits = 0;
+        uint64_t misses = 0;
+        uint64_t overflow = 0; // 条目数达到上限未缓存
+        size_t entries = 0;
+        double HitRate() const
+        {
+            uint64_t total = hits + negativeHits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits + negativeHits) / static_cast<double>(total);
+        }
+    };
+
+    DISALLOW_COPY_AND_MOVE(SessionCache);
+    // 时间参数为秒
+    explicit SessionCache(size_t maxEntries = 1 << 18, int maxAge = 300, int negativeTtl = 10, size_t shards = 16);
+
+    Result Get(const std::string &id, Session *out, int64_t nowNanos = Now());
+    // 从数据库读到的会话，ttlNanos 为距 expire_time 的时间；不覆盖已撤销的条目
+    void Put(const std::string &id, const Session &session, int64_t ttlNanos, int64_t nowNanos = Now());
+    void PutUnknown(const std::string &id, int64_t nowNanos = Now()); // 数据库中不存在（或已过期）；不覆盖已撤销的条目
+    void Save(const std::string &id, const Session &session, int64_t ttlNanos, int64_t nowNanos = Now()); // 新建会话，写穿
+    void Revoke(const std::string &id, int64_t nowNanos = Now());                                          // 登出
+
+    // 后台刷新：返回上次刷新以来被命中过、缓存将在 withinNanos 内到期、会话本身尚未到期的 ID（至多 limit 个）
+    // 调用方从数据库重新读取后 Put（或 PutUnknown），常用会话不会因缓存到期落回同步查库
+    std::vector<std::string> Expiring(int64_t withinNanos, size_t limit, int64_t nowNanos = Now());
+    size_t Evict(int64_t nowNanos = Now()); // 删除已到期的条目，返回删除数
+
+    Stats GetStats() const;
+    static int64_t Now(); // CLOCK_MONOTONIC_COARSE，纳秒
+
+private:
+    enum State : uint8_t
+    {
+        kValid,
+        kAbsent,  // 数据库中没有
+        kRevoked, // 本进程登出
+    };
+
+    struct Entry
+    {
+        State state = kAbsent;
+        Session session;
+        int64_t cacheUntil = 0;   // 条目到期
+        int64_t sessionUntil = 0; // 会话到期（expire_time）
+        std::atomic<bool> used{false}; // 自上次写入以来被命中过
+    };
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    Shard &ShardOf(const std::string &id) { return shards_[std::hash<std::string>()(id) % shards_.size()]; }
+    // 调用方持有写锁；条目数达到上限且 id 不在表中时返回 nullptr
+    Entry *Slot(Shard &shard, const std::string &id);
+    void Store(const std::string &id, State state, const Session *session, int64_t cacheTtl, int64_t sessionTtl, int64_t nowNanos, bool overrideRevoked);
+
+    std::vector<Shard> shards_;
+    const size_t maxPerShard_;
+    const int64_t maxAge_;
+    const int64_t negativeTtl_;
+    Metrics::Counter hits_;
+    Metrics::Counter negativeHits_;
+    Metrics::Counter misses_;
+    std::atomic<uint64_t> overflow_{0};
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Macro.h"
+#include "Metrics.h"
+#include "Sha256.h"
+
+// 无状态会话令牌：登录时签发，校验只做一次 HMAC-SHA256，不访问数据库，任一节点都能校验
+// 格式 t1.<密钥 ID>.<载荷>.<签名>，载荷为 "用户ID:到期时间:令牌ID:用户名" 的 base64url，签名为 HMAC(密钥, "t1.<密钥 ID>.<载荷>") 的 base64url
+// 密钥轮换：新令牌用最后加入的密钥签发，其余密钥只用于校验，旧令牌在其密钥移除前一直有效
+// 登出：令牌 ID 记入撤销集合直到令牌到期；撤销集合由调用方定期与数据库同步，其他节点上登出的令牌在一个同步周期内失效
+// 指标：session_token_verifications_total{result=valid|invalid|expired|revoked}
+class SessionTokens
+{
+public:
+    enum Result
+    {
+        kValid,
+        kInvalid, // 格式错误、未知密钥或签名不符
+        kExpired,
+        kRevoked,
+    };
+
+    struct Claims
+    {
+        int userId = 0;
+        std::string username;
+        int64_t expires = 0; // Unix 秒
+        std::string tokenId;
+        std::string keyId;
+    };
+
+    struct Stats
+    {
+        uint64_t valid = 0;
+        uint64_t invalid = 0;
+        uint64_t expired = 0;
+        uint64_t revoked = 0;
+        size_t keys = 0;
+        size_t revokedEntries = 0;
+    };
+
+    DISALLOW_COPY_AND_MOVE(SessionTokens);
+    SessionTokens();
+
+    // 密钥文件每行 "<密钥 ID> <密钥>"，# 开头为注释；最后一行为签发密钥。密钥 ID 只能含字母、数字、'-' 与 '_'
+    // 文件修改时间未变时不重新读取；返回当前密钥数，读取失败或没有有效行时保留原有密钥并返回 -1
+    int LoadKeys(const std::string &path);
+    bool AddKey(const std::string &keyId, const std::string &secret); // 加入（或替换）并设为签发密钥
+    bool RemoveKey(const std::string &keyId);
+    bool Enabled() const; // 已有签发密钥
+
+    std::string Issue(int userId, const std::string &username, int64_t ttlSeconds, int64_t now = Now()) const; // 未启用时返回空串
+    Result Verify(const std::string &token, Claims *claims, int64_t now = Now()) const;
+    static bool LooksLikeToken(const std::string &s) { return s.compare(0, 3, "t1.") == 0; }
+
+    void Revoke(const std::string &tokenId, int64_t expires);
+    size_t PurgeRevoked(int64_t now = Now()); // 删除已到期令牌的撤销记录
+
+    Stats GetStats() const;
+    static int64_t Now(); // Unix 秒（CLOCK_REALTIME_COARSE）
+
+private:
+    struct Key
+    {
+        explicit Key(const std::string &secret) : hmac(secret) {}
+        HmacSha256 hmac; // 已压缩密钥的状态，使用时按值复制
+    };
+
+    std::optional<HmacSha256> KeyState(std::string *keyId) const; // keyId 为空时取签发密钥并回填 ID
+    Result Count(Result r) const;
+
+    mutable std::shared_mutex keysMutex_;
+    std::map<std::string, Key> keys_;
+    std::string activeKey_;
+    int64_t keysMtime_ = -1;
+
+    mutable std::shared_mutex revokedMutex_;
+    std::unordered_map<std::string, int64_t> revoked_; // 令牌ID -> 到期时间
+
+    Metrics::Counter valid_;
+    Metrics::Counter invalid_;
+    Metrics::Counter expired_;
+    Metrics::Counter revokedHits_;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+// 流式 SHA-256：数据分片到达时增量更新，结束时取摘要
+// 压缩函数运行时按 CPU 选择：x86-64 支持 SHA-NI 时走硬件指令，否则用可移植实现
+class Sha256
+{
+public:
+    static const size_t kDigestSize = 32;
+    static const size_t kBlockSize = 64;
+
+    Sha256();
+
+    void Reset();
+    void Update(const void *data, size_t len);
+    void Final(uint8_t digest[kDigestSize]); // 取摘要后需 Reset 才能复用
+    std::string HexDigest();                 // Final 并返回 64 位小写十六进制
+
+    static std::string Hex(const uint8_t *data, size_t len);
+    static std::string HexOf(const void *data, size_t len); // 一次性计算
+    static bool ValidHex(const std::string &hex);            // 是否为 64 位小写十六进制摘要
+
+    static const char *Implementation();              // 当前压缩实现："sha-ni" 或 "portable"
+    static bool SetHardwareAcceleration(bool enable); // 测试与基准用，返回实际是否启用硬件实现
+
+private:
+    void Compress(const uint8_t *blocks, size_t count);
+
+    uint32_t state_[8];
+    uint8_t buffer_[kBlockSize];
+    size_t bufferLen_;
+    uint64_t totalLen_;
+};
+
+// HMAC-SHA256（RFC 2104）：构造时把密钥与 ipad/opad 各压缩一块并保存中间状态，
+// 之后每次计算只处理消息本身与外层的一块，可按值复制给多个线程各自使用
+class HmacSha256
+{
+public:
+    static const size_t kMacSize = Sha256::kDigestSize;
+
+    explicit HmacSha256(const std::string &key);
+
+    void Update(const void *data, size_t len);
+    void Final(uint8_t mac[kMacSize]); // 取结果后自动复位，可直接计算下一条消息
+
+    static void Compute(const std::string &key, const void *data, size_t len, uint8_t mac[kMacSize]);
+    static bool Equal(const uint8_t *a, const uint8_t *b, size_t len); // 比较耗时与内容无关
+
+private:
+    Sha256 inner_;
+    Sha256 innerKeyed_; // 已压缩 key ^ ipad
+    Sha256 outerKeyed_; // 已压缩 key ^ opad
+};
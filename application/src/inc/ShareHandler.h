@@ -1,10 +1,12 @@
 #pragma once
 
-#include "Db.h"
+#include "DbPool.h"
 #include "AuthHandler.h"
 #include "StaticHandler.h"
 #include <string>
 #include "ShareRepository.h"
+#include "BlobStore.h"
+#include "ContentCache.h"
 #include "Connection.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
@@ -14,8 +16,8 @@
 class ShareHandler
 {
 public:
-    ShareHandler(Db &db, AuthHandler &auth, StaticHandler &stat, const std::string &uploadDir)
-        : db_(db), auth_(auth), staticHandler_(stat), uploadDir(uploadDir), sharesRepo_(db) {}
+    ShareHandler(DbPool &db, AuthHandler &auth, StaticHandler &stat, BlobStore &blobStore, ContentCache &contentCache, const std::string &uploadDir)
+        : db_(db), auth_(auth), staticHandler_(stat), blobStore_(blobStore), contentCache_(contentCache), uploadDir(uploadDir), sharesRepo_(db) {}
     ~ShareHandler() = default;
 
     bool handleShareFile(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp);     // 处理创建分享请求
@@ -24,9 +26,11 @@ public:
     bool handleShareInfo(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp);     // 处理分享信息请求
 
 private:
-    Db &db_;
+    DbPool &db_;
     AuthHandler &auth_;
     StaticHandler &staticHandler_;
+    BlobStore &blobStore_;
+    ContentCache &contentCache_;
     std::string uploadDir;
     SharesRepository sharesRepo_;
 };
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Db.h"
+#include "DbPool.h"
 #include <string>
 #include <optional>
 
@@ -23,78 +23,63 @@ struct ShareRecord
     std::string fileType;                  // 文件类型
     int fileOwnerId;                       // 文件所有者ID
     std::string ownerUsername;             // 文件所有者用户名
+    std::string contentHash;               // 内容摘要，为空表示旧文件
 };
 
 class SharesRepository
 {
 public:
-    SharesRepository(Db &db) : db_(db) {}
+    SharesRepository(DbPool &db) : db_(db) {}
     ~SharesRepository() = default;
 
     std::optional<ShareRecord> getByCode(const std::string &code)
     {
-        std::string q =
+        DbPool::Stmt st = db_.prepare(
             "SELECT fs.id AS share_id, fs.file_id, fs.owner_id, fs.shared_with_id, fs.share_type, fs.share_code, fs.extract_code, DATE_FORMAT(fs.created_at, '%Y-%m-%d %H:%i:%s') AS created_at, "
-            "DATE_FORMAT(fs.expire_time, '%Y-%m-%d %H:%i:%s') AS expire_time, f.filename AS server_filename, f.original_filename, f.file_size, f.file_type, f.user_id AS file_owner_id, u.username AS owner_username "
+            "DATE_FORMAT(fs.expire_time, '%Y-%m-%d %H:%i:%s') AS expire_time, f.filename AS server_filename, f.original_filename, f.file_size, f.file_type, f.user_id AS file_owner_id, u.username AS owner_username, f.content_hash "
             "FROM file_shares fs JOIN files f ON fs.file_id = f.id JOIN users u ON f.user_id = u.id "
-            "WHERE fs.share_code = '" +
-            db_.escape(code) + "' AND (fs.expire_time IS NULL OR fs.expire_time > NOW())";
-        MYSQL_RES *r = db_.query(q);
-        if (!r || mysql_num_rows(r) == 0)
-        {
-            if (r)
-                mysql_free_result(r);
+            "WHERE fs.share_code = ? AND (fs.expire_time IS NULL OR fs.expire_time > NOW())");
+        if (!st || !st->query(code) || !st->fetch())
             return std::nullopt;
-        }
-        MYSQL_ROW row = mysql_fetch_row(r);
         ShareRecord rec;
-        rec.shareId = std::stoi(row[0]);
-        rec.fileId = std::stoi(row[1]);
-        rec.ownerId = std::stoi(row[2]);
-        rec.sharedWithId = row[3] ? std::optional<int>(std::stoi(row[3])) : std::nullopt;
-        rec.shareType = row[4] ? row[4] : "";
-        rec.shareCode = row[5] ? row[5] : "";
-        rec.extractCode = row[6] ? std::optional<std::string>(row[6]) : std::nullopt;
-        rec.createdAt = row[7] ? row[7] : "";
-        rec.expireTime = row[8] ? std::optional<std::string>(row[8]) : std::nullopt;
-        rec.serverFilename = row[9] ? row[9] : "";
-        rec.originalFilename = row[10] ? row[10] : "";
-        rec.fileSize = row[11] ? static_cast<uint64_t>(std::stoull(row[11])) : 0ULL;
-        rec.fileType = row[12] ? row[12] : "unknown";
-        rec.fileOwnerId = row[13] ? std::stoi(row[13]) : 0;
-        rec.ownerUsername = row[14] ? row[14] : "";
-        mysql_free_result(r);
+        rec.shareId = st->getInt(0);
+        rec.fileId = st->getInt(1);
+        rec.ownerId = st->getInt(2);
+        rec.sharedWithId = st->getOptionalInt(3);
+        rec.shareType = st->getString(4);
+        rec.shareCode = st->getString(5);
+        rec.extractCode = st->getOptionalString(6);
+        rec.createdAt = st->getString(7);
+        rec.expireTime = st->getOptionalString(8);
+        rec.serverFilename = st->getString(9);
+        rec.originalFilename = st->getString(10);
+        rec.fileSize = st->getUInt64(11);
+        rec.fileType = st->isNull(12) ? "unknown" : st->getString(12);
+        rec.fileOwnerId = st->getInt(13);
+        rec.ownerUsername = st->getString(14);
+        rec.contentHash = st->getString(15);
         return rec;
     }
 
     // 判断文件是否属于某用户
     bool isFileOwnedBy(int fileId, int userId)
     {
-        std::string q = "SELECT 1 FROM files WHERE id = " + std::to_string(fileId) + " AND user_id = " + std::to_string(userId) + " LIMIT 1";
-        MYSQL_RES *r = db_.query(q);
-        bool ok = (r && mysql_num_rows(r) > 0);
-        if (r)
-            mysql_free_result(r);
-        return ok;
+        DbPool::Stmt st = db_.prepare("SELECT 1 FROM files WHERE id = ? AND user_id = ? LIMIT 1");
+        return st && st->query(fileId, userId) && st->rowCount() > 0;
     }
 
     // 是否已存在分享给指定用户的记录（share_type='user'）
     bool existsUserShare(int fileId, int sharedWithId)
     {
-        std::string q = "SELECT 1 FROM file_shares WHERE file_id = " + std::to_string(fileId) +
-                        " AND shared_with_id = " + std::to_string(sharedWithId) + " AND share_type = 'user' LIMIT 1";
-        MYSQL_RES *r = db_.query(q);
-        bool ok = (r && mysql_num_rows(r) > 0);
-        if (r)
-            mysql_free_result(r);
-        return ok;
+        DbPool::Stmt st = db_.prepare("SELECT 1 FROM file_shares WHERE file_id = ? AND shared_with_id = ? AND share_type = 'user' LIMIT 1");
+        return st && st->query(fileId, sharedWithId) && st->rowCount() > 0;
     }
 
     // 设为私有：删除该文件的所有分享
     bool setPrivate(int fileId)
     {
-        std::string q = "DELETE FROM file_shares WHERE file_id = " + std::to_string(fileId);
-        return db_.exec(q);
+        DbPool::Stmt st = db_.prepare("DELETE FROM file_shares WHERE file_id = ?");
+        return st && st->execute(fileId);
     }
 
     // 创建分享，返回 share_id
@@ -106,21 +91,18 @@ public:
                                    const std::optional<std::string> &extractCode,
                                    const std::optional<int> &expireHours)
     {
-        std::string expireExpr = "NULL";
+        // expireHours 为空或不大于 0 时不过期
+        std::optional<int> hours;
         if (expireHours && *expireHours > 0)
-        {
-            expireExpr = "DATE_ADD(NOW(), INTERVAL " + std::to_string(*expireHours) + " HOUR)";
-        }
-        std::string sharedWithExpr = sharedWithId ? std::to_string(*sharedWithId) : std::string("NULL");
-        std::string extractExpr = extractCode ? ("'" + db_.escape(*extractCode) + "'") : std::string("NULL");
-        std::string q =
-            "INSERT INTO file_shares (file_id, owner_id, shared_with_id, share_type, share_code, extract_code, expire_time) VALUES (" +
-            std::to_string(fileId) + ", " + std::to_string(ownerId) + ", " + sharedWithExpr + ", '" + db_.escape(shareType) + "', '" + db_.escape(shareCode) + "', " + extractExpr + ", " + expireExpr + ")";
-        if (!db_.exec(q))
+            hours = *expireHours;
+        DbPool::Stmt st = db_.prepare(
+            "INSERT INTO file_shares (file_id, owner_id, shared_with_id, share_type, share_code, extract_code, expire_time) "
+            "VALUES (?, ?, ?, ?, ?, ?, DATE_ADD(NOW(), INTERVAL ? HOUR))");
+        if (!st || !st->execute(fileId, ownerId, sharedWithId, shareType, shareCode, extractCode, hours))
             return std::nullopt;
-        return static_cast<int>(db_.insertId());
+        return static_cast<int>(st->insertId());
     }
 
 private:
-    Db &db_; // 数据库连接
+    DbPool &db_; // 数据库连接
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mysql/mysql.h>
+#include "Macro.h"
+#include "Metrics.h"
+
+class Db;
+
+// 预处理语句：每个连接上同一 SQL 只准备一次（由 Db::prepare 缓存），之后每次执行只发送参数，服务端不再解析 SQL
+// 参数与结果按二进制类型绑定：整数列直接读成 int64，不经过字符串与 stoi；其余列（字符串、日期、DECIMAL）读成字符串
+// 结果集由 mysql_stmt_store_result 一次取到客户端；下一次执行前自动释放
+// 由借到连接的线程独占使用，不加锁
+class Statement
+{
+public:
+    DISALLOW_COPY_AND_MOVE(Statement); // 绑定信息指向自身的缓冲
+    Statement(Db &db, MYSQL_STMT *stmt);
+    ~Statement();
+
+    // 按顺序绑定参数并执行：整数、std::string/const char*、std::nullopt 与 std::optional
+    template <typename... Args>
+    bool execute(const Args &...args) // INSERT/UPDATE/DELETE
+    {
+        return bindAll(args...) && run(false);
+    }
+    template <typename... Args>
+    bool query(const Args &...args) // SELECT，之后用 fetch 逐行读取
+    {
+        return bindAll(args...) && run(true);
+    }
+
+    bool fetch(); // 读下一行，没有更多行返回 false
+    uint64_t rowCount() const;
+    uint64_t insertId() const;
+    uint64_t affectedRows() const;
+
+    // 当前行第 col 列（从 0 开始）；NULL 读作 0 或空串
+    bool isNull(unsigned col) const { return columns_[col].isNull; }
+    int64_t getInt64(unsigned col) const;
+    int getInt(unsigned col) const { return static_cast<int>(getInt64(col)); }
+    uint64_t getUInt64(unsigned col) const { return static_cast<uint64_t>(getInt64(col)); }
+    std::string getString(unsigned col) const;
+    std::optional<int> getOptionalInt(unsigned col) const;
+    std::optional<std::string> getOptionalString(unsigned col) const;
+
+    void setLatency(const Metrics::Histogram *latency) { latency_ = latency; } // 本次使用记入的 db_query_duration_seconds{method}
+
+private:
+    // 结果列的接收缓冲；整数列 value 有效，其余列 text 有效（被截断时 fetch 中扩容重取）
+    struct Column
+    {
+        bool integer = false;
+        int64_t value = 0;
+        std::vector<char> text;
+        unsigned long length = 0;
+        bool isNull = false;
+        bool error = false;
+    };
+
+    template <typename... Args>
+    bool bindAll(const Args &...args)
+    {
+        if (sizeof...(Args) != params_.size())
+            return paramCountMismatch(sizeof...(Args));
+        size_t i = 0;
+        (bindParam(i++, args), ...);
+        return true;
+    }
+    void bindParam(size_t i, int v) { bindInt(i, v, false); }
+    void bindParam(size_t i, int64_t v) { bindInt(i, v, false); }
+    void bindParam(size_t i, uint64_t v) { bindInt(i, static_cast<int64_t>(v), true); }
+    void bindParam(size_t i, const std::string &v) { bindText(i, v.data(), v.size()); }
+    void bindParam(size_t i, const char *v);
+    void bindParam(size_t i, std::nullopt_t);
+    template <typename T>
+    void bindParam(size_t i, const std::optional<T> &v)
+    {
+        if (v)
+            bindParam(i, *v);
+        else
+            bindParam(i, std::nullopt);
+    }
+    void bindInt(size_t i, int64_t v, bool isUnsigned);
+    void bindText(size_t i, const char *data, size_t size);
+    bool paramCountMismatch(size_t given);
+
+    void bindResult(); // 按结果集元数据准备 columns_ 与 results_
+    bool run(bool store);
+    void fail(const char *what);
+
+    Db &db_;
+    MYSQL_STMT *stmt_;
+    std::vector<MYSQL_BIND> params_;
+    std::vector<int64_t> paramInts_;
+    std::vector<unsigned long> paramLengths_;
+    std::vector<MYSQL_BIND> results_;
+    std::vector<Column> columns_;
+    bool hasResult_ = false; // 有未释放的结果集
+    const Metrics::Histogram *latency_ = nullptr;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <stdint.h>
+#include "Macro.h"
+
+class EventLoop;
+class DirWatcher;
+class HttpRequest;
+class HttpResponse;
+
+// 预加载的静态资源：原文与预压缩的 gzip / brotli 版本，各带强 ETag
+// 内容不可变，更新时整体替换条目，正在发送的响应仍持有旧内容
+struct StaticAsset
+{
+    enum Encoding
+    {
+        kIdentity = 0,
+        kGzip,
+        kBrotli,
+        kEncodingCount
+    };
+
+    std::string contentType;
+    std::shared_ptr<const std::string> body[kEncodingCount]; // 压缩后不更小的版本为空
+    std::string etag[kEncodingCount];                        // 带引号，如 "3f2a...-br"
+};
+
+// 静态资源引擎：启动时把静态目录读入内存并预压缩，inotify 监视目录，文件变化后在 loop 线程重新加载
+// 请求按 Accept-Encoding 选择版本，If-None-Match 命中时回 304；响应以 BUFFER_TYPE 引用内存发送，保持长连接
+// 超过 maxFileBytes 的文件不预加载，由调用方走 sendfile
+class StaticAssets
+{
+public:
+    struct Stats
+    {
+        size_t assets = 0;
+        size_t identityBytes = 0;
+        size_t compressedBytes = 0; // gzip 与 brotli 版本合计
+        uint64_t reloads = 0;       // 因文件变化重新加载的次数
+        uint64_t served = 0;
+        uint64_t notModified = 0;
+    };
+
+    DISALLOW_COPY_AND_MOVE(StaticAssets);
+    explicit StaticAssets(const std::string &dir, size_t maxFileBytes = 8 * 1024 * 1024);
+    ~StaticAssets();
+
+    // 扫描整个目录（含子目录）并替换现有内容，返回资源数
+    size_t Load();
+    // 监视目录变化，在 loop 线程调用；StaticAssets 须在 loop 退出后析构
+    bool Watch(EventLoop *loop);
+
+    // relPath 为相对静态目录的路径，如 "index.html"、"js/app.js"；未预加载返回 nullptr
+    std::shared_ptr<const StaticAsset> Find(const std::string &relPath) const;
+    // 按请求的 Accept-Encoding / If-None-Match 填充 200 或 304 响应
+    void Respond(const StaticAsset &asset, const HttpRequest &req, HttpResponse *resp);
+
+    Stats GetStats() const;
+    const std::string &Dir() const { return dir_; }
+
+    // 按扩展名取 Content-Type
+    static std::string ContentTypeOf(const std::string &path);
+    // 从 Accept-Encoding 中选出可用的最优编码（br > gzip > identity），available[i] 表示该版本存在
+    static StaticAsset::Encoding Negotiate(const std::string &acceptEncoding, const bool available[StaticAsset::kEncodingCount]);
+    // If-None-Match 是否与 etag 匹配（弱比较，支持 * 与逗号分隔的列表）
+    static bool EtagMatches(const std::string &ifNoneMatch, const std::string &etag);
+
+private:
+    typedef std::map<std::string, std::shared_ptr<const StaticAsset>> AssetMap;
+
+    std::shared_ptr<const StaticAsset> LoadFile(const std::string &path) const;
+    void Scan(const std::string &dir, const std::string &prefix, AssetMap &assets) const;
+    void OnChange(const std::string &path);
+    void ScheduleFlush();
+    void FlushPending();
+
+    const std::string dir_;
+    const size_t maxFileBytes_;
+
+    mutable std::mutex mutex_;
+    AssetMap assets_;
+
+    EventLoop *loop_ = nullptr;
+    std::unique_ptr<DirWatcher> watcher_;
+    std::set<std::string> pending_; // 待重新加载的路径，只在 loop 线程访问
+    bool reloadAll_ = false;
+    bool flushScheduled_ = false;
+
+    std::atomic<uint64_t> reloads_{0};
+    std::atomic<uint64_t> served_{0};
+    std::atomic<uint64_t> notModified_{0};
+};
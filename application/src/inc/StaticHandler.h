@@ -3,17 +3,31 @@
 #include <string>
 #include <memory>
 #include "Connection.h"
+#include "FdCache.h"
+#include "StaticAssets.h"
 
 // 静态资源处理器
 
 class StaticHandler {
 public:
-    StaticHandler() = default;
-    
-    // 处理主页请求
+    // assets 非空时从预加载的内存资源回包（支持压缩协商与 304）；未预加载的文件经 cache（可为空）打开后 sendfile
+    explicit StaticHandler(StaticAssets* assets = nullptr, FdCache* cache = nullptr) : assets_(assets), cache_(cache) {}
+
+    // 静态资源目录（application/static）
+    static const std::string& staticDir();
+
+    // 处理页面请求：/、/index.html、/register.html、/share.html 与 /share/:code
     bool handleIndex(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
     // 处理 favicon.ico 请求
     bool handleFavicon(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
     // 处理 /static/* 静态资源
     bool handleStaticAsset(const std::shared_ptr<Connection>& conn, HttpRequest& req, HttpResponse* resp);
-};
\ No newline at end of file
+
+private:
+    // relPath 为相对静态目录的路径；响应遵循客户端的长连接设置
+    void serve(HttpRequest& req, HttpResponse* resp, const std::string& relPath);
+    std::shared_ptr<const CachedFile> openFile(const std::string& path);
+
+    StaticAssets* assets_;
+    FdCache* cache_;
+};
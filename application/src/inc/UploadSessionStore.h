@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+class EventLoop;
+class UploadWriter;
+class UploadSessionStore;
+
+// 断点续传会话
+struct UploadSession
+{
+    std::string id;       // 会话ID
+    int userId = 0;       // 所属用户
+    std::string filename; // 原始文件名
+    uint64_t size = 0;    // 文件总大小
+    std::string sha256;   // 客户端声明的摘要（可选）
+    uint64_t offset = 0;  // 已持久化的字节数
+    int64_t createdAt = 0;
+    int64_t updatedAt = 0;
+    bool busy = false;    // 是否有 PATCH 正在写入
+    // 并行分片上传：各分片写入预分配数据文件的固定偏移，partSize 为 0 表示顺序上传
+    enum PartState : uint8_t { kPartMissing = 0, kPartWriting = 1, kPartDone = 2 };
+    uint64_t partSize = 0;
+    std::vector<uint8_t> parts; // 每个分片的 PartState
+    int activeParts = 0;        // 正在写入的分片数
+
+    bool isMultipart() const { return partSize > 0; }
+    uint64_t partCount() const { return partSize == 0 ? 0 : (size + partSize - 1) / partSize; }
+    uint64_t partOffset(uint64_t index) const { return index * partSize; }
+    uint64_t partLength(uint64_t index) const { return index + 1 < partCount() ? partSize : size - index * partSize; }
+};
+
+// 断点续传会话的持久化与过期清理
+// 每个会话在 dir 下有 <id>.json（元数据）与 <id>.data（已接收数据），重启后可恢复
+// 顺序上传的偏移以数据文件长度为准；分片上传以元数据中已完成的分片为准，分片落盘后才记为完成
+class UploadSessionStore
+{
+public:
+    UploadSessionStore(const std::string &dir, int64_t ttlSeconds);
+
+    void load();                                         // 启动时扫描目录恢复会话
+    void startExpiry(EventLoop *loop, double interval);  // 在 loop 上定时清理过期会话
+    size_t expireStale();                                // 清理超过 ttl 未活动的会话，返回清理数量
+
+    // partSize 非 0 时创建分片上传会话，数据文件按总大小预分配
+    std::shared_ptr<UploadSession> create(int userId, const std::string &filename, uint64_t size, const std::string &sha256, uint64_t partSize = 0);
+    std::shared_ptr<UploadSession> get(const std::string &id);
+    enum Admission
+    {
+        kAdmitted,       // 已占用会话（或分片）
+        kBusy,           // 已有请求在写
+        kOffsetMismatch, // Upload-Offset 与已持久化偏移不符
+        kBadLength,      // 请求体长度超出文件或不是整片
+        kIncomplete,     // 完成时仍有分片缺失或数据文件长度不符
+    };
+    // 一次 PATCH：偏移须等于已持久化偏移、数据不超出文件大小，通过后占用会话；失败时会话不变
+    Admission admitPatch(const std::shared_ptr<UploadSession> &s, uint64_t offset, uint64_t length);
+    // 一个分片的 PUT：必须整片上传，同一分片不可并发写，通过后标记分片写入中
+    Admission admitPart(const std::shared_ptr<UploadSession> &s, uint64_t index, uint64_t length);
+    // 分片上传完成：没有分片在写、全部分片已落盘且数据文件长度正确时占用会话；缺失的分片写入 missing
+    Admission admitComplete(const std::shared_ptr<UploadSession> &s, std::vector<uint64_t> *missing);
+    bool acquire(const std::shared_ptr<UploadSession> &s);                      // 标记为写入中，已被占用或有分片在写返回 false
+    void release(const std::shared_ptr<UploadSession> &s, uint64_t newOffset, bool keepBusy = false); // 更新偏移并持久化，keepBusy 为 false 时解除占用
+    bool acquirePart(const std::shared_ptr<UploadSession> &s, uint64_t index);  // 标记分片写入中，同一分片不可并发写
+    void releasePart(const std::shared_ptr<UploadSession> &s, uint64_t index, bool done); // 分片结束，done 表示已完整落盘
+    std::vector<uint64_t> missingParts(const std::shared_ptr<UploadSession> &s);           // 尚未完成的分片
+    void remove(const std::string &id);                                        // 删除会话及其文件
+
+    std::string dataPath(const std::string &id) const { return dir_ + "/" + id + ".data"; }
+    std::string metaPath(const std::string &id) const { return dir_ + "/" + id + ".json"; }
+    const std::string &dir() const { return dir_; }
+    int64_t ttl() const { return ttl_; }
+
+    static bool validId(const std::string &id);                       // 防止路径穿越
+    static std::string joinParts(const std::vector<uint64_t> &parts); // Upload-Missing-Parts 的取值，如 "1,3"
+
+private:
+    void persist(const std::shared_ptr<UploadSession> &s); // 持久化会话当前状态（已删除的会话跳过）
+    bool writeMeta(const UploadSession &s);                 // 原子写入元数据
+
+    std::string dir_;
+    int64_t ttl_;
+    std::mutex mutex_;
+    std::mutex persistMutex_; // 串行化元数据写入
+    std::map<std::string, std::shared_ptr<UploadSession>> sessions_;
+};
+
+// 一次 PATCH/分片 PUT 请求的写入状态，保存在 HttpContext 中，跨分片回调复用
+// 请求未正常结束就析构（连接中断、出错）时：顺序上传保留已落盘的数据并推进偏移，分片上传把该分片记为缺失
+struct ResumablePatchContext
+{
+    std::shared_ptr<UploadSession> session;
+    std::shared_ptr<UploadWriter> writer;
+    UploadSessionStore *store = nullptr;
+    uint64_t startOffset = 0;
+    int64_t part = -1;     // 分片上传的分片序号，顺序上传为 -1
+    bool finished = false; // 已由 finishPatch 释放会话
+    int userId = 0;        // 预检已校验的用户；此时尚未占用会话，writer 为空
+
+    ~ResumablePatchContext();
+};
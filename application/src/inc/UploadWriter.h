@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <stdint.h>
+#include "Macro.h"
+#include "Sha256.h"
+
+// 单块磁盘对应的 I/O 线程：FIFO 执行写盘任务，队列深度有上限
+// Reactor 线程只负责投递任务，队列满时由调用方对连接施加背压
+class DiskIoThread
+{
+public:
+    DISALLOW_COPY_AND_MOVE(DiskIoThread);
+    explicit DiskIoThread(size_t maxQueueDepth = 64);
+    ~DiskIoThread();
+
+    // 按路径所在的设备返回共享的 I/O 线程，同一块磁盘上的写入串行化
+    static DiskIoThread *ForPath(const std::string &path);
+    // 摘要计算线程：与写盘线程并行，按调用轮流分配；同一上传的摘要任务始终在同一线程按序执行
+    static DiskIoThread *HashWorker();
+
+    void Submit(std::function<void()> task);       // 投递任务，不阻塞
+    bool Full() const;                             // 队列是否已达上限
+    size_t QueueDepth() const;                     // 当前排队的任务数
+    void NotifyWhenDrained(std::function<void()> cb); // 队列回落到一半以下时回调一次（在 I/O 线程执行）
+
+private:
+    void ThreadFunc();
+
+    const size_t maxDepth_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::function<void()>> drainWaiters_;
+    std::atomic<size_t> depth_;
+    bool running_;
+    std::thread thread_;
+};
+
+// 上传写入器：fallocate 预分配，数据先拷贝进对齐缓冲区，写满后交给 I/O 线程 pwrite；
+// 提交时统一 fdatasync，并把临时文件原子 rename 为最终文件
+// 启用摘要后，同一缓冲区同时交给摘要线程计算 SHA-256，两边都用完才归还，Reactor 线程不做哈希
+class UploadWriter : public std::enable_shared_from_this<UploadWriter>
+{
+public:
+    DISALLOW_COPY_AND_MOVE(UploadWriter);
+    static const size_t kBufferSize = 1024 * 1024; // 单个缓冲区大小
+    static const size_t kAlignment = 4096;         // 缓冲区对齐
+
+    typedef std::function<void(bool)> DoneCallback; // 在 I/O 线程中回调（启用摘要时 Commit 可能在摘要线程回调）
+
+    // tmpPath 为空时直接写 finalPath（断点续传等场景），否则提交时 rename(tmpPath, finalPath)
+    UploadWriter(DiskIoThread *io, const std::string &finalPath, const std::string &tmpPath);
+    ~UploadWriter();
+
+    // 打开文件；preallocate>0 时从 offset 处预分配，truncate 为 false 时保留已有内容
+    bool Open(uint64_t preallocate, uint64_t offset = 0, bool truncate = true);
+    void EnableHash(DiskIoThread *hashThread); // Append 之前调用，Commit 完成时摘要可用
+    void Append(const char *data, size_t len); // Reactor 线程调用，只做内存拷贝
+    void Flush();                              // 把未满的缓冲区也交给 I/O 线程
+    void Sync(DoneCallback done);              // 刷盘但不关闭（断点续传每个分片落盘）
+    void Commit(DoneCallback done);            // 刷盘、截断预分配的尾部、关闭并 rename
+    void Abort();                              // 放弃写入，删除临时文件（没有临时文件时保留目标文件）
+
+    bool Backpressured() const { return io_->Full() || (hashIo_ && hashIo_->Full()); }
+    void NotifyWhenDrained(std::function<void()> cb); // 写盘与摘要队列都回落后回调一次
+    bool Failed() const { return failed_.load(); }
+    uint64_t BytesAppended() const { return appended_; }
+    const std::string &GetFinalPath() const { return finalPath_; }
+    const std::string &Digest() const { return digest_; } // SHA-256 十六进制，Commit 回调之后有效
+    DiskIoThread *GetIoThread() const { return io_; }
+
+private:
+    struct AlignedBuffer
+    {
+        char *data;
+        size_t len;
+    };
+    AlignedBuffer AcquireBuffer();
+    void ReleaseBuffer(char *data);
+    void WriteBuffer(AlignedBuffer buf, uint64_t offset); // I/O 线程中执行
+    void UnrefBuffer(char *data, const std::shared_ptr<std::atomic<int>> &refs); // 写盘与摘要都用完后归还
+
+    DiskIoThread *io_;
+    std::string finalPath_;
+    std::string tmpPath_;
+    int fd_;
+    uint64_t startOffset_;  // 起始写入位置
+    uint64_t appended_;     // 已追加的字节数
+    uint64_t preallocated_; // 预分配到的文件末尾
+    AlignedBuffer current_; // 正在填充的缓冲区
+    std::atomic<bool> failed_;
+    bool finished_;         // 已提交或放弃
+    DiskIoThread *hashIo_;  // 摘要线程，未启用时为空
+    Sha256 hasher_;         // 只在摘要线程中更新
+    std::string digest_;
+
+    std::mutex freeMutex_;
+    std::vector<char *> freeList_; // I/O 线程归还的缓冲区
+};
@@ -3,8 +3,7 @@
 #include <string>
 #include <vector>
 #include <optional>
-#include <mysql/mysql.h>
-#include "Db.h"
+#include "DbPool.h"
 
 // 定义用户仓库类
 
@@ -18,28 +17,25 @@ struct UserRow{
 
 class UserRepository{
 public:
-    explicit UserRepository(Db& db): db_(db) {}
+    explicit UserRepository(DbPool& db): db_(db) {}
     
     // 按用户名关键字搜索用户，排除指定用户ID，返回结果限制数量
     std::vector<UserRow> searchByUsernameKeywordExcluding(const std::string& keyword, int excludeUserId, int limit=10){
         std::vector<UserRow> out;
-        std::string q = "SELECT id, username, email, password FROM users WHERE username LIKE ''%" + db_.escape(keyword) + 
-                        "%' AND id != " + std::to_string(excludeUserId) + " LIMIT " + std::to_string(limit);
-        if (MYSQL_RES* res = db_.query(q)) {
-            MYSQL_ROW row;
-            while(row = mysql_fetch_row(res)) {
-                UserRow u;
-                u.id = std::stoi(row[0]);
-                u.username = row[1] ? row[1] : "";
-                u.email = row[2] ? row[2] : "";
-                u.password = row[3] ? row[3] : ""; // 假设密码也需要返回
-                out.push_back(std::move(u));
-            }
-            mysql_free_result(res);
+        DbPool::Stmt st = db_.prepare("SELECT id, username, email, password FROM users WHERE username LIKE ? AND id != ? LIMIT ?");
+        if (!st || !st->query("%" + keyword + "%", excludeUserId, limit))
+            return out;
+        while (st->fetch()) {
+            UserRow u;
+            u.id = st->getInt(0);
+            u.username = st->getString(1);
+            u.email = st->getString(2);
+            u.password = st->getString(3); // 假设密码也需要返回
+            out.push_back(std::move(u));
         }
         return out;
     }
 
 private:
-    Db& db_;   // 数据库连接引用
+    DbPool& db_;   // 数据库连接引用
 };
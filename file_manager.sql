@@ -35,6 +35,28 @@ CREATE TABLE
         FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE
     ) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4 COLLATE = utf8mb4_unicode_ci;
 
+-- 创建令牌撤销表（无状态会话令牌登出后记录令牌ID，各节点定期同步；令牌到期后删除）
+CREATE TABLE
+    IF NOT EXISTS revoked_tokens (
+        id INT PRIMARY KEY AUTO_INCREMENT, -- 记录ID
+        token_id CHAR(16) NOT NULL UNIQUE, -- 令牌ID
+        expire_time TIMESTAMP NOT NULL, -- 令牌到期时间
+        revoked_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, -- 登出时间（增量同步依据）
+        INDEX idx_revoked_at (revoked_at), -- 同步索引
+        INDEX idx_expire_time (expire_time) -- 清理索引
+    ) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4 COLLATE = utf8mb4_unicode_ci;
+
+-- 创建内容表（内容寻址存储，相同内容只保存一份）
+CREATE TABLE
+    IF NOT EXISTS blobs (
+        hash CHAR(64) PRIMARY KEY, -- 内容 SHA-256（小写十六进制）
+        size BIGINT UNSIGNED NOT NULL, -- 内容大小
+        ref_count INT NOT NULL DEFAULT 0, -- 引用该内容的文件数
+        created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, -- 创建时间
+        updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP, -- 更新时间（回收宽限期依据）
+        INDEX idx_ref_count (ref_count, updated_at) -- 回收扫描索引
+    ) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4 COLLATE = utf8mb4_unicode_ci;
+
 -- 创建文件表
 CREATE TABLE
     IF NOT EXISTS files (
@@ -44,10 +66,14 @@ CREATE TABLE
         file_size BIGINT UNSIGNED NOT NULL, -- 文件大小
         file_type VARCHAR(50), -- 文件类型
         user_id INT NOT NULL, -- 用户ID
+        content_hash CHAR(64) NULL, -- 内容摘要，指向 blobs；为 NULL 的旧文件仍按 filename 存放在上传目录
         created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, -- 创建时间
         updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP, -- 更新时间
         INDEX idx_filename (filename), -- 文件名索引
-        INDEX idx_user_id (user_id), -- 用户ID索引
+        INDEX idx_user_created (user_id, created_at, id), -- 文件列表：按上传时间排序与翻页（同时作为 user_id 外键索引）
+        INDEX idx_user_name (user_id, original_filename, id), -- 文件列表：按文件名排序与翻页
+        INDEX idx_user_size (user_id, file_size, id), -- 文件列表：按大小排序与翻页
+        INDEX idx_content_hash (content_hash), -- 内容摘要索引
         FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE
     ) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4 COLLATE = utf8mb4_unicode_ci;
 
@@ -71,4 +97,11 @@ CREATE TABLE
         FOREIGN KEY (file_id) REFERENCES files (id) ON DELETE CASCADE,
         FOREIGN KEY (owner_id) REFERENCES users (id) ON DELETE CASCADE,
         FOREIGN KEY (shared_with_id) REFERENCES users (id) ON DELETE CASCADE
-    ) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4 COLLATE = utf8mb4_unicode_ci;
\ No newline at end of file
+    ) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4 COLLATE = utf8mb4_unicode_ci;
+
+-- 已有数据库升级到内容寻址存储：
+-- CREATE TABLE blobs (...)（同上）;
+-- ALTER TABLE files ADD COLUMN content_hash CHAR(64) NULL AFTER user_id, ADD INDEX idx_content_hash (content_hash);
+
+-- 已有数据库升级到文件列表分页（复合索引覆盖 user_id 前缀，原 idx_user_id 可删除）：
+-- ALTER TABLE files ADD INDEX idx_user_created (user_id, created_at, id), ADD INDEX idx_user_name (user_id, original_filename, id), ADD INDEX idx_user_size (user_id, file_size, id), DROP INDEX idx_user_id;
@@ -0,0 +1,90 @@
+#include "BlockingExecutor.h"
+#include "Logger.h"
+#include <exception>
+
+BlockingExecutor::BlockingExecutor(int threads, size_t maxQueue) : maxQueue_(maxQueue)
+{
+    if (threads < 1)
+        threads = 1;
+    threads_.reserve(threads);
+    for (int i = 0; i < threads; ++i)
+        threads_.emplace_back([this]() { WorkerLoop(); });
+}
+
+BlockingExecutor::~BlockingExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &t : threads_)
+        t.join();
+}
+
+bool BlockingExecutor::Submit(const std::string &name, std::function<void()> task)
+{
+    return Enqueue(name, task, true);
+}
+
+bool BlockingExecutor::SubmitUnbounded(const std::string &name, std::function<void()> task)
+{
+    return Enqueue(name, task, false);
+}
+
+bool BlockingExecutor::Enqueue(const std::string &name, std::function<void()> &task, bool bounded)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats &st = stats_[name];
+        if (stop_ || (bounded && queue_.size() >= maxQueue_))
+        {
+            ++st.rejected;
+            return false;
+        }
+        queue_.push_back(Task{std::move(task), &st, Clock::now()});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+size_t BlockingExecutor::QueueDepth() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+std::map<std::string, BlockingExecutor::Stats> BlockingExecutor::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BlockingExecutor::WorkerLoop()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (queue_.empty())
+                return; // stop_ 且队列已清空
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            double waitMs = std::chrono::duration<double, std::milli>(Clock::now() - task.enqueued).count();
+            ++task.stats->executed;
+            task.stats->totalWaitMs += waitMs;
+            if (waitMs > task.stats->maxWaitMs)
+                task.stats->maxWaitMs = waitMs;
+        }
+        try
+        {
+            task.fn();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR << "BlockingExecutor task failed: " << e.what();
+        }
+    }
+}
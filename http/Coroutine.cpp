@@ -0,0 +1,119 @@
+#include "Coroutine.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+const size_t kClasses = 7; // 128 .. 8192
+
+struct FreeLists
+{
+    std::vector<void *> free[kClasses];
+    FramePool::Stats stats;
+
+    ~FreeLists()
+    {
+        for (auto &list : free)
+            for (void *p : list)
+                ::operator delete(p);
+    }
+};
+
+thread_local FreeLists t_pool;
+
+// 返回 size 所属的级别，超出最大级别返回 kClasses
+size_t ClassOf(size_t size)
+{
+    size_t block = FramePool::kMinBlock;
+    size_t cls = 0;
+    while (block < size && cls < kClasses)
+    {
+        block <<= 1;
+        ++cls;
+    }
+    return cls;
+}
+
+// 文件描述符的 RAII 包装
+struct Fd
+{
+    int fd;
+    explicit Fd(int f) : fd(f) {}
+    ~Fd()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+};
+} // namespace
+
+void *FramePool::Allocate(size_t size)
+{
+    size_t cls = ClassOf(size);
+    if (cls < kClasses && !t_pool.free[cls].empty())
+    {
+        void *p = t_pool.free[cls].back();
+        t_pool.free[cls].pop_back();
+        ++t_pool.stats.pooled;
+        return p;
+    }
+    ++t_pool.stats.fresh;
+    return ::operator new(cls < kClasses ? kMinBlock << cls : size);
+}
+
+void FramePool::Deallocate(void *p, size_t size)
+{
+    // 在其他线程释放的帧进入该线程的空闲链：块大小只由级别决定，归属哪个线程都一样
+    size_t cls = ClassOf(size);
+    if (cls < kClasses && t_pool.free[cls].size() < kMaxFreePerClass)
+    {
+        t_pool.free[cls].push_back(p);
+        return;
+    }
+    ::operator delete(p);
+}
+
+FramePool::Stats FramePool::ThreadStats() { return t_pool.stats; }
+
+std::string ReadFileBlocking(const std::string &path, uint64_t offset, size_t length)
+{
+    Fd f(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (f.fd < 0)
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    std::string out(length, '\0');
+    size_t done = 0;
+    while (done < length)
+    {
+        ssize_t n = ::pread(f.fd, &out[done], length - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            throw std::system_error(errno, std::generic_category(), "read " + path);
+        if (n == 0)
+            break;
+        done += static_cast<size_t>(n);
+    }
+    out.resize(done);
+    return out;
+}
+
+size_t WriteFileBlocking(const std::string &path, uint64_t offset, const std::string &data)
+{
+    Fd f(::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644));
+    if (f.fd < 0)
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = ::pwrite(f.fd, data.data() + done, data.size() - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            throw std::system_error(errno, std::generic_category(), "write " + path);
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
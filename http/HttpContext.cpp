@@ -6,13 +6,13 @@
 #include <cstring>
 
 HttpContext::HttpContext()
-    : request_(std::make_shared<HttpRequest>()), state_(HttpRequestParseState::START) {}
+    : arena_(arena_buffer_, sizeof(arena_buffer_)), request_(&arena_), state_(HttpRequestParseState::START) {}
 
 HttpContext::~HttpContext() = default;
 
 HttpRequest *HttpContext::GetRequest()
 {
-    return request_.get();
+    return &request_;
 }
 
 bool HttpContext::GetCompleteRequest()
@@ -22,7 +22,8 @@ bool HttpContext::GetCompleteRequest()
 
 void HttpContext::ResetContextStatus()
 {
-    request_.reset(new HttpRequest());
+    request_.Reset();
+    arena_.release(); // Reset 之后请求不再引用 arena 中的内存
     state_ = HttpRequestParseState::START;
     deferred_response_.reset();
     headers_complete_ = false;
@@ -30,6 +31,10 @@ void HttpContext::ResetContextStatus()
     chunked_ = false;
     content_length_ = 0;
     received_body_bytes_ = 0;
+    header_bytes_ = 0; // 头部上限按单个请求计算，keep-alive 连接上不能累加
+    body_admitted_ = false;
+    precheck_pending_ = false;
+    request_start_ = 0;
     chunk_state_ = ChunkState::SIZE;
     current_chunk_size_ = 0;
     chunk_size_buf_.clear();
@@ -52,14 +57,14 @@ bool HttpContext::ParseRequest(const char *begin, int size)
                 if (isupper(ch)) { state_ = HttpRequestParseState::METHOD; start = end; } else state_ = HttpRequestParseState::INVALID; }
             break;
         case HttpRequestParseState::METHOD:
-            if (isblank(ch)) { request_->SetMethod(std::string(start, end)); state_ = HttpRequestParseState::BEFORE_URL; start = end + 1; }
+            if (isblank(ch)) { request_.SetMethod(std::string_view(start, end - start)); state_ = HttpRequestParseState::BEFORE_URL; start = end + 1; }
             break;
         case HttpRequestParseState::BEFORE_URL:
             if (ch == '/') { state_ = HttpRequestParseState::IN_URL; start = end; }
             else if (!isblank(ch)) state_ = HttpRequestParseState::INVALID; break;
         case HttpRequestParseState::IN_URL:
-            if (ch == '?') { request_->SetUrl(std::string(start, end)); start = end + 1; state_ = HttpRequestParseState::BEFORE_URL_PARAM_KEY; }
-            else if (isblank(ch)) { request_->SetUrl(std::string(start, end)); start = end + 1; state_ = HttpRequestParseState::BEFORE_PROTOCOL; }
+            if (ch == '?') { request_.SetUrl(std::string_view(start, end - start)); start = end + 1; state_ = HttpRequestParseState::BEFORE_URL_PARAM_KEY; }
+            else if (isblank(ch)) { request_.SetUrl(std::string_view(start, end - start)); start = end + 1; state_ = HttpRequestParseState::BEFORE_PROTOCOL; }
             break;
         case HttpRequestParseState::BEFORE_URL_PARAM_KEY:
             if (ch == CR || ch == LF || isblank(ch)) state_ = HttpRequestParseState::INVALID; else state_ = HttpRequestParseState::URL_PARAM_KEY; break;
@@ -69,17 +74,17 @@ bool HttpContext::ParseRequest(const char *begin, int size)
         case HttpRequestParseState::BEFORE_URL_PARAM_VALUE:
             if (ch == CR || ch == LF || isblank(ch)) state_ = HttpRequestParseState::INVALID; else state_ = HttpRequestParseState::URL_PARAM_VALUE; break;
         case HttpRequestParseState::URL_PARAM_VALUE:
-            if (ch == '&') { request_->SetRequestParams(std::string(start, colon), std::string(colon + 1, end)); start = end + 1; state_ = HttpRequestParseState::BEFORE_URL_PARAM_KEY; }
-            else if (isblank(ch)) { request_->SetRequestParams(std::string(start, colon), std::string(colon + 1, end)); start = end + 1; state_ = HttpRequestParseState::BEFORE_PROTOCOL; }
+            if (ch == '&') { request_.SetRequestParams(std::string_view(start, colon - start), std::string_view(colon + 1, end - (colon + 1))); start = end + 1; state_ = HttpRequestParseState::BEFORE_URL_PARAM_KEY; }
+            else if (isblank(ch)) { request_.SetRequestParams(std::string_view(start, colon - start), std::string_view(colon + 1, end - (colon + 1))); start = end + 1; state_ = HttpRequestParseState::BEFORE_PROTOCOL; }
             break;
         case HttpRequestParseState::BEFORE_PROTOCOL:
             if (!isblank(ch)) { state_ = HttpRequestParseState::PROTOCOL; start = end; } break;
         case HttpRequestParseState::PROTOCOL:
-            if (ch == '/') { request_->SetProtocol(std::string(start, end)); start = end + 1; state_ = HttpRequestParseState::BEFORE_VERSION; } break;
+            if (ch == '/') { request_.SetProtocol(std::string_view(start, end - start)); start = end + 1; state_ = HttpRequestParseState::BEFORE_VERSION; } break;
         case HttpRequestParseState::BEFORE_VERSION:
             if (isdigit(ch)) { state_ = HttpRequestParseState::VERSION; start = end; } else state_ = HttpRequestParseState::INVALID; break;
         case HttpRequestParseState::VERSION:
-            if (ch == CR) { request_->SetVersion(std::string(start, end)); start = end + 1; state_ = HttpRequestParseState::WHEN_CR; }
+            if (ch == CR) { request_.SetVersion(std::string_view(start, end - start)); start = end + 1; state_ = HttpRequestParseState::WHEN_CR; }
             else if (!(ch == '.' || isdigit(ch))) state_ = HttpRequestParseState::INVALID_VERSION; break;
         case HttpRequestParseState::WHEN_CR:
             if (ch == LF) { state_ = HttpRequestParseState::CR_LF; start = end + 1; } else state_ = HttpRequestParseState::INVALID; break;
@@ -90,15 +95,16 @@ bool HttpContext::ParseRequest(const char *begin, int size)
             if (ch == ':') { colon = end; state_ = HttpRequestParseState::HEADER_VALUE; }
             break;
         case HttpRequestParseState::HEADER_VALUE:
-            if (ch == CR) { request_->AddHeader(std::string(start, colon), std::string(colon + 2, end)); start = end + 1; state_ = HttpRequestParseState::WHEN_CR; }
+            if (ch == CR) { request_.AddHeader(std::string_view(start, colon - start), std::string_view(colon + 2, end - (colon + 2))); start = end + 1; state_ = HttpRequestParseState::WHEN_CR; }
             break;
         case HttpRequestParseState::CR_LF_CR:
             if (ch == LF) {
                 headers_complete_ = true;
                 // 判断 body 模式
-                auto &hs = request_->GetHeaders();
-                if (hs.count("Transfer-Encoding") && hs.at("Transfer-Encoding") == "chunked") { chunked_ = true; state_ = HttpRequestParseState::BODY; }
-                else if (hs.count("Content-Length")) { content_length_ = static_cast<size_t>(::atoll(request_->GetHeader("Content-Length").c_str())); if (content_length_ > 0) state_ = HttpRequestParseState::BODY; else { body_complete_ = true; state_ = HttpRequestParseState::COMPLETE; } }
+                auto &hs = request_.GetHeaders();
+                auto te = hs.find("Transfer-Encoding");
+                if (te != hs.end() && te->second == "chunked") { chunked_ = true; state_ = HttpRequestParseState::BODY; }
+                else if (hs.count("Content-Length")) { content_length_ = static_cast<size_t>(::atoll(request_.GetHeader("Content-Length").c_str())); if (content_length_ > 0) state_ = HttpRequestParseState::BODY; else { body_complete_ = true; state_ = HttpRequestParseState::COMPLETE; } }
                 else { // 无长度：假定无 body
                     body_complete_ = true; state_ = HttpRequestParseState::COMPLETE;
                 }
@@ -107,7 +113,7 @@ bool HttpContext::ParseRequest(const char *begin, int size)
             // 剩余全部视作 body 一次性吸收（兼容旧调用）
             {
                 size_t body_len = static_cast<size_t>(begin + size - end);
-                if (body_len) request_->AppendBody(end, body_len);
+                if (body_len) request_.AppendBody(end, body_len);
                 received_body_bytes_ += body_len;
                 if (chunked_) { body_complete_ = true; } // 旧接口不支持增量 chunk 直接标记完成
                 else if (received_body_bytes_ >= content_length_) { body_complete_ = true; }
@@ -174,32 +180,31 @@ bool HttpContext::ParseIncremental(const char* data, size_t len, size_t &consume
             if (lineLen > limits_.max_header_line_len) { state_ = HttpRequestParseState::INVALID_HEADER; return false; }
             header_bytes_ += lineLen + 2;
             if (header_bytes_ > limits_.max_header_bytes) { state_ = HttpRequestParseState::INVALID_HEADER; return false; }
-            std::string line(lineStart, lineLen);
+            std::string_view line(lineStart, lineLen);
             consumedBytes += lineLen + 2;
             if (state_ == HttpRequestParseState::START) state_ = HttpRequestParseState::METHOD;
             if (line.empty()) {
                 headers_complete_ = true;
-                auto &hs = request_->GetHeaders();
-                if (hs.count("Transfer-Encoding") && hs.at("Transfer-Encoding") == "chunked") { chunked_ = true; }
-                else if (hs.count("Content-Length")) { content_length_ = static_cast<size_t>(::atoll(request_->GetHeader("Content-Length").c_str())); }
+                auto &hs = request_.GetHeaders();
+                auto te = hs.find("Transfer-Encoding");
+                if (te != hs.end() && te->second == "chunked") { chunked_ = true; }
+                else if (hs.count("Content-Length")) { content_length_ = static_cast<size_t>(::atoll(hs.find("Content-Length")->second.c_str())); }
                 if ((!chunked_ && content_length_ == 0)) { body_complete_ = true; state_ = HttpRequestParseState::COMPLETE; }
                 break;
             }
-            if (request_->GetMethod() == HttpMethod::kInvalid) {
-                size_t p1 = line.find(' '); if (p1 == std::string::npos) { state_ = HttpRequestParseState::INVALID; return false; }
-                size_t p2 = line.find(' ', p1 + 1); if (p2 == std::string::npos) { state_ = HttpRequestParseState::INVALID; return false; }
-                request_->SetMethod(line.substr(0, p1));
-                request_->SetUrl(line.substr(p1 + 1, p2 - p1 - 1));
-                std::string proto = line.substr(p2 + 1);
-                if (proto.rfind("HTTP/", 0) == 0) request_->SetVersion(proto.substr(5));
+            if (request_.GetMethod() == HttpMethod::kInvalid) {
+                size_t p1 = line.find(' '); if (p1 == std::string_view::npos) { state_ = HttpRequestParseState::INVALID; return false; }
+                size_t p2 = line.find(' ', p1 + 1); if (p2 == std::string_view::npos) { state_ = HttpRequestParseState::INVALID; return false; }
+                request_.SetMethod(line.substr(0, p1));
+                request_.SetUrl(line.substr(p1 + 1, p2 - p1 - 1));
+                std::string_view proto = line.substr(p2 + 1);
+                if (proto.rfind("HTTP/", 0) == 0) request_.SetVersion(proto.substr(5));
             } else {
                 size_t colon = line.find(':');
-                if (colon == std::string::npos) { state_ = HttpRequestParseState::INVALID; return false; }
+                if (colon == std::string_view::npos) { state_ = HttpRequestParseState::INVALID; return false; }
                 size_t vstart = colon + 1;
                 while (vstart < line.size() && (line[vstart] == ' ' || line[vstart] == '\t')) ++vstart;
-                std::string key = line.substr(0, colon);
-                std::string value = line.substr(vstart);
-                request_->AddHeader(key, value);
+                request_.AddHeader(line.substr(0, colon), line.substr(vstart));
             }
         }
     }
@@ -222,7 +227,7 @@ bool HttpContext::ParseBodyBlock(const char* data, size_t len, size_t &consumed)
     size_t need = content_length_ - received_body_bytes_;
     size_t take = std::min(need, len);
     if (take) {
-        request_->AppendBody(data, take);
+        request_.AppendBody(data, take);
         received_body_bytes_ += take;
     }
     consumed = take;
@@ -251,7 +256,7 @@ bool HttpContext::ParseChunkedBlock(const char* data, size_t len, size_t &consum
         case ChunkState::DATA: {
             size_t remain = current_chunk_size_;
             size_t take = std::min(remain, len - consumed);
-            request_->AppendBody(data + consumed, take);
+            request_.AppendBody(data + consumed, take);
             current_chunk_size_ -= take;
             consumed += take;
             if (current_chunk_size_ == 0) chunk_state_ = ChunkState::DATA_CR;
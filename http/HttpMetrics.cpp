@@ -0,0 +1,37 @@
+#include "HttpMetrics.h"
+#include <map>
+#include <mutex>
+
+RouteMetrics::RouteMetrics(const std::string &method, const std::string &route)
+{
+    static const char *kClasses[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+    for (int i = 0; i < 5; ++i)
+        latency_[i] = Metrics::GetHistogram("http_request_duration_seconds", "HTTP request latency from first byte to response queued",
+                                            {{"method", method}, {"route", route}, {"code", kClasses[i]}});
+}
+
+const RouteMetrics *RouteMetrics::Get(const std::string &method, const std::string &route)
+{
+    static std::mutex mutex;
+    static std::map<std::string, RouteMetrics *> *routes = new std::map<std::string, RouteMetrics *>();
+    std::lock_guard<std::mutex> lock(mutex);
+    RouteMetrics *&found = (*routes)[method + " " + route];
+    if (!found)
+        found = new RouteMetrics(method, route);
+    return found;
+}
+
+const RouteMetrics *RouteMetrics::Unmatched()
+{
+    static const RouteMetrics *unmatched = Get("", "unmatched");
+    return unmatched;
+}
+
+const HttpTrafficMetrics &HttpTrafficMetrics::Get()
+{
+    static const HttpTrafficMetrics traffic{
+        Metrics::GetCounter("http_received_bytes_total", "Bytes of HTTP requests parsed"),
+        Metrics::GetCounter("http_sent_bytes_total", "Bytes of HTTP responses queued for sending"),
+    };
+    return traffic;
+}
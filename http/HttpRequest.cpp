@@ -3,11 +3,52 @@
 #include <string>
 #include <algorithm>
 
-HttpRequest::HttpRequest():method_(HttpMethod::kInvalid), version_(HttpVersion::kUnknown) {}
+HttpRequest::HttpRequest() : HttpRequest(std::pmr::get_default_resource()) {}
+
+HttpRequest::HttpRequest(std::pmr::memory_resource *resource)
+    : method_(HttpMethod::kInvalid), version_(HttpVersion::kUnknown),
+      query_params_multi_(resource), path_params_(resource), request_params_(resource), headers_(resource)
+{
+}
 
 HttpRequest::~HttpRequest() {}
 
-void HttpRequest::SetMethod(const std::string &method) 
+void HttpRequest::Reset()
+{
+    static const size_t kMaxRetainedBody = 64 * 1024; // 更大的请求体不保留容量
+
+    has_range_ = false;
+    range_start_ = 0;
+    range_end_ = -1;
+    range_suffix_ = false;
+    method_ = HttpMethod::kInvalid;
+    version_ = HttpVersion::kUnknown;
+    url_.clear();
+    raw_query_.clear();
+    protocol_.clear();
+    route_ = nullptr;
+    if (body_.capacity() > kMaxRetainedBody)
+        std::string().swap(body_);
+    else
+        body_.clear();
+    // map 清空后不再持有任何节点，resource 可以随后整体释放
+    query_params_multi_.clear();
+    path_params_.clear();
+    request_params_.clear();
+    headers_.clear();
+}
+
+// 有则覆盖，无则插入；键与值都在 map 的 resource 上构造
+static void Assign(HttpRequest::StringMap &map, std::string_view key, std::string_view value)
+{
+    auto it = map.find(key);
+    if (it != map.end())
+        it->second.assign(value.data(), value.size());
+    else
+        map.emplace(key, value);
+}
+
+void HttpRequest::SetMethod(std::string_view method) 
 {
     method_ = HttpMethod::kInvalid; // 默认无效
     if (method == "GET") 
@@ -20,6 +61,8 @@ void HttpRequest::SetMethod(const std::string &method)
         method_ = HttpMethod::kPut;
     else if (method == "DELETE")
         method_ = HttpMethod::kDelete;
+    else if (method == "PATCH")
+        method_ = HttpMethod::kPatch;
 }
 
 HttpMethod HttpRequest::GetMethod() const 
@@ -41,11 +84,13 @@ std::string HttpRequest::GetMethodString() const
         method = "PUT";
     else if (method_ == HttpMethod::kDelete)
         method = "DELETE"; 
+    else if (method_ == HttpMethod::kPatch)
+        method = "PATCH";
     
     return method.empty() ? "INVALID" : method;
 }
 
-void HttpRequest::SetVersion(const std::string &ver)
+void HttpRequest::SetVersion(std::string_view ver)
 {
     version_ = HttpVersion::kUnknown; // 默认未知
     if (ver == "1.0")
@@ -73,16 +118,16 @@ std::string HttpRequest::GetVersionString() const
     return ver;
 }
 
-void HttpRequest::SetUrl(const std::string &url)
+void HttpRequest::SetUrl(std::string_view url)
 {
     // 拆分 ? 之前为 path, 之后为 query
     auto pos = url.find('?');
-    if (pos == std::string::npos) {
-        url_ = url;
+    if (pos == std::string_view::npos) {
+        url_.assign(url.data(), url.size());
         raw_query_.clear();
     } else {
-        url_ = url.substr(0, pos);
-        raw_query_ = url.substr(pos + 1);
+        url_.assign(url.data(), pos);
+        raw_query_.assign(url.data() + pos + 1, url.size() - pos - 1);
     }
     // 清空旧查询参数并重新解析
     query_params_multi_.clear();
@@ -98,50 +143,55 @@ const std::string &HttpRequest::GetUrl() const
 
 const std::string &HttpRequest::GetRawQuery() const { return raw_query_; }
 
-std::string HttpRequest::GetQueryValue(const std::string &key) const {
+std::string HttpRequest::GetQueryValue(std::string_view key) const {
     auto it = query_params_multi_.find(key);
-    if (it != query_params_multi_.end() && !it->second.empty()) return it->second.front();
+    if (it != query_params_multi_.end() && !it->second.empty()) return std::string(it->second.front());
     return {};
 }
-const std::vector<std::string> &HttpRequest::GetQueryValues(const std::string &key) const {
-    static const std::vector<std::string> kEmpty;
+const HttpRequest::StringList &HttpRequest::GetQueryValues(std::string_view key) const {
+    static const StringList kEmpty;
     auto it = query_params_multi_.find(key);
     if (it != query_params_multi_.end()) return it->second;
     return kEmpty;
 }
-const std::map<std::string, std::vector<std::string>> &HttpRequest::GetQueryParamMap() const { return query_params_multi_; }
+const HttpRequest::QueryMap &HttpRequest::GetQueryParamMap() const { return query_params_multi_; }
 
-void HttpRequest::SetPathParam(const std::string& key, const std::string& value) { path_params_[key] = value; }
-void HttpRequest::SetPathParam(const std::map<std::string, std::string>& params) { path_params_ = params; }
-std::string HttpRequest::GetPathParam(const std::string& key) const 
+void HttpRequest::SetPathParam(std::string_view key, std::string_view value) { Assign(path_params_, key, value); }
+void HttpRequest::SetPathParam(const std::map<std::string, std::string>& params)
+{
+    path_params_.clear();
+    for (const auto &kv : params) path_params_.emplace(kv.first, kv.second);
+}
+void HttpRequest::ClearPathParams() { path_params_.clear(); }
+std::string HttpRequest::GetPathParam(std::string_view key) const 
 {
     auto it = path_params_.find(key);
-    if (it != path_params_.end()) return it->second;
+    if (it != path_params_.end()) return std::string(it->second);
     return {};
 }
-const std::map<std::string,std::string>& HttpRequest::GetPathParams() const { return path_params_; }
+const HttpRequest::StringMap &HttpRequest::GetPathParams() const { return path_params_; }
 
-void HttpRequest::SetRequestParams(const std::string &key, const std::string &value) 
+void HttpRequest::SetRequestParams(std::string_view key, std::string_view value) 
 {
-    request_params_[key] = value; // 使用map存储参数
+    Assign(request_params_, key, value); // 使用map存储参数
 }
 
-std::string HttpRequest::GetRequestValue(const std::string &key) const 
+std::string HttpRequest::GetRequestValue(std::string_view key) const 
 {
     auto it = request_params_.find(key);
     if (it != request_params_.end())
-        return it->second;
+        return std::string(it->second);
     return {};
 }
 
-const std::map<std::string, std::string> &HttpRequest::GetRequestParams() const 
+const HttpRequest::StringMap &HttpRequest::GetRequestParams() const 
 {
     return request_params_;
 }
 
-void HttpRequest::SetProtocol(const std::string &str) 
+void HttpRequest::SetProtocol(std::string_view str) 
 {
-    protocol_ = str; // 设置协议字符串
+    protocol_.assign(str.data(), str.size()); // 设置协议字符串
 }
 
 const std::string &HttpRequest::GetProtocol() const 
@@ -149,20 +199,20 @@ const std::string &HttpRequest::GetProtocol() const
     return protocol_;
 }
 
-void HttpRequest::AddHeader(const std::string &field, const std::string &value) 
+void HttpRequest::AddHeader(std::string_view field, std::string_view value) 
 {
-    headers_[field] = value; // 添加请求头
+    Assign(headers_, field, value); // 添加请求头
 }
 
-std::string HttpRequest::GetHeader(const std::string &field) const 
+std::string HttpRequest::GetHeader(std::string_view field) const 
 {
     auto it = headers_.find(field); 
     if (it != headers_.end())
-        return it->second;
+        return std::string(it->second);
     return {};
 }
 
-const std::map<std::string, std::string> &HttpRequest::GetHeaders() const 
+const HttpRequest::StringMap &HttpRequest::GetHeaders() const 
 {
     return headers_;
 }
@@ -182,11 +232,11 @@ void HttpRequest::AppendBody(const char* data, size_t len)
     if (data && len) body_.append(data, len);
 }
 
-// URL Decode 实现（处理 %XX 与 + -> space）
-std::string HttpRequest::UrlDecode(const std::string &src)
+// URL Decode 实现（处理 %XX 与 + -> space），解码结果追加到 out
+template <typename Str>
+static void UrlDecodeTo(std::string_view src, Str &out)
 {
-    std::string out;
-    out.reserve(src.size());
+    out.reserve(out.size() + src.size());
     for (size_t i = 0; i < src.size(); ++i) {
         unsigned char c = static_cast<unsigned char>(src[i]);
         if (c == '+') { out.push_back(' '); }
@@ -209,29 +259,41 @@ std::string HttpRequest::UrlDecode(const std::string &src)
             out.push_back(static_cast<char>(c));
         }
     }
+}
+
+std::string HttpRequest::UrlDecode(const std::string &src)
+{
+    std::string out;
+    UrlDecodeTo(src, out);
     return out;
 }
 
-void HttpRequest::AddQueryParam(const std::string &key, const std::string &value)
+void HttpRequest::AddQueryParam(std::string_view key, std::string_view value)
 {
-    query_params_multi_[key].push_back(value);
+    auto it = query_params_multi_.find(key);
+    if (it == query_params_multi_.end())
+        it = query_params_multi_.emplace(key, StringList()).first;
+    it->second.emplace_back(value);
 }
 
 void HttpRequest::ParseQueryString()
 {
+    // 解码结果直接构造在 arena 上，不经过临时 std::string
+    std::pmr::memory_resource *resource = query_params_multi_.get_allocator().resource();
+    std::string_view query(raw_query_);
     size_t start = 0;
-    while (start < raw_query_.size()) {
-        size_t amp = raw_query_.find('&', start);
-        if (amp == std::string::npos) amp = raw_query_.size();
-        std::string pair = raw_query_.substr(start, amp - start);
+    while (start < query.size()) {
+        size_t amp = query.find('&', start);
+        if (amp == std::string_view::npos) amp = query.size();
+        std::string_view pair = query.substr(start, amp - start);
         if (!pair.empty()) {
             size_t eq = pair.find('=');
-            std::string key, value;
-            if (eq == std::string::npos) {
-                key = UrlDecode(pair);
+            String key(resource), value(resource);
+            if (eq == std::string_view::npos) {
+                UrlDecodeTo(pair, key);
             } else {
-                key = UrlDecode(pair.substr(0, eq));
-                value = UrlDecode(pair.substr(eq + 1));
+                UrlDecodeTo(pair.substr(0, eq), key);
+                UrlDecodeTo(pair.substr(eq + 1), value);
             }
             if (!key.empty()) AddQueryParam(key, value);
         }
@@ -253,7 +315,7 @@ bool HttpRequest::ExtractPathParams(const std::string &pattern)
         const std::string &seg = pathSegs[i];
         if (!p.empty() && p[0]==':') {
             std::string key = p.substr(1);
-            path_params_[key] = seg; // 覆盖旧值
+            Assign(path_params_, key, seg); // 覆盖旧值
         } else if (p != seg) {
             return false;
         }
@@ -267,7 +329,7 @@ bool HttpRequest::ParseRangeHeader()
     has_range_ = false; range_start_ = 0; range_end_ = -1; range_suffix_ = false;
     auto it = headers_.find("Range");
     if (it == headers_.end()) return false;
-    const std::string& val = it->second;
+    std::string val(it->second);
     if (val.size() < 6 || val.substr(0,6) != "bytes=") return false;
     std::string spec = val.substr(6);
     auto dash = spec.find('-');
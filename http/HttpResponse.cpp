@@ -1,7 +1,7 @@
 #include "HttpResponse.h"
 #include "Buffer.h"
 
-HttpResponse::HttpResponse(bool close_connection) : status_code_(HttpStatusCode::Unknown), close_connection_(close_connection), content_length_(0), filefd_(-1) {}
+HttpResponse::HttpResponse(bool close_connection) : status_code_(HttpStatusCode::Unknown), close_connection_(close_connection), content_length_(0), filefd_(-1), body_type_(HTML_TYPE) {}
 
 HttpResponse::~HttpResponse() {}
 
@@ -10,6 +10,11 @@ void HttpResponse::SetStatusCode(HttpStatusCode status_code)
     status_code_ = status_code;
 }
 
+HttpStatusCode HttpResponse::GetStatusCode() const
+{
+    return status_code_;
+}
+
 void HttpResponse::SetStatusMessage(const std::string &status_message)
 {
     status_message_ = status_message;
@@ -30,9 +35,9 @@ void HttpResponse::SetContentType(const std::string &content_type)
     AddHeader("Content-Type", content_type);
 }
 
-void HttpResponse::SetContentLength(const int &len)
+void HttpResponse::SetContentLength(long long len)
 {
-    content_length_ = std::move(len);
+    content_length_ = len;
 }
 
 void HttpResponse::AddHeader(const std::string &key, const std::string &value)
@@ -45,7 +50,7 @@ bool HttpResponse::IsCloseConnection()
     return close_connection_;
 }   
 
-int HttpResponse::GetContentLength()
+long long HttpResponse::GetContentLength()
 {
     return content_length_;
 }
@@ -63,6 +68,20 @@ HttpBodyType HttpResponse::GetBodyType()
 void HttpResponse::SetFileFd(int filefd)
 {
     filefd_ = std::move(filefd);
+    file_owner_.reset();
+}
+
+void HttpResponse::SetSharedBody(std::shared_ptr<const std::string> body)
+{
+    body_type_ = BUFFER_TYPE;
+    content_length_ = static_cast<long long>(body->size());
+    shared_body_ = std::move(body);
+}
+
+void HttpResponse::SetSharedFile(int filefd, std::shared_ptr<const void> owner)
+{
+    filefd_ = filefd;
+    file_owner_ = std::move(owner);
 }
 
 void HttpResponse::SetBodyType(HttpBodyType bodytype)
@@ -117,22 +136,28 @@ void HttpResponse::AppendToBuffer(Buffer* out) const
         switch (status_code_) {
             case HttpStatusCode::OK: statusMsg = "OK"; break;
             case HttpStatusCode::PartialContent: statusMsg = "Partial Content"; break;
+            case HttpStatusCode::NotModified: statusMsg = "Not Modified"; break;
             case HttpStatusCode::BadRequest: statusMsg = "Bad Request"; break;
             case HttpStatusCode::NotFound: statusMsg = "Not Found"; break;
             case HttpStatusCode::Forbidden: statusMsg = "Forbidden"; break;
+            case HttpStatusCode::PayloadTooLarge: statusMsg = "Payload Too Large"; break;
             case HttpStatusCode::RangeNotSatisfiable: statusMsg = "Range Not Satisfiable"; break;
+            case HttpStatusCode::ExpectationFailed: statusMsg = "Expectation Failed"; break;
+            case HttpStatusCode::TooManyRequests: statusMsg = "Too Many Requests"; break;
             case HttpStatusCode::InternalServerError: statusMsg = "Internal Server Error"; break;
+            case HttpStatusCode::ServiceUnavailable: statusMsg = "Service Unavailable"; break;
+            case HttpStatusCode::InsufficientStorage: statusMsg = "Insufficient Storage"; break;
             default: statusMsg = ""; break;
         }
     }
     head += "HTTP/1.1 " + std::to_string(status_code_) + " " + statusMsg + "\r\n";
     if (close_connection_) head += "Connection: close\r\n"; else head += "Connection: Keep-Alive\r\n";
-    // 若未显式 Content-Length 且非关闭连接，则计算
+    // 未显式设置 Content-Length 时按 body_ 计算；关闭连接的响应也给出长度，客户端无需等待 EOF 判断结束
     if (!has_range_) {
-        if (!close_connection_ && content_length_ == 0 && !body_.empty())
-            head += "Content-Length: " + std::to_string(body_.size()) + "\r\n";
-        else if (content_length_ > 0)
+        if (content_length_ > 0)
             head += "Content-Length: " + std::to_string(content_length_) + "\r\n";
+        else // 空文件也要输出 0
+            head += "Content-Length: " + std::to_string(body_.size()) + "\r\n";
     } else {
         std::string cr = "bytes " + std::to_string(range_start_) + "-" + std::to_string(range_end_);
         if (total_length_ >= 0) cr += "/" + std::to_string(total_length_); else cr += "/*";
@@ -7,7 +7,14 @@
 #include "HttpContext.h"
 #include "CurrentThread.h"
 #include "Logger.h"
+#include "Buffer.h"
+#include "BlockingExecutor.h"
+#include "HttpMetrics.h"
+#include "RateLimiter.h"
+#include <cmath>
+#include "Metrics.h"
 #include <arpa/inet.h>
+#include <strings.h>
 #include <iostream>
 #include <fstream>
 
@@ -15,10 +22,8 @@ bool HttpServer::HttpDefaultCallBack(const std::shared_ptr<Connection> &conn, co
 {
     resp->SetStatusCode(HttpStatusCode::NotFound);
     resp->SetStatusMessage("Not Found");
-    resp->SetCloseConnection(true);
     resp->SetBodyType(HTML_TYPE);
     resp->SetBody("404 Not Found\n");
-    resp->SetContentLength(13);
     resp->SetContentType("text/plain; charset=utf-8");
     return true;
 }
@@ -31,12 +36,60 @@ HttpServer::HttpServer(EventLoop *loop, const char *ip, const int port, bool aut
     server_->setMessageCallback(std::bind(&HttpServer::onMessage, this, std::placeholders::_1));
     SetHttpCallback(std::bind(&HttpServer::HttpDefaultCallBack, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
     router_ = std::make_unique<RouteTrie>();
+    streamingFilter_ = [](const HttpRequest &req) { return req.GetMethod() == HttpMethod::kPost && req.GetUrl() == "/upload"; };
 }
 
-HttpServer::~HttpServer() {}
+HttpServer::~HttpServer()
+{
+    if (metricsCollector_)
+        Metrics::RemoveCollector(metricsCollector_);
+    executor_.reset();
+}
 
 void HttpServer::SetHttpCallback(const HttpResponseCallback &cb) { responseCallback_ = std::move(cb); }
 
+void HttpServer::SetBodyStreamingFilter(const BodyStreamingFilter &filter) { streamingFilter_ = filter; }
+
+void HttpServer::SetBodyPrecheck(const BodyPrecheck &check) { bodyPrecheck_ = check; }
+
+void HttpServer::EnableMetrics(const std::string &path)
+{
+    metricsPath_ = path;
+    if (metricsCollector_)
+        return;
+    metricsCollector_ = Metrics::AddCollector([this](Metrics::Writer &writer) {
+        std::vector<EventLoop *> loops = server_->GetLoops();
+        for (size_t i = 0; i < loops.size(); ++i)
+        {
+            Metrics::Labels labels{{"loop", std::to_string(i)}}; // 0 为主事件循环
+            writer.Gauge("event_loop_connections", "Connections currently owned by the event loop", labels, loops[i]->ConnectionCount());
+            writer.Gauge("event_loop_pending_tasks", "Tasks queued to the event loop and not yet run", labels, static_cast<double>(loops[i]->PendingTasks()));
+        }
+        if (!executor_)
+            return;
+        writer.Gauge("blocking_queue_depth", "Tasks waiting for a blocking executor thread", {}, static_cast<double>(executor_->QueueDepth()));
+        writer.Gauge("blocking_queue_capacity", "Maximum queued tasks before requests get 503", {}, static_cast<double>(executor_->MaxQueue()));
+        for (const auto &kv : executor_->GetStats())
+        {
+            Metrics::Labels labels{{"task", kv.first}};
+            writer.Counter("blocking_tasks_executed_total", "Blocking tasks started", labels, static_cast<double>(kv.second.executed));
+            writer.Counter("blocking_tasks_rejected_total", "Blocking tasks rejected because the queue was full", labels, static_cast<double>(kv.second.rejected));
+            writer.Counter("blocking_task_wait_seconds_total", "Total time blocking tasks spent queued", labels, kv.second.totalWaitMs / 1000);
+        }
+    });
+}
+
+RateLimiter *HttpServer::EnableRateLimit(size_t maxBuckets, double evictSeconds)
+{
+    if (!limiter_)
+    {
+        limiter_ = std::make_unique<RateLimiter>(maxBuckets);
+        RateLimiter *limiter = limiter_.get();
+        loop_->RunEvery(evictSeconds, [limiter]() { limiter->Evict(RateLimiter::Now()); });
+    }
+    return limiter_.get();
+}
+
 void HttpServer::SetOnConnectionCallback(const std::function<void(const ConnectionPtr &)> &cb) { onConnectionCallback_ = cb; }
 
 void HttpServer::start() { server_->start(); }
@@ -58,22 +111,42 @@ void HttpServer::onMessage(const ConnectionPtr &conn)
             context = std::make_shared<HttpContext>();
             conn->SetContext(context);
         }
+        // 上一个请求的异步响应尚未发送、或请求体预检尚未完成，暂不解析
+        if (context->HasDeferredResponse() || context->PrecheckPending()) return;
         // 支持 HTTP pipelining: 循环解析缓冲中的多个请求
         while (true) {
+            // 上一个响应的正文还在 sendfile/分段发送，下一个响应只能排在它之后：暂停读取，写完后再解析
+            if (conn->SendingBody()) {
+                ResumeReading(conn);
+                return;
+            }
             if (!context->HeadersComplete() || !context->BodyComplete()) {
+                // 延迟从请求的第一个字节开始计算（不含 keep-alive 连接上的空闲时间）
+                if (context->RequestStart() == 0 && conn->GetReadBuffer()->GetReadablebytes() > 0)
+                    context->SetRequestStart(Metrics::NowNanos());
                 size_t consumed = 0;
                 if (!context->ParseIncremental(conn->GetReadBuffer()->Peek(), conn->GetReadBuffer()->GetReadablebytes(), consumed)) {
-                    conn->Send("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
-                    conn->HandleClose();
+                    conn->Send("HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+                    CloseAfterWrite(conn);
                     return;
                 }
-                if (consumed) conn->GetReadBuffer()->Retrieve(consumed);
+                if (consumed) {
+                    conn->GetReadBuffer()->Retrieve(consumed);
+                    HttpTrafficMetrics::Get().received.Inc(consumed);
+                }
+
+                // 请求体未到齐：先预检，客户端带 Expect: 100-continue 时据此决定是否让它发送请求体
+                // 流式请求即使请求体随头部一起到齐也预检，业务回调据此不在 loop 线程上校验会话
+                if (context->HeadersComplete() && !context->BodyAdmitted() &&
+                    (!context->BodyComplete() || streamingFilter_(*context->GetRequest()))) {
+                    if (!AdmitBody(conn, *context)) return;
+                }
 
                 // 参考 WebMem: 头部完成但请求体未接收完，且达到阈值则先落盘（调用业务回调处理分片）
                 if (context->HeadersComplete() && !context->BodyComplete()) {
                     HttpRequest *req = context->GetRequest();
-                    // 仅对上传接口执行分片回调，避免影响其他 POST
-                    if (req && req->GetMethod() == HttpMethod::kPost && req->GetUrl() == "/upload") {
+                    // 仅对需要流式处理请求体的接口执行分片回调，避免影响其他 POST
+                    if (req && streamingFilter_(*req)) {
                         static const size_t kChunkThreshold = 1 * 1024 * 1024; // 1MB
                         size_t buffered = req->GetBody().size();
                         if (buffered >= kChunkThreshold) {
@@ -84,16 +157,20 @@ void HttpServer::onMessage(const ConnectionPtr &conn)
                                 // 让出本次 onMessage，后续数据到来再继续
                                 return;
                             }
-                            // 若同步处理完成，继续循环，等待更多数据或完整请求
+                            // 请求体尚未收完业务就给出了最终响应（鉴权失败、格式错误等），剩余的请求体无法再解析，回包后关闭连接
+                            tmpResp.SetCloseConnection(true);
+                            SendResponse(conn, tmpResp);
+                            return;
                         }
                     }
                 }
             }
             if (context->GetCompleteRequest()) 
             {
-                onRequest(conn, *context->GetRequest());
-                // 如果连接已被业务标记关闭则不再解析后续
-                if (conn->GetState() != connectionState::Connected) return;
+                // 响应要求关闭连接或连接已被业务关闭则不再解析后续
+                if (!onRequest(conn, *context->GetRequest()) || conn->GetState() != connectionState::Connected) return;
+                // 异步响应：由 SendDeferredResponse 发送后再重置上下文
+                if (context->HasDeferredResponse()) return;
                 context->ResetContextStatus();
                 // 若缓冲区尚有数据则继续下一轮；否则退出
                 if (conn->GetReadBuffer()->GetReadablebytes() == 0) break;
@@ -105,10 +182,113 @@ void HttpServer::onMessage(const ConnectionPtr &conn)
     }
 }
 
-void HttpServer::onRequest(const ConnectionPtr &conn, HttpRequest &request)
+bool HttpServer::WantsClose(const HttpRequest &request)
 {
     std::string connection_state = request.GetHeader("Connection");
-    bool Close = (connection_state == "close" || (request.GetVersion() == HttpVersion::kHttp10 && connection_state != "keep-alive")); // 是否关闭连接
+    return connection_state == "close" || (request.GetVersion() == HttpVersion::kHttp10 && connection_state != "keep-alive");
+}
+
+HttpResponse HttpServer::RateLimited(bool close, double retryAfter)
+{
+    HttpResponse resp = HttpResponse::MakeSimple(close, HttpStatusCode::TooManyRequests, "Too Many Requests", "429 Too Many Requests\n");
+    resp.AddHeader("Retry-After", std::to_string(static_cast<long long>(std::ceil(retryAfter))));
+    return resp;
+}
+
+bool HttpServer::AdmitBody(const ConnectionPtr &conn, HttpContext &context)
+{
+    context.SetBodyAdmitted();
+    HttpRequest &request = *context.GetRequest();
+    std::string expect = request.GetHeader("Expect");
+    bool expectContinue = strcasecmp(expect.c_str(), "100-continue") == 0;
+    HttpResponse resp(true); // 拒绝后请求体无法跳过，总是关闭连接
+    if (!expect.empty() && !expectContinue)
+    {
+        resp = HttpResponse::MakeSimple(true, HttpStatusCode::ExpectationFailed, "Expectation Failed", "417 Expectation Failed\n");
+        SendResponse(conn, resp);
+        return false;
+    }
+    double retryAfter = 0;
+    if (limiter_ && !limiter_->Admit(*conn, request, &retryAfter))
+    {
+        resp = RateLimited(true, retryAfter);
+        SendResponse(conn, resp);
+        return false;
+    }
+    if (bodyPrecheck_ && executor_)
+    {
+        // 预检会查会话（可能访问数据库）、statvfs，放到工作线程；期间暂停读取，完成后回到 loop 回 100 或拒绝
+        std::shared_ptr<HttpContext> ctx = conn->GetContext();
+        auto result = std::make_shared<HttpResponse>(true);
+        EventLoop *loop = conn->GetLoop();
+        bool queued = executor_->Submit("body precheck", [this, conn, ctx, &request, result, loop]() {
+            bool ok = false;
+            try
+            {
+                ok = bodyPrecheck_(conn, request, result.get());
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR << "body precheck failed: " << e.what();
+                *result = HttpResponse::MakeSimple(true, HttpStatusCode::InternalServerError, "Internal Server Error", "500 Internal Server Error\n");
+            }
+            loop->queueOneFunc([this, conn, ctx, ok, result]() { FinishPrecheck(conn, ctx, ok, *result); });
+        });
+        if (!queued)
+        {
+            LOG_WARN << "body precheck rejected: blocking queue full (" << executor_->MaxQueue() << ")";
+            resp = HttpResponse::MakeSimple(true, HttpStatusCode::ServiceUnavailable, "Service Unavailable", "503 Service Unavailable\n");
+            resp.AddHeader("Retry-After", "1");
+            SendResponse(conn, resp);
+            return false;
+        }
+        context.SetPrecheckPending(true);
+        conn->StopReading();
+        return false;
+    }
+    if (bodyPrecheck_ && !bodyPrecheck_(conn, request, &resp))
+    {
+        RejectBody(conn, request, resp);
+        return false;
+    }
+    ContinueBody(conn, request);
+    return true;
+}
+
+void HttpServer::FinishPrecheck(const ConnectionPtr &conn, const std::shared_ptr<HttpContext> &context, bool ok, HttpResponse &resp)
+{
+    // 等待期间连接已关闭（上下文被替换或清空）则丢弃结果
+    if (conn->GetState() != connectionState::Connected || conn->GetContext() != context || !context->PrecheckPending())
+        return;
+    context->SetPrecheckPending(false);
+    if (!ok)
+    {
+        RejectBody(conn, *context->GetRequest(), resp);
+        return;
+    }
+    ContinueBody(conn, *context->GetRequest());
+    // 请求体可能已在缓冲区中收齐，不能只等下一次读事件：恢复读取并直接继续解析
+    conn->StartReading();
+    onMessage(conn);
+}
+
+void HttpServer::ContinueBody(const ConnectionPtr &conn, HttpRequest &request)
+{
+    // HTTP/1.0 客户端不认识 1xx；已开始发送请求体的客户端不再需要 100，但多发一次无害
+    if (strcasecmp(request.GetHeader("Expect").c_str(), "100-continue") == 0 && request.GetVersion() == HttpVersion::kHttp11)
+        conn->Send("HTTP/1.1 100 Continue\r\n\r\n");
+}
+
+void HttpServer::RejectBody(const ConnectionPtr &conn, HttpRequest &request, HttpResponse &resp)
+{
+    LOG_INFO << "request body rejected before upload: " << request.GetMethodString() << " " << request.GetUrl();
+    resp.SetCloseConnection(true);
+    SendResponse(conn, resp);
+}
+
+bool HttpServer::onRequest(const ConnectionPtr &conn, HttpRequest &request)
+{
+    bool Close = WantsClose(request); // 是否关闭连接
 
     // // 处理文件上传的请求
     // if (request.GetHeader("Content-Type").find("multipart/form-data") != std::string::npos)
@@ -142,33 +322,83 @@ void HttpServer::onRequest(const ConnectionPtr &conn, HttpRequest &request)
     // }
 
     HttpResponse response(Close);
+    if (!metricsPath_.empty() && request.GetMethod() == HttpMethod::kGet && request.GetUrl() == metricsPath_)
+    {
+        request.SetRoute(RouteMetrics::Get("GET", metricsPath_));
+        response.SetStatusCode(HttpStatusCode::OK);
+        response.SetStatusMessage("OK");
+        response.SetContentType("text/plain; version=0.0.4; charset=utf-8");
+        response.SetBody(Metrics::Render());
+        return SendResponse(conn, response);
+    }
+    // 请求体未到齐时已在 AdmitBody 中计过一次
+    double retryAfter = 0;
+    if (limiter_ && !conn->GetContext()->BodyAdmitted() && !limiter_->Admit(*conn, request, &retryAfter))
+    {
+        response = RateLimited(Close, retryAfter);
+        return SendResponse(conn, response);
+    }
     bool done = responseCallback_(conn, request, &response); // true 表示同步返回
     auto context = conn->GetContext();
     if (!done) 
     {
         // 异步: 保存响应对象, 业务稍后填充后调用 SendDeferredResponse
+        // 期间暂停读取，后续请求留在内核缓冲中，不在读缓冲里无限堆积
         context->StoreDeferredResponse(response);
-        return;
+        conn->StopReading();
+        return true;
     }
+    return SendResponse(conn, response); // 同步回包
+}
 
-    // 同步回包
-    if(response.GetBodyType() == HttpBodyType::HTML_TYPE) {
-        conn->Send(response.GetMessage());
-    } 
-    else if(response.GetBodyType() == HttpBodyType::FILE_TYPE) {
-        conn->Send(response.GetBeforeBody());
-        if (response.HasRange()) {
-            off_t start = static_cast<off_t>(response.GetRangeStart());
-            size_t len = static_cast<size_t>(response.GetRangeEnd() - response.GetRangeStart() + 1);
-            conn->SendFileRange(response.GetFileFd(), start, len);
-        } 
-        else {
-            conn->SendFile(response.GetFileFd(), response.GetContentLength());
-        }
-        int ret = close(response.GetFileFd());
-        if (ret < 0) LOG_ERROR << "HttpServer::onRequest : close filefd failed, errno: " << errno;
+bool HttpServer::SendResponse(const ConnectionPtr &conn, HttpResponse &resp)
+{
+    size_t bytes;
+    if (resp.GetBodyType() == HttpBodyType::HTML_TYPE)
+    {
+        Buffer out; // 长连接下未显式设置长度时按正文补 Content-Length
+        resp.AppendToBuffer(&out);
+        bytes = out.GetReadablebytes();
+        conn->Send(out.Peek(), bytes);
+    }
+    else
+        bytes = SendStreamBody(conn, resp);
+    HttpTrafficMetrics::Get().sent.Inc(bytes);
+    auto context = conn->GetContext();
+    if (context && context->RequestStart() != 0)
+    {
+        const RouteMetrics *route = context->GetRequest()->GetRoute();
+        (route ? route : RouteMetrics::Unmatched())->Record(resp.GetStatusCode(), static_cast<uint64_t>(Metrics::NowNanos() - context->RequestStart()));
     }
-    if (response.IsCloseConnection()) conn->HandleClose();
+    if (!resp.IsCloseConnection())
+        return true;
+    CloseAfterWrite(conn);
+    return false;
+}
+
+void HttpServer::CloseAfterWrite(const ConnectionPtr &conn)
+{
+    // 不再读取和解析后续请求；等响应（含 sendfile 中的正文）全部写出再关闭，立即关闭会截断尚未写出的数据
+    conn->StopReading();
+    conn->RunAfterWrite([](const ConnectionPtr &c) { c->forceClose(); });
+}
+
+size_t HttpServer::SendStreamBody(const ConnectionPtr &conn, HttpResponse &resp)
+{
+    off_t start = 0;
+    size_t len = static_cast<size_t>(resp.GetContentLength());
+    if (resp.HasRange()) {
+        start = static_cast<off_t>(resp.GetRangeStart());
+        len = static_cast<size_t>(resp.GetRangeEnd() - resp.GetRangeStart() + 1);
+    }
+    Buffer head;
+    resp.AppendToBuffer(&head); // 文件/共享正文响应没有 body_，只生成状态行与头部
+    std::string header(head.Peek(), head.GetReadablebytes());
+    if (resp.GetBodyType() == HttpBodyType::BUFFER_TYPE)
+        conn->SendBufferStream(header, resp.GetSharedBody()->data() + start, len, resp.GetSharedBody());
+    else
+        conn->SendFileStream(header, resp.GetFileFd(), start, len, resp.GetFileOwner());
+    return header.size() + len;
 }
 
 void HttpServer::SendDeferredResponse(const ConnectionPtr &conn)
@@ -177,30 +407,125 @@ void HttpServer::SendDeferredResponse(const ConnectionPtr &conn)
     auto context = conn->GetContext();
     if (!context || !context->HasDeferredResponse()) return;
 
-    HttpResponse *resp = context->GetDeferredResponse();
-    if (resp->GetBodyType() == HttpBodyType::HTML_TYPE) {
-        conn->Send(resp->GetMessage());
-    } 
-    else if (resp->GetBodyType() == HttpBodyType::FILE_TYPE) {
-        conn->Send(resp->GetBeforeBody());
-        if (resp->HasRange()) {
-            off_t start = static_cast<off_t>(resp->GetRangeStart());
-            size_t len = static_cast<size_t>(resp->GetRangeEnd() - resp->GetRangeStart() + 1);
-            conn->SendFileRange(resp->GetFileFd(), start, len);
-        } 
-        else {
-            conn->SendFile(resp->GetFileFd(), resp->GetContentLength());
-        }
-        int ret = close(resp->GetFileFd());
-        if (ret < 0) LOG_ERROR << "HttpServer::SendDeferredResponse : close filefd failed errno=" << errno;
-    }
-    bool closeConn = resp->IsCloseConnection();
+    bool keepAlive = SendResponse(conn, *context->GetDeferredResponse());
     context->ClearDeferredResponse();
-    if (closeConn) conn->HandleClose();
+    context->ResetContextStatus(); // 准备解析同一连接上的下一个请求
+    if (keepAlive)
+        ResumeReading(conn);
+}
+
+void HttpServer::ResumeReading(const ConnectionPtr &conn)
+{
+    if (conn->GetState() != connectionState::Connected) return;
+    if (conn->SendingBody())
+    {
+        // 正文发完前不读也不解析，后续请求留在内核缓冲中
+        conn->StopReading();
+        conn->RunAfterWrite([](const ConnectionPtr &c) { ResumeReading(c); });
+        return;
+    }
+    conn->StartReading();
+    // 暂停期间已读入缓冲的（流水线）请求不会再触发读事件，排到 loop 中继续处理
+    if (conn->GetReadBuffer()->GetReadablebytes() > 0)
+        conn->GetLoop()->queueOneFunc([conn]() { conn->HandleEvent(); });
 }
 
 void HttpServer::SetThreadNums(int thread_nums) { server_->SetThreadPoolSize(thread_nums); }
 
+void HttpServer::SetBlockingExecutor(int threads, size_t maxQueue) { executor_ = std::make_unique<BlockingExecutor>(threads, maxQueue); }
+
+bool HttpServer::RunBlocking(const std::string &name, const ConnectionPtr &conn, HttpRequest &request, HttpResponse *resp, const HttpResponseCallback &cb)
+{
+    if (!executor_ || !conn)
+        return cb(conn, request, resp);
+    // 上下文持有 request，连接关闭时业务可能清空连接上的上下文，任务自己保留一份引用
+    std::shared_ptr<HttpContext> context = conn->GetContext();
+    auto result = std::make_shared<HttpResponse>(resp->IsCloseConnection());
+    EventLoop *loop = conn->GetLoop();
+    bool queued = executor_->Submit(name, [this, name, conn, context, &request, result, cb, loop]() {
+        bool done = false;
+        try
+        {
+            done = cb(conn, request, result.get());
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR << name << " failed: " << e.what();
+        }
+        if (!done)
+        {
+            // 异常，或回调要求再次异步（工作线程上不支持）
+            LOG_ERROR << name << " did not complete on the blocking executor";
+            *result = HttpResponse::MakeSimple(result->IsCloseConnection(), HttpStatusCode::InternalServerError, "Internal Server Error", "500 Internal Server Error\n");
+        }
+        loop->queueOneFunc([this, conn, context, result]() { FinishDeferred(conn, context, *result); });
+    });
+    if (queued)
+        return false;
+    LOG_WARN << name << " rejected: blocking queue full (" << executor_->MaxQueue() << ")";
+    *resp = HttpResponse::MakeSimple(resp->IsCloseConnection(), HttpStatusCode::ServiceUnavailable, "Service Unavailable", "503 Service Unavailable\n");
+    resp->AddHeader("Retry-After", "1");
+    return true;
+}
+
+// 协程完成前一直由协程帧持有；in_call 表示仍在 RunCoroutine 调用之内（同步完成）
+struct HttpServer::CoroutineState
+{
+    HttpServer *server;
+    ConnectionPtr conn;
+    std::shared_ptr<HttpContext> context;
+    HttpResponse result;
+    bool in_call = true;
+    bool done = false;
+
+    CoroutineState(HttpServer *s, const ConnectionPtr &c, bool close) : server(s), conn(c), context(c->GetContext()), result(close) {}
+};
+
+bool HttpServer::RunCoroutine(const ConnectionPtr &conn, HttpResponse *resp, Task<HttpResponse> task)
+{
+    auto state = std::make_shared<CoroutineState>(this, conn, resp->IsCloseConnection());
+    DriveCoroutine(std::move(task), state);
+    state->in_call = false;
+    if (!state->done)
+        return false; // 挂起中：onRequest 保存待发送响应，完成后由 FinishDeferred 发送
+    *resp = state->result;
+    return true;
+}
+
+DetachedTask HttpServer::DriveCoroutine(Task<HttpResponse> task, std::shared_ptr<CoroutineState> state)
+{
+    bool close = state->result.IsCloseConnection();
+    try
+    {
+        state->result = co_await task;
+    }
+    catch (const ExecutorBusy &e)
+    {
+        LOG_WARN << e.what();
+        state->result = HttpResponse::MakeSimple(close, HttpStatusCode::ServiceUnavailable, "Service Unavailable", "503 Service Unavailable\n");
+        state->result.AddHeader("Retry-After", "1");
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR << "coroutine handler failed: " << e.what();
+        state->result = HttpResponse::MakeSimple(close, HttpStatusCode::InternalServerError, "Internal Server Error", "500 Internal Server Error\n");
+    }
+    if (close)
+        state->result.SetCloseConnection(true); // 客户端要求关闭时不因业务的响应而保持
+    state->done = true;
+    if (!state->in_call)
+        state->server->FinishDeferred(state->conn, state->context, state->result);
+}
+
+void HttpServer::FinishDeferred(const ConnectionPtr &conn, const std::shared_ptr<HttpContext> &context, HttpResponse &resp)
+{
+    // 等待期间连接已关闭（上下文被替换或清空）则丢弃响应
+    if (conn->GetState() != connectionState::Connected || conn->GetContext() != context || !context->HasDeferredResponse())
+        return;
+    *context->GetDeferredResponse() = resp;
+    SendDeferredResponse(conn); // 异步处理期间留在读缓冲中的请求由它继续处理
+}
+
 void HttpServer::ActiveCloseConn(std::weak_ptr<Connection> &conn)
 {
     // std::cout<< "ActiveCloseConn called." << std::endl;
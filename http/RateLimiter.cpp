@@ -0,0 +1,171 @@
+#include "RateLimiter.h"
+#include "Connection.h"
+#include <functional>
+#include <mutex>
+#include <time.h>
+
+namespace
+{
+// splitmix64 的混合步骤：让规则下标与 IP 的组合在分片与哈希表中分布均匀
+uint64_t Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+} // namespace
+
+RateLimiter::RateLimiter(size_t maxBuckets, size_t shards) : shards_(shards ? shards : 1), maxPerShard_((maxBuckets + shards_.size() - 1) / shards_.size()) {}
+
+void RateLimiter::AddRule(const std::string &name, HttpMethod method, const std::string &path, double ratePerSec, double burst, KeyBy keyBy)
+{
+    Rule rule;
+    rule.name = name;
+    rule.method = method;
+    rule.prefix = !path.empty() && path.back() == '*';
+    rule.path = rule.prefix ? path.substr(0, path.size() - 1) : path;
+    rule.interval = static_cast<int64_t>(1e9 / ratePerSec);
+    rule.burst = static_cast<int64_t>(static_cast<double>(rule.interval) * (burst < 1 ? 1 : burst));
+    rule.keyBy = keyBy;
+    rule.limited = Metrics::GetCounter("http_rate_limited_total", "Requests answered with 429 by the rate limiter", {{"rule", name}});
+    rules_.push_back(std::move(rule));
+}
+
+bool RateLimiter::Matches(const Rule &rule, const HttpRequest &request) const
+{
+    if (rule.method != HttpMethod::kInvalid && rule.method != request.GetMethod())
+        return false;
+    const std::string &url = request.GetUrl();
+    if (rule.prefix)
+        return url.compare(0, rule.path.size(), rule.path) == 0;
+    return rule.path.empty() || url == rule.path;
+}
+
+int64_t RateLimiter::Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t RateLimiter::PeerKey(const Connection &conn)
+{
+    return conn.GetpeerAddr().addr.sin_addr.s_addr;
+}
+
+uint64_t RateLimiter::SessionKey(std::string_view session)
+{
+    return std::hash<std::string_view>()(session) | (1ULL << 63); // 与 IPv4 键不重叠
+}
+
+bool RateLimiter::Admit(const Connection &conn, const HttpRequest &request, double *retryAfter, const std::string **rule)
+{
+    int64_t now = 0;
+    for (size_t i = 0; i < rules_.size(); ++i)
+    {
+        const Rule &r = rules_[i];
+        if (!Matches(r, request))
+            continue;
+        uint64_t key = 0;
+        if (r.keyBy == kSession)
+        {
+            const auto &headers = request.GetHeaders();
+            auto it = headers.find(std::string_view(sessionHeader_));
+            if (it != headers.end() && !it->second.empty())
+                key = SessionKey(it->second);
+        }
+        if (key == 0)
+            key = PeerKey(conn);
+        if (now == 0)
+            now = Now();
+        int64_t wait = 0;
+        if (!Acquire(i, key, now, &wait))
+        {
+            r.limited.Inc();
+            *retryAfter = static_cast<double>(wait) / 1e9;
+            if (rule)
+                *rule = &r.name;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 放行时 tat 推后一个 interval；推后后超出 now + burst 说明桶已空
+bool RateLimiter::Take(std::atomic<int64_t> &tat, const Rule &rule, int64_t now, int64_t *wait)
+{
+    int64_t current = tat.load(std::memory_order_relaxed);
+    while (true)
+    {
+        int64_t next = (current > now ? current : now) + rule.interval;
+        if (next - now > rule.burst)
+        {
+            *wait = next - now - rule.burst;
+            return false;
+        }
+        if (tat.compare_exchange_weak(current, next, std::memory_order_relaxed))
+            return true;
+    }
+}
+
+bool RateLimiter::Acquire(size_t rule, uint64_t key, int64_t nowNanos, int64_t *waitNanos)
+{
+    const Rule &r = rules_[rule];
+    uint64_t slot = Mix(key * 31 + rule);
+    Shard &shard = shards_[slot % shards_.size()];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.buckets.find(slot);
+        if (it != shard.buckets.end())
+            return Take(it->second, r, nowNanos, waitNanos); // 读锁保证 Evict 不会同时删除该桶
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.buckets.find(slot);
+    if (it == shard.buckets.end())
+    {
+        if (shard.buckets.size() >= maxPerShard_)
+        {
+            overflow_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        it = shard.buckets.try_emplace(slot, nowNanos).first; // 新桶是满的
+    }
+    return Take(it->second, r, nowNanos, waitNanos);
+}
+
+size_t RateLimiter::Evict(int64_t nowNanos)
+{
+    size_t removed = 0;
+    for (Shard &shard : shards_)
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+        {
+            if (it->second.load(std::memory_order_relaxed) <= nowNanos)
+            {
+                it = shard.buckets.erase(it);
+                ++removed;
+            }
+            else
+                ++it;
+        }
+    }
+    return removed;
+}
+
+RateLimiter::Stats RateLimiter::GetStats() const
+{
+    Stats st;
+    st.overflow = overflow_.load(std::memory_order_relaxed);
+    for (const Rule &r : rules_)
+        st.limited += r.limited.Value();
+    for (const Shard &shard : shards_)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        st.buckets += shard.buckets.size();
+    }
+    return st;
+}
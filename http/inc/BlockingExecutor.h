@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Macro.h"
+
+// 阻塞任务执行器：数据库查询等会阻塞的业务放到固定数量的工作线程上执行，不占用 sub-reactor 线程
+// 队列有上限，满时 Submit 立即返回 false，调用方据此快速回 503；按任务名（一般是路由）统计排队等待时间
+class BlockingExecutor
+{
+public:
+    struct Stats
+    {
+        uint64_t executed = 0;  // 已开始执行的任务数
+        uint64_t rejected = 0;  // 因队列已满被拒绝的任务数
+        double totalWaitMs = 0; // 累计排队时间
+        double maxWaitMs = 0;   // 最长排队时间
+        double AvgWaitMs() const { return executed ? totalWaitMs / static_cast<double>(executed) : 0; }
+    };
+
+    DISALLOW_COPY_AND_MOVE(BlockingExecutor);
+    BlockingExecutor(int threads, size_t maxQueue);
+    ~BlockingExecutor(); // 执行完已入队的任务后退出
+
+    // 入队；队列已满时返回 false，task 不会被执行
+    bool Submit(const std::string &name, std::function<void()> task);
+    // 入队且不受队列上限限制，仅在执行器析构中返回 false；用于不能丢弃的收尾任务（如已落盘的上传入库）
+    bool SubmitUnbounded(const std::string &name, std::function<void()> task);
+
+    int Threads() const { return static_cast<int>(threads_.size()); }
+    size_t MaxQueue() const { return maxQueue_; }
+    size_t QueueDepth() const;                   // 排队中（尚未开始执行）的任务数
+    std::map<std::string, Stats> GetStats() const; // 任务名 -> 统计
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Task
+    {
+        std::function<void()> fn;
+        Stats *stats; // 指向 stats_ 中的条目，std::map 节点地址稳定
+        Clock::time_point enqueued;
+    };
+
+    bool Enqueue(const std::string &name, std::function<void()> &task, bool bounded);
+    void WorkerLoop();
+
+    const size_t maxQueue_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> queue_;
+    std::map<std::string, Stats> stats_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
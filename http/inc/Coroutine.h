@@ -0,0 +1,258 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "BlockingExecutor.h"
+#include "Connection.h"
+#include "EventLoop.h"
+
+// 协程式业务处理：Task<T> 惰性启动，被 co_await 时才开始执行，结束后对称转移回等待者
+// 等待体（定时器、阻塞任务、文件读写、连接可写）都在调用协程所在的 loop 线程恢复，协程体内无需加锁
+// 协程帧从当前线程（即所在 loop）的 FramePool 分配
+
+// 协程帧分配器：按 2 的幂分级的线程局部空闲链，帧释放后留给同一线程复用；超过最大级别的帧直接走堆
+class FramePool
+{
+public:
+    struct Stats
+    {
+        uint64_t pooled = 0; // 从空闲链取得的帧
+        uint64_t fresh = 0;  // 新分配的帧（含超大帧）
+    };
+
+    static void *Allocate(size_t size);
+    static void Deallocate(void *p, size_t size);
+    static Stats ThreadStats(); // 当前线程的统计
+
+    static const size_t kMinBlock = 128;
+    static const size_t kMaxBlock = 8192;
+    static const size_t kMaxFreePerClass = 256; // 每级最多保留的空闲帧
+};
+
+// 阻塞任务队列已满
+class ExecutorBusy : public std::runtime_error
+{
+public:
+    explicit ExecutorBusy(const std::string &name) : std::runtime_error(name + ": blocking queue full") {}
+};
+
+template <typename T>
+class Task
+{
+    static_assert(!std::is_void<T>::value, "Task<void> is not supported");
+
+public:
+    struct promise_type
+    {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U>
+        void return_value(U &&v) { value.emplace(std::forward<U>(v)); }
+        void unhandled_exception() { error = std::current_exception(); }
+
+        static void *operator new(size_t size) { return FramePool::Allocate(size); }
+        static void operator delete(void *p, size_t size) { FramePool::Deallocate(p, size); }
+    };
+
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+    {
+        handle_.promise().continuation = caller;
+        return handle_;
+    }
+    T await_resume()
+    {
+        if (handle_.promise().error)
+            std::rethrow_exception(handle_.promise().error);
+        return std::move(*handle_.promise().value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 立即开始、结束后自行销毁的协程，用于在回调接口里驱动 Task；协程体内的异常会终止进程，需自行捕获
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void *operator new(size_t size) { return FramePool::Allocate(size); }
+        static void operator delete(void *p, size_t size) { FramePool::Deallocate(p, size); }
+    };
+};
+
+namespace coro_detail
+{
+// 在 loop 线程恢复；不在 loop 线程（如单元测试直接驱动）时原地恢复
+inline void ResumeOn(EventLoop *loop, std::coroutine_handle<> h)
+{
+    if (loop)
+        loop->queueOneFunc([h]() { h.resume(); });
+    else
+        h.resume();
+}
+} // namespace coro_detail
+
+// co_await SleepFor(0.5)：由当前 loop 的定时器在若干秒后恢复
+class SleepFor
+{
+public:
+    explicit SleepFor(double seconds) : seconds_(seconds) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        EventLoop *loop = EventLoop::CurrentLoop();
+        if (!loop)
+            throw std::logic_error("SleepFor must be awaited on an EventLoop thread");
+        loop->RunAfter(seconds_, [h]() { h.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+private:
+    double seconds_;
+};
+
+// co_await Offload(executor, "name", fn)：fn 在阻塞任务执行器上执行，结果（或异常）带回协程，在原 loop 线程恢复
+// executor 为空时在当前线程直接执行；队列已满时抛出 ExecutorBusy
+template <typename F>
+class OffloadAwaiter
+{
+public:
+    using Result = std::invoke_result_t<F &>;
+
+    OffloadAwaiter(BlockingExecutor *executor, std::string name, F fn) : executor_(executor), name_(std::move(name)), fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return executor_ == nullptr; }
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        EventLoop *loop = EventLoop::CurrentLoop();
+        bool queued = executor_->Submit(name_, [this, h, loop]() {
+            try
+            {
+                Run();
+            }
+            catch (...)
+            {
+                error_ = std::current_exception();
+            }
+            coro_detail::ResumeOn(loop, h);
+        });
+        if (!queued)
+            error_ = std::make_exception_ptr(ExecutorBusy(name_));
+        return queued;
+    }
+    Result await_resume()
+    {
+        if (!executor_)
+            Run();
+        if (error_)
+            std::rethrow_exception(error_);
+        if constexpr (!std::is_void<Result>::value)
+            return std::move(*result_);
+    }
+
+private:
+    void Run()
+    {
+        if constexpr (std::is_void<Result>::value)
+            fn_();
+        else
+            result_.emplace(fn_());
+    }
+
+    BlockingExecutor *executor_;
+    std::string name_;
+    F fn_;
+    std::optional<std::conditional_t<std::is_void<Result>::value, std::monostate, Result>> result_;
+    std::exception_ptr error_;
+};
+
+template <typename F>
+OffloadAwaiter<std::decay_t<F>> Offload(BlockingExecutor *executor, std::string name, F &&fn)
+{
+    return OffloadAwaiter<std::decay_t<F>>(executor, std::move(name), std::forward<F>(fn));
+}
+
+// 文件读写在阻塞任务执行器上完成（统计名 file.read / file.write），失败抛出 std::system_error
+std::string ReadFileBlocking(const std::string &path, uint64_t offset, size_t length); // 读到文件末尾为止
+size_t WriteFileBlocking(const std::string &path, uint64_t offset, const std::string &data); // 文件不存在时创建
+
+inline auto ReadFile(BlockingExecutor *executor, std::string path, uint64_t offset, size_t length)
+{
+    return Offload(executor, "file.read", [path = std::move(path), offset, length]() { return ReadFileBlocking(path, offset, length); });
+}
+
+inline auto WriteFile(BlockingExecutor *executor, std::string path, uint64_t offset, std::string data)
+{
+    return Offload(executor, "file.write", [path = std::move(path), offset, data = std::move(data)]() { return WriteFileBlocking(path, offset, data); });
+}
+
+// co_await Writable(conn)：连接上已排队的数据全部写出后恢复，返回连接是否仍然可用；须在连接所属 loop 线程等待
+class Writable
+{
+public:
+    explicit Writable(std::shared_ptr<Connection> conn) : conn_(std::move(conn)) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        EventLoop *loop = conn_->GetLoop();
+        // 没有待写数据时 RunAfterWrite 会立即回调，统一经任务队列恢复，避免在 await_suspend 内重入协程
+        conn_->RunAfterWrite([loop, h](const std::shared_ptr<Connection> &) { loop->queueOneFunc([h]() { h.resume(); }); });
+    }
+    bool await_resume() const { return conn_->GetState() == connectionState::Connected; }
+
+private:
+    std::shared_ptr<Connection> conn_;
+};
@@ -2,6 +2,10 @@
 
 #include <string>
 #include <memory>
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+#include "HttpRequest.h"
 #include "HttpResponse.h" // 需要完整类型存储 unique_ptr
 
 #define CR '\r' // 回车
@@ -51,8 +55,6 @@ enum HttpRequestParseState // 解析状态机
     COMPLETE, // 完成
 };
 
-class HttpRequest; // 前向声明
-
 struct HttpLimits {
     size_t max_header_line_len = 8192;    // 单行最大长度
     size_t max_header_bytes = 16384;      // 头部总字节数
@@ -62,7 +64,12 @@ struct HttpLimits {
 class HttpContext
 {
 private:
-    std::shared_ptr<HttpRequest> request_; // 请求对象
+    // 每连接一块 arena：请求头等容器从这里分配，一个请求结束后整体释放，请求对象原地复用
+    // 头部超出内联缓冲时向堆申请，同样在请求结束后归还
+    static const size_t kArenaBytes = 4096;
+    alignas(std::max_align_t) char arena_buffer_[kArenaBytes];
+    std::pmr::monotonic_buffer_resource arena_;
+    HttpRequest request_; // 请求对象，须在 arena_ 之后声明
     HttpRequestParseState state_;          // 当前解析状态
     std::shared_ptr<void> context_;        // 自定义上下文
 
@@ -76,6 +83,9 @@ private:
     size_t content_length_ = 0;      // 期望的 Content-Length 剩余未读长度
     size_t received_body_bytes_ = 0; // 已累计正文字节
     size_t header_bytes_ = 0;        // 已累计头部字节数
+    bool body_admitted_ = false;     // 请求体预检已执行（每个请求一次）
+    bool precheck_pending_ = false;  // 预检在工作线程上执行中，完成前不解析
+    int64_t request_start_ = 0;      // 请求首个字节开始解析的时刻（单调时钟纳秒），0 表示尚未开始
     HttpLimits limits_ = {};         // 限制配置
 
     // chunked 解析临时字段
@@ -123,6 +133,12 @@ public:
     bool BodyComplete() const { return body_complete_; }
     bool IsChunked() const { return chunked_; }
     size_t RemainingContentLength() const { return chunked_ ? 0 : content_length_ - received_body_bytes_; }
+    bool BodyAdmitted() const { return body_admitted_; }
+    void SetBodyAdmitted() { body_admitted_ = true; }
+    bool PrecheckPending() const { return precheck_pending_; }
+    void SetPrecheckPending(bool pending) { precheck_pending_ = pending; }
+    int64_t RequestStart() const { return request_start_; }
+    void SetRequestStart(int64_t nanos) { request_start_ = nanos; }
 
     // 增量解析入口（供上层按分片调用）
     // 返回: true 表示解析推进正常; false 表示非法/出错
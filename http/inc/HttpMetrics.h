@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "Metrics.h"
+
+// 单个路由的请求指标：http_request_duration_seconds{method,route,code}，按状态码类别（2xx 等）各一个直方图
+// _count 即请求数。对象在注册路由时创建且不释放，请求只保存指针
+class RouteMetrics
+{
+public:
+    // 同一方法与路由模式返回同一对象；route 应为注册时的模式而不是实际路径，避免标签无限增长
+    static const RouteMetrics *Get(const std::string &method, const std::string &route);
+    static const RouteMetrics *Unmatched(); // 没有命中任何路由的请求
+
+    void Record(int status, uint64_t nanos) const { latency_[Class(status)].Record(nanos); }
+
+private:
+    RouteMetrics(const std::string &method, const std::string &route);
+    static int Class(int status) { return status < 200 ? 0 : status >= 500 ? 4 : status / 100 - 1; }
+
+    Metrics::Histogram latency_[5];
+};
+
+// 连接层的字节计数
+struct HttpTrafficMetrics
+{
+    Metrics::Counter received; // http_received_bytes_total
+    Metrics::Counter sent;     // http_sent_bytes_total
+
+    static const HttpTrafficMetrics &Get();
+};
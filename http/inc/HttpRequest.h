@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <memory_resource>
 #include <map>
 #include <vector>
 
@@ -12,7 +14,8 @@ enum HttpMethod
     kPost,
     kHead,
     kPut,
-    kDelete
+    kDelete,
+    kPatch
 };
 
 enum HttpVersion
@@ -22,8 +25,23 @@ enum HttpVersion
     kHttp11,
 };
 
+class RouteMetrics;
+
+// 请求头、查询参数等容器从构造时传入的 memory_resource 分配（HttpContext 传入每连接的 arena）
+// 路径、查询串、协议与请求体仍是 std::string，随对象复用保留容量
 class HttpRequest
 {
+public:
+    struct KeyLess
+    {
+        using is_transparent = void;
+        bool operator()(std::string_view a, std::string_view b) const { return a < b; }
+    };
+    using String = std::pmr::string;
+    using StringMap = std::pmr::map<String, String, KeyLess>;
+    using StringList = std::pmr::vector<String>;
+    using QueryMap = std::pmr::map<String, StringList, KeyLess>;
+
 private:
     // Range 解析
     bool has_range_ = false;
@@ -35,12 +53,13 @@ private:
 
     std::string url_;                                                    // 原始路径(不含query)
     std::string raw_query_;                                              // 原始查询串  key1=val1&key2=val2
-    std::map<std::string, std::vector<std::string>> query_params_multi_; // 支持重复 key: k=a&k=b  -> query_params_multi_["k"] = {"a","b"}
-    std::map<std::string, std::string> path_params_;                     // 路由解析出的动态路径参数 /user/:id
-    std::map<std::string, std::string> request_params_;                  // 请求参数
+    QueryMap query_params_multi_;                                        // 支持重复 key: k=a&k=b  -> query_params_multi_["k"] = {"a","b"}
+    StringMap path_params_;                                              // 路由解析出的动态路径参数 /user/:id
+    StringMap request_params_;                                           // 请求参数
     std::string protocol_;                                               // 协议
-    std::map<std::string, std::string> headers_;                         // 请求头
+    StringMap headers_;                                                  // 请求头
     std::string body_;                                                   // 请求体
+    const RouteMetrics *route_ = nullptr;                                // 命中的路由（指标用），未命中为空
 
 public:
     // Range 头解析
@@ -50,57 +69,66 @@ public:
     bool IsRangeSuffix() const { return range_suffix_; }
     bool ParseRangeHeader();
     HttpRequest();
+    explicit HttpRequest(std::pmr::memory_resource *resource);
     ~HttpRequest();
 
+    // 清空全部内容以复用于下一个请求；之后 resource 上为本请求分配的内存不再被引用，可以整体释放
+    void Reset();
+
     // 设定请求方法
-    void SetMethod(const std::string &method);
+    void SetMethod(std::string_view method);
     HttpMethod GetMethod() const;
     std::string GetMethodString() const;
 
     // http版本
-    void SetVersion(const std::string &ver);
+    void SetVersion(std::string_view ver);
     HttpVersion GetVersion() const;
     std::string GetVersionString() const;
 
     // 请求路径
     // 设置原始URL(可能包含 ?query)；内部拆分 path 与 query
-    void SetUrl(const std::string &url);
+    void SetUrl(std::string_view url);
     const std::string &GetUrl() const;
     const std::string &GetRawQuery() const; // 原始 query 子串
-    std::string GetQueryValue(const std::string &key) const;
+    std::string GetQueryValue(std::string_view key) const;
     // Query 访问：GetQueryValue 返回首个值；GetQueryValues 返回全部；GetQueryParamMap 返回映射
-    const std::vector<std::string> &GetQueryValues(const std::string &key) const;
-    const std::map<std::string, std::vector<std::string>> &GetQueryParamMap() const;
+    const StringList &GetQueryValues(std::string_view key) const;
+    const QueryMap &GetQueryParamMap() const;
 
     // 手动注入路径参数(路由匹配阶段调用)
-    void SetPathParam(const std::string &key, const std::string &value);
+    void SetPathParam(std::string_view key, std::string_view value);
     void SetPathParam(const std::map<std::string, std::string>& params);
-    std::string GetPathParam(const std::string &key) const;
-    const std::map<std::string, std::string> &GetPathParams() const;
+    void ClearPathParams();
+    std::string GetPathParam(std::string_view key) const;
+    const StringMap &GetPathParams() const;
 
     // 请求参数
-    void SetRequestParams(const std::string &key, const std::string &value);
-    std::string GetRequestValue(const std::string &key) const;
-    const std::map<std::string, std::string> &GetRequestParams() const;
+    void SetRequestParams(std::string_view key, std::string_view value);
+    std::string GetRequestValue(std::string_view key) const;
+    const StringMap &GetRequestParams() const;
 
     // 协议
-    void SetProtocol(const std::string &str);
+    void SetProtocol(std::string_view str);
     const std::string &GetProtocol() const;
 
     // 添加请求头
-    void AddHeader(const std::string &field, const std::string &value);
-    std::string GetHeader(const std::string &field) const;
-    const std::map<std::string, std::string> &GetHeaders() const;
+    void AddHeader(std::string_view field, std::string_view value);
+    std::string GetHeader(std::string_view field) const;
+    const StringMap &GetHeaders() const;
 
     // 请求体
     void SetBody(const std::string &str);
     const std::string &GetBody() const;
     void AppendBody(const char* data, size_t len); // 追加请求体（增量解析用）
 
+    // 路由匹配阶段记下命中的路由，响应发送时按路由统计
+    void SetRoute(const RouteMetrics *route) { route_ = route; }
+    const RouteMetrics *GetRoute() const { return route_; }
+
     // 工具
     static std::string UrlDecode(const std::string &src);
     void ParseQueryString();                                              // 在 SetUrl 内部调用或外部重新触发
-    void AddQueryParam(const std::string &key, const std::string &value); // 多值追加
+    void AddQueryParam(std::string_view key, std::string_view value);     // 多值追加
 
     // 路径参数自动提取：pattern 形如 /user/:id/books/:bid ，成功则写入 path_params_
     bool ExtractPathParams(const std::string &pattern);
@@ -3,6 +3,7 @@
 #include <string>
 #include <utility>
 #include <map>
+#include <memory>
 class Buffer; // 前向声明
 
 enum HttpStatusCode
@@ -10,21 +11,30 @@ enum HttpStatusCode
     Unknown = 0,              // 未知状态码
     Continue = 100,           // 继续
     OK = 200,                 // 成功
+    NoContent = 204,          // 无内容
     PartialContent = 206,     // 部分内容
     k301K = 301,              // 永久重定向
     k302K = 302,              // 临时重定向
+    NotModified = 304,        // 未修改（条件请求）
     BadRequest = 400,         // 错误请求
     Unauthorized = 401,       // 未授权
     Forbidden = 403,          // 禁止访问
     NotFound = 404,           // 未找到
+    Conflict = 409,           // 状态冲突
+    PayloadTooLarge = 413,    // 请求体过大
     RangeNotSatisfiable = 416, // Range 无法满足
-    InternalServerError = 500 // 服务器内部错误
+    ExpectationFailed = 417,  // 不支持的 Expect
+    TooManyRequests = 429,    // 请求过于频繁（限流）
+    InternalServerError = 500, // 服务器内部错误
+    ServiceUnavailable = 503,  // 服务暂不可用（过载）
+    InsufficientStorage = 507  // 存储空间不足
 };
 
 enum HttpBodyType
 {
     HTML_TYPE,
     FILE_TYPE,
+    BUFFER_TYPE, // 引用计数的只读内存正文（如内容缓存），发送时不拷贝
 };
 
 class HttpResponse
@@ -36,8 +46,10 @@ private:
     bool close_connection_;      // 是否关闭连接
 
     std::map<std::string, std::string> headers_; // 响应头
-    int content_length_;                         // 内容长度
+    long long content_length_;                   // 内容长度（文件可能超过 2GB）
     int filefd_;                                 // 文件描述符，用于文件传输
+    std::shared_ptr<const void> file_owner_;     // 非空时 filefd_ 归它所有（如 fd 缓存条目），发送方不关闭
+    std::shared_ptr<const std::string> shared_body_; // BUFFER_TYPE 的正文
     HttpBodyType body_type_;                     // 响应体类型
     bool async_pending_ = false;                 // 是否处于异步延迟发送
 
@@ -52,17 +64,22 @@ public:
     ~HttpResponse();
 
     void SetStatusCode(HttpStatusCode status_code);                   // 设置状态码
+    HttpStatusCode GetStatusCode() const;                             // 获取状态码
     void SetStatusMessage(const std::string &status_message);         // 设置状态消息
     void SetCloseConnection(bool close_connection);                   // 设置连接关闭标志
     void SetBody(const std::string &body);                            // 设置响应体内容
     void SetContentType(const std::string &content_type);             // 设置内容类型
     void AddHeader(const std::string &key, const std::string &value); // 添加响应头
-    void SetContentLength(const int &len);                        // 设置内容长度
-    void SetFileFd(int file_fd);                                      // 设置文件描述符
+    void SetContentLength(long long len);                            // 设置内容长度
+    void SetFileFd(int file_fd);                                      // 设置文件描述符（发送后由连接关闭）
+    void SetSharedFile(int file_fd, std::shared_ptr<const void> owner); // 借用 owner 持有的 fd，发送期间保持引用
     void SetBodyType(HttpBodyType body_type);                         // 设置响应体类型
     HttpBodyType GetBodyType();                                       // 获取响应体类型
-    int GetContentLength();                                           // 获取内容长度
+    long long GetContentLength();                                     // 获取内容长度
     int GetFileFd();                                                  // 获取文件描述符
+    const std::shared_ptr<const void> &GetFileOwner() const { return file_owner_; } // 获取 fd 的持有者
+    void SetSharedBody(std::shared_ptr<const std::string> body);                        // 设置共享正文（BUFFER_TYPE），同时设置内容长度
+    const std::shared_ptr<const std::string> &GetSharedBody() const { return shared_body_; }
 
     bool IsCloseConnection(); // 检查是否关闭连接
 
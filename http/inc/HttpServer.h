@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include "Macro.h"
 #include "RouterTrie.h"
+#include "Coroutine.h"
+#include "HttpResponse.h"
 
 // 自动关闭的时间，以秒为单位
 #define AUTOCLOSETIMEOUT 100
@@ -18,6 +20,9 @@ class HttpResponse;
 class EventLoop;
 class Connection;
 class RouteTrie;
+class HttpContext;
+class BlockingExecutor;
+class RateLimiter;
 
 class HttpServer
 {
@@ -25,6 +30,12 @@ public:
     typedef std::shared_ptr<Connection> ConnectionPtr;
     // 回调签名: (连接, 请求, 响应*) -> bool; true=同步发送; false=异步稍后调用 SendDeferredResponse
     typedef std::function<bool(const ConnectionPtr &, HttpRequest &, HttpResponse *)> HttpResponseCallback;
+    // 协程回调: (连接, 请求) -> Task<HttpResponse>；conn 按值传入，协程挂起期间保持有效
+    typedef std::function<Task<HttpResponse>(ConnectionPtr, HttpRequest &)> CoroutineCallback;
+    // 判断请求体是否按分片交给业务回调（大文件上传等），默认仅 POST /upload
+    typedef std::function<bool(const HttpRequest &)> BodyStreamingFilter;
+    // 请求体预检: 头部完整而请求体未到齐时（流式请求总是）调用一次，返回 false 时 resp 为拒绝响应，发送后关闭连接、不再读取请求体
+    typedef std::function<bool(const ConnectionPtr &, HttpRequest &, HttpResponse *)> BodyPrecheck;
     DISALLOW_COPY_AND_MOVE(HttpServer);
 
     HttpServer(EventLoop *loop, const char *ip, const int port, bool auto_close_conn = true);
@@ -32,16 +43,38 @@ public:
 
     void SetHttpCallback(const HttpResponseCallback &cb);                     // 设置HTTP响应回调函数 (同步/异步)
     void SetOnConnectionCallback(const std::function<void(const ConnectionPtr &)> &cb); // 设置新连接回调函数
+    void SetBodyStreamingFilter(const BodyStreamingFilter &filter);           // 设置需要流式处理请求体的请求
+    void SetBodyPrecheck(const BodyPrecheck &check);                          // 设置请求体预检（鉴权、大小、配额），通过后才对 Expect: 100-continue 回 100；设置了阻塞执行器时在工作线程上执行
+    // 在 GET path 上以 Prometheus 文本格式输出 Metrics 中的全部指标，并补充各事件循环的连接数、任务队列与阻塞执行器的统计
+    // 请求延迟与收发字节无论是否开启都会记录
+    void EnableMetrics(const std::string &path = "/metrics");
+    // 在业务回调之前按规则限流，超速的请求直接回 429（带 Retry-After），不进入路由与数据库
+    // 返回的限流器用于在 start 之前添加规则；每 evictSeconds 秒在主循环上清理已满的令牌桶
+    RateLimiter *EnableRateLimit(size_t maxBuckets = 1 << 20, double evictSeconds = 10.0);
+    RateLimiter *GetRateLimiter() { return limiter_.get(); }
     bool HttpDefaultCallBack(const ConnectionPtr &conn, const HttpRequest &request, HttpResponse *resp); // 默认回调, 返回true表示同步发送
 
     void start(); // 启动服务器
 
     void onConnection(const ConnectionPtr &conn);                          // 新连接信息
     void onMessage(const ConnectionPtr &conn);                             // 处理接收到的消息，到onRequest函数处理
-    void onRequest(const ConnectionPtr &conn, HttpRequest &request); // 处理HTTP请求，支持同步/异步
-    void SendDeferredResponse(const ConnectionPtr &conn);                  // 业务异步完成后触发发送，使用定时器延迟发送
+    bool onRequest(const ConnectionPtr &conn, HttpRequest &request); // 处理HTTP请求，支持同步/异步；返回 false 表示响应后关闭连接
+    static void SendDeferredResponse(const ConnectionPtr &conn);           // 业务异步完成后在连接所属 loop 线程调用，发送保存的响应
     void SetThreadNums(int thread_nums);
 
+    // 阻塞型业务（数据库查询等）的工作线程池：threads 个线程，最多 maxQueue 个任务排队
+    void SetBlockingExecutor(int threads, size_t maxQueue);
+    BlockingExecutor *GetBlockingExecutor() { return executor_.get(); }
+    const BlockingExecutor *GetBlockingExecutor() const { return executor_.get(); }
+    // 在业务回调中调用：把 cb 交给工作线程执行并返回 false（异步），完成后回到连接所属 loop 发送响应，
+    // 再继续解析等待期间到达的请求；队列已满时填写 503 并返回 true；未设置执行器时直接在当前线程执行 cb
+    // request 必须是连接上下文中的当前请求；cb 在工作线程上必须同步完成（返回 true），name 用于统计排队时间
+    bool RunBlocking(const std::string &name, const ConnectionPtr &conn, HttpRequest &request, HttpResponse *resp, const HttpResponseCallback &cb);
+    // 在业务回调中调用：在 loop 线程驱动协程，协程同步完成时把结果写入 resp 并返回 true；
+    // 挂起则返回 false，完成后发送响应并继续解析等待期间到达的请求。ExecutorBusy 回 503，其他异常回 500
+    // task 引用的请求必须是连接上下文中的当前请求（在响应发送前不会被重置）
+    bool RunCoroutine(const ConnectionPtr &conn, HttpResponse *resp, Task<HttpResponse> task);
+
     void ActiveCloseConn(std::weak_ptr<Connection> &conn);                 // 主动关闭连接，不控制conn的生命周期，依然由正常的方式进行释放。
 
     // 路由注册与处理器绑定
@@ -51,11 +84,31 @@ public:
     bool DispatchByRouter(const ConnectionPtr &conn, const HttpRequest &request, HttpResponse *resp);
 
 private:
+    // 发送完整响应；响应要求关闭时停止读取并在写完后关闭，返回连接是否继续使用
+    static bool SendResponse(const ConnectionPtr &conn, HttpResponse &resp);
+    static void CloseAfterWrite(const ConnectionPtr &conn);
+    static void ResumeReading(const ConnectionPtr &conn); // 恢复读取并处理缓冲中的请求；正文仍在发送时推迟到写完之后
+    static bool WantsClose(const HttpRequest &request); // 按 Connection 头与协议版本判断响应后是否关闭
+    static HttpResponse RateLimited(bool close, double retryAfter); // 429 响应
+    bool AdmitBody(const ConnectionPtr &conn, HttpContext &context); // 请求体到齐前的预检与 100 Continue；拒绝或预检转到工作线程时返回 false
+    void FinishPrecheck(const ConnectionPtr &conn, const std::shared_ptr<HttpContext> &context, bool ok, HttpResponse &resp); // loop 线程：工作线程上的预检完成
+    static void ContinueBody(const ConnectionPtr &conn, HttpRequest &request);                 // 预检通过：按需回 100 Continue
+    static void RejectBody(const ConnectionPtr &conn, HttpRequest &request, HttpResponse &resp); // 预检拒绝：回包后关闭
+    static size_t SendStreamBody(const ConnectionPtr &conn, HttpResponse &resp); // FILE_TYPE/BUFFER_TYPE 响应：头部与正文区间零拷贝发送，文件描述符或正文交给连接；返回字节数
+    void FinishDeferred(const ConnectionPtr &conn, const std::shared_ptr<HttpContext> &context, HttpResponse &resp); // loop 线程：发送异步生成的响应
+    struct CoroutineState;
+    static DetachedTask DriveCoroutine(Task<HttpResponse> task, std::shared_ptr<CoroutineState> state);
     EventLoop *loop_;
     std::unique_ptr<Server> server_;
     HttpResponseCallback responseCallback_;
     std::function<void(const ConnectionPtr &)> onConnectionCallback_;   // 新连接回调
+    BodyStreamingFilter streamingFilter_;                               // 流式请求体判定
+    BodyPrecheck bodyPrecheck_;                                         // 请求体预检，可为空
+    std::string metricsPath_;                                           // 指标路径，空表示未开启
+    int metricsCollector_ = 0;                                          // Metrics 收集器编号
+    std::unique_ptr<RateLimiter> limiter_;                              // 限流，可为空
     bool auto_close_conn_; // 是否自动关闭连接
     std::unique_ptr<RouteTrie> router_;                                 // 路由树
     std::map<std::string, HttpResponseCallback> route_handlers_;        // handler 名称 -> 业务回调
+    std::unique_ptr<BlockingExecutor> executor_;                        // 最后析构：先等工作线程退出
 };
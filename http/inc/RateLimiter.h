@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Macro.h"
+#include "HttpRequest.h"
+#include "Metrics.h"
+
+class Connection;
+
+// 请求限流：每条规则对每个客户端（对端 IP 或会话）维护一个令牌桶，速率 rate 个/秒，容量 burst 个
+// 桶用 GCRA 表示：只存一个“理论到达时间”(tat)，取令牌是对这个 int64 的一次 CAS，不加锁
+// 桶按键的哈希分片存放，查找持分片的读锁，只有新建与清理持写锁
+// tat 不晚于当前时间的桶是满的，与不存在等价，Evict 把它们删除不改变任何结果，内存只与近期超速的客户端数有关
+// 规则在 HttpServer::start 之前添加，之后只读
+class RateLimiter
+{
+public:
+    enum KeyBy
+    {
+        kPeer,   // 对端 IPv4 地址
+        kSession // 会话头（X-Session-ID），没有时退回对端地址；会话由客户端提供，应同时配一条按 IP 的规则
+    };
+
+    struct Stats
+    {
+        uint64_t limited = 0;  // 各规则的 http_rate_limited_total 之和
+        uint64_t overflow = 0; // 桶数达到上限、未计量直接放行的请求
+        size_t buckets = 0;
+    };
+
+    DISALLOW_COPY_AND_MOVE(RateLimiter);
+    // maxBuckets: 桶总数上限（超出时新客户端不计量，放行并计入 overflow）
+    explicit RateLimiter(size_t maxBuckets = 1 << 20, size_t shards = 16);
+
+    // path 为空匹配所有路径，以 '*' 结尾按前缀匹配，否则须完全相同；method 为 kInvalid 时匹配所有方法
+    // 一个请求须通过所有匹配的规则
+    void AddRule(const std::string &name, HttpMethod method, const std::string &path, double ratePerSec, double burst, KeyBy keyBy = kPeer);
+    void SetSessionHeader(const std::string &header) { sessionHeader_ = header; }
+
+    // 放行返回 true；否则 retryAfter 为可以重试前需等待的秒数，rule 为拒绝的规则名
+    bool Admit(const Connection &conn, const HttpRequest &request, double *retryAfter, const std::string **rule = nullptr);
+    // 按规则下标与客户端键取一个令牌（Admit 内部使用，也供基准直接调用）
+    bool Acquire(size_t rule, uint64_t key, int64_t nowNanos, int64_t *waitNanos);
+
+    size_t Evict(int64_t nowNanos); // 删除已满的桶，返回删除数；nowNanos 取自 Now()
+    size_t RuleCount() const { return rules_.size(); }
+    Stats GetStats() const;
+
+    // 限流用的时钟（CLOCK_MONOTONIC_COARSE，纳秒）：精度为一个调度节拍，读取比 CLOCK_MONOTONIC 便宜得多
+    static int64_t Now();
+    static uint64_t PeerKey(const Connection &conn);
+    static uint64_t SessionKey(std::string_view session);
+
+private:
+    struct Rule
+    {
+        std::string name;
+        HttpMethod method;
+        std::string path;
+        bool prefix;
+        int64_t interval; // 每个令牌的纳秒数
+        int64_t burst;    // 容量对应的纳秒数 = interval * burst
+        KeyBy keyBy;
+        Metrics::Counter limited; // http_rate_limited_total{rule}
+    };
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint64_t, std::atomic<int64_t>> buckets; // (规则, 客户端) -> tat
+    };
+
+    static bool Take(std::atomic<int64_t> &tat, const Rule &rule, int64_t now, int64_t *wait);
+    bool Matches(const Rule &rule, const HttpRequest &request) const;
+
+    std::vector<Rule> rules_;
+    std::vector<Shard> shards_;
+    const size_t maxPerShard_;
+    std::string sessionHeader_ = "X-Session-ID";
+    std::atomic<uint64_t> overflow_{0};
+};
@@ -0,0 +1,340 @@
+#include "Metrics.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <stdio.h>
+
+__thread Metrics::Shard *t_metricsShard = nullptr;
+
+namespace
+{
+// 导出的直方图 le 边界：2^10 .. 2^36（纳秒计时约 1 微秒到 68 秒）
+const int kExportMinExponent = 10;
+
+enum Type
+{
+    kCounter,
+    kGauge,
+    kHistogram
+};
+
+struct Series
+{
+    std::string labels; // 已格式化的 {k="v",...}，无标签时为空
+    uint32_t slot;
+};
+
+struct Family
+{
+    std::string help;
+    Type type;
+    double scale = 1.0;
+    std::vector<Series> series;
+};
+
+// 渲染中的一族样本
+struct FamilyText
+{
+    std::string help;
+    std::string type;
+    std::string lines;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::map<std::string, Family> families;
+    std::map<std::string, uint32_t> index; // 名称+标签 -> 槽位
+    uint32_t nextSlot = Metrics::kBuckets + 1; // 开头一段留给默认构造的句柄，写入不影响任何指标
+    std::vector<Metrics::Shard *> shards; // 线程退出后保留
+    std::map<int, Metrics::Collector> collectors;
+    int nextCollector = 1;
+};
+
+Registry &GetRegistry()
+{
+    static Registry *registry = new Registry(); // 不析构：其他静态对象析构时可能仍在记录
+    return *registry;
+}
+
+void AppendEscaped(std::string &out, const std::string &value)
+{
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (c == '\n')
+            out += "\\n";
+        else
+            out += c;
+    }
+}
+
+std::string FormatLabels(const Metrics::Labels &labels)
+{
+    if (labels.empty())
+        return "";
+    std::string out = "{";
+    for (const auto &kv : labels)
+    {
+        if (out.size() > 1)
+            out += ',';
+        out += kv.first + "=\"";
+        AppendEscaped(out, kv.second);
+        out += '"';
+    }
+    out += '}';
+    return out;
+}
+
+// 在已格式化的标签后追加一个标签
+std::string WithLabel(const std::string &labels, const char *key, const std::string &value)
+{
+    std::string extra = std::string(key) + "=\"" + value + "\"";
+    if (labels.empty())
+        return "{" + extra + "}";
+    return labels.substr(0, labels.size() - 1) + "," + extra + "}";
+}
+
+std::string FormatNumber(double value)
+{
+    char buf[32];
+    if (value == static_cast<double>(static_cast<int64_t>(value)))
+        snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));
+    else
+        snprintf(buf, sizeof(buf), "%.12g", value);
+    return buf;
+}
+
+const char *TypeName(Type type)
+{
+    return type == kCounter ? "counter" : type == kGauge ? "gauge" : "histogram";
+}
+
+uint32_t Register(const std::string &name, const std::string &help, const Metrics::Labels &labels, Type type, uint32_t width, double scale)
+{
+    Registry &r = GetRegistry();
+    std::string formatted = FormatLabels(labels);
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto found = r.index.find(name + formatted);
+    if (found != r.index.end())
+        return found->second;
+    Family &family = r.families[name];
+    if (family.series.empty())
+    {
+        family.help = help;
+        family.type = type;
+        family.scale = scale;
+    }
+    else if (family.type != type)
+        throw std::logic_error("metric " + name + " registered with another type");
+    // 一个指标的槽位不跨页
+    uint32_t offset = r.nextSlot & (Metrics::kPageSlots - 1);
+    if (offset + width > Metrics::kPageSlots)
+        r.nextSlot += Metrics::kPageSlots - offset;
+    if (r.nextSlot + width > Metrics::kPageSlots * Metrics::kMaxPages)
+        throw std::length_error("too many metrics");
+    uint32_t slot = r.nextSlot;
+    r.nextSlot += width;
+    family.series.push_back(Series{formatted, slot});
+    r.index[name + formatted] = slot;
+    return slot;
+}
+
+uint64_t SumLocked(Registry &r, uint32_t slot)
+{
+    uint64_t total = 0;
+    for (Metrics::Shard *shard : r.shards)
+    {
+        std::atomic<uint64_t> *page = shard->pages[slot >> Metrics::kPageBits].load(std::memory_order_acquire);
+        if (page)
+            total += page[slot & (Metrics::kPageSlots - 1)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void SnapshotLocked(Registry &r, uint32_t base, Metrics::HistogramSnapshot &snap)
+{
+    snap.buckets.assign(Metrics::kBuckets, 0);
+    for (int i = 0; i < Metrics::kBuckets; ++i)
+    {
+        snap.buckets[i] = SumLocked(r, base + i);
+        snap.count += snap.buckets[i];
+    }
+    snap.sum = SumLocked(r, base + Metrics::kBuckets);
+}
+} // namespace
+
+std::atomic<uint64_t> &Metrics::SlowCell(uint32_t slot)
+{
+    Registry &r = GetRegistry();
+    if (!t_metricsShard)
+    {
+        Shard *shard = new Shard();
+        for (auto &page : shard->pages)
+            page.store(nullptr, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.shards.push_back(shard);
+        t_metricsShard = shard;
+    }
+    std::atomic<std::atomic<uint64_t> *> &page = t_metricsShard->pages[slot >> kPageBits];
+    if (!page.load(std::memory_order_relaxed))
+        page.store(new std::atomic<uint64_t>[kPageSlots](), std::memory_order_release);
+    return page.load(std::memory_order_relaxed)[slot & (kPageSlots - 1)];
+}
+
+uint64_t Metrics::Sum(uint32_t slot)
+{
+    Registry &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return SumLocked(r, slot);
+}
+
+uint64_t Metrics::BucketUpper(int bucket)
+{
+    if (bucket < (1 << kSubBits))
+        return static_cast<uint64_t>(bucket) + 1;
+    int exp = (bucket >> kSubBits) + kSubBits - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket & ((1 << kSubBits) - 1));
+    uint64_t width = 1ULL << (exp - kSubBits);
+    return (((1ULL << kSubBits) + sub) << (exp - kSubBits)) + width;
+}
+
+uint64_t Metrics::HistogramSnapshot::Quantile(double q) const
+{
+    if (count == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return BucketUpper(static_cast<int>(i));
+    }
+    return BucketUpper(kBuckets - 1);
+}
+
+Metrics::HistogramSnapshot Metrics::Histogram::Snapshot() const
+{
+    Registry &r = GetRegistry();
+    HistogramSnapshot snap;
+    std::lock_guard<std::mutex> lock(r.mutex);
+    SnapshotLocked(r, base_, snap);
+    return snap;
+}
+
+Metrics::Counter Metrics::GetCounter(const std::string &name, const std::string &help, const Labels &labels)
+{
+    return Counter(Register(name, help, labels, kCounter, 1, 1.0));
+}
+
+Metrics::Gauge Metrics::GetGauge(const std::string &name, const std::string &help, const Labels &labels)
+{
+    return Gauge(Register(name, help, labels, kGauge, 1, 1.0));
+}
+
+Metrics::Histogram Metrics::GetHistogram(const std::string &name, const std::string &help, const Labels &labels, double scale)
+{
+    return Histogram(Register(name, help, labels, kHistogram, kBuckets + 1, scale));
+}
+
+int Metrics::AddCollector(Collector collector)
+{
+    Registry &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    int id = r.nextCollector++;
+    r.collectors[id] = std::move(collector);
+    return id;
+}
+
+void Metrics::RemoveCollector(int id)
+{
+    Registry &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.collectors.erase(id);
+}
+
+void Metrics::Writer::Counter(const std::string &name, const std::string &help, const Labels &labels, double value)
+{
+    Add(name, help, "counter", labels, value);
+}
+
+void Metrics::Writer::Gauge(const std::string &name, const std::string &help, const Labels &labels, double value)
+{
+    Add(name, help, "gauge", labels, value);
+}
+
+void Metrics::Writer::Add(const std::string &name, const std::string &help, const char *type, const Labels &labels, double value)
+{
+    FamilyText &family = (*static_cast<std::map<std::string, FamilyText> *>(families_))[name];
+    if (family.type.empty())
+    {
+        family.help = help;
+        family.type = type;
+    }
+    family.lines += name + FormatLabels(labels) + " " + FormatNumber(value) + "\n";
+}
+
+std::string Metrics::Render()
+{
+    Registry &r = GetRegistry();
+    std::map<std::string, FamilyText> families;
+    std::vector<Collector> collectors;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        HistogramSnapshot snap;
+        for (const auto &kv : r.families)
+        {
+            const Family &family = kv.second;
+            FamilyText &text = families[kv.first];
+            text.help = family.help;
+            text.type = TypeName(family.type);
+            for (const Series &s : family.series)
+            {
+                if (family.type == kCounter)
+                    text.lines += kv.first + s.labels + " " + std::to_string(SumLocked(r, s.slot)) + "\n";
+                else if (family.type == kGauge)
+                    text.lines += kv.first + s.labels + " " + std::to_string(static_cast<int64_t>(SumLocked(r, s.slot))) + "\n";
+                else
+                {
+                    snap = HistogramSnapshot();
+                    SnapshotLocked(r, s.slot, snap);
+                    // 按 2 的幂输出累计桶，各序列的 le 集合相同，便于跨实例聚合
+                    uint64_t cumulative = 0;
+                    int bucket = 0;
+                    for (int exp = kExportMinExponent; exp <= kMaxExponent; ++exp)
+                    {
+                        int end = (exp - kSubBits + 1) << kSubBits; // 上界不超过 2^exp 的桶
+                        for (; bucket < end && bucket < kBuckets; ++bucket)
+                            cumulative += snap.buckets[bucket];
+                        text.lines += kv.first + "_bucket" + WithLabel(s.labels, "le", FormatNumber(static_cast<double>(1ULL << exp) * family.scale)) + " " +
+                                      std::to_string(cumulative) + "\n";
+                    }
+                    text.lines += kv.first + "_bucket" + WithLabel(s.labels, "le", "+Inf") + " " + std::to_string(snap.count) + "\n";
+                    text.lines += kv.first + "_sum" + s.labels + " " + FormatNumber(static_cast<double>(snap.sum) * family.scale) + "\n";
+                    text.lines += kv.first + "_count" + s.labels + " " + std::to_string(snap.count) + "\n";
+                }
+            }
+        }
+        for (const auto &kv : r.collectors)
+            collectors.push_back(kv.second);
+    }
+    // 收集器在锁外执行，可以访问自己的锁保护的数据
+    Writer writer;
+    writer.families_ = &families;
+    for (const Collector &collect : collectors)
+        collect(writer);
+
+    std::string out;
+    for (const auto &kv : families)
+    {
+        out += "# HELP " + kv.first + " " + kv.second.help + "\n";
+        out += "# TYPE " + kv.first + " " + kv.second.type + "\n";
+        out += kv.second.lines;
+    }
+    return out;
+}
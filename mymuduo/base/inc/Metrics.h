@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <utility>
+#include <vector>
+
+// 进程内指标：计数器、仪表与对数线性直方图，抓取时以 Prometheus 文本格式输出
+// 每个线程写自己的分片（单写者，relaxed 读写，不加锁也没有原子读改写），抓取时把所有线程的分片相加
+// 指标在注册时分到固定的槽位，记录只是一次线程局部的数组写；线程退出后分片保留，计数不会倒退
+// 注册（Get*）加锁，应在启动或首次使用时完成并保存返回的句柄
+class Metrics
+{
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    static const int kPageBits = 12;                        // 每页 4096 个槽位
+    static const uint32_t kPageSlots = 1u << kPageBits;
+    static const int kMaxPages = 64;
+    // 直方图桶：2 的幂区间各分 4 个线性子桶，值域 [0, 2^36)，超出的计入最后一个桶
+    // 纳秒计时覆盖约 68 秒，相对误差不超过 25%
+    static const int kSubBits = 2;
+    static const int kMaxExponent = 36;
+    static const int kBuckets = (kMaxExponent - 1) << kSubBits;
+
+    // 每线程分片：按页惰性分配，页指针只由所属线程写入
+    struct Shard
+    {
+        std::atomic<std::atomic<uint64_t> *> pages[kMaxPages];
+    };
+
+    class Counter
+    {
+    public:
+        Counter() = default;
+        void Inc(uint64_t n = 1) const { Bump(Cell(slot_), n); }
+        uint64_t Value() const { return Sum(slot_); }
+
+    private:
+        friend class Metrics;
+        explicit Counter(uint32_t slot) : slot_(slot) {}
+        uint32_t slot_ = 0;
+    };
+
+    // 可增可减，各线程的增量相加；连接数等在不同线程增减的值也能得到正确总数
+    class Gauge
+    {
+    public:
+        Gauge() = default;
+        void Add(int64_t n) const { Bump(Cell(slot_), static_cast<uint64_t>(n)); }
+        int64_t Value() const { return static_cast<int64_t>(Sum(slot_)); }
+
+    private:
+        friend class Metrics;
+        explicit Gauge(uint32_t slot) : slot_(slot) {}
+        uint32_t slot_ = 0;
+    };
+
+    struct HistogramSnapshot
+    {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        std::vector<uint64_t> buckets; // kBuckets 个
+        uint64_t Quantile(double q) const; // 所在桶的上界（原始单位），没有样本时为 0
+    };
+
+    class Histogram
+    {
+    public:
+        Histogram() = default;
+        void Record(uint64_t value) const
+        {
+            // 各桶与总和在同一页内连续存放
+            std::atomic<uint64_t> *cells = &Cell(base_);
+            Bump(cells[BucketOf(value)], 1);
+            Bump(cells[kBuckets], value);
+        }
+        HistogramSnapshot Snapshot() const;
+
+    private:
+        friend class Metrics;
+        explicit Histogram(uint32_t base) : base_(base) {}
+        uint32_t base_ = 0;
+    };
+
+    // 抓取时由收集器补充的样本（队列深度、缓存统计等已在别处维护的数值）
+    class Writer
+    {
+    public:
+        void Counter(const std::string &name, const std::string &help, const Labels &labels, double value);
+        void Gauge(const std::string &name, const std::string &help, const Labels &labels, double value);
+
+    private:
+        friend class Metrics;
+        void Add(const std::string &name, const std::string &help, const char *type, const Labels &labels, double value);
+        void *families_ = nullptr;
+    };
+    using Collector = std::function<void(Writer &)>;
+
+    // 同名同标签的指标返回同一句柄；直方图导出时乘以 scale（纳秒计时传 1e-9，导出为秒）
+    static Counter GetCounter(const std::string &name, const std::string &help, const Labels &labels = {});
+    static Gauge GetGauge(const std::string &name, const std::string &help, const Labels &labels = {});
+    static Histogram GetHistogram(const std::string &name, const std::string &help, const Labels &labels = {}, double scale = 1e-9);
+
+    static int AddCollector(Collector collector); // 返回编号，供 RemoveCollector 使用
+    static void RemoveCollector(int id);
+
+    static std::string Render(); // Prometheus 文本格式（version 0.0.4）
+
+    static int BucketOf(uint64_t value)
+    {
+        if (value < (1u << kSubBits))
+            return static_cast<int>(value);
+        int exp = 63 - __builtin_clzll(value);
+        if (exp >= kMaxExponent)
+            return kBuckets - 1;
+        return ((exp - kSubBits + 1) << kSubBits) + static_cast<int>((value >> (exp - kSubBits)) & ((1u << kSubBits) - 1));
+    }
+    static uint64_t BucketUpper(int bucket); // 桶的上界（不含）
+
+    static int64_t NowNanos()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+private:
+    static void Bump(std::atomic<uint64_t> &cell, uint64_t n) { cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    static std::atomic<uint64_t> &Cell(uint32_t slot);
+    static std::atomic<uint64_t> &SlowCell(uint32_t slot); // 首次使用的线程或页
+    static uint64_t Sum(uint32_t slot);                   // 所有线程分片之和
+};
+
+// 初始 TLS 模型：pine_shared 随进程启动加载，不经 dlopen，访问分片指针不必调用 __tls_get_addr
+extern __thread Metrics::Shard *t_metricsShard __attribute__((tls_model("initial-exec")));
+
+inline std::atomic<uint64_t> &Metrics::Cell(uint32_t slot)
+{
+    Shard *shard = t_metricsShard;
+    if (__builtin_expect(shard != nullptr, 1))
+    {
+        std::atomic<uint64_t> *page = shard->pages[slot >> kPageBits].load(std::memory_order_relaxed);
+        if (__builtin_expect(page != nullptr, 1))
+            return page[slot & (kPageSlots - 1)];
+    }
+    return SlowCell(slot);
+}
@@ -1,129 +1,261 @@
 #include "RouterTrie.h"
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
 
-
-RouteTrie::RouteTrie() : root_(std::make_shared<TrieNode>()) {}
-
-void RouteTrie::clear() { root_ = std::make_shared<TrieNode>(); }
-
-std::vector<std::string> RouteTrie::splitPath(const std::string &path) 
+namespace
+{
+// 按 '/' 切分，忽略空段（连续的 '/' 与首尾的 '/'）
+std::vector<std::string> splitPath(const std::string &path)
 {
     std::vector<std::string> segments;
-    std::string segment;
-    std::istringstream pathStream(path);
-    while(std::getline(pathStream, segment, '/')) 
+    size_t pos = 0;
+    while (pos < path.size())
     {
-        if(!segment.empty())
-        segments.emplace_back(segment);
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos)
+            end = path.size();
+        if (end > pos)
+            segments.emplace_back(path, pos, end - pos);
+        pos = end + 1;
     }
     return segments;
 }
 
+// 从 pos 起找下一个非空段，返回段起点；没有更多段时返回 path.size()，end 为段终点
+size_t nextSegment(std::string_view path, size_t pos, size_t &end)
+{
+    while (pos < path.size() && path[pos] == '/')
+        ++pos;
+    end = pos < path.size() ? std::min(path.find('/', pos), path.size()) : pos;
+    return pos;
+}
+} // namespace
+
+RouteTrie::RouteTrie() { clear(); }
+
+void RouteTrie::clear()
+{
+    build_.assign(1, BuildNode());
+    compile();
+}
+
 void RouteTrie::addRoute(const std::string &path,
                          const std::string &method,
                          const std::string &handler,
-                         const std::vector<std::string> &paramNames) 
+                         const std::vector<std::string> &paramNames)
 {
-    auto current = root_;
     std::vector<std::string> segments = splitPath(path);
+    if (segments.size() > kMaxDepth)
+        throw std::invalid_argument("route has too many segments: " + path);
 
-    for (const auto &segment : segments) {
-        if (!segment.empty() && segment[0] == ':') {
-            // 参数节点使用 "*" 作为统一键（参数名应记录在子节点上）
-            if (!current->children["*"]) {
-                current->children["*"] = std::make_shared<TrieNode>();
-            }
-            current = current->children["*"];
-            current->paramNames.push_back(segment.substr(1));
-        } else if (segment == "**") {
-            // 通配符节点（可选），使用 "**" 作为键
-            if (!current->children["**"]) {
-                current->children["**"] = std::make_shared<TrieNode>();
-            }
-            current = current->children["**"];
-        } else {
-            // 静态节点
-            if (!current->children[segment]) {
-                current->children[segment] = std::make_shared<TrieNode>();
-            }
-            current = current->children[segment];
+    int current = 0;
+    for (const auto &segment : segments)
+    {
+        int next;
+        if (segment[0] == ':')
+        {
+            next = build_[current].param;
+            if (next < 0)
+                next = build_[current].param = static_cast<int>(build_.size());
         }
+        else if (segment == "**")
+        {
+            next = build_[current].wildcard;
+            if (next < 0)
+                next = build_[current].wildcard = static_cast<int>(build_.size());
+        }
+        else
+        {
+            auto it = build_[current].children.find(segment);
+            next = it != build_[current].children.end() ? it->second : build_[current].children[segment] = static_cast<int>(build_.size());
+        }
+        if (next == static_cast<int>(build_.size()))
+            build_.emplace_back();
+        if (segment[0] == ':')
+            build_[next].paramName = segment.substr(1);
+        current = next;
     }
+    build_[current].handlers[method] = handler;
+    compile();
+}
 
-    current->isLeaf = true;
-    current->handlers[method] = handler;
+uint32_t RouteTrie::intern(const std::string &s)
+{
+    uint32_t offset = static_cast<uint32_t>(pool_.size());
+    pool_ += s;
+    return offset;
 }
 
-RouteMatch RouteTrie::findRoute(const std::string &path, const std::string &method) {
-    // 去除查询串
-    size_t pos = path.find('?');
-    std::string basePath = (pos != std::string::npos) ? path.substr(0, pos) : path;
-
-    auto current = root_;
-    std::unordered_map<std::string, std::string> params;
-    std::vector<std::string> segments = splitPath(basePath);
-
-    std::vector<std::pair<std::shared_ptr<TrieNode>, std::unordered_map<std::string, std::string>>> matches;
-    findMatches(current, segments, 0, params, matches);
-
-    if (!matches.empty()) {
-        for (const auto &m : matches) {
-            if (m.first->isLeaf) {
-                auto it = m.first->handlers.find(method);
-                if (it != m.first->handlers.end()) {
-                    return RouteMatch{it->second, m.second};
-                }
-            }
+// 压平注册树：每个节点的静态子段在 edges_ 中连续且按段排序（std::map 已有序）
+void RouteTrie::compile()
+{
+    nodes_.assign(build_.size(), Node());
+    edges_.clear();
+    handlers_.clear();
+    pool_.clear();
+    for (size_t i = 0; i < build_.size(); ++i)
+    {
+        const BuildNode &b = build_[i];
+        Node &n = nodes_[i];
+        n.edgeBegin = static_cast<uint32_t>(edges_.size());
+        for (const auto &kv : b.children)
+            edges_.push_back(Edge{intern(kv.first), static_cast<uint32_t>(kv.first.size()), kv.second});
+        n.edgeEnd = static_cast<uint32_t>(edges_.size());
+        n.param = b.param;
+        n.wildcard = b.wildcard;
+        n.nameOffset = intern(b.paramName);
+        n.nameLength = static_cast<uint32_t>(b.paramName.size());
+        n.handlerBegin = static_cast<uint32_t>(handlers_.size());
+        for (const auto &kv : b.handlers)
+        {
+            uint32_t methodOffset = intern(kv.first);
+            uint32_t nameOffset = intern(kv.second);
+            handlers_.push_back(Handler{methodOffset, static_cast<uint32_t>(kv.first.size()), nameOffset, static_cast<uint32_t>(kv.second.size())});
         }
+        n.handlerEnd = static_cast<uint32_t>(handlers_.size());
     }
-    return RouteMatch{"", {}};
 }
 
-void RouteTrie::findMatches(std::shared_ptr<TrieNode> node,
-                            const std::vector<std::string> &segments,
-                            size_t currentIndex,
-                            std::unordered_map<std::string, std::string> currentParams,
-                            std::vector<std::pair<std::shared_ptr<TrieNode>, std::unordered_map<std::string, std::string>>> &matches) {
-    if (currentIndex >= segments.size()) {
-        if (node->isLeaf) {
-            matches.push_back({node, currentParams});
-        }
-        return;
+int RouteTrie::findChild(const Node &node, std::string_view segment) const
+{
+    auto begin = edges_.begin() + node.edgeBegin;
+    auto end = edges_.begin() + node.edgeEnd;
+    auto it = std::lower_bound(begin, end, segment, [this](const Edge &e, std::string_view s) { return text(e.offset, e.length) < s; });
+    if (it != end && text(it->offset, it->length) == segment)
+        return it->child;
+    return -1;
+}
+
+std::string_view RouteTrie::findHandler(const Node &node, std::string_view method) const
+{
+    for (uint32_t i = node.handlerBegin; i < node.handlerEnd; ++i)
+    {
+        if (text(handlers_[i].methodOffset, handlers_[i].methodLength) == method)
+            return text(handlers_[i].nameOffset, handlers_[i].nameLength);
     }
+    return std::string_view();
+}
 
-    const std::string &cur = segments[currentIndex];
+bool RouteTrie::match(std::string_view path, std::string_view method, MatchView &out) const
+{
+    // 去除查询串
+    path = path.substr(0, std::min(path.find('?'), path.size()));
 
-    // 1) 静态匹配
-    auto it = node->children.find(cur);
-    if (it != node->children.end()) {
-        findMatches(it->second, segments, currentIndex + 1, currentParams, matches);
-    }
+    // 每帧对应树上的一层：stage 表示下一步尝试 静态 / 参数 / 通配（及通配已吞下的终点）
+    enum Stage : uint8_t
+    {
+        kTryStatic,
+        kTryParam,
+        kTryWildcard,
+        kWildcardMore,
+        kDone
+    };
+    struct Frame
+    {
+        int32_t node;
+        uint32_t pos;      // 本层剩余路径的起点
+        uint32_t capBase;  // 进入本层时已有的捕获数
+        uint32_t wcEnd;    // 通配已吞到的位置
+        Stage stage;
+    };
+    std::array<Frame, kMaxDepth + 1> stack;
+    size_t depth = 0;
+    stack[depth++] = Frame{0, 0, 0, 0, kTryStatic};
 
-    // 2) 参数匹配（*）
-    auto itParam = node->children.find("*");
-    if (itParam != node->children.end()) {
-        auto paramNode = itParam->second;
-        if (!paramNode->paramNames.empty()) {
-            auto nextParams = currentParams;
-            nextParams[paramNode->paramNames.back()] = cur;
-            findMatches(paramNode, segments, currentIndex + 1, nextParams, matches);
+    while (depth > 0)
+    {
+        Frame &f = stack[depth - 1];
+        const Node &node = nodes_[f.node];
+        out.paramCount = f.capBase;
+
+        size_t segEnd;
+        size_t segBegin = nextSegment(path, f.pos, segEnd);
+        if (segBegin == path.size())
+        {
+            // 路径已耗尽：本节点是叶子且有该方法的处理器即命中
+            std::string_view handler = f.stage == kTryStatic ? findHandler(node, method) : std::string_view();
+            if (!handler.empty())
+            {
+                out.handler = handler;
+                return true;
+            }
+            --depth;
+            continue;
         }
-    }
+        std::string_view segment = path.substr(segBegin, segEnd - segBegin);
 
-    // 3) 通配符匹配（**）
-    auto itStarStar = node->children.find("**");
-    if (itStarStar != node->children.end()) {
-        auto wcNode = itStarStar->second;
-        // ** 可以匹配 0..N 段
-        for (size_t i = currentIndex; i <= segments.size(); ++i) {
-            std::string captured;
-            for (size_t j = currentIndex; j < i; ++j) {
-                if (!captured.empty()) captured.push_back('/');
-                captured.append(segments[j]);
+        int child = -1;
+        uint32_t childPos = static_cast<uint32_t>(segEnd);
+        switch (f.stage)
+        {
+        case kTryStatic:
+            f.stage = kTryParam;
+            child = findChild(node, segment);
+            break;
+        case kTryParam:
+            f.stage = kTryWildcard;
+            if (node.param >= 0)
+            {
+                child = node.param;
+                const Node &p = nodes_[child];
+                out.params[out.paramCount++] = std::make_pair(text(p.nameOffset, p.nameLength), segment);
             }
-            auto nextParams = currentParams;
-            if (!captured.empty()) nextParams["*"] = captured; // 统一命名为 "*"
-            findMatches(wcNode, segments, i, nextParams, matches);
+            break;
+        case kTryWildcard:
+            if (node.wildcard < 0)
+            {
+                f.stage = kDone;
+                break;
+            }
+            // 先吞 0 段，之后每次多吞一段
+            f.stage = kWildcardMore;
+            f.wcEnd = static_cast<uint32_t>(segBegin);
+            child = node.wildcard;
+            childPos = f.wcEnd;
+            break;
+        case kWildcardMore:
+        {
+            size_t end;
+            size_t begin = nextSegment(path, f.wcEnd, end);
+            if (begin == path.size())
+            {
+                f.stage = kDone;
+                break;
+            }
+            f.wcEnd = static_cast<uint32_t>(end);
+            child = node.wildcard;
+            childPos = f.wcEnd;
+            out.params[out.paramCount++] = std::make_pair(std::string_view("*"), path.substr(segBegin, end - segBegin));
+            break;
+        }
+        case kDone:
+            break;
         }
+
+        if (f.stage == kDone && child < 0)
+        {
+            --depth;
+            continue;
+        }
+        if (child < 0)
+            continue;
+        // 新帧的 capBase 记录当前捕获数；回到本帧时 out.paramCount 会被重置为 f.capBase
+        stack[depth++] = Frame{child, childPos, static_cast<uint32_t>(out.paramCount), 0, kTryStatic};
     }
+    out.handler = std::string_view();
+    out.paramCount = 0;
+    return false;
+}
+
+RouteMatch RouteTrie::findRoute(const std::string &path, const std::string &method) const
+{
+    MatchView view;
+    if (!match(path, method, view))
+        return RouteMatch{"", {}};
+    RouteMatch m;
+    m.handler.assign(view.handler);
+    for (size_t i = 0; i < view.paramCount; ++i)
+        m.params[std::string(view.params[i].first)] = std::string(view.params[i].second);
+    return m;
 }
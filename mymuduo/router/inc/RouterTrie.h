@@ -1,8 +1,9 @@
 #pragma once
 
 #include <map>
-#include <memory>
+#include <stdint.h>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -14,42 +15,82 @@ struct RouteMatch
     std::unordered_map<std::string, std::string> params; // 提取的路径参数
 };
 
-// Trie树节点
-class TrieNode
-{
-public:
-    std::map<std::string, std::shared_ptr<TrieNode>> children; // 段 -> 子节点
-    std::map<std::string, std::string> handlers;               // method -> handler 名称
-    std::vector<std::string> paramNames;                       // 该层路径的参数名栈（配合 "*" 参数节点）,如/:user/:id,则paramNames为["user","id"]
-    bool isLeaf{false};
-};
-
 // Trie 路由
+// 注册阶段维护一棵便于插入的树，每次 addRoute 后压平成紧凑的节点数组：
+// 同一节点的静态子段连续存放且有序（二分查找），段文字集中存放在一个字符串池中
+// 匹配是迭代的深度优先：固定大小的帧栈与捕获栈，优先级 静态 > 参数 > 通配，命中第一个即返回
 class RouteTrie
 {
 public:
+    static const size_t kMaxDepth = 32; // 单条路由的最大段数
+
+    // 无分配的匹配结果：handler 与参数名指向路由表，参数值指向请求路径；路由表修改或路径释放后失效
+    struct MatchView
+    {
+        std::string_view handler; // 为空表示未命中
+        size_t paramCount = 0;
+        std::pair<std::string_view, std::string_view> params[kMaxDepth];
+    };
+
     RouteTrie();
 
-    // 添加路由：path 允许静态段、:param 参数段、"**" 通配段（可选）
+    // 添加路由：path 允许静态段、:param 参数段、"**" 通配段（可选，匹配 0..N 段）
+    // 段数超过 kMaxDepth 抛出 std::invalid_argument
     void addRoute(const std::string &path,
                   const std::string &method,
                   const std::string &handler,
                   const std::vector<std::string> &paramNames = {});
 
     // 查找路由：返回匹配的 handler 与参数；未命中返回 {"", {}}
-    RouteMatch findRoute(const std::string &path, const std::string &method);
+    RouteMatch findRoute(const std::string &path, const std::string &method) const;
+    // 同上，不分配内存；命中返回 true。"**" 的捕获名为 "*"，为请求路径中对应的原始子串
+    bool match(std::string_view path, std::string_view method, MatchView &out) const;
 
     void clear();
 
 private:
-    std::vector<std::string> splitPath(const std::string &path);
+    // 注册用的树
+    struct BuildNode
+    {
+        std::map<std::string, int> children;         // 静态段 -> 节点
+        int param = -1;                              // :param 子节点
+        int wildcard = -1;                           // ** 子节点
+        std::string paramName;                       // 本节点为参数节点时的参数名（后注册的覆盖先注册的）
+        std::map<std::string, std::string> handlers; // method -> handler 名称
+    };
+
+    // 匹配用的紧凑节点，与 BuildNode 下标一一对应
+    struct Node
+    {
+        uint32_t edgeBegin = 0, edgeEnd = 0;       // edges_ 中的静态子段区间
+        int32_t param = -1;
+        int32_t wildcard = -1;
+        uint32_t nameOffset = 0, nameLength = 0;   // 参数名在 pool_ 中的位置
+        uint32_t handlerBegin = 0, handlerEnd = 0; // handlers_ 中的区间，非空即叶子
+    };
+
+    struct Edge
+    {
+        uint32_t offset, length; // 段文字在 pool_ 中的位置
+        int32_t child;
+    };
+
+    struct Handler
+    {
+        uint32_t methodOffset, methodLength;
+        uint32_t nameOffset, nameLength;
+    };
+
+    uint32_t intern(const std::string &s);
+    std::string_view text(uint32_t offset, uint32_t length) const { return std::string_view(pool_.data() + offset, length); }
+    int findChild(const Node &node, std::string_view segment) const;
+    std::string_view findHandler(const Node &node, std::string_view method) const;
+    void compile();
 
-    void findMatches(std::shared_ptr<TrieNode> node,
-                     const std::vector<std::string> &segments,
-                     size_t currentIndex,
-                     std::unordered_map<std::string, std::string> currentParams,
-                     std::vector<std::pair<std::shared_ptr<TrieNode>,
-                                           std::unordered_map<std::string, std::string>>> &matches);
+    std::vector<BuildNode> build_; // build_[0] 为根
 
-    std::shared_ptr<TrieNode> root_;            // 根节点
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::vector<Handler> handlers_;
+    std::string pool_;
 };
@@ -7,6 +7,8 @@
 #include <assert.h>
 #include <iostream>
 #include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <fcntl.h>
 #include "Logger.h"
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -18,6 +20,7 @@ Connection::Connection(EventLoop *_loop, int fd, int conn_id, const InetAddress&
     channel = std::make_unique<Channel>(loop, fd);
     readBuffer = std::make_unique<Buffer>();
     sendBuffer = std::make_unique<Buffer>();
+    afterFileBuffer = std::make_unique<Buffer>();
     // 不再默认创建具体协议上下文，业务按需 setContext
 }
 
@@ -26,6 +29,7 @@ Connection::~Connection()
     // close(fd); // 关闭文件描述符
     // 注意：deleteConnectionCallback不需要在这里调用，因为它是一个回调函数
     LOG_INFO << "Connection destructor called, fd: " << fd << ", conn_id: " << conn_id;
+    CloseSendFile();
     close(fd);
 }
 
@@ -63,6 +67,7 @@ void Connection::ConnectionEstablished()
     channel->setErrorCallback(std::bind(&Connection::HandleError, this));
     channel->Tie(shared_from_this());                                     // 绑定Connection对象到Channel
     state = connectionState::Connected;
+    loop->CountConnection(1);
     channel->enableReading(true); // 延迟注册事件
     if (onConnectionCallback)     // 打印新连接的信息
         onConnectionCallback(shared_from_this());
@@ -73,7 +78,7 @@ void Connection::Read()
     // assert(state == connectionState::Connected);
     if (state != connectionState::Connected)
         return;
-    readBuffer->RetrieveAll(); // 先将缓冲区的数据全部读取出来
+    // 新数据追加在上次未取走的数据之后：由业务回调取走已处理的部分（如异步响应期间留在缓冲中的流水线请求）
     ReadNonBlocking();
 }
 
@@ -101,6 +106,13 @@ void Connection::Send(const char *msg, size_t len) // 发送数据
     size_t remaining = len;
     ssize_t send_size = 0;
 
+    // 正文还在发送，数据排在正文之后
+    if (SendingBody())
+    {
+        afterFileBuffer->Append(msg, len);
+        return;
+    }
+
     // 如果发送缓冲区空，尝试直接发送
     if (sendBuffer->GetReadablebytes() == 0)
     {
@@ -146,63 +158,130 @@ void Connection::Send(const char *msg, size_t len) // 发送数据
     {
         // 如果没有剩余数据，说明发送缓冲区已经清空，取消写事件监听
         channel->disableWriting();
-        if (writeCompleteCallback)
-            writeCompleteCallback(shared_from_this());
+        WriteComplete();
     }
 }
 
 void Connection::SendFile(int filefd, int size) // 发送文件
 {
-    size_t send_size = 0;
-    size_t data_size = static_cast<size_t>(size);
-    // std::cout<< "Connection::SendFile, filefd: " << filefd << ", size: " << data_size << std::endl;
-    // 一次性把文件写完，虽然肯定不行。
-    while (send_size < data_size)
+    SendFileRange(filefd, 0, static_cast<size_t>(size));
+}
+
+void Connection::SendFileRange(int filefd, off_t start, size_t len)
+{
+    // 调用方仍会关闭 filefd，复制一份交给异步发送（sendfile 指定偏移，不影响共享的文件位置）
+    int dupfd = ::fcntl(filefd, F_DUPFD_CLOEXEC, 0);
+    if (dupfd < 0)
+    {
+        LOG_ERROR << "Connection::SendFileRange - dup failed, errno: " << errno;
+        return;
+    }
+    SendFileStream("", dupfd, start, len);
+}
+
+void Connection::SendFileStream(const std::string &header, int filefd, off_t start, size_t len, const std::shared_ptr<const void> &owner)
+{
+    if (state != connectionState::Connected)
+    {
+        if (!owner)
+            ::close(filefd);
+        return;
+    }
+    if (SendingBody())
+    {
+        // 上一个正文尚未发完（如流水线请求），无法保证顺序，只能断开
+        LOG_ERROR << "Connection::SendFileStream - another file is still sending, fd: " << fd;
+        if (!owner)
+            ::close(filefd);
+        HandleClose();
+        return;
+    }
+    // header 放入发送缓冲区而不是直接 Send，避免头部发完就提前触发 writeCompleteCallback
+    sendBuffer->Append(header.data(), header.size());
+    sendFileFd_ = filefd;
+    sendBodyOwner_ = owner;
+    sendFileOffset_ = start;
+    sendFileRemaining_ = len;
+    WriteNonBlocking();
+}
+
+void Connection::SendBufferStream(const std::string &header, const char *data, size_t len, const std::shared_ptr<const void> &owner)
+{
+    if (state != connectionState::Connected)
+        return;
+    if (SendingBody())
+    {
+        LOG_ERROR << "Connection::SendBufferStream - another body is still sending, fd: " << fd;
+        HandleClose();
+        return;
+    }
+    sendBuffer->Append(header.data(), header.size());
+    if (len > 0)
+    {
+        sendData_ = data;
+        sendDataRemaining_ = len;
+        sendBodyOwner_ = owner;
+    }
+    WriteNonBlocking();
+}
+
+bool Connection::WriteFileNonBlocking()
+{
+    while (sendFileRemaining_ > 0)
     {
-        ssize_t bytes_write = sendfile(fd, filefd, (off_t *)&send_size, data_size - send_size);
-        if (bytes_write == -1 && errno == EINTR) // 程序正常中断、继续写入
+        ssize_t n = ::sendfile(fd, sendFileFd_, &sendFileOffset_, sendFileRemaining_);
+        if (n > 0)
         {
-            printf("continue writing\n");
+            sendFileRemaining_ -= static_cast<size_t>(n);
             continue;
         }
-        else if (bytes_write == -1 && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) // 非阻塞IO，这个条件表示数据全部写入完毕
-        {
+        if (n < 0 && errno == EINTR)
             continue;
-        }
-        else if (bytes_write == -1) // 其他错误
-        {
-            printf("other error, size: %zu\n", data_size);
-            break;
-        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return false; // 等待可写
+        // n == 0 表示文件被截断，已发出的长度与响应头不符，只能断开
+        LOG_ERROR << "Connection::WriteFileNonBlocking - sendfile failed, fd: " << fd << ", errno: " << (n == 0 ? 0 : errno);
+        CloseSendFile();
+        HandleClose();
+        return false;
     }
+    CloseSendFile();
+    return true;
 }
 
-void Connection::SendFileRange(int filefd, off_t start, size_t len)
+bool Connection::WriteDataNonBlocking()
 {
-    // 使用 sendfile 支持 offset 的循环（Linux sendfile 第三个参数为 off_t* 会更新位置）
-    off_t offset = start;
-    size_t sent = 0;
-    while (sent < len) {
-        size_t toSend = len - sent;
-        ssize_t n = ::sendfile(fd, filefd, &offset, toSend);
-        if (n > 0) {
-            sent += static_cast<size_t>(n);
+    while (sendDataRemaining_ > 0)
+    {
+        ssize_t n = ::write(fd, sendData_, sendDataRemaining_);
+        if (n > 0)
+        {
+            sendData_ += n;
+            sendDataRemaining_ -= static_cast<size_t>(n);
             continue;
         }
-        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            // 将剩余部分记录到发送缓冲区（简化：读取拷贝方式）
-            size_t remain = len - sent;
-            std::string tmp;
-            tmp.resize(remain);
-            ssize_t rn = ::pread(filefd, (void *)tmp.data(), remain, offset);
-            if (rn > 0) {
-                Send(tmp.data(), static_cast<size_t>(rn));
-            }
-            break;
-        }
-        if (n == -1 && errno == EINTR) continue;
-        break; // 其他错误终止
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return false; // 等待可写
+        LOG_ERROR << "Connection::WriteDataNonBlocking - write failed, fd: " << fd << ", errno: " << errno;
+        CloseSendFile();
+        HandleClose();
+        return false;
     }
+    CloseSendFile();
+    return true;
+}
+
+void Connection::CloseSendFile()
+{
+    if (sendFileFd_ >= 0 && !sendBodyOwner_)
+        ::close(sendFileFd_);
+    sendFileFd_ = -1;
+    sendFileRemaining_ = 0;
+    sendData_ = nullptr;
+    sendDataRemaining_ = 0;
+    sendBodyOwner_.reset();
 }
 
 void Connection::ReadNonBlocking() // 非阻塞读取数据
@@ -242,31 +321,65 @@ void Connection::ReadNonBlocking() // 非阻塞读取数据
 
 void Connection::WriteNonBlocking() // 非阻塞写入数据
 {
-    size_t remaining = sendBuffer->GetReadablebytes();
-    if (remaining == 0) return;
-    ssize_t send_size = write(fd, sendBuffer->Peek(), remaining);
-    if (send_size == -1)
+    while (state == connectionState::Connected)
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        size_t remaining = sendBuffer->GetReadablebytes();
+        if (remaining > 0)
         {
-            return; // 等待下次可写
+            ssize_t send_size;
+            if (sendData_)
+            {
+                // 响应头与内存正文一次 writev 发出，多写出的部分直接记入正文进度
+                struct iovec iov[2] = {{const_cast<char *>(sendBuffer->Peek()), remaining},
+                                       {const_cast<char *>(sendData_), sendDataRemaining_}};
+                send_size = ::writev(fd, iov, 2);
+                if (send_size > static_cast<ssize_t>(remaining))
+                {
+                    sendData_ += send_size - static_cast<ssize_t>(remaining);
+                    sendDataRemaining_ -= static_cast<size_t>(send_size) - remaining;
+                    send_size = static_cast<ssize_t>(remaining);
+                }
+            }
+            else if (sendFileFd_ >= 0) // 后面紧跟文件时带 MSG_MORE，响应头与文件开头合并成满段发出，避免小段被 Nagle 与延迟确认卡住
+                send_size = ::send(fd, sendBuffer->Peek(), remaining, MSG_MORE);
+            else
+                send_size = write(fd, sendBuffer->Peek(), remaining);
+            if (send_size == -1)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    LOG_ERROR << "Connection::Send - Connection Send ERROR";
+                    return;
+                }
+                send_size = 0;
+            }
+            sendBuffer->Retrieve(static_cast<size_t>(send_size));
+            if (static_cast<size_t>(send_size) < remaining)
+                break; // 等待下次可写
+        }
+        if (sendFileFd_ >= 0)
+        {
+            if (!WriteFileNonBlocking())
+                break;
+            // 文件发完，接着发送期间追加的数据
+            sendBuffer.swap(afterFileBuffer);
+            continue;
+        }
+        if (sendData_)
+        {
+            if (!WriteDataNonBlocking())
+                break;
+            sendBuffer.swap(afterFileBuffer);
+            continue;
         }
-        LOG_ERROR << "Connection::Send - Connection Send ERROR";
-        return;
-    }
-    if (send_size > 0)
-    {
-        remaining -= static_cast<size_t>(send_size);
-        sendBuffer->Retrieve(static_cast<size_t>(send_size));
-    }
-    if (remaining == 0)
-    {
         // 如果发送缓冲区已经清空，取消写事件监听
         channel->disableWriting();
-        if (writeCompleteCallback)
-            writeCompleteCallback(shared_from_this());
+        WriteComplete();
+        return;
     }
-    // 如果还有剩余数据，继续监听写事件
+    // 还有剩余数据，继续监听写事件
+    if (state == connectionState::Connected && !channel->isWriting())
+        channel->enableWriting(true);
 }
 
 connectionState Connection::GetState() // 获取连接状态
@@ -279,8 +392,17 @@ void Connection::HandleClose() // 关闭连接
     if (state == connectionState::Closed)
         return;
     state = connectionState::Closed;
+    loop->CountConnection(-1);
     if (closeCallback)
         closeCallback(shared_from_this());
+    // 排队的数据不会再写出：一次性回调也在此调用，等待者通过 GetState 得知连接已关闭
+    if (!afterWriteHooks_.empty())
+    {
+        std::vector<std::function<void(const std::shared_ptr<Connection> &)>> hooks;
+        hooks.swap(afterWriteHooks_);
+        for (auto &hook : hooks)
+            hook(shared_from_this());
+    }
     deleteConnectionCallback(shared_from_this());
 }
 
@@ -321,6 +443,29 @@ EventLoop *Connection::GetLoop() // 获取事件循环
     return loop;
 }
 
+void Connection::RunAfterWrite(const std::function<void(const std::shared_ptr<Connection> &)> &fn)
+{
+    if (!SendingBody() && sendBuffer->GetReadablebytes() == 0)
+    {
+        fn(shared_from_this());
+        return;
+    }
+    afterWriteHooks_.push_back(fn);
+}
+
+void Connection::WriteComplete()
+{
+    if (!afterWriteHooks_.empty())
+    {
+        std::vector<std::function<void(const std::shared_ptr<Connection> &)>> hooks;
+        hooks.swap(afterWriteHooks_); // 回调中可能再次排队
+        for (auto &hook : hooks)
+            hook(shared_from_this());
+    }
+    if (writeCompleteCallback)
+        writeCompleteCallback(shared_from_this());
+}
+
 void Connection::shutdown() 
 {
     if (state == connectionState::Connected)
@@ -341,6 +486,24 @@ void Connection::forceClose()
     }
 }
 
+void Connection::StopReading()
+{
+    if (state == connectionState::Connected && reading_)
+    {
+        reading_ = false;
+        channel->disableReading();
+    }
+}
+
+void Connection::StartReading()
+{
+    if (state == connectionState::Connected && !reading_)
+    {
+        reading_ = true;
+        channel->enableReading(true); // ET 模式下重新注册，内核中已有数据会再次触发
+    }
+}
+
 void Connection::HandleEvent() // 处理事件，调用回调函数
 {
     // LOG_INFO << "HandleEvent, fd: " << fd << ", state: " << state;
@@ -357,7 +520,6 @@ void Connection::HandleEvent() // 处理事件，调用回调函数
 
 void Connection::HandleWrite() // 处理写事件
 {
-    LOG_INFO << "HandleWrite, fd: " << fd << ", state: " << state;
     Write();
 }
 
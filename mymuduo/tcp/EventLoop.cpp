@@ -7,7 +7,12 @@
 #include <sys/eventfd.h>
 #include <assert.h>
 
-EventLoop::EventLoop() : quit(false), callingfunctor(false)
+namespace
+{
+thread_local EventLoop *t_loopInThisThread = nullptr;
+}
+
+EventLoop::EventLoop() : quit(false), callingfunctor(false), connections_(0)
 {
     ep = std::make_unique<Epoll>(); // 使用智能指针管理Epoll实例
 
@@ -31,6 +36,7 @@ EventLoop::~EventLoop()
 void EventLoop::loop()
 {
     tid = CurrentThread::tid(); // 获取当前线程ID
+    t_loopInThisThread = this;
     while (!quit)
     {
         std::vector<Channel *> ActiveEvents = ep->poll();
@@ -40,8 +46,11 @@ void EventLoop::loop()
         }
         doToDoList(); // 执行待处理的任务列表
     }
+    t_loopInThisThread = nullptr;
 }
 
+EventLoop *EventLoop::CurrentLoop() { return t_loopInThisThread; }
+
 void EventLoop::updateChannel(Channel *ch)
 {
     ep->updateChannel(ch); // 更新Channel到epoll中
@@ -74,7 +83,8 @@ void EventLoop::queueOneFunc(const std::function<void()> fn) // 将任务添加
     // 如果调用当前函数的并不是当前当前EventLoop对应的的线程，将其唤醒。主要用于关闭TcpConnection
     // 由于关闭连接是由对应`TcpConnection`所发起的，但是关闭连接的操作应该由main_reactor所进行
     // 为了释放ConnectionMap的所持有的TcpConnection
-    if (!callingfunctor || !isInLoopThread()) // 如果当前正在处理任务或者不是当前线程
+    // loop 线程在处理事件时添加的任务会在本轮 doToDoList 中执行，无需唤醒；在任务中再添加的任务要等下一轮，必须唤醒
+    if (callingfunctor || !isInLoopThread()) // 如果当前正在处理任务或者不是当前线程
     {
         uint64_t one = 1;
         ssize_t write_size = write(wakeup_fd, &one, sizeof(one));
@@ -108,6 +118,12 @@ void EventLoop::doToDoList() // 执行待处理的任务列表
     callingfunctor = false; // 任务处理完毕
 }
 
+size_t EventLoop::PendingTasks()
+{
+    std::lock_guard<std::mutex> lock(tasks_mtx);
+    return tasks.size();
+}
+
 void EventLoop::handleWakeup() // 处理唤醒事件
 {
     uint64_t one = 1;
@@ -103,4 +103,10 @@ void Server::SetThreadPoolSize(int size)
         return;
     }
     threadPool->SetThreadNums(size); // 设置线程池大小
-}
\ No newline at end of file
+}
+std::vector<EventLoop *> Server::GetLoops() const
+{
+    std::vector<EventLoop *> loops{mainReactor};
+    loops.insert(loops.end(), threadPool->GetLoops().begin(), threadPool->GetLoops().end());
+    return loops;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 #include "Channel.h"
 #include "Buffer.h"
 #include "Macro.h"
@@ -42,15 +43,30 @@ private:
     std::function<void(const std::shared_ptr<Connection> &)> deleteConnectionCallback;      // 从 Server 移除
     std::function<void(const std::shared_ptr<Connection> &)> onConnectionCallback;          // 连接建立通知
     std::function<void(const std::shared_ptr<Connection> &)> writeCompleteCallback;         // 发送缓冲区清空
+    std::vector<std::function<void(const std::shared_ptr<Connection> &)>> afterWriteHooks_; // 一次性：当前已排队的数据写完后调用
     std::function<void(const std::shared_ptr<Connection> &)> closeCallback;                 // 主动/被动关闭
     std::function<void(const std::shared_ptr<Connection> &)> errorCallback;                 // 错误事件
     std::function<void(const std::shared_ptr<Connection> &, size_t)> highWaterMarkCallback; // 高水位
     size_t highWaterMark_ = 64 * 1024;                                                      // 默认 64KB
+    bool reading_ = true;                                                                   // 是否在监听读事件
+
+    // 零拷贝正文发送：sendBuffer 中的数据（响应头）发完后用 sendfile 发送文件区间，或直接从共享内存写出，期间 Send 的数据排在正文之后
+    int sendFileFd_ = -1;                // 正在发送的文件，发完或连接析构时关闭
+    off_t sendFileOffset_ = 0;           // 下一个要发送的文件偏移
+    size_t sendFileRemaining_ = 0;       // 文件区间剩余字节数
+    const char *sendData_ = nullptr;     // 正在发送的内存正文（与文件互斥）
+    size_t sendDataRemaining_ = 0;       // 内存正文剩余字节数
+    std::shared_ptr<const void> sendBodyOwner_; // 正文的持有者：非空时文件 fd 归它所有，发完只释放引用
+    std::unique_ptr<Buffer> afterFileBuffer; // 正文发送期间追加的数据
 
     std::shared_ptr<HttpContext> context;
 
     void ReadNonBlocking();  // 非阻塞读取数据F
     void WriteNonBlocking(); // 非阻塞写入数据
+    bool WriteFileNonBlocking(); // sendfile 发送文件区间，发完返回 true
+    bool WriteDataNonBlocking(); // 发送内存正文，发完返回 true
+    void CloseSendFile();        // 结束正文发送，关闭文件或释放持有者
+    void WriteComplete();        // 数据全部写出：先调一次性回调，再调 writeCompleteCallback
 
 public:
     DISALLOW_COPY_AND_MOVE(Connection);
@@ -78,10 +94,22 @@ public:
     void Send(const std::string &msg);                       // 发送消息
     void Send(const char *msg, size_t len);                  // 发送C风格字符串
     void Send(const char *msg);                              // 发送C风格字符串
-    void SendFile(int filefd, int size);                     // 发送文件
-    void SendFileRange(int filefd, off_t start, size_t len); // 发送文件区间
+    void SendFile(int filefd, int size);                     // 发送文件（不接管 filefd）
+    void SendFileRange(int filefd, off_t start, size_t len); // 发送文件区间（不接管 filefd）
+    // 先发 header，再零拷贝发送文件区间并接管 filefd：按可写事件驱动 sendfile，不阻塞 loop，全部发完后才触发 writeCompleteCallback
+    // owner 非空时不接管 filefd，改为发送期间持有 owner（共享的缓存 fd）
+    void SendFileStream(const std::string &header, int filefd, off_t start, size_t len, const std::shared_ptr<const void> &owner = nullptr);
+    // 先发 header，再直接从 data 发送 len 字节（不拷入发送缓冲区），发送期间持有 owner，全部发完后才触发 writeCompleteCallback
+    void SendBufferStream(const std::string &header, const char *data, size_t len, const std::shared_ptr<const void> &owner);
+    bool SendingBody() const { return sendFileFd_ >= 0 || sendData_ != nullptr; } // 正文（文件或共享内存）是否仍在发送
+    // 目前已排队的数据（包括正在发送的正文）全部写出后调用 fn 一次，没有待写数据时立即调用
+    // 用于单个响应的收尾（如响应后关闭），不会覆盖 writeCompleteCallback；连接关闭时未写出的也会调用一次
+    void RunAfterWrite(const std::function<void(const std::shared_ptr<Connection> &)> &fn);
     void shutdown();                                         // 半关闭(写端)
     void forceClose();                                       // 强制关闭
+    void StopReading();                                      // 暂停读事件（背压），需在所属 loop 线程调用
+    void StartReading();                                     // 恢复读事件
+    bool IsReading() const { return reading_; }              // 是否在监听读事件
 
     connectionState GetState();          // 获取连接状态
     void SetSendBuffer(const char *str); // 设置发送缓冲区内容
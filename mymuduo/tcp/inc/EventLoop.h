@@ -39,6 +39,8 @@ private:
     // 定时器队列
     std::unique_ptr<TimerQueue> timer_queue;
 
+    std::atomic<int> connections_; // 本循环上已建立的连接数（关闭可能发生在其他线程）
+
 public:
     DISALLOW_COPY_AND_MOVE(EventLoop);
     EventLoop();
@@ -53,9 +55,15 @@ public:
 
     // 线程判断
     bool isInLoopThread() const;
+    static EventLoop *CurrentLoop(); // 当前线程正在运行的事件循环，没有则为 nullptr
     void doToDoList();   // 执行待处理的任务列表
     void handleWakeup(); // 处理唤醒事件
 
+    // 统计（指标抓取用，可在任意线程调用）
+    void CountConnection(int delta) { connections_.fetch_add(delta, std::memory_order_relaxed); }
+    int ConnectionCount() const { return connections_.load(std::memory_order_relaxed); }
+    size_t PendingTasks(); // 任务队列中尚未执行的任务数
+
     // 定时器的回调函数
     void RunAt(TimeStamp when, const std::function<void()> &cb);     // 在指定时间执行回调
     void RunAfter(double delay, const std::function<void()> &cb);    // 延迟指定时间执行回调
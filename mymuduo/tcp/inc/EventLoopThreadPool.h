@@ -28,4 +28,5 @@ public:
 
     // 获取线程池中的EventLoop
     EventLoop *nextloop();
+    const std::vector<EventLoop *> &GetLoops() const { return loops_; } // 不含主事件循环
 };
\ No newline at end of file
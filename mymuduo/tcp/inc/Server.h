@@ -53,4 +53,5 @@ public:
     void DeleteConnection(std::shared_ptr<Connection> const &conn);                                                         // 断开TCP连接
     void HandleCloseInMainReactor(std::shared_ptr<Connection> const &conn);                                                 // 在主事件循环中处理连接关闭
     void SetThreadPoolSize(int size);                                                                                       // 设置线程池大小
+    std::vector<EventLoop *> GetLoops() const;                                                                              // 主事件循环与各工作线程的事件循环
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "TimerQueue.h"
 #include "util.h"
+#include "Metrics.h"
 #include <sys/socket.h>
 #include <cstring>
 #include <cassert>
@@ -49,8 +50,13 @@ void TimerQueue::HandleRead()
     active_timers_.insert(active_timers_.end(), timers_.begin(), end);
 
     timers_.erase(timers_.begin(), end);
+    // 到期到实际执行的延迟，反映事件循环被阻塞的程度
+    static const Metrics::Histogram lateness = Metrics::GetHistogram("event_loop_timer_lateness_seconds", "Delay between timer expiration and callback start");
+    int64_t now = TimeStamp::Now().GetMicroseconds();
     for (auto &entry : active_timers_)
     {
+        int64_t late = now - entry.first.GetMicroseconds();
+        lateness.Record(late > 0 ? static_cast<uint64_t>(late) * 1000 : 0);
         entry.second->run(); // 执行定时器回调函数
     }
     ResetTimers(); // 重置定时器
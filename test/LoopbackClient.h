@@ -0,0 +1,151 @@
+#pragma once
+
+// 测试与基准共用的回环 HTTP 客户端：连接本机端口、整段写出、按 Content-Length 读响应
+// 读取函数都带一个 pending 缓冲：多读到的字节（流水线的下一个响应）留在其中，供下次读取
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// 连接 127.0.0.1:port，服务端线程可能尚未开始监听，失败时重试约 2 秒；noDelay 关闭 Nagle（基准逐个请求往返时用）
+inline int Connect(int port, bool noDelay = false)
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0)
+        {
+            if (noDelay)
+            {
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return -1;
+}
+
+// 写出全部数据，出错返回 false
+inline bool SendAll(int fd, const std::string &data)
+{
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n <= 0)
+            return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 测试用：写失败即断言失败
+inline void Write(int fd, const std::string &data)
+{
+    bool ok = SendAll(fd, data);
+    assert(ok);
+    (void)ok;
+}
+
+// 读一次到 pending；timeoutMs < 0 时阻塞等待。超时或对端关闭返回 false
+inline bool ReadMore(int fd, std::string &pending, int timeoutMs = -1, size_t limit = 64 * 1024)
+{
+    if (timeoutMs >= 0)
+    {
+        pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, timeoutMs) <= 0)
+            return false;
+    }
+    char tmp[64 * 1024];
+    ssize_t n = ::read(fd, tmp, std::min(sizeof(tmp), limit));
+    if (n <= 0)
+        return false;
+    pending.append(tmp, static_cast<size_t>(n));
+    return true;
+}
+
+// 读到一个完整的头部块（含 1xx 中间响应）并从 pending 中取走；超时或对端关闭返回空串
+inline std::string ReadHead(int fd, std::string &pending, int timeoutMs = -1)
+{
+    while (true)
+    {
+        size_t headEnd = pending.find("\r\n\r\n");
+        if (headEnd != std::string::npos)
+        {
+            std::string head = pending.substr(0, headEnd + 4);
+            pending.erase(0, headEnd + 4);
+            return head;
+        }
+        if (!ReadMore(fd, pending, timeoutMs))
+            return "";
+    }
+}
+
+// 头部中的 Content-Length，没有时为 0
+inline uint64_t ContentLength(const std::string &head)
+{
+    size_t pos = head.find("Content-Length: ");
+    return pos == std::string::npos ? 0 : std::strtoull(head.c_str() + pos + 16, nullptr, 10);
+}
+
+// 读一个完整响应（按 Content-Length），返回头部；body 为空时读完即丢弃正文（大文件下载不拷贝）；对端关闭返回空串
+inline std::string ReadResponse(int fd, std::string &pending, std::string *body = nullptr)
+{
+    std::string head = ReadHead(fd, pending);
+    if (head.empty())
+        return "";
+    uint64_t len = ContentLength(head);
+    if (body)
+    {
+        while (pending.size() < len)
+            if (!ReadMore(fd, pending))
+                return "";
+        body->assign(pending, 0, len);
+        pending.erase(0, len);
+        return head;
+    }
+    uint64_t skipped = std::min<uint64_t>(len, pending.size());
+    pending.erase(0, skipped);
+    std::string discard;
+    while (skipped < len)
+    {
+        // 只读本响应剩余的字节，不吞掉后面的响应
+        if (!ReadMore(fd, discard, -1, static_cast<size_t>(std::min<uint64_t>(len - skipped, 64 * 1024))))
+            return "";
+        skipped += discard.size();
+        discard.clear();
+    }
+    return head;
+}
+
+inline std::string ReadResponse(int fd, std::string &pending, std::string &body)
+{
+    return ReadResponse(fd, pending, &body);
+}
+
+// 对端已关闭连接（2 秒内读到 EOF）
+inline bool PeerClosed(int fd, int timeoutMs = 2000)
+{
+    pollfd pfd{fd, POLLIN, 0};
+    char c;
+    return ::poll(&pfd, 1, timeoutMs) == 1 && ::read(fd, &c, 1) == 0;
+}
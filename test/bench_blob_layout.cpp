@@ -0,0 +1,151 @@
+#include "BlobStore.h"
+#include "Sha256.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 基准：百万级文件下平铺目录与扇出目录的 stat/open/create 延迟与目录遍历耗时
+// 先在平铺目录创建 N 个内容文件，测量后用 LayoutMigrator 迁移到扇出布局再测量
+// 用法: bench_blob_layout [目录=./bench_layout_tmp] [文件数=1000000] [采样数=100000] [迁移线程=4]
+using Clock = std::chrono::steady_clock;
+
+struct Latency
+{
+    double avgUs;
+    double p99Us;
+};
+
+static Latency Summarize(std::vector<double> &us)
+{
+    std::sort(us.begin(), us.end());
+    double sum = 0;
+    for (double v : us)
+        sum += v;
+    return Latency{sum / us.size(), us[std::min(us.size() - 1, us.size() * 99 / 100)]};
+}
+
+template <typename F>
+static Latency Measure(size_t samples, F op)
+{
+    std::vector<double> us;
+    us.reserve(samples);
+    for (size_t i = 0; i < samples; ++i)
+    {
+        auto t0 = Clock::now();
+        op(i);
+        us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+    return Summarize(us);
+}
+
+static double ListSeconds(const std::string &dir, size_t *count)
+{
+    auto t0 = Clock::now();
+    DIR *d = ::opendir(dir.c_str());
+    *count = 0;
+    if (d)
+    {
+        while (::readdir(d))
+            ++*count;
+        ::closedir(d);
+    }
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static void Print(const char *name, const Latency &l)
+{
+    std::cout << "  " << name << ": avg " << l.avgUs << " us, p99 " << l.p99Us << " us" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string dir = argc > 1 ? argv[1] : "./bench_layout_tmp";
+    size_t files = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+    size_t samples = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100000;
+    int threads = argc > 4 ? std::atoi(argv[4]) : 4;
+    if (files == 0 || samples == 0)
+        return 1;
+    std::string cleanup = "rm -rf " + dir;
+    if (std::system(cleanup.c_str()) != 0)
+        return 1;
+    ::mkdir(dir.c_str(), 0755);
+    ShardedBlobStore store(dir + "/blobs", dir);
+
+    std::vector<std::string> hashes(files);
+    for (size_t i = 0; i < files; ++i)
+    {
+        std::string key = std::to_string(i);
+        hashes[i] = Sha256::HexOf(key.data(), key.size());
+    }
+    std::mt19937_64 rng(7);
+    std::vector<size_t> picks(samples);
+    for (size_t &p : picks)
+        p = rng() % files;
+
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < files; ++i)
+    {
+        int fd = ::open(store.FlatBlobPath(hashes[i]).c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0)
+            ::close(fd);
+    }
+    std::cout << files << " files created flat in " << std::chrono::duration<double>(Clock::now() - t0).count() << " s" << std::endl;
+
+    struct stat st;
+    std::cout << "flat layout:" << std::endl;
+    Print("stat  ", Measure(samples, [&](size_t i) { ::stat(store.FlatBlobPath(hashes[picks[i]]).c_str(), &st); }));
+    Print("open  ", Measure(samples, [&](size_t i) {
+        int fd = ::open(store.FlatBlobPath(hashes[picks[i]]).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+            ::close(fd);
+    }));
+    Print("create", Measure(std::min<size_t>(samples, 10000), [&](size_t i) {
+        std::string p = store.FlatBlobPath("new" + std::to_string(i));
+        int fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0)
+            ::close(fd);
+        ::unlink(p.c_str());
+    }));
+    size_t entries = 0;
+    double listSecs = ListSeconds(store.Root(), &entries);
+    std::cout << "  list  : " << entries << " entries in " << listSecs << " s" << std::endl;
+
+    t0 = Clock::now();
+    LayoutMigrator::Stats ms = LayoutMigrator(store).Run(threads);
+    std::cout << "migrated " << ms.moved << " files (failed " << ms.failed << ") with " << threads << " threads in "
+              << std::chrono::duration<double>(Clock::now() - t0).count() << " s" << std::endl;
+
+    std::cout << "sharded layout:" << std::endl;
+    std::string path;
+    uint64_t size = 0;
+    Print("stat  ", Measure(samples, [&](size_t i) { ::stat(store.BlobPath(hashes[picks[i]]).c_str(), &st); }));
+    Print("open  ", Measure(samples, [&](size_t i) {
+        int fd = ::open(store.BlobPath(hashes[picks[i]]).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+            ::close(fd);
+    }));
+    Print("create", Measure(std::min<size_t>(samples, 10000), [&](size_t i) {
+        std::string key = "new" + std::to_string(i);
+        std::string p = store.BlobPath(Sha256::HexOf(key.data(), key.size()));
+        int fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0)
+            ::close(fd);
+        ::unlink(p.c_str());
+    }));
+    Print("Resolve", Measure(samples, [&](size_t i) { store.Resolve("", hashes[picks[i]], &path, &size); }));
+    std::string shard = store.BlobPath(hashes[0]);
+    listSecs = ListSeconds(shard.substr(0, shard.rfind('/')), &entries);
+    std::cout << "  list one shard: " << entries << " entries in " << listSecs << " s" << std::endl;
+
+    if (std::system(cleanup.c_str()) != 0)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "BlobStore.h"
+#include "FdCache.h"
+#include "ContentCache.h"
+#include "Sha256.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：热点小文件下载的 requests/sec，对比 sendfile 发送与经 ContentCache 从内存发送
+// 服务端与 FileHandler 下载路径相同：经 FdCache 打开文件，未缓存内容时 FILE_TYPE 响应 sendfile 发送，命中时 BUFFER_TYPE 响应引用缓存内容
+// 客户端多条 keep-alive 连接循环请求少量热点文件，排除建连开销
+// 用法: bench_content_cache [热点文件数=64] [文件KB=16] [连接数=8] [每轮秒数=3]
+using Clock = std::chrono::steady_clock;
+
+static const int kServerPort = 18097;
+static std::string g_dir;
+static std::vector<std::string> g_hashes;
+static ShardedBlobStore *g_store = nullptr;
+static std::atomic<ContentCache *> g_contentCache(nullptr);
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    size_t index = std::strtoull(req.GetUrl().c_str() + 1, nullptr, 10) % g_hashes.size();
+    std::shared_ptr<const CachedFile> file = g_store->Open("", g_hashes[index]);
+    if (!file)
+    {
+        resp->SetStatusCode(HttpStatusCode::NotFound);
+        resp->SetStatusMessage("Not Found");
+        return true;
+    }
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetContentType("application/octet-stream");
+    ContentCache *contentCache = g_contentCache.load();
+    std::shared_ptr<const std::string> body = contentCache ? contentCache->Get(*file) : nullptr;
+    if (body)
+    {
+        resp->SetSharedBody(body);
+        return true;
+    }
+    resp->SetBodyType(HttpBodyType::FILE_TYPE);
+    resp->SetSharedFile(file->fd, file);
+    resp->SetContentLength(static_cast<long long>(file->size));
+    return true;
+}
+
+static void RunServer()
+{
+    EventLoop loop;
+    HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+    server.SetHttpCallback(OnRequest);
+    server.SetThreadNums(4);
+    server.start();
+    loop.loop();
+}
+
+// 一个请求一个响应，按 Content-Length 读完正文
+static bool Request(int fd, uint64_t index, std::string &pending, std::string &body)
+{
+    return SendAll(fd, "GET /" + std::to_string(index) + " HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n") && !ReadResponse(fd, pending, body).empty();
+}
+
+static void RunRound(const char *name, int connections, double seconds)
+{
+    std::atomic<uint64_t> total(0);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < connections; ++c)
+    {
+        clients.emplace_back([&, c]() {
+            int fd = Connect(kServerPort, true);
+            std::string pending, body;
+            uint64_t i = static_cast<uint64_t>(c), n = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (!Request(fd, i++, pending, body))
+                {
+                    std::cerr << name << ": request failed" << std::endl;
+                    std::exit(1);
+                }
+                ++n;
+            }
+            total += n;
+            ::close(fd);
+        });
+    }
+    Clock::time_point t0 = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &t : clients)
+        t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    std::cout << name << ": " << static_cast<uint64_t>(total / secs) << " req/s" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t files = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    size_t fileKb = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    int connections = argc > 3 ? std::atoi(argv[3]) : 8;
+    double seconds = argc > 4 ? std::atof(argv[4]) : 3.0;
+    Logger::SetLogLevel(Logger::ERROR);
+
+    char tmpl[] = "/tmp/bench_content_cache_XXXXXX";
+    g_dir = ::mkdtemp(tmpl);
+    ShardedBlobStore store(g_dir + "/blobs", g_dir);
+    FdCache fdCache(1024, 16);
+    store.SetFdCache(&fdCache);
+    g_store = &store;
+    for (size_t i = 0; i < files; ++i)
+    {
+        std::string content(fileKb * 1024, static_cast<char>('a' + i % 26));
+        content += std::to_string(i);
+        std::string hash = Sha256::HexOf(content.data(), content.size());
+        std::ofstream(g_dir + "/in", std::ios::binary | std::ios::trunc) << content;
+        store.Adopt(g_dir + "/in", hash);
+        g_hashes.push_back(hash);
+    }
+
+    std::thread(RunServer).detach();
+
+    RunRound("sendfile", connections, seconds);
+    ContentCache contentCache(64 * 1024 * 1024, 1024 * 1024);
+    g_contentCache = &contentCache;
+    RunRound("memory  ", connections, seconds);
+    ContentCache::Stats st = contentCache.GetStats();
+    std::cout << "content cache hit rate " << st.HitRate() << ", " << st.entries << " files, " << st.bytes << " bytes, "
+              << st.loads << " loads" << std::endl;
+
+    std::system(("rm -rf " + g_dir).c_str());
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "Db.h"
+#include "DbPool.h"
+#include "FileRepository.h"
+#include "FileListQuery.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// 基准：bench_file_listing 的真实数据库版本。为一个用户写入 N 个文件（十分之一带分享），对比改动前的列表
+// （整表取出 + 每个文件一次分享查询）与分页列表（一页一条 SQL）的首页耗时、翻完全部页的耗时与语句数
+// 数据写在单独建立的临时库中（表结构与索引取自 file_manager），结束后删除整个库，不改动 file_manager 中的数据
+// 需要本机 MySQL（与 http_upload 相同的连接参数）
+// 用法: bench_db_listing [文件数=10000]
+using Clock = std::chrono::steady_clock;
+
+static const char *kScratchDb = "file_manager_bench_listing";
+
+static double Ms(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static int Run(int files)
+{
+    DbPool pool("localhost", "root", "123456", kScratchDb, 3306, 1);
+    if (pool.ConnectAll() == 0)
+        return 1;
+    std::string username = "bench_list";
+    int userId = 0;
+    {
+        DbPool::Stmt st = pool.prepare("INSERT INTO users (username, password) VALUES (?, 'x')");
+        if (!st || !st->execute(username))
+            return 1;
+        userId = static_cast<int>(st->insertId());
+    }
+    pool.exec("START TRANSACTION");
+    for (int i = 0; i < files; ++i)
+    {
+        DbPool::Stmt st = pool.prepare("INSERT INTO files (filename, original_filename, file_size, file_type, user_id, created_at) "
+                                       "VALUES (?, ?, ?, 'text/plain', ?, NOW() - INTERVAL ? SECOND)");
+        std::string name = "bench_" + std::to_string(i);
+        if (!st || !st->execute(name, name + ".txt", static_cast<uint64_t>(i % 997) * 1024, userId, i))
+            break;
+        if (i % 10 == 0)
+        {
+            int fileId = static_cast<int>(st->insertId());
+            DbPool::Stmt share = pool.prepare("INSERT INTO file_shares (file_id, owner_id, share_type, share_code) VALUES (?, ?, 'public', ?)");
+            if (share)
+                share->execute(fileId, userId, "bl_" + std::to_string(i));
+        }
+    }
+    pool.exec("COMMIT");
+
+    FilesRepository repo(pool);
+
+    Clock::time_point t0 = Clock::now();
+    size_t rows = 0;
+    long statements = 1;
+    {
+        std::vector<int> ids;
+        {
+            DbPool::Stmt st = pool.prepare("SELECT id, filename, original_filename, file_size, file_type, created_at FROM files WHERE user_id = ?");
+            if (st && st->query(userId))
+                while (st->fetch())
+                    ids.push_back(st->getInt(0));
+        }
+        for (int id : ids)
+        {
+            DbPool::Stmt st = pool.prepare("SELECT fs.share_type, fs.shared_with_id, u.username, fs.share_code, fs.extract_code, fs.expire_time "
+                                           "FROM file_shares fs LEFT JOIN users u ON fs.shared_with_id = u.id WHERE fs.file_id = ? LIMIT 1");
+            if (st && st->query(id))
+                st->fetch();
+            ++statements;
+        }
+        rows = ids.size();
+    }
+    std::cout << "before (all rows + share per row): " << rows << " files, " << statements << " statements, " << Ms(t0) << " ms" << std::endl;
+
+    for (FileListQuery::Sort sort : {FileListQuery::kNewest, FileListQuery::kNameAsc, FileListQuery::kLargest})
+    {
+        t0 = Clock::now();
+        FilePage first;
+        repo.listFiles(userId, FileListQuery::kMine, sort, nullptr, FileListQuery::kDefaultLimit, first);
+        double firstMs = Ms(t0);
+        t0 = Clock::now();
+        size_t total = 0;
+        long pages = 0;
+        std::optional<FileListQuery::Cursor> cursor;
+        for (;;)
+        {
+            FilePage page;
+            if (!repo.listFiles(userId, FileListQuery::kMine, sort, cursor ? &*cursor : nullptr, FileListQuery::kMaxLimit, page))
+                break;
+            total += page.rows.size();
+            ++pages;
+            if (page.nextCursor.empty())
+                break;
+            cursor.emplace();
+            FileListQuery::DecodeCursor(page.nextCursor, sort, &*cursor);
+        }
+        std::cout << "paged (" << FileListQuery::SortName(sort) << "): first page of " << FileListQuery::kDefaultLimit << " " << firstMs << " ms; all "
+                  << total << " files in " << pages << " pages of " << FileListQuery::kMaxLimit << ", " << Ms(t0) << " ms" << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int files = argc > 1 ? std::atoi(argv[1]) : 10000;
+    Logger::SetLogLevel(Logger::ERROR);
+    Db admin("localhost", "root", "123456", "file_manager", 3306);
+    if (!admin.connect())
+    {
+        std::cerr << "cannot connect to MySQL at localhost:3306/file_manager" << std::endl;
+        return 1;
+    }
+    // 上次运行中断时留下的临时库先删掉
+    const std::string db = kScratchDb;
+    if (!admin.exec("DROP DATABASE IF EXISTS " + db) || !admin.exec("CREATE DATABASE " + db))
+        return 1;
+    int rc = 0;
+    for (const char *table : {"users", "files", "file_shares"})
+        if (!admin.exec("CREATE TABLE " + db + "." + table + " LIKE file_manager." + table))
+            rc = 1;
+    if (rc == 0)
+        rc = Run(files);
+    admin.exec("DROP DATABASE " + db);
+    return rc;
+}
@@ -0,0 +1,145 @@
+#include "DbPool.h"
+#include "AuthHandler.h"
+#include "ShareRepository.h"
+#include "Util.h"
+#include "Logger.h"
+#include <mysql/mysql.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：热点查询在文本协议（拼接 SQL、逐列 stoi，改用预处理语句之前的写法）与预处理语句下的每秒查询数，
+// 以及 validateSession 经会话缓存、校验签名令牌（不访问数据库）时的每秒次数
+// 查询真实存在的会话与分享码（表为空时查不存在的值，仍走完整的查询路径）；只读，不修改数据
+// 需要本机 MySQL 上的 file_manager 库（与 http_upload 相同的连接参数）
+// 用法: bench_db_queries [秒数=5] [线程数=4]
+
+static int Run(int seconds, int threads)
+{
+    DbPool pool("localhost", "root", "123456", "file_manager", 3306, static_cast<size_t>(threads));
+    if (pool.ConnectAll() == 0)
+    {
+        std::cerr << "cannot connect to MySQL at localhost:3306/file_manager" << std::endl;
+        return 1;
+    }
+    AuthHandler auth(pool);
+    SharesRepository shares(pool);
+    std::string sessionId = "no-such-session";
+    std::string shareCode = "no-such-share";
+    if (MYSQL_RES *r = pool.query("SELECT session_id FROM sessions WHERE expire_time > NOW() LIMIT 1"))
+    {
+        if (MYSQL_ROW row = mysql_fetch_row(r))
+            sessionId = row[0];
+        mysql_free_result(r);
+    }
+    if (MYSQL_RES *r = pool.query("SELECT share_code FROM file_shares LIMIT 1"))
+    {
+        if (MYSQL_ROW row = mysql_fetch_row(r))
+            shareCode = row[0];
+        mysql_free_result(r);
+    }
+
+    auto textSession = [&pool, &sessionId]() {
+        MYSQL_RES *r = pool.query("SELECT user_id, username FROM sessions WHERE session_id = '" + pool.escape(sessionId) + "' AND expire_time > NOW()");
+        if (!r)
+            return;
+        if (MYSQL_ROW row = mysql_fetch_row(r))
+        {
+            int userId = std::stoi(row[0]);
+            std::string username = row[1];
+            (void)userId;
+        }
+        mysql_free_result(r);
+    };
+    auto textShare = [&pool, &shareCode]() {
+        MYSQL_RES *r = pool.query(
+            "SELECT fs.id AS share_id, fs.file_id, fs.owner_id, fs.shared_with_id, fs.share_type, fs.share_code, fs.extract_code, DATE_FORMAT(fs.created_at, '%Y-%m-%d %H:%i:%s') AS created_at, "
+            "DATE_FORMAT(fs.expire_time, '%Y-%m-%d %H:%i:%s') AS expire_time, f.filename AS server_filename, f.original_filename, f.file_size, f.file_type, f.user_id AS file_owner_id, u.username AS owner_username, f.content_hash "
+            "FROM file_shares fs JOIN files f ON fs.file_id = f.id JOIN users u ON f.user_id = u.id "
+            "WHERE fs.share_code = '" + pool.escape(shareCode) + "' AND (fs.expire_time IS NULL OR fs.expire_time > NOW())");
+        if (!r)
+            return;
+        if (MYSQL_ROW row = mysql_fetch_row(r))
+        {
+            ShareRecord rec;
+            rec.shareId = std::stoi(row[0]);
+            rec.fileId = std::stoi(row[1]);
+            rec.ownerId = std::stoi(row[2]);
+            rec.sharedWithId = row[3] ? std::optional<int>(std::stoi(row[3])) : std::nullopt;
+            rec.shareType = row[4] ? row[4] : "";
+            rec.shareCode = row[5] ? row[5] : "";
+            rec.extractCode = row[6] ? std::optional<std::string>(row[6]) : std::nullopt;
+            rec.createdAt = row[7] ? row[7] : "";
+            rec.expireTime = row[8] ? std::optional<std::string>(row[8]) : std::nullopt;
+            rec.serverFilename = row[9] ? row[9] : "";
+            rec.originalFilename = row[10] ? row[10] : "";
+            rec.fileSize = row[11] ? static_cast<uint64_t>(std::stoull(row[11])) : 0ULL;
+            rec.fileType = row[12] ? row[12] : "unknown";
+            rec.fileOwnerId = row[13] ? std::stoi(row[13]) : 0;
+            rec.ownerUsername = row[14] ? row[14] : "";
+            rec.contentHash = row[15] ? row[15] : "";
+        }
+        mysql_free_result(r);
+    };
+    auto preparedSession = [&pool, &sessionId]() {
+        DbPool::Stmt st = pool.prepare("SELECT user_id, username FROM sessions WHERE session_id = ? AND expire_time > NOW()");
+        if (st && st->query(sessionId) && st->fetch())
+        {
+            int userId = st->getInt(0);
+            std::string username = st->getString(1);
+            (void)userId;
+        }
+    };
+    auto cachedSession = [&auth, &sessionId]() {
+        int userId;
+        std::string username;
+        auth.validateSession(sessionId, userId, username);
+    };
+    auto preparedShare = [&shares, &shareCode]() { shares.getByCode(shareCode); };
+    auth.sessionTokens().AddKey("bench", RandomString(48)); // 只在本进程内签发、校验
+    std::string token = auth.sessionTokens().Issue(1, "bench", 3600);
+    auto tokenSession = [&auth, &token]() {
+        int userId;
+        std::string username;
+        auth.validateSession(token, userId, username);
+    };
+
+    auto run = [seconds, threads](const char *name, const std::function<void()> &fn) {
+        std::atomic<bool> stop(false);
+        std::atomic<long> total(0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&]() {
+                long n = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    fn();
+                    ++n;
+                }
+                total += n;
+            });
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        stop = true;
+        for (auto &w : workers)
+            w.join();
+        std::cout << name << ": " << total.load() / seconds << " queries/s" << std::endl;
+    };
+    run("validateSession text", textSession);
+    run("validateSession prepared", preparedSession);
+    run("validateSession cached", cachedSession);
+    run("validateSession token", tokenSession);
+    run("getByCode text", textShare);
+    run("getByCode prepared", preparedShare);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    Logger::SetLogLevel(Logger::ERROR);
+    return Run(argc > 1 ? std::atoi(argv[1]) : 5, argc > 2 ? std::atoi(argv[2]) : 4);
+}
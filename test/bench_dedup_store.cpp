@@ -0,0 +1,191 @@
+#include "BlobStore.h"
+#include "Sha256.h"
+#include "UploadWriter.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// 基准：重复内容占多数的上传负载下，平铺存储与内容寻址存储的磁盘占用和上传延迟
+//   flat       : 旧实现，每次上传一个 UniqueFilename 文件
+//   dedup      : 边收边算 SHA-256，提交后按摘要放入 BlobStore，重复内容删除副本
+//   hash-first : 客户端先发摘要，内容已存在则秒传（只增加引用），否则同 dedup
+// blobs 表用内存中的引用计数表代替，客户端计算摘要的耗时不计入
+// 用法: bench_dedup_store [目录=./bench_dedup_tmp] [上传次数=200] [不同内容数=20] [每个文件MB=8]
+using Clock = std::chrono::steady_clock;
+
+static const size_t kChunk = 64 * 1024;
+
+struct Stats
+{
+    std::vector<double> latencyMs;
+    uint64_t diskBytes = 0;
+};
+
+static uint64_t DiskUsage(const std::string &dir)
+{
+    uint64_t total = 0;
+    DIR *d = ::opendir(dir.c_str());
+    if (!d)
+        return 0;
+    while (struct dirent *e = ::readdir(d))
+    {
+        std::string name = e->d_name;
+        if (name == "." || name == "..")
+            continue;
+        std::string path = dir + "/" + name;
+        struct stat st;
+        if (::lstat(path.c_str(), &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+            total += DiskUsage(path);
+        else
+            total += static_cast<uint64_t>(st.st_blocks) * 512;
+    }
+    ::closedir(d);
+    return total;
+}
+
+static void RemoveTree(const std::string &dir)
+{
+    DIR *d = ::opendir(dir.c_str());
+    if (!d)
+        return;
+    while (struct dirent *e = ::readdir(d))
+    {
+        std::string name = e->d_name;
+        if (name == "." || name == "..")
+            continue;
+        std::string path = dir + "/" + name;
+        struct stat st;
+        if (::lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+            RemoveTree(path);
+        else
+            ::unlink(path.c_str());
+    }
+    ::closedir(d);
+    ::rmdir(dir.c_str());
+}
+
+// 模拟一次流式上传：分片追加到 UploadWriter，可选边写边算摘要，等待提交完成
+static std::string StreamUpload(DiskIoThread *io, const std::string &path, const std::string &content, bool hash)
+{
+    auto writer = std::make_shared<UploadWriter>(io, path, path + ".part");
+    writer->Open(content.size());
+    Sha256 hasher;
+    for (size_t off = 0; off < content.size(); off += kChunk)
+    {
+        size_t n = std::min(kChunk, content.size() - off);
+        writer->Append(content.data() + off, n);
+        if (hash)
+            hasher.Update(content.data() + off, n);
+    }
+    std::mutex m;
+    std::condition_variable cv;
+    bool done = false;
+    writer->Commit([&](bool) { std::unique_lock<std::mutex> l(m); done = true; cv.notify_one(); });
+    std::unique_lock<std::mutex> l(m);
+    cv.wait(l, [&]() { return done; });
+    return hash ? hasher.HexDigest() : "";
+}
+
+enum class Mode { kFlat, kDedup, kHashFirst };
+
+static Stats Run(Mode mode, const std::string &root, const std::vector<int> &sequence, const std::vector<std::string> &contents,
+                 const std::vector<std::string> &digests)
+{
+    RemoveTree(root);
+    ::mkdir(root.c_str(), 0755);
+    ShardedBlobStore store(root + "/blobs", root);
+    DiskIoThread *io = DiskIoThread::ForPath(root);
+    std::map<std::string, int> refs; // 代替 blobs 表
+    Stats stats;
+    int seq = 0;
+    for (int idx : sequence)
+    {
+        auto t0 = Clock::now();
+        std::string path = root + "/upload_" + std::to_string(seq++);
+        if (mode == Mode::kFlat)
+        {
+            StreamUpload(io, path, contents[idx], false);
+        }
+        else
+        {
+            if (mode == Mode::kHashFirst)
+            {
+                auto it = refs.find(digests[idx]);
+                if (it != refs.end() && store.Exists(digests[idx]))
+                {
+                    ++it->second; // 秒传
+                    stats.latencyMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+                    continue;
+                }
+            }
+            std::string hash = StreamUpload(io, path, contents[idx], true);
+            ++refs[hash];
+            store.Adopt(path, hash);
+        }
+        stats.latencyMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    stats.diskBytes = DiskUsage(root);
+    RemoveTree(root);
+    return stats;
+}
+
+static void Report(const char *name, Stats s)
+{
+    std::sort(s.latencyMs.begin(), s.latencyMs.end());
+    double sum = 0;
+    for (double v : s.latencyMs)
+        sum += v;
+    size_t n = s.latencyMs.size();
+    std::cout << "  " << name << ": disk " << s.diskBytes / (1024.0 * 1024.0) << " MB, latency avg " << sum / n
+              << " ms, p50 " << s.latencyMs[n / 2] << " ms, p99 " << s.latencyMs[std::min(n - 1, n * 99 / 100)] << " ms" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string root = argc > 1 ? argv[1] : "./bench_dedup_tmp";
+    int uploads = argc > 2 ? std::atoi(argv[2]) : 200;
+    int distinct = argc > 3 ? std::atoi(argv[3]) : 20;
+    size_t mb = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 8;
+    if (uploads <= 0 || distinct <= 0)
+        return 1;
+
+    // 不同内容，热门内容按 Zipf 分布被反复上传
+    std::vector<std::string> contents(distinct);
+    std::vector<std::string> digests(distinct);
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < distinct; ++i)
+    {
+        contents[i].resize(mb * 1024 * 1024);
+        for (size_t j = 0; j < contents[i].size(); j += 8)
+        {
+            uint64_t v = rng();
+            contents[i].replace(j, std::min<size_t>(8, contents[i].size() - j), reinterpret_cast<const char *>(&v), std::min<size_t>(8, contents[i].size() - j));
+        }
+        digests[i] = Sha256::HexOf(contents[i].data(), contents[i].size());
+    }
+    std::vector<double> weights(distinct);
+    for (int i = 0; i < distinct; ++i)
+        weights[i] = 1.0 / (i + 1);
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+    std::vector<int> sequence(uploads);
+    for (int &idx : sequence)
+        idx = zipf(rng);
+
+    std::cout << uploads << " uploads of " << mb << "MB drawn from " << distinct << " distinct files (zipf)" << std::endl;
+    Report("flat      ", Run(Mode::kFlat, root, sequence, contents, digests));
+    Report("dedup     ", Run(Mode::kDedup, root, sequence, contents, digests));
+    Report("hash-first", Run(Mode::kHashFirst, root, sequence, contents, digests));
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：下载路径每 GB 消耗的服务端 CPU
+// copy: 改造前的做法，ifstream 每次读 1MB 到 vector，再拷成 string 交给 Send，由写完成回调驱动下一块
+// sendfile: FILE_TYPE 响应，Connection 在可写事件里 sendfile，文件数据不经过用户态
+// 服务端 CPU = 进程 CPU - 客户端线程 CPU；文件在页缓存中，测的是服务端自身的开销
+// 用法: bench_download [文件MB=256] [每种方式下载次数=8]
+using Clock = std::chrono::steady_clock;
+
+static const int kServerPort = 18095;
+static const std::string kDir = "./bench_download_tmp";
+static const std::string kDataPath = kDir + "/data";
+
+static bool g_copyMode = false;
+
+// ---------------- 服务端 ----------------
+
+struct CopyDownload
+{
+    std::ifstream file;
+    uint64_t remaining = 0;
+};
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    struct stat st;
+    ::stat(kDataPath.c_str(), &st);
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetContentType("application/octet-stream");
+    resp->SetContentLength(static_cast<long long>(size));
+    if (!g_copyMode)
+    {
+        resp->SetBodyType(HttpBodyType::FILE_TYPE);
+        resp->SetFileFd(::open(kDataPath.c_str(), O_RDONLY | O_CLOEXEC));
+        return true;
+    }
+    resp->SetBodyType(HttpBodyType::HTML_TYPE);
+    auto dl = std::make_shared<CopyDownload>();
+    dl->file.open(kDataPath, std::ios::binary | std::ios::in);
+    dl->remaining = size;
+    conn->setWriteCompleteCallback([dl](const std::shared_ptr<Connection> &c) {
+        if (dl->remaining == 0)
+        {
+            c->setWriteCompleteCallback(nullptr);
+            return true;
+        }
+        uint64_t n = std::min<uint64_t>(1024 * 1024, dl->remaining);
+        std::vector<char> buffer(n);
+        dl->file.read(buffer.data(), static_cast<std::streamsize>(n));
+        std::string chunk(buffer.data(), n);
+        dl->remaining -= n;
+        c->Send(chunk);
+        return true;
+    });
+    return true;
+}
+
+static void RunServer()
+{
+    EventLoop loop;
+    HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+    server.SetHttpCallback(OnRequest);
+    server.SetThreadNums(1);
+    server.start();
+    loop.loop();
+}
+
+// ---------------- 客户端 ----------------
+
+// 发一个 GET 并读完响应体（不保留正文），返回正文字节数
+static uint64_t Download(int fd, std::string &pending)
+{
+    if (!SendAll(fd, "GET /data HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n"))
+        return 0;
+    std::string head = ReadResponse(fd, pending);
+    return head.empty() ? 0 : ContentLength(head);
+}
+
+static double ProcessCpu()
+{
+    struct rusage ru;
+    ::getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static double ThreadCpu()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void RunRound(const char *name, uint64_t fileSize, int rounds)
+{
+    int fd = Connect(kServerPort);
+    if (fd < 0)
+    {
+        std::cerr << "connect failed" << std::endl;
+        std::exit(1);
+    }
+    std::string pending;
+    Download(fd, pending); // 预热页缓存与连接
+    double cpu0 = ProcessCpu(), client0 = ThreadCpu();
+    Clock::time_point t0 = Clock::now();
+    uint64_t total = 0;
+    for (int i = 0; i < rounds; ++i)
+    {
+        uint64_t n = Download(fd, pending);
+        if (n != fileSize)
+        {
+            std::cerr << name << ": short body " << n << " / " << fileSize << std::endl;
+            std::exit(1);
+        }
+        total += n;
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    double server = (ProcessCpu() - cpu0) - (ThreadCpu() - client0);
+    double gb = total / (1024.0 * 1024 * 1024);
+    ::close(fd);
+    std::cout << name << ": " << total / (1024 * 1024) << " MB in " << secs << " s, "
+              << (total / (1024.0 * 1024)) / secs << " MB/s, server CPU " << server / gb << " s/GB" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t fileMb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 8;
+    Logger::SetLogLevel(Logger::ERROR);
+
+    ::mkdir(kDir.c_str(), 0755);
+    {
+        std::ofstream out(kDataPath, std::ios::binary | std::ios::trunc);
+        std::string block(1024 * 1024, 'x');
+        for (uint64_t i = 0; i < fileMb; ++i)
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+    uint64_t fileSize = fileMb * 1024 * 1024;
+
+    std::thread(RunServer).detach();
+
+    g_copyMode = true;
+    RunRound("copy    ", fileSize, rounds);
+    g_copyMode = false;
+    RunRound("sendfile", fileSize, rounds);
+
+    ::unlink(kDataPath.c_str());
+    ::rmdir(kDir.c_str());
+    return 0;
+}
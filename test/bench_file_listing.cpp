@@ -0,0 +1,70 @@
+#include "FileListQuery.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+// 基准：单个用户 10k 个文件时 GET /files 的数据库耗时（模拟：每条语句一次固定往返，外加按返回行数计的传输耗时）
+// 改动前：整表取出，再为每个文件查一次分享信息（1 + N 条语句）
+// 改动后：一页一条语句（分享信息随行取回），首页与按游标翻完全部页；游标的编码/解码为真实代码
+// 真实数据库上的对比见 bench_db_listing
+// 用法: bench_file_listing [文件数=10000] [往返微秒=200] [每行纳秒=500]
+using Clock = std::chrono::steady_clock;
+
+static long g_statements = 0;
+
+static void Statement(int rtUs, long rows, int rowNs)
+{
+    ++g_statements;
+    std::this_thread::sleep_for(std::chrono::microseconds(rtUs) + std::chrono::nanoseconds(rows * rowNs));
+}
+
+static double Ms(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+int main(int argc, char **argv)
+{
+    long files = argc > 1 ? std::atol(argv[1]) : 10000;
+    int rtUs = argc > 2 ? std::atoi(argv[2]) : 200;
+    int rowNs = argc > 3 ? std::atoi(argv[3]) : 500;
+
+    g_statements = 0;
+    Clock::time_point t0 = Clock::now();
+    Statement(rtUs, files, rowNs);
+    for (long i = 0; i < files; ++i)
+        Statement(rtUs, 1, rowNs);
+    std::cout << "before: " << files << " files, " << g_statements << " statements, " << Ms(t0) << " ms" << std::endl;
+
+    const FileListQuery::Sort sort = FileListQuery::kNewest;
+    g_statements = 0;
+    t0 = Clock::now();
+    Statement(rtUs, FileListQuery::kDefaultLimit + 1, rowNs);
+    std::cout << "paged: first page of " << FileListQuery::kDefaultLimit << ", " << g_statements << " statement, " << Ms(t0) << " ms" << std::endl;
+
+    g_statements = 0;
+    t0 = Clock::now();
+    long remaining = files;
+    long pages = 0;
+    std::optional<FileListQuery::Cursor> cursor;
+    while (remaining > 0)
+    {
+        long rows = remaining < FileListQuery::kMaxLimit ? remaining : FileListQuery::kMaxLimit;
+        Statement(rtUs, rows + (remaining > rows ? 1 : 0), rowNs);
+        remaining -= rows;
+        ++pages;
+        if (remaining > 0)
+        {
+            std::string next = FileListQuery::EncodeCursor(sort, "2024-06-10 23:54:09", static_cast<int>(remaining));
+            cursor.emplace();
+            if (!FileListQuery::DecodeCursor(next, sort, &*cursor))
+                return 1;
+        }
+    }
+    std::cout << "paged: all " << files << " files in " << pages << " pages of " << FileListQuery::kMaxLimit << ", " << g_statements << " statements, "
+              << Ms(t0) << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：前端轮询 /files 的 requests/sec，对比每个 JSON 响应后半关闭连接与保持长连接
+// 服务端回包方式与 sendJson 相同（HTML_TYPE 的 JSON 正文，约 20 条文件记录）
+//   半关闭：改造前 sendJson 永久设置 writeCompleteCallback 为 shutdown，每次轮询都要重新建连
+//   长连接：响应遵循请求的 keep-alive，连接复用
+// 用法: bench_keepalive [连接数=8] [每轮秒数=3]
+using Clock = std::chrono::steady_clock;
+
+static const int kServerPort = 18100;
+static std::atomic<bool> g_legacyShutdown(false);
+static std::string g_filesJson;
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetContentType("application/json");
+    resp->SetBody(g_filesJson);
+    resp->SetBodyType(HTML_TYPE);
+    resp->SetContentLength(static_cast<long long>(g_filesJson.size()));
+    if (g_legacyShutdown)
+        conn->setWriteCompleteCallback([](const std::shared_ptr<Connection> &c) { c->shutdown(); });
+    return true;
+}
+
+static void RunServer()
+{
+    EventLoop loop;
+    HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+    server.SetHttpCallback(OnRequest);
+    server.SetThreadNums(4);
+    server.start();
+    loop.loop();
+}
+
+// 一个请求一个响应，按 Content-Length 读完正文
+static bool Request(int fd, std::string &pending, std::string &body)
+{
+    static const std::string req = "GET /files?type=my HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\nX-Session-ID: bench\r\n\r\n";
+    return SendAll(fd, req) && !ReadResponse(fd, pending, body).empty();
+}
+
+// 服务端半关闭后的连接不能再用，客户端（浏览器）只能重新建连
+static void RunRound(const char *name, int connections, double seconds, bool reconnect)
+{
+    std::atomic<uint64_t> total(0), connects(0);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < connections; ++c)
+    {
+        clients.emplace_back([&]() {
+            int fd = Connect(kServerPort, true);
+            uint64_t n = 0, k = 1;
+            std::string pending, body;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (!Request(fd, pending, body))
+                {
+                    std::cerr << name << ": request failed" << std::endl;
+                    std::exit(1);
+                }
+                ++n;
+                if (reconnect)
+                {
+                    ::close(fd);
+                    fd = Connect(kServerPort, true);
+                    ++k;
+                }
+            }
+            total += n;
+            connects += k;
+            ::close(fd);
+        });
+    }
+    Clock::time_point t0 = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &t : clients)
+        t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    std::cout << name << ": " << static_cast<uint64_t>(total / secs) << " req/s, " << connects << " connections for " << total
+              << " requests" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int connections = argc > 1 ? std::atoi(argv[1]) : 8;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 3.0;
+    Logger::SetLogLevel(Logger::ERROR);
+
+    g_filesJson = "{\"code\":0,\"message\":\"Success\",\"files\":[";
+    for (int i = 0; i < 20; ++i)
+    {
+        if (i)
+            g_filesJson += ",";
+        g_filesJson += "{\"id\":" + std::to_string(1000 + i) + ",\"name\":\"report-" + std::to_string(i) +
+                       ".pdf\",\"size\":" + std::to_string(1048576 + i * 4096) +
+                       ",\"type\":\"application/pdf\",\"createdAt\":\"2024-05-01 12:00:00\",\"isOwner\":true,\"shareInfo\":null}";
+    }
+    g_filesJson += "]}";
+
+    std::thread(RunServer).detach();
+
+    g_legacyShutdown = true;
+    RunRound("shutdown per response", connections, seconds, true);
+    g_legacyShutdown = false;
+    RunRound("keep-alive           ", connections, seconds, false);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "Metrics.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：指标记录的开销。Counter::Inc、Gauge::Add、Histogram::Record 与空循环对比（ns/次），
+// 单线程与多线程（各线程写同一指标，检验分片没有伪共享与锁竞争）；以及注册 200 个直方图后一次 Render 的耗时
+// 用法: bench_metrics [每线程次数=50000000] [线程数=4]
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+static double NsPerOp(int threads, long iters, F body)
+{
+    std::vector<std::thread> workers;
+    Clock::time_point t0 = Clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&body, iters]() {
+            for (long i = 0; i < iters; ++i)
+                body(static_cast<uint64_t>(i));
+        });
+    for (auto &w : workers)
+        w.join();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    return ns / static_cast<double>(iters); // 各线程并行执行，按单个线程的次数折算
+}
+
+int main(int argc, char **argv)
+{
+    long iters = argc > 1 ? std::atol(argv[1]) : 50000000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    Metrics::Counter counter = Metrics::GetCounter("bench_total", "bench");
+    Metrics::Gauge gauge = Metrics::GetGauge("bench_gauge", "bench");
+    Metrics::Histogram hist = Metrics::GetHistogram("bench_seconds", "bench");
+
+    for (int n : {1, threads})
+    {
+        // 空循环：只防止优化掉循环本身
+        double empty = NsPerOp(n, iters, [](uint64_t i) { asm volatile("" : : "r"(i)); });
+        double inc = NsPerOp(n, iters, [&counter](uint64_t) { counter.Inc(); });
+        double add = NsPerOp(n, iters, [&gauge](uint64_t i) { gauge.Add((i & 1) ? 1 : -1); });
+        // 值在 1us..1ms 间变化，覆盖多个桶
+        double rec = NsPerOp(n, iters, [&hist](uint64_t i) { hist.Record(1000 + (i * 7919) % 1000000); });
+        std::cout << n << " thread(s): empty " << empty << " ns, Counter::Inc " << inc << " ns, Gauge::Add " << add
+                  << " ns, Histogram::Record " << rec << " ns" << std::endl;
+    }
+    uint64_t expected = static_cast<uint64_t>(iters) * (1 + threads);
+    if (counter.Value() != expected)
+    {
+        std::cerr << "counter mismatch: " << counter.Value() << " != " << expected << std::endl;
+        return 1;
+    }
+
+    for (int i = 0; i < 200; ++i)
+        Metrics::GetHistogram("bench_route_seconds", "bench", {{"route", "/r" + std::to_string(i)}}).Record(static_cast<uint64_t>(i) * 1000);
+    Clock::time_point t0 = Clock::now();
+    size_t bytes = Metrics::Render().size();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "Render: 203 series, " << bytes << " bytes, " << ms << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,362 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpContext.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "UploadWriter.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：高延迟链路上 1/4/16 个分片并行上传的吞吐
+// 客户端 -> 延迟代理 -> HttpServer，服务端与 ResumableUploadHandler 相同：每个分片一条连接，
+// UploadWriter pwrite 到预分配文件的固定偏移，分片 fdatasync 后回 204，最后原地校验
+// 延迟代理为每个方向的数据加固定单向时延，并限制在途字节数（模拟 TCP 窗口），单连接吞吐约为 窗口/时延
+// 若环境支持 tc netem，可把时延设为 0 并在 lo 上配置 netem 得到更真实的结果
+// 用法: bench_parallel_upload [总MB=64] [单向时延ms=20] [窗口KB=256] [分片数列表=1,4,16]
+using Clock = std::chrono::steady_clock;
+
+static const int kServerPort = 18090;
+static const int kProxyPort = 18091;
+static const std::string kDir = "./bench_parallel_tmp";
+static const std::string kDataPath = kDir + "/data";
+
+static uint64_t g_partSize = 0; // 当前轮次的分片大小，服务端按它计算分片偏移
+
+static inline char PatternByte(uint64_t i)
+{
+    return static_cast<char>((i * 2654435761u) >> 24);
+}
+
+// ---------------- 服务端 ----------------
+
+struct PartState
+{
+    std::shared_ptr<UploadWriter> writer;
+};
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    std::shared_ptr<HttpContext> ctx = conn->GetContext();
+    if (req.GetMethod() != HttpMethod::kPut || req.GetUrl().compare(0, 7, "/parts/") != 0)
+    {
+        resp->SetStatusCode(HttpStatusCode::NotFound);
+        resp->SetStatusMessage("Not Found");
+        resp->SetBodyType(HttpBodyType::HTML_TYPE);
+        return true;
+    }
+    std::shared_ptr<PartState> st = ctx->GetContext<PartState>();
+    if (!st)
+    {
+        uint64_t index = std::strtoull(req.GetUrl().c_str() + 7, nullptr, 10);
+        st = std::make_shared<PartState>();
+        st->writer = std::make_shared<UploadWriter>(DiskIoThread::ForPath(kDir), kDataPath, "");
+        st->writer->Open(0, index * g_partSize, false);
+        ctx->SetContext(st);
+    }
+    const std::string &body = req.GetBody();
+    st->writer->Append(body.data(), body.size());
+    req.SetBody("");
+
+    EventLoop *loop = conn->GetLoop();
+    std::weak_ptr<Connection> weakConn(conn);
+    if (!ctx->GetCompleteRequest())
+    {
+        if (st->writer->Backpressured() && conn->IsReading())
+        {
+            conn->StopReading();
+            st->writer->GetIoThread()->NotifyWhenDrained([weakConn, loop]() {
+                loop->queueOneFunc([weakConn]() {
+                    if (auto c = weakConn.lock())
+                        c->StartReading();
+                });
+            });
+        }
+        return false;
+    }
+    st->writer->Sync([weakConn, loop](bool ok) {
+        loop->queueOneFunc([weakConn, ok]() {
+            auto c = weakConn.lock();
+            if (!c)
+                return;
+            std::shared_ptr<HttpContext> ctx = c->GetContext();
+            if (!ctx || !ctx->HasDeferredResponse())
+                return;
+            ctx->SetContext(std::shared_ptr<void>());
+            HttpResponse *r = ctx->GetDeferredResponse();
+            r->SetStatusCode(ok ? HttpStatusCode::NoContent : HttpStatusCode::InternalServerError);
+            r->SetStatusMessage(ok ? "No Content" : "Internal Server Error");
+            r->SetBodyType(HttpBodyType::HTML_TYPE);
+            HttpServer::SendDeferredResponse(c);
+        });
+    });
+    return false;
+}
+
+static void RunServer()
+{
+    EventLoop loop;
+    HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+    server.SetHttpCallback(OnRequest);
+    server.SetBodyStreamingFilter([](const HttpRequest &req) { return req.GetMethod() == HttpMethod::kPut; });
+    server.SetThreadNums(4);
+    server.start();
+    loop.loop();
+}
+
+// ---------------- 延迟代理 ----------------
+
+static int Connect(int port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static bool WriteAll(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, data, len);
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 单方向转发：读到的数据延迟 delay 后写出，在途数据超过 window 时停止读取
+static void Forward(int from, int to, std::chrono::microseconds delay, size_t window)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<Clock::time_point, std::string>> queue;
+    size_t inflight = 0;
+    bool eof = false;
+
+    std::thread reader([&]() {
+        char buf[64 * 1024];
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return inflight < window; });
+            }
+            ssize_t n = ::read(from, buf, sizeof(buf));
+            std::unique_lock<std::mutex> lock(mutex);
+            if (n <= 0)
+            {
+                eof = true;
+                cv.notify_all();
+                return;
+            }
+            queue.emplace_back(Clock::now() + delay, std::string(buf, static_cast<size_t>(n)));
+            inflight += static_cast<size_t>(n);
+            cv.notify_all();
+        }
+    });
+
+    while (true)
+    {
+        std::pair<Clock::time_point, std::string> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return !queue.empty() || eof; });
+            if (queue.empty())
+                break;
+            item = std::move(queue.front());
+            queue.pop_front();
+        }
+        std::this_thread::sleep_until(item.first);
+        bool ok = WriteAll(to, item.second.data(), item.second.size());
+        std::unique_lock<std::mutex> lock(mutex);
+        inflight -= item.second.size();
+        cv.notify_all();
+        if (!ok)
+            break;
+    }
+    ::shutdown(to, SHUT_WR);
+    ::shutdown(from, SHUT_RD); // 让阻塞中的读线程退出
+    reader.join();
+}
+
+static void RunProxy(int listenFd, std::chrono::microseconds delay, size_t window)
+{
+    while (true)
+    {
+        int client = ::accept(listenFd, nullptr, nullptr);
+        if (client < 0)
+            continue;
+        int one = 1;
+        ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::thread([client, delay, window]() {
+            int upstream = Connect(kServerPort);
+            if (upstream < 0)
+            {
+                ::close(client);
+                return;
+            }
+            std::thread down(Forward, upstream, client, delay, window);
+            Forward(client, upstream, delay, window);
+            down.join();
+            ::close(client);
+            ::close(upstream);
+        }).detach();
+    }
+}
+
+// ---------------- 客户端 ----------------
+
+static bool UploadPart(uint64_t index, uint64_t offset, uint64_t len)
+{
+    int fd = Connect(kProxyPort);
+    if (fd < 0)
+        return false;
+    std::string head = "PUT /parts/" + std::to_string(index) + " HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                       "Content-Type: application/offset+octet-stream\r\nContent-Length: " + std::to_string(len) + "\r\n\r\n";
+    bool ok = WriteAll(fd, head.data(), head.size());
+    std::string buf(64 * 1024, '\0');
+    for (uint64_t done = 0; ok && done < len;)
+    {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(buf.size(), len - done));
+        for (size_t i = 0; i < n; ++i)
+            buf[i] = PatternByte(offset + done + i);
+        ok = WriteAll(fd, buf.data(), n);
+        done += n;
+    }
+    std::string resp;
+    char rbuf[1024];
+    while (ok && resp.find("\r\n\r\n") == std::string::npos)
+    {
+        ssize_t n = ::read(fd, rbuf, sizeof(rbuf));
+        if (n <= 0)
+            break;
+        resp.append(rbuf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return ok && resp.compare(0, 12, "HTTP/1.1 204") == 0;
+}
+
+// 分片已写在最终位置，原地校验全部内容
+static bool VerifyInPlace(uint64_t size)
+{
+    int fd = ::open(kDataPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool ok = ::fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) == size;
+    std::string buf(1024 * 1024, '\0');
+    for (uint64_t off = 0; ok && off < size;)
+    {
+        ssize_t n = ::pread(fd, &buf[0], buf.size(), static_cast<off_t>(off));
+        if (n <= 0)
+        {
+            ok = false;
+            break;
+        }
+        for (ssize_t i = 0; i < n && ok; ++i)
+            ok = buf[static_cast<size_t>(i)] == PatternByte(off + static_cast<uint64_t>(i));
+        off += static_cast<uint64_t>(n);
+    }
+    ::close(fd);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t totalMB = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    int delayMs = argc > 2 ? std::atoi(argv[2]) : 20;
+    size_t windowKB = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256;
+    std::string list = argc > 4 ? argv[4] : "1,4,16";
+    Logger::SetLogLevel(Logger::ERROR);
+    ::mkdir(kDir.c_str(), 0755);
+
+    std::thread(RunServer).detach();
+
+    int listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kProxyPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(listenFd, 128) != 0)
+    {
+        std::cerr << "proxy listen failed" << std::endl;
+        return 1;
+    }
+    std::thread(RunProxy, listenFd, std::chrono::microseconds(delayMs * 1000), windowKB * 1024).detach();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // 等待服务端监听
+
+    uint64_t size = totalMB * 1024 * 1024;
+    std::cout << "upload " << totalMB << "MB, one-way delay " << delayMs << "ms, window " << windowKB << "KB" << std::endl;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        uint64_t parts = std::strtoull(item.c_str(), nullptr, 10);
+        if (parts == 0)
+            continue;
+        g_partSize = (size + parts - 1) / parts;
+        // 与 UploadSessionStore 相同：创建会话时按总大小预分配
+        int fd = ::open(kDataPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ::fallocate(fd, 0, 0, static_cast<off_t>(size)) != 0)
+            ::ftruncate(fd, static_cast<off_t>(size));
+        ::close(fd);
+
+        auto t0 = Clock::now();
+        std::atomic<int> failed(0);
+        std::vector<std::thread> clients;
+        for (uint64_t i = 0; i < parts; ++i)
+        {
+            uint64_t off = i * g_partSize;
+            uint64_t len = std::min(g_partSize, size - off);
+            clients.emplace_back([&failed, i, off, len]() {
+                if (!UploadPart(i, off, len))
+                    ++failed;
+            });
+        }
+        for (auto &t : clients)
+            t.join();
+        double uploadSecs = std::chrono::duration<double>(Clock::now() - t0).count();
+        auto v0 = Clock::now();
+        bool verified = failed.load() == 0 && VerifyInPlace(size);
+        double verifySecs = std::chrono::duration<double>(Clock::now() - v0).count();
+        std::cout << "  " << parts << " parts: " << totalMB / uploadSecs << " MB/s (" << uploadSecs << " s), verify "
+                  << verifySecs << " s, " << (verified ? "ok" : "FAILED") << std::endl;
+        ::unlink(kDataPath.c_str());
+    }
+    ::rmdir(kDir.c_str());
+    std::cout.flush();
+    _exit(0); // 服务端与代理线程常驻，直接退出
+}
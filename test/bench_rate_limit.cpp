@@ -0,0 +1,105 @@
+#include "RateLimiter.h"
+#include "Connection.h"
+#include "EventLoop.h"
+#include "HttpRequest.h"
+#include "Logger.h"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：限流器每个请求的开销（HttpServer::onRequest 中 Admit 的耗时）
+// 规则与 http_upload 相同；场景：没有匹配的路由规则（只有按 IP 的总量规则）、/files 同时匹配会话规则、
+// 大量不同客户端轮流请求（桶不在缓存中）、多线程各自的客户端；最后是清理 10 万个已满桶的耗时
+// 用法: bench_rate_limit [每个场景的请求数=2000000] [线程数=4]
+using Clock = std::chrono::steady_clock;
+
+static std::shared_ptr<Connection> MakeConnection(EventLoop *loop, uint32_t ip)
+{
+    InetAddress local("127.0.0.1", 8080);
+    InetAddress peer("127.0.0.1", 40000);
+    peer.addr.sin_addr.s_addr = htonl(ip);
+    return std::make_shared<Connection>(loop, ::socket(AF_INET, SOCK_STREAM, 0), 0, local, peer);
+}
+
+static void AddRules(RateLimiter &limiter)
+{
+    // 速率足够高，基准中的请求都会放行，测的是查找与 CAS 本身
+    limiter.AddRule("per_ip", HttpMethod::kInvalid, "", 1e9, 1e9);
+    limiter.AddRule("login", HttpMethod::kPost, "/login", 1e9, 1e9);
+    limiter.AddRule("register", HttpMethod::kPost, "/register", 1e9, 1e9);
+    limiter.AddRule("files", HttpMethod::kGet, "/files", 1e9, 1e9, RateLimiter::kSession);
+    limiter.AddRule("share_info", HttpMethod::kGet, "/share/info/*", 1e9, 1e9);
+    limiter.AddRule("user_search", HttpMethod::kGet, "/users/search", 1e9, 1e9, RateLimiter::kSession);
+}
+
+static double Run(RateLimiter &limiter, const std::vector<std::shared_ptr<Connection>> &conns, const HttpRequest &req, long count)
+{
+    double retryAfter;
+    long limited = 0;
+    Clock::time_point t0 = Clock::now();
+    for (long i = 0; i < count; ++i)
+        if (!limiter.Admit(*conns[static_cast<size_t>(i) % conns.size()], req, &retryAfter))
+            ++limited;
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    if (limited)
+        std::cerr << "unexpected 429s: " << limited << std::endl;
+    return ns / static_cast<double>(count);
+}
+
+int main(int argc, char **argv)
+{
+    long count = argc > 1 ? std::atol(argv[1]) : 2000000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+    Logger::SetLogLevel(Logger::FATAL);
+    EventLoop loop;
+
+    RateLimiter limiter;
+    AddRules(limiter);
+    HttpRequest asset, files;
+    asset.SetMethod("GET");
+    asset.SetUrl("/static/js/app.js");
+    files.SetMethod("GET");
+    files.SetUrl("/files");
+    files.AddHeader("X-Session-ID", "6f1c2a9e-5b7d-4c3e-9a8f-0d2e4b6c8a1f");
+
+    std::vector<std::shared_ptr<Connection>> one{MakeConnection(&loop, 0x0a000001)};
+    std::vector<std::shared_ptr<Connection>> many;
+    for (uint32_t i = 0; i < 10000; ++i)
+        many.push_back(MakeConnection(&loop, 0x0a100000 + i));
+
+    std::cout << "GET /static (1 rule), 1 client: " << Run(limiter, one, asset, count) << " ns/request" << std::endl;
+    std::cout << "GET /files (2 rules), 1 client: " << Run(limiter, one, files, count) << " ns/request" << std::endl;
+    std::cout << "GET /static (1 rule), 10000 clients: " << Run(limiter, many, asset, count) << " ns/request" << std::endl;
+
+    std::vector<std::thread> workers;
+    std::vector<double> perThread(static_cast<size_t>(threads));
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]() {
+            std::vector<std::shared_ptr<Connection>> own(many.begin() + t * 100, many.begin() + t * 100 + 100);
+            perThread[static_cast<size_t>(t)] = Run(limiter, own, asset, count / threads);
+        });
+    for (auto &w : workers)
+        w.join();
+    double total = 0;
+    for (double v : perThread)
+        total += v;
+    std::cout << "GET /static, " << threads << " threads x 100 clients: " << total / threads << " ns/request per thread" << std::endl;
+
+    // 清理：10 万个桶全部已满
+    RateLimiter big(1 << 20);
+    big.AddRule("per_ip", HttpMethod::kInvalid, "", 1000, 1000);
+    int64_t wait;
+    for (uint64_t key = 0; key < 100000; ++key)
+        big.Acquire(0, key, 1000000000, &wait);
+    Clock::time_point t0 = Clock::now();
+    size_t removed = big.Evict(RateLimiter::Now() + 3600LL * 1000000000);
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "Evict: " << removed << " buckets in " << ms << " ms" << std::endl;
+    return 0;
+}
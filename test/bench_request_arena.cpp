@@ -0,0 +1,99 @@
+#include "HttpContext.h"
+#include "HttpRequest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// 基准：一条 keep-alive 连接上连续解析请求时，每个请求的堆分配次数与耗时
+// 替换全局 operator new 计数（统计进程内全部分配），按 HttpServer 的方式驱动 HttpContext：
+// ParseIncremental 直到完整，读取 Connection 头与路径，然后 ResetContextStatus 解析下一条
+// 用法: bench_request_arena [每种请求的条数=200000]
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> g_allocs(0);
+static volatile size_t g_sink = 0;
+
+void *operator new(size_t n)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+// 浏览器页面请求、前端轮询 /files、带 JSON 请求体的 POST
+static const char *kBrowserAsset =
+    "GET /static/js/player.js HTTP/1.1\r\n"
+    "Host: files.example.com:8080\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Accept: */*\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: script\r\n"
+    "Referer: http://files.example.com:8080/\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+    "If-None-Match: \"3f2a9c0d81e4b7a6c5d2-br\"\r\n"
+    "\r\n";
+
+static const char *kFilesPoll =
+    "GET /files?type=my&page=1&size=50 HTTP/1.1\r\n"
+    "Host: files.example.com:8080\r\n"
+    "Connection: keep-alive\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "X-Session-ID: 6f1c2a9e-5b7d-4c3e-9a8f-0d2e4b6c8a1f\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Referer: http://files.example.com:8080/\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9\r\n"
+    "\r\n";
+
+static const char *kJsonPost =
+    "POST /share HTTP/1.1\r\n"
+    "Host: files.example.com:8080\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Type: application/json\r\n"
+    "X-Session-ID: 6f1c2a9e-5b7d-4c3e-9a8f-0d2e4b6c8a1f\r\n"
+    "Content-Length: 54\r\n"
+    "\r\n"
+    "{\"fileId\":1042,\"shareType\":\"protected\",\"expireDays\":7}";
+
+static void Run(const char *name, const std::string &wire, int count)
+{
+    HttpContext context;
+    uint64_t allocs0 = g_allocs.load();
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < count; ++i)
+    {
+        size_t consumed = 0;
+        if (!context.ParseIncremental(wire.data(), wire.size(), consumed) || !context.GetCompleteRequest())
+        {
+            std::cerr << name << ": parse failed" << std::endl;
+            std::exit(1);
+        }
+        HttpRequest *req = context.GetRequest();
+        g_sink = g_sink + req->GetHeader("Connection").size() + req->GetUrl().size();
+        context.ResetContextStatus();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / count;
+    double allocs = static_cast<double>(g_allocs.load() - allocs0) / count;
+    std::cout << name << ": " << allocs << " allocations/request, " << ns << " ns/request" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 200000;
+    Run("browser asset", kBrowserAsset, count);
+    Run("/files poll   ", kFilesPoll, count);
+    Run("json post     ", kJsonPost, count);
+    return 0;
+}
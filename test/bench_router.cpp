@@ -0,0 +1,182 @@
+#include "Router.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+// 基准：应用路由的分发耗时，对比改造前逐条 std::regex_match 的线性路由
+// 路由表与 registerRoutes 相同（26 条），请求混合静态页、/files 轮询、下载、分片上传与未命中的路径
+// 用法: bench_router [轮数=200000]
+using Clock = std::chrono::steady_clock;
+
+// 改造前的 Router：精确路径也编译成正则，按注册顺序逐条匹配
+class RegexRouter
+{
+public:
+    using Handler = Router::Handler;
+
+    void addRouteExact(const std::string &path, HttpMethod method, Handler handler)
+    {
+        std::string pattern = "^";
+        for (char c : path)
+        {
+            if (std::string(".+*?^$()[]{}|\\").find(c) != std::string::npos)
+                pattern += '\\';
+            pattern += c;
+        }
+        routes_.emplace_back(Route{std::regex(pattern + "$"), {}, std::move(handler), method});
+    }
+
+    void addRouteRegex(const std::string &pattern, HttpMethod method, Handler handler, const std::vector<std::string> &params)
+    {
+        routes_.emplace_back(Route{std::regex(pattern), params, std::move(handler), method});
+    }
+
+    bool dispatch(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp) const
+    {
+        const std::string &path = req.GetUrl();
+        for (const auto &route : routes_)
+        {
+            if (route.method != req.GetMethod())
+                continue;
+            std::smatch matches;
+            if (std::regex_match(path, matches, route.pattern))
+            {
+                std::map<std::string, std::string> params;
+                for (size_t i = 0; i < route.params.size() && i + 1 < matches.size(); ++i)
+                    params[route.params[i]] = matches[i + 1];
+                req.SetPathParam(params);
+                return route.handler(conn, req, resp);
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Route
+    {
+        std::regex pattern;
+        std::vector<std::string> params;
+        Handler handler;
+        HttpMethod method;
+    };
+    std::vector<Route> routes_;
+};
+
+static int g_sink = 0;
+
+template <typename R>
+static void Register(R &r)
+{
+    int id = 0;
+    auto h = [&id]() {
+        int mine = ++id;
+        return [mine](const std::shared_ptr<Connection> &, HttpRequest &, HttpResponse *) {
+            g_sink += mine;
+            return true;
+        };
+    };
+    r.addRouteExact("/favicon.ico", kGet, h());
+    r.addRouteExact("/register", kPost, h());
+    r.addRouteExact("/login", kPost, h());
+    r.addRouteExact("/", kGet, h());
+    r.addRouteExact("/index.html", kGet, h());
+    r.addRouteExact("/share.html", kGet, h());
+    r.addRouteRegex("/static/(.*)", kGet, h(), {"path"});
+    r.addRouteExact("/register.html", kGet, h());
+    r.addRouteRegex("/share/([^/]+)", kGet, h(), {"code"});
+    r.addRouteRegex("/share/download/([^/]+)", kGet, h(), {"filename"});
+    r.addRouteRegex("/share/info/([^/]+)", kGet, h(), {"code"});
+    r.addRouteExact("/upload", kPost, h());
+    r.addRouteExact("/upload/instant", kPost, h());
+    r.addRouteExact("/uploads", kPost, h());
+    r.addRouteRegex("/uploads/([^/]+)", kHead, h(), {"id"});
+    r.addRouteRegex("/uploads/([^/]+)", kPatch, h(), {"id"});
+    r.addRouteRegex("/uploads/([^/]+)/parts/([0-9]+)", kPut, h(), {"id", "part"});
+    r.addRouteRegex("/uploads/([^/]+)/complete", kPost, h(), {"id"});
+    r.addRouteRegex("/uploads/([^/]+)", kDelete, h(), {"id"});
+    r.addRouteExact("/files", kGet, h());
+    r.addRouteRegex("/download/([^/]+)", kHead, h(), {"filename"});
+    r.addRouteRegex("/download/([^/]+)", kGet, h(), {"filename"});
+    r.addRouteRegex("/delete/([^/]+)", kDelete, h(), {"filename"});
+    r.addRouteExact("/share", kPost, h());
+    r.addRouteExact("/users/search", kGet, h());
+    r.addRouteExact("/logout", kPost, h());
+}
+
+struct Sample
+{
+    const char *method;
+    const char *url;
+};
+
+static const Sample kSamples[] = {
+    {"GET", "/"},
+    {"GET", "/static/player.js"},
+    {"GET", "/files?type=my"},
+    {"GET", "/files?type=shared"},
+    {"GET", "/download/8d2f6c1e0a4b-report.pdf"},
+    {"PUT", "/uploads/5b7c9e21f3a8/parts/17"},
+    {"HEAD", "/uploads/5b7c9e21f3a8"},
+    {"GET", "/share/download/8d2f6c1e0a4b-report.pdf"},
+    {"POST", "/logout"},
+    {"GET", "/no/such/route"},
+};
+
+template <typename R>
+static double Run(const R &router, int rounds, std::vector<int> &hits)
+{
+    std::vector<HttpRequest> reqs(sizeof(kSamples) / sizeof(kSamples[0]));
+    for (size_t i = 0; i < reqs.size(); ++i)
+    {
+        reqs[i].SetMethod(kSamples[i].method);
+        reqs[i].SetUrl(kSamples[i].url);
+    }
+    HttpResponse resp(false);
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (size_t i = 0; i < reqs.size(); ++i)
+        {
+            int before = g_sink;
+            bool ok = router.dispatch(nullptr, reqs[i], &resp);
+            if (r == 0)
+                hits.push_back(ok ? g_sink - before : 0);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    return ns / (static_cast<double>(rounds) * reqs.size());
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    RegexRouter before;
+    Register(before);
+    Router after;
+    Register(after);
+
+    if (after.FallbackCount() != 0)
+    {
+        std::cerr << after.FallbackCount() << " routes fell back to regex" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> hitsBefore, hitsAfter;
+    double regexNs = Run(before, rounds / 20, hitsBefore); // 正则路由慢一个数量级以上，少跑几轮
+    double treeNs = Run(after, rounds, hitsAfter);
+    if (hitsBefore != hitsAfter)
+    {
+        std::cerr << "routers disagree" << std::endl;
+        return 1;
+    }
+    std::cout << "regex linear: " << regexNs << " ns/dispatch" << std::endl;
+    std::cout << "prefix tree : " << treeNs << " ns/dispatch (" << regexNs / treeNs << "x)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "ConnectionPool.h"
+#include "SessionCache.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：会话缓存
+// 1) 命中一次 Get 的开销（单线程与 4 线程）
+// 2) 模拟 /files：每个请求先校验会话再查文件列表，各为一次数据库往返（固定往返时间，连接池 4 个连接、8 个工作线程）；
+//    对比每次查库校验（改动前）与经会话缓存校验时的请求延迟 p50/p99、吞吐与命中率。
+//    会话按 Zipf 分布访问（少数活跃用户占多数请求），另有 5% 的请求带伪造的会话 ID
+// 用法: bench_session_cache [每线程请求数=2000] [往返微秒=200] [会话数=2000]
+using Clock = std::chrono::steady_clock;
+
+class SimulatedPool : public ConnectionPool
+{
+public:
+    SimulatedPool(const std::string &name, size_t size) : ConnectionPool(name, size) {}
+
+protected:
+    bool Connect(size_t) override { return true; }
+    bool Ping(size_t) override { return true; }
+    bool IsConnected(size_t) const override { return true; }
+};
+
+static void RoundTrip(SimulatedPool &pool, int latencyUs)
+{
+    ConnectionPool::Lease lease = pool.Acquire(10000);
+    std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+}
+
+static void BenchGet(int threads)
+{
+    SessionCache cache;
+    const int sessions = 4096;
+    for (int i = 0; i < sessions; ++i)
+        cache.Put("session-" + std::to_string(i) + "-abcdefghijklmnopqrstuv", {i, "user"}, 3600LL * 1000000000LL);
+    std::vector<std::string> ids;
+    for (int i = 0; i < sessions; ++i)
+        ids.push_back("session-" + std::to_string(i) + "-abcdefghijklmnopqrstuv");
+    const long iters = 2000000 / threads;
+    std::vector<std::thread> workers;
+    Clock::time_point t0 = Clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]() {
+            SessionCache::Session s;
+            for (long i = 0; i < iters; ++i)
+                cache.Get(ids[static_cast<size_t>(i * 7 + t) % ids.size()], &s);
+        });
+    for (auto &w : workers)
+        w.join();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    std::cout << "Get hit, " << threads << " thread(s): " << ns / static_cast<double>(iters) << " ns/op per thread" << std::endl;
+}
+
+static void BenchFiles(bool cached, long perThread, int latencyUs, int sessions)
+{
+    const int threads = 8;
+    SimulatedPool pool(cached ? "bench_files_cached" : "bench_files_uncached", 4);
+    pool.ConnectAll();
+    SessionCache cache;
+    SessionCache::Stats before = cache.GetStats();
+    std::vector<std::vector<int64_t>> latencies(threads);
+    Clock::time_point t0 = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(static_cast<unsigned>(t + 1));
+            // Zipf(s=1)：按 1/k 的权重抽取会话
+            std::vector<double> weights(static_cast<size_t>(sessions));
+            for (int k = 0; k < sessions; ++k)
+                weights[static_cast<size_t>(k)] = 1.0 / (k + 1);
+            std::discrete_distribution<int> pick(weights.begin(), weights.end());
+            std::uniform_int_distribution<int> forged(0, 99);
+            std::vector<int64_t> &lat = latencies[static_cast<size_t>(t)];
+            lat.reserve(static_cast<size_t>(perThread));
+            for (long i = 0; i < perThread; ++i)
+            {
+                bool bogus = forged(rng) < 5;
+                std::string id = bogus ? "forged-" + std::to_string(rng() % 1000) : "session-" + std::to_string(pick(rng));
+                Clock::time_point start = Clock::now();
+                bool valid;
+                SessionCache::Session s;
+                SessionCache::Result r = cached ? cache.Get(id, &s) : SessionCache::kMiss;
+                if (r == SessionCache::kMiss)
+                {
+                    RoundTrip(pool, latencyUs); // SELECT ... FROM sessions
+                    valid = !bogus;
+                    if (cached)
+                    {
+                        if (valid)
+                            cache.Put(id, {1, "user"}, 3600LL * 1000000000LL);
+                        else
+                            cache.PutUnknown(id);
+                    }
+                }
+                else
+                    valid = r == SessionCache::kHit;
+                if (valid)
+                    RoundTrip(pool, latencyUs); // 文件列表
+                lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+            }
+        });
+    for (auto &w : workers)
+        w.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    std::vector<int64_t> all;
+    for (const auto &v : latencies)
+        all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    auto pct = [&all](double q) { return static_cast<double>(all[static_cast<size_t>(q * static_cast<double>(all.size() - 1))]) / 1000; };
+    std::cout << (cached ? "/files with session cache: " : "/files querying sessions: ") << static_cast<long>(static_cast<double>(all.size()) / seconds)
+              << " req/s, p50 " << pct(0.5) << " us, p99 " << pct(0.99) << " us";
+    if (cached)
+    {
+        SessionCache::Stats st = cache.GetStats();
+        uint64_t hits = st.hits - before.hits, negative = st.negativeHits - before.negativeHits, misses = st.misses - before.misses;
+        std::cout << ", hit rate " << static_cast<double>(hits + negative) / static_cast<double>(hits + negative + misses) << " (negative " << negative << ")";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    long perThread = argc > 1 ? std::atol(argv[1]) : 2000;
+    int latencyUs = argc > 2 ? std::atoi(argv[2]) : 200;
+    int sessions = argc > 3 ? std::atoi(argv[3]) : 2000;
+    Logger::SetLogLevel(Logger::FATAL);
+
+    BenchGet(1);
+    BenchGet(4);
+    BenchFiles(false, perThread, latencyUs, sessions);
+    BenchFiles(true, perThread, latencyUs, sessions);
+    return 0;
+}
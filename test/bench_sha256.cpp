@@ -0,0 +1,133 @@
+#include "Sha256.h"
+#include "UploadWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 基准：SHA-256 单核吞吐（可移植实现 vs SHA-NI）、多线程扩展性，
+// 以及上传路径上哈希放在 Reactor 线程与放在摘要线程（与写盘并行）时 Reactor 的占用时间
+// 用法: bench_sha256 [每线程MB=512] [目录=./bench_sha256_tmp] [上传MB=512]
+using Clock = std::chrono::steady_clock;
+
+static const size_t kChunk = 64 * 1024; // 模拟一次 onMessage 收到的数据量
+
+static double HashThroughput(const std::string &data, size_t mb, int threads)
+{
+    auto t0 = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]() {
+            Sha256 h;
+            size_t rounds = mb * 1024 * 1024 / data.size();
+            for (size_t i = 0; i < rounds; ++i)
+                h.Update(data.data(), data.size());
+            volatile char sink = h.HexDigest()[0];
+            (void)sink;
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    return static_cast<double>(mb) * threads / secs;
+}
+
+struct PipelineResult
+{
+    double seconds;
+    double reactorSecs; // Reactor 线程花在 Append/哈希上的时间
+    std::string digest;
+};
+
+static PipelineResult RunPipeline(const std::string &dir, size_t bytes, const std::string &chunk, bool offload)
+{
+    std::string path = dir + (offload ? "/offload" : "/inline");
+    auto writer = std::make_shared<UploadWriter>(DiskIoThread::ForPath(dir), path, path + ".part");
+    writer->Open(bytes);
+    if (offload)
+        writer->EnableHash(DiskIoThread::HashWorker());
+    Sha256 inlineHasher;
+    int64_t reactorNs = 0;
+    auto t0 = Clock::now();
+    for (size_t done = 0; done < bytes; done += chunk.size())
+    {
+        if (writer->Backpressured())
+        {
+            std::mutex m;
+            std::condition_variable c;
+            bool drained = false;
+            writer->NotifyWhenDrained([&]() { std::unique_lock<std::mutex> l(m); drained = true; c.notify_one(); });
+            std::unique_lock<std::mutex> l(m);
+            c.wait(l, [&]() { return drained; });
+        }
+        auto b = Clock::now();
+        writer->Append(chunk.data(), chunk.size());
+        if (!offload)
+            inlineHasher.Update(chunk.data(), chunk.size());
+        reactorNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - b).count();
+    }
+    std::mutex m;
+    std::condition_variable c;
+    bool committed = false;
+    writer->Commit([&](bool ok) { std::unique_lock<std::mutex> l(m); committed = true; c.notify_one(); });
+    {
+        std::unique_lock<std::mutex> l(m);
+        c.wait(l, [&]() { return committed; });
+    }
+    PipelineResult r{std::chrono::duration<double>(Clock::now() - t0).count(), reactorNs / 1e9,
+                     offload ? writer->Digest() : inlineHasher.HexDigest()};
+    ::unlink(path.c_str());
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    size_t mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 512;
+    std::string dir = argc > 2 ? argv[2] : "./bench_sha256_tmp";
+    size_t uploadMb = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 512;
+    if (mb == 0 || uploadMb == 0)
+        return 1;
+
+    std::string data(1024 * 1024, '\0');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<char>(i * 131 + (i >> 9));
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    bool hardware = Sha256::SetHardwareAcceleration(true);
+    std::vector<bool> modes{false};
+    if (hardware)
+        modes.push_back(true);
+    for (bool hw : modes)
+    {
+        Sha256::SetHardwareAcceleration(hw);
+        std::cout << Sha256::Implementation() << ":" << std::endl;
+        for (int threads = 1; threads <= cores; threads *= 2)
+        {
+            double total = HashThroughput(data, mb, threads);
+            std::cout << "  " << threads << " thread(s): " << total << " MB/s total, " << total / threads << " MB/s per core" << std::endl;
+        }
+    }
+    Sha256::SetHardwareAcceleration(true);
+
+    ::mkdir(dir.c_str(), 0755);
+    std::string chunk(data.data(), kChunk);
+    size_t bytes = uploadMb * 1024 * 1024;
+    PipelineResult a = RunPipeline(dir, bytes, chunk, false);
+    PipelineResult b = RunPipeline(dir, bytes, chunk, true);
+    assert(a.digest == b.digest);
+    std::cout << "upload " << uploadMb << "MB with " << Sha256::Implementation() << ":" << std::endl;
+    std::cout << "  hash on reactor      : " << uploadMb / a.seconds << " MB/s, reactor busy " << a.reactorSecs << " s" << std::endl;
+    std::cout << "  hash on worker thread: " << uploadMb / b.seconds << " MB/s, reactor busy " << b.reactorSecs << " s" << std::endl;
+    ::rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "StaticHandler.h"
+#include "StaticAssets.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 基准：/ 与 /static/* 的 requests/sec 与每个响应的线上字节数
+// 服务端用 StaticHandler 服务 application/static，交替请求 / 与 /static/player.js，分五轮：
+//   短连接 sendfile：每个请求新建连接（改造前静态资源强制 Connection: close）
+//   长连接 sendfile：不预加载，每个请求经 open + sendfile
+//   预加载 identity / br：从内存回包，分别不带与带 Accept-Encoding
+//   304：带上次的 ETag 重新验证
+// 用法: bench_static_assets [连接数=8] [每轮秒数=3]
+using Clock = std::chrono::steady_clock;
+
+static const int kServerPort = 18098;
+static std::atomic<StaticHandler *> g_handler(nullptr);
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    StaticHandler *handler = g_handler.load();
+    if (req.GetUrl() == "/")
+        return handler->handleIndex(conn, req, resp);
+    return handler->handleStaticAsset(conn, req, resp);
+}
+
+static void RunServer()
+{
+    EventLoop loop;
+    HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+    server.SetHttpCallback(OnRequest);
+    server.SetThreadNums(4);
+    server.start();
+    loop.loop();
+}
+
+// 一个请求一个响应，按 Content-Length 读完正文；返回响应总字节数，失败返回 0
+static size_t Request(int fd, const std::string &req, std::string &pending, std::string &body, std::string *etag)
+{
+    if (!SendAll(fd, req))
+        return 0;
+    std::string head = ReadResponse(fd, pending, body);
+    if (head.compare(0, 12, "HTTP/1.1 200") != 0 && head.compare(0, 12, "HTTP/1.1 304") != 0)
+        return 0;
+    size_t pos = head.find("ETag: ");
+    if (etag && pos != std::string::npos)
+        *etag = head.substr(pos + 6, head.find("\r\n", pos) - pos - 6);
+    return head.size() + body.size();
+}
+
+static std::string MakeRequest(const std::string &url, bool keepAlive, const std::string &extra)
+{
+    return "GET " + url + " HTTP/1.1\r\nHost: localhost\r\nConnection: " + (keepAlive ? "keep-alive" : "close") + "\r\n" + extra + "\r\n";
+}
+
+static void RunRound(const char *name, int connections, double seconds, bool keepAlive, const std::string &acceptEncoding, bool revalidate)
+{
+    const char *urls[] = {"/", "/static/player.js"};
+    std::atomic<uint64_t> total(0), bytes(0);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < connections; ++c)
+    {
+        clients.emplace_back([&]() {
+            std::string etags[2];
+            std::string extra = acceptEncoding.empty() ? "" : "Accept-Encoding: " + acceptEncoding + "\r\n";
+            for (int i = 0; i < 2; ++i)
+            {
+                // 先取一次 ETag，供 304 轮使用
+                int fd = Connect(kServerPort, true);
+                std::string pending, body;
+                Request(fd, MakeRequest(urls[i], false, extra), pending, body, &etags[i]);
+                ::close(fd);
+            }
+            int fd = keepAlive ? Connect(kServerPort, true) : -1;
+            std::string pending, body;
+            uint64_t n = 0, b = 0;
+            for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i)
+            {
+                std::string headers = extra + (revalidate ? "If-None-Match: " + etags[i % 2] + "\r\n" : "");
+                if (!keepAlive)
+                    fd = Connect(kServerPort, true);
+                size_t got = Request(fd, MakeRequest(urls[i % 2], keepAlive, headers), pending, body, nullptr);
+                if (got == 0)
+                {
+                    std::cerr << name << ": request failed" << std::endl;
+                    std::exit(1);
+                }
+                if (!keepAlive)
+                    ::close(fd);
+                ++n;
+                b += got;
+            }
+            total += n;
+            bytes += b;
+            if (keepAlive)
+                ::close(fd);
+        });
+    }
+    Clock::time_point t0 = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &t : clients)
+        t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    std::cout << name << ": " << static_cast<uint64_t>(total / secs) << " req/s, " << bytes / (total ? total.load() : 1)
+              << " bytes/response" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int connections = argc > 1 ? std::atoi(argv[1]) : 8;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 3.0;
+    Logger::SetLogLevel(Logger::ERROR);
+
+    StaticHandler plain;
+    g_handler = &plain;
+    std::thread(RunServer).detach();
+
+    RunRound("close+sendfile    ", connections, seconds, false, "", false);
+    RunRound("keepalive+sendfile", connections, seconds, true, "", false);
+
+    Clock::time_point t0 = Clock::now();
+    StaticAssets assets(StaticHandler::staticDir());
+    size_t n = assets.Load();
+    StaticAssets::Stats st = assets.GetStats();
+    std::cout << "preloaded " << n << " assets, " << st.identityBytes << " bytes, " << st.compressedBytes << " bytes compressed in "
+              << std::chrono::duration<double, std::milli>(Clock::now() - t0).count() << " ms" << std::endl;
+    StaticHandler preloaded(&assets);
+    g_handler = &preloaded;
+
+    RunRound("memory identity   ", connections, seconds, true, "", false);
+    RunRound("memory br         ", connections, seconds, true, "gzip, deflate, br", false);
+    RunRound("304               ", connections, seconds, true, "gzip, deflate, br", true);
+    return 0;
+}
@@ -52,8 +52,9 @@ void EchoServer::onMessage(const std::shared_ptr<Connection> & conn){
     // std::cout << std::this_thread::get_id() << " EchoServer::onMessage" << std::endl;
     if (conn->GetState() == connectionState::Connected)
     {
-        std::cout << "Message from client " << conn->GetReadBuffer()->PeekAllAsString() << std::endl;
-        conn->Send(conn->GetReadBuffer()->PeekAllAsString());
+        std::string message = conn->GetReadBuffer()->RetrieveAllAsString();
+        std::cout << "Message from client " << message << std::endl;
+        conn->Send(message);
     }
 }
 
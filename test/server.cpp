@@ -14,7 +14,7 @@ int main() {
             // ncon->Close(); // 这里不需要手动关闭连接，已经在Connection的析构函数中处理了
             return;
         }
-        std::string message = ncon->GetReadBuffer()->PeekAllAsString(); // 获取接收到的消息
+        std::string message = ncon->GetReadBuffer()->RetrieveAllAsString(); // 取出接收到的消息
         std::cout<< "Message from client " << ncon->GetFd() << ": " << message << std::endl;
         for(char &c : message) {
             c = toupper(c); // 将接收到的消息转换为大写
@@ -0,0 +1,121 @@
+#include "Router.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+// 测试：应用路由的前缀树匹配（静态段、类型化参数、剩余路径通配、方法分发与回退到正则）
+static std::string g_hit;
+
+static Router::Handler Named(const std::string &name)
+{
+    return [name](const std::shared_ptr<Connection> &, HttpRequest &, HttpResponse *) {
+        g_hit = name;
+        return true;
+    };
+}
+
+static bool Dispatch(const Router &router, const std::string &method, const std::string &url, HttpRequest &req)
+{
+    g_hit.clear();
+    req.SetMethod(method);
+    req.SetUrl(url);
+    HttpResponse resp(false);
+    return router.dispatch(nullptr, req, &resp);
+}
+
+int main()
+{
+    Router router;
+    router.addRouteExact("/", HttpMethod::kGet, Named("index"));
+    router.addRouteExact("/files", HttpMethod::kGet, Named("list"));
+    router.addRouteExact("/share", HttpMethod::kPost, Named("shareCreate"));
+    router.addRouteExact("/index.html", HttpMethod::kGet, Named("indexHtml"));
+    router.addRouteRegex("/static/(.*)", HttpMethod::kGet, Named("static"), {"path"});
+    router.addRouteRegex("/share/([^/]+)", HttpMethod::kGet, Named("shareAccess"), {"code"});
+    router.addRouteRegex("/share/download/([^/]+)", HttpMethod::kGet, Named("shareDownload"), {"filename"});
+    router.addRouteRegex("/uploads/([^/]+)", HttpMethod::kHead, Named("uploadHead"), {"id"});
+    router.addRouteRegex("/uploads/([^/]+)", HttpMethod::kPatch, Named("uploadPatch"), {"id"});
+    router.addRouteRegex("/uploads/([^/]+)/parts/([0-9]+)", HttpMethod::kPut, Named("putPart"), {"id", "part"});
+    router.addRouteRegex("/uploads/([^/]+)/complete", HttpMethod::kPost, Named("complete"), {"id"});
+    router.addRouteRegex("/files/([0-9]+)", HttpMethod::kGet, Named("fileById"), {"id"});
+    router.addRouteRegex("/files/([^/]+)", HttpMethod::kGet, Named("fileByName"), {"name"});
+    router.addRouteRegex("/legacy/v[0-9]/(\\w+)", HttpMethod::kGet, Named("legacy"), {"name"}); // 不可编译，走正则
+    router.addRouteExact("/files", HttpMethod::kGet, Named("duplicate"));                        // 重复注册，先注册的生效
+
+    assert(router.FallbackCount() == 1);
+
+    HttpRequest req;
+    assert(Dispatch(router, "GET", "/", req) && g_hit == "index");
+    assert(Dispatch(router, "GET", "/files", req) && g_hit == "list");
+    assert(Dispatch(router, "GET", "/index.html", req) && g_hit == "indexHtml");
+    assert(!Dispatch(router, "GET", "/files/", req));
+    assert(!Dispatch(router, "GET", "/nope", req));
+
+    // 方法不匹配视为未命中
+    assert(!Dispatch(router, "GET", "/share", req));
+    assert(Dispatch(router, "POST", "/share", req) && g_hit == "shareCreate");
+    assert(Dispatch(router, "HEAD", "/uploads/abc", req) && g_hit == "uploadHead" && req.GetPathParam("id") == "abc");
+    assert(Dispatch(router, "PATCH", "/uploads/abc", req) && g_hit == "uploadPatch");
+    assert(!Dispatch(router, "DELETE", "/uploads/abc", req));
+
+    // 静态段没有该方法的处理器时回退到参数段：/share/download 匹配 /share/([^/]+)
+    assert(Dispatch(router, "GET", "/share/download", req) && g_hit == "shareAccess" && req.GetPathParam("code") == "download");
+    assert(Dispatch(router, "GET", "/share/download/a.txt", req) && g_hit == "shareDownload");
+    assert(req.GetPathParam("filename") == "a.txt" && req.GetPathParam("code").empty()); // 上一次的参数已清除
+    assert(!Dispatch(router, "GET", "/share/", req));
+
+    // 数字参数优先于任意参数
+    assert(Dispatch(router, "GET", "/files/42", req) && g_hit == "fileById" && req.GetPathParam("id") == "42");
+    assert(Dispatch(router, "GET", "/files/42a", req) && g_hit == "fileByName" && req.GetPathParam("name") == "42a");
+    assert(Dispatch(router, "PUT", "/uploads/u1/parts/7", req) && g_hit == "putPart");
+    assert(req.GetPathParam("id") == "u1" && req.GetPathParam("part") == "7");
+    assert(!Dispatch(router, "PUT", "/uploads/u1/parts/x", req));
+    assert(Dispatch(router, "POST", "/uploads/u1/complete", req) && g_hit == "complete");
+
+    // 剩余路径通配：可为空，可含 '/'
+    assert(Dispatch(router, "GET", "/static/js/app.js", req) && g_hit == "static" && req.GetPathParam("path") == "js/app.js");
+    assert(Dispatch(router, "GET", "/static/", req) && req.GetPathParam("path").empty());
+    assert(!Dispatch(router, "GET", "/static", req));
+
+    // 查询串不参与匹配
+    assert(Dispatch(router, "GET", "/files?type=my", req) && g_hit == "list");
+
+    assert(Dispatch(router, "GET", "/legacy/v2/report", req) && g_hit == "legacy" && req.GetPathParam("name") == "report");
+    assert(!Dispatch(router, "GET", "/legacy/vx/report", req));
+
+    // 找到路由与处理器是否同步完成分开返回；未设置 server 时 kBlocking 路由在当前线程执行
+    router.addRouteExact("/async", HttpMethod::kPost, [](auto &, auto &, auto *) { return false; });
+    router.addRouteExact("/blocking", HttpMethod::kGet, Named("blocking"), Router::kBlocking);
+    HttpResponse resp(false);
+    bool sync = true;
+    req.SetMethod("POST");
+    req.SetUrl("/async");
+    assert(router.dispatch(nullptr, req, &resp, sync) && !sync);
+    req.SetUrl("/missing");
+    assert(!router.dispatch(nullptr, req, &resp, sync));
+    assert(Dispatch(router, "GET", "/blocking", req) && g_hit == "blocking");
+
+    // 请求体预检：按注册时的模式挂到路由上，看到的路径参数与处理器相同；没有预检的路由与未知路径放行
+    std::string checkedPart;
+    bool attached = router.setPreCheck("/uploads/([^/]+)/parts/([0-9]+)", HttpMethod::kPut, [&checkedPart](auto &, auto &r, auto *s) {
+        checkedPart = r.GetPathParam("part");
+        s->SetStatusCode(HttpStatusCode::PayloadTooLarge);
+        return false;
+    });
+    bool unknown = router.setPreCheck("/uploads/([^/]+)/parts/([0-9]+)", HttpMethod::kPost, nullptr);
+    assert(attached && !unknown);
+    req.SetMethod("PUT");
+    req.SetUrl("/uploads/u1/parts/3");
+    HttpResponse rejected(false);
+    assert(!router.precheck(nullptr, req, &rejected) && checkedPart == "3" && rejected.GetMessage().find("HTTP/1.1 413") == 0);
+    req.SetMethod("PATCH");
+    req.SetUrl("/uploads/u1");
+    assert(router.precheck(nullptr, req, &resp));
+    req.SetUrl("/missing");
+    assert(router.precheck(nullptr, req, &resp));
+
+    std::cout << "test_app_router passed" << std::endl;
+    return 0;
+}
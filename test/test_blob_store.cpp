@@ -0,0 +1,78 @@
+#include "BlobStore.h"
+#include "Sha256.h"
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 测试：扇出布局的路径解析、平铺文件回退、在线迁移与回收
+static void WriteFile(const std::string &path, const std::string &content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+static bool IsFile(const std::string &path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+int main()
+{
+    char tmpl[] = "/tmp/test_blob_store_XXXXXX";
+    std::string dir = ::mkdtemp(tmpl);
+    ShardedBlobStore store(dir + "/blobs", dir);
+
+    std::string a = "hello", b = "world";
+    std::string ha = Sha256::HexOf(a.data(), a.size()), hb = Sha256::HexOf(b.data(), b.size());
+    assert(store.BlobPath(ha) == dir + "/blobs/" + ha.substr(0, 2) + "/" + ha.substr(2, 2) + "/" + ha);
+    assert(ShardedBlobStore::ShardOf("upload_1").size() == 5);
+
+    // 新上传直接进入扇出目录，重复内容删除副本
+    WriteFile(dir + "/in1", a);
+    assert(store.Adopt(dir + "/in1", ha));
+    assert(IsFile(store.BlobPath(ha)) && !IsFile(dir + "/in1"));
+    WriteFile(dir + "/in2", a);
+    assert(store.Adopt(dir + "/in2", ha));
+    assert(!IsFile(dir + "/in2"));
+
+    // 旧布局：平铺的内容文件与 legacy 文件，迁移前按旧路径解析
+    WriteFile(store.FlatBlobPath(hb), b);
+    WriteFile(dir + "/legacy_1", "old");
+    WriteFile(dir + "/filename_mapping.json", "{}");
+    WriteFile(dir + "/x.part", "partial");
+    std::string path;
+    uint64_t size = 0;
+    assert(store.Resolve("", hb, &path, &size) && path == store.FlatBlobPath(hb) && size == 5);
+    assert(store.Resolve("legacy_1", "", &path, &size) && path == dir + "/legacy_1" && size == 3);
+    assert(store.Exists(hb));
+    assert(!store.Resolve("missing", "", &path, &size));
+
+    LayoutMigrator::Stats st = LayoutMigrator(store).Run(2, 1);
+    assert(st.moved == 2 && st.failed == 0);
+    assert(store.Resolve("", hb, &path, &size) && path == store.BlobPath(hb));
+    assert(store.Resolve("legacy_1", "", &path, &size) && path == store.LegacyPath("legacy_1"));
+    assert(IsFile(dir + "/filename_mapping.json") && IsFile(dir + "/x.part")); // 非上传文件不动
+    st = LayoutMigrator(store).Run(2, 1);
+    assert(st.moved == 0); // 重复执行无副作用
+
+    // 回收：被重新引用则移回，否则删除
+    assert(store.BeginCollect(hb));
+    assert(!store.Exists(hb));
+    store.FinishCollect(hb, false);
+    assert(store.Exists(hb));
+    assert(store.BeginCollect(hb));
+    store.FinishCollect(hb, true);
+    assert(!store.Exists(hb));
+
+    assert(store.RemoveLegacy("legacy_1"));
+    assert(!store.Resolve("legacy_1", "", &path, &size));
+
+    std::string cmd = "rm -rf " + dir;
+    assert(std::system(cmd.c_str()) == 0);
+    std::cout << "test_blob_store passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "BlockingExecutor.h"
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// 测试：阻塞任务执行器的队列上限（收尾任务不受限）与排队统计；HttpServer::RunBlocking 在工作线程执行业务，
+// 期间同一 sub-reactor 上的其它连接照常响应，完成后回包并继续处理流水线请求（包括等待期间分多次到达的），队列满时回 503
+using Clock = std::chrono::steady_clock;
+static const int kServerPort = 18101;
+static HttpServer *g_server = nullptr;
+
+static bool SlowHandler(const std::shared_ptr<Connection> &, HttpRequest &req, HttpResponse *resp)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(300)); // 模拟慢查询
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetBody("slow " + req.GetQueryValue("id"));
+    return true;
+}
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    if (req.GetUrl() == "/slow")
+        return g_server->RunBlocking("GET /slow", conn, req, resp, SlowHandler);
+    if (req.GetUrl() == "/defer")
+        return g_server->RunBlocking("GET /defer", conn, req, resp, [](auto &, auto &, auto *) { return false; });
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetBody("fast");
+    return true;
+}
+
+static double ElapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static void TestExecutor()
+{
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::atomic<int> ran(0);
+    {
+        BlockingExecutor executor(1, 2);
+        assert(executor.Threads() == 1 && executor.MaxQueue() == 2);
+        assert(executor.Submit("a", [&]() { opened.wait(); ++ran; }));
+        while (executor.QueueDepth() != 0) // 等第一个任务被取走
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        assert(executor.Submit("b", [&]() { ++ran; }));
+        assert(executor.Submit("b", [&]() { ++ran; }));
+        assert(!executor.Submit("b", [&]() { ++ran; })); // 队列已满
+        assert(executor.SubmitUnbounded("c", [&]() { ++ran; })); // 收尾任务不受上限限制
+        assert(executor.QueueDepth() == 3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        gate.set_value();
+        // 析构时执行完已入队的任务
+    }
+    assert(ran == 4);
+
+    BlockingExecutor executor(2, 8);
+    assert(executor.Submit("throws", []() { throw std::runtime_error("boom"); })); // 异常不会终止工作线程
+    std::promise<void> done;
+    assert(executor.Submit("after", [&]() { done.set_value(); }));
+    done.get_future().wait();
+    std::map<std::string, BlockingExecutor::Stats> stats = executor.GetStats();
+    assert(stats["throws"].executed == 1 && stats["after"].executed == 1);
+}
+
+static void TestExecutorStats()
+{
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    BlockingExecutor executor(1, 4);
+    executor.Submit("blocker", [opened]() { opened.wait(); });
+    executor.Submit("queued", []() {});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    gate.set_value();
+    while (executor.GetStats()["queued"].executed == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    BlockingExecutor::Stats st = executor.GetStats()["queued"];
+    assert(st.rejected == 0 && st.maxWaitMs >= 40 && st.AvgWaitMs() == st.maxWaitMs);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    TestExecutor();
+    TestExecutorStats();
+
+    std::thread([]() {
+        EventLoop loop;
+        HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+        server.SetHttpCallback(OnRequest);
+        server.SetThreadNums(1); // 所有连接在同一个 sub-reactor 上
+        server.SetBlockingExecutor(1, 1);
+        g_server = &server;
+        server.start();
+        loop.loop();
+    }).detach();
+
+    std::string pendingA, pendingB, body;
+    {
+        // 慢请求在工作线程执行期间，同一 loop 上的其它连接照常响应
+        int a = Connect(kServerPort);
+        int b = Connect(kServerPort);
+        Clock::time_point t0 = Clock::now();
+        Write(a, "GET /slow?id=1 HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Write(b, "GET /fast HTTP/1.1\r\nHost: x\r\n\r\n");
+        assert(ReadResponse(b, pendingB, body).find("HTTP/1.1 200") == 0 && body == "fast");
+        assert(ElapsedMs(t0) < 200);
+        std::string head = ReadResponse(a, pendingA, body);
+        assert(head.find("HTTP/1.1 200") == 0 && head.find("Connection: Keep-Alive") != std::string::npos && body == "slow 1");
+        assert(ElapsedMs(t0) >= 300);
+
+        // 流水线：慢请求之后的请求在其响应发出后继续处理，按序回包
+        Write(a, "GET /slow?id=2 HTTP/1.1\r\nHost: x\r\n\r\nGET /fast HTTP/1.1\r\nHost: x\r\n\r\n");
+        assert(ReadResponse(a, pendingA, body).find("HTTP/1.1 200") == 0 && body == "slow 2");
+        assert(ReadResponse(a, pendingA, body).find("HTTP/1.1 200") == 0 && body == "fast");
+
+        // 等待期间后续请求分多次到达（各自一次读事件）：都保留下来，按序回包
+        Write(a, "GET /slow?id=8 HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Write(a, "GET /fast HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Write(a, "GET /slow?id=9 HTTP/1.1\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Write(a, "Host: x\r\n\r\n");
+        assert(ReadResponse(a, pendingA, body).find("HTTP/1.1 200") == 0 && body == "slow 8");
+        assert(ReadResponse(a, pendingA, body).find("HTTP/1.1 200") == 0 && body == "fast");
+        assert(ReadResponse(a, pendingA, body).find("HTTP/1.1 200") == 0 && body == "slow 9");
+
+        // 工作线程上不能再次异步：回 500，连接继续可用
+        Write(a, "GET /defer HTTP/1.1\r\nHost: x\r\n\r\n");
+        assert(ReadResponse(a, pendingA, body).find("HTTP/1.1 500") == 0);
+        ::close(a);
+        ::close(b);
+    }
+    {
+        // 1 个工作线程 + 1 个排队位：第三个请求立即得到 503
+        int c1 = Connect(kServerPort), c2 = Connect(kServerPort), c3 = Connect(kServerPort);
+        std::string p1, p2, p3;
+        Write(c1, "GET /slow?id=3 HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Write(c2, "GET /slow?id=4 HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Clock::time_point t0 = Clock::now();
+        Write(c3, "GET /slow?id=5 HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::string head = ReadResponse(c3, p3, body);
+        assert(head.find("HTTP/1.1 503") == 0 && head.find("Retry-After: 1") != std::string::npos);
+        assert(ElapsedMs(t0) < 200);
+        assert(ReadResponse(c1, p1, body).find("HTTP/1.1 200") == 0 && body == "slow 3");
+        assert(ReadResponse(c2, p2, body).find("HTTP/1.1 200") == 0 && body == "slow 4");
+        ::close(c1);
+        ::close(c2);
+        ::close(c3);
+    }
+    {
+        // 等待期间客户端断开：响应被丢弃，服务继续工作
+        int c = Connect(kServerPort);
+        Write(c, "GET /slow?id=6 HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ::close(c);
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        c = Connect(kServerPort);
+        std::string p;
+        Write(c, "GET /slow?id=7 HTTP/1.1\r\nHost: x\r\n\r\n");
+        assert(ReadResponse(c, p, body).find("HTTP/1.1 200") == 0 && body == "slow 7");
+        ::close(c);
+    }
+    std::map<std::string, BlockingExecutor::Stats> stats = g_server->GetBlockingExecutor()->GetStats();
+    assert(stats["GET /slow"].executed == 8 && stats["GET /slow"].rejected == 1);
+    assert(stats["GET /slow"].maxWaitMs >= 200); // 第二个慢请求排在第一个之后
+    std::cout << "test_blocking_executor passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "ConnectionPool.h"
+#include "Logger.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 测试：线程亲和（同一线程拿回同一槽位）、各线程不共用连接、全部占用时等待与超时、归还唤醒等待者；
+// 断开的连接借出时重连，失败后退避期内不再尝试；HealthCheck 探活失败时重连，跳过借出中的连接
+// 统计来自按池名注册的指标，各用例使用不同的池名
+class FakePool : public ConnectionPool
+{
+public:
+    FakePool(const std::string &name, size_t size) : ConnectionPool(name, size), up(size), inside(size) {}
+
+    std::vector<std::atomic<bool>> up;     // 连接状态
+    std::vector<std::atomic<int>> inside;  // 同时使用某个连接的线程数，应不超过 1
+    std::atomic<bool> serverDown{false};   // 为 true 时 Connect 与 Ping 失败
+    std::atomic<int> connects{0};
+    std::atomic<int> pings{0};
+
+protected:
+    bool Connect(size_t index) override
+    {
+        ++connects;
+        up[index] = !serverDown;
+        return up[index];
+    }
+    bool Ping(size_t index) override
+    {
+        ++pings;
+        if (serverDown)
+            up[index] = false;
+        return up[index];
+    }
+    bool IsConnected(size_t index) const override { return up[index]; }
+};
+
+static void TestAffinity()
+{
+    FakePool pool("affinity", 4);
+    assert(pool.ConnectAll() == 4);
+    size_t first;
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+        assert(lease);
+        first = lease.Index();
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+        assert(lease.Index() == first);
+    }
+    // 本线程的槽位被占用时借到其他槽位
+    ConnectionPool::Lease held = pool.Acquire();
+    ConnectionPool::Lease other = pool.Acquire();
+    assert(held.Index() == first && other.Index() != first);
+    assert(pool.GetStats().inUse == 2);
+    other.Release();
+    held = ConnectionPool::Lease();
+    assert(pool.GetStats().inUse == 0);
+
+    // 另一个线程同样拿回首次借到的槽位
+    std::thread([&pool]() {
+        size_t mine;
+        {
+            ConnectionPool::Lease lease = pool.Acquire();
+            mine = lease.Index();
+        }
+        ConnectionPool::Lease again = pool.Acquire();
+        assert(again.Index() == mine);
+    }).join();
+    assert(pool.GetStats().reconnects == 0);
+}
+
+static void TestWaitAndTimeout()
+{
+    FakePool pool("wait", 2);
+    pool.ConnectAll();
+    ConnectionPool::Lease a = pool.Acquire();
+    ConnectionPool::Lease b = pool.Acquire();
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    ConnectionPool::Lease none = pool.Acquire(50);
+    assert(!none && std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(50));
+    assert(pool.GetStats().timeouts == 1);
+
+    // 等待中的线程在归还时被唤醒，拿到归还的槽位
+    size_t returned = b.Index();
+    std::atomic<bool> got(false);
+    std::thread waiter([&]() {
+        ConnectionPool::Lease lease = pool.Acquire(5000);
+        assert(lease && lease.Index() == returned);
+        got = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    assert(!got);
+    b.Release();
+    waiter.join();
+    assert(got && pool.GetStats().timeouts == 1);
+}
+
+static void TestConcurrent()
+{
+    // 8 个线程争用 3 个连接：每个连接同一时刻只有一个线程在用
+    FakePool pool("concurrent", 3);
+    pool.ConnectAll();
+    std::atomic<int> overlap(0);
+    std::atomic<int> done(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 2000; ++i)
+            {
+                ConnectionPool::Lease lease = pool.Acquire(10000);
+                if (!lease)
+                    continue;
+                if (++pool.inside[lease.Index()] != 1)
+                    ++overlap;
+                if (i % 64 == 0)
+                    std::this_thread::yield();
+                --pool.inside[lease.Index()];
+                ++done;
+            }
+        });
+    for (auto &th : threads)
+        th.join();
+    assert(overlap == 0 && done == 8 * 2000);
+    assert(pool.GetStats().inUse == 0 && pool.GetStats().timeouts == 0);
+}
+
+static void TestReconnect()
+{
+    FakePool pool("reconnect", 2);
+    pool.SetReconnectBackoff(100, 1000);
+    pool.ConnectAll();
+    assert(pool.connects == 2 && pool.GetStats().connected == 2);
+
+    // 连接断开：下次借出时重连
+    pool.up[0] = false;
+    pool.up[1] = false;
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+        assert(pool.up[lease.Index()] && pool.connects == 3);
+    }
+    assert(pool.GetStats().reconnects == 1);
+
+    // 数据库不可用：重连失败后退避期内照常借出，不再尝试
+    pool.serverDown = true;
+    size_t slot;
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+        slot = lease.Index();
+    }
+    pool.up[slot] = false;
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+        assert(lease && lease.Index() == slot && !pool.up[slot]);
+    }
+    assert(pool.connects == 4 && pool.GetStats().reconnectFailures == 1);
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+    }
+    assert(pool.connects == 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    pool.serverDown = false;
+    {
+        ConnectionPool::Lease lease = pool.Acquire();
+        assert(pool.up[slot]);
+    }
+    assert(pool.connects == 5 && pool.GetStats().reconnects == 2);
+}
+
+static void TestHealthCheck()
+{
+    FakePool pool("health", 3);
+    pool.ConnectAll();
+    assert(pool.HealthCheck() == 3 && pool.pings == 3);
+
+    // 服务端关闭了空闲连接：探活失败后立即重连
+    pool.up[1] = false;
+    assert(pool.HealthCheck() == 3 && pool.up[1]);
+
+    // 借出中的连接不探活
+    ConnectionPool::Lease held = pool.Acquire();
+    int pings = pool.pings;
+    pool.serverDown = true;
+    assert(pool.HealthCheck() == 1); // 借出的按归还时的状态计
+    assert(pool.pings == pings + 2);
+    pool.serverDown = false;
+    held.Release();
+    assert(pool.HealthCheck() == 3);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    TestAffinity();
+    TestWaitAndTimeout();
+    TestConcurrent();
+    TestReconnect();
+    TestHealthCheck();
+    std::cout << "test_connection_pool passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "ContentCache.h"
+#include "FdCache.h"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// 测试：内容缓存的门卫准入、命中、预算内淘汰、文件改写后换键，以及并发未命中只读一次盘
+static void WriteFile(const std::string &path, const std::string &content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+int main()
+{
+    char tmpl[] = "/tmp/test_content_cache_XXXXXX";
+    std::string dir = ::mkdtemp(tmpl);
+    WriteFile(dir + "/a", std::string(1000, 'a'));
+    WriteFile(dir + "/b", std::string(1000, 'b'));
+    WriteFile(dir + "/c", std::string(1000, 'c'));
+    WriteFile(dir + "/big", std::string(5000, 'x'));
+    WriteFile(dir + "/empty", "");
+
+    {
+        ContentCache cache(2500, 2000);
+        auto a = FdCache::OpenFile(dir + "/a");
+        auto big = FdCache::OpenFile(dir + "/big");
+        auto empty = FdCache::OpenFile(dir + "/empty");
+
+        // 只访问过一次的文件不读入，第二次才读入
+        assert(!cache.Get(*a));
+        auto body = cache.Get(*a);
+        assert(body && *body == std::string(1000, 'a'));
+        assert(cache.Get(*a) == body); // 命中返回同一份内容
+        ContentCache::Stats st = cache.GetStats();
+        assert(st.hits == 1 && st.misses == 2 && st.loads == 1 && st.entries == 1 && st.bytes == 1000);
+
+        // 过大和空文件不缓存
+        assert(!cache.Get(*big) && !cache.Get(*big) && !cache.Get(*empty));
+
+        // 预算 2500：b 读入后放不下 c，c 的频率须高于最先被淘汰者才准入
+        auto b = FdCache::OpenFile(dir + "/b");
+        auto c = FdCache::OpenFile(dir + "/c");
+        cache.Get(*b);
+        assert(cache.Get(*b) && cache.GetStats().entries == 2);
+        cache.Get(*c);
+        assert(!cache.Get(*c)); // 与 b 频率相同，不准入
+        assert(cache.GetStats().rejections == 1);
+        auto cBody = cache.Get(*c); // 频率超过 b，淘汰 b 后读入
+        assert(cBody && *cBody == std::string(1000, 'c'));
+        st = cache.GetStats();
+        assert(st.evictions == 1 && st.entries == 2 && st.bytes == 2000);
+        assert(cache.Get(*a) == body); // a 在保护段，未被淘汰
+    }
+
+    {
+        // 改写文件：mtime 与大小变化后是新的键，不会返回旧内容
+        ContentCache cache(1024 * 1024, 4096);
+        auto a = FdCache::OpenFile(dir + "/a");
+        cache.Get(*a);
+        auto body = cache.Get(*a);
+        assert(body && body->size() == 1000);
+        WriteFile(dir + "/a", std::string(1500, 'A'));
+        struct timeval times[2] = {{1, 0}, {1, 0}};
+        ::utimes((dir + "/a").c_str(), times);
+        auto a2 = FdCache::OpenFile(dir + "/a");
+        assert(!cache.Get(*a2)); // 新键，首次访问
+        auto body2 = cache.Get(*a2);
+        assert(body2 && *body2 == std::string(1500, 'A'));
+        assert(*body == std::string(1000, 'a')); // 旧内容的持有者不受影响
+    }
+
+    {
+        // 并发未命中同一文件只读一次盘
+        WriteFile(dir + "/hot", std::string(100 * 1024, 'h'));
+        auto hot = FdCache::OpenFile(dir + "/hot");
+        ContentCache cache(1024 * 1024, 512 * 1024);
+        cache.Get(*hot); // 第一次访问由门卫拦下
+        std::atomic<int> ok(0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 16; ++i)
+            threads.emplace_back([&]() {
+                auto data = cache.Get(*hot);
+                if (data && data->size() == 100 * 1024)
+                    ++ok;
+            });
+        for (auto &t : threads)
+            t.join();
+        assert(ok == 16);
+        assert(cache.GetStats().loads == 1);
+    }
+
+    std::system(("rm -rf " + dir).c_str());
+    std::cout << "test_content_cache passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "Coroutine.h"
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// 测试：Task 嵌套与异常传递、协程帧复用；HttpServer::RunCoroutine 驱动协程处理器：
+// 同步完成直接回包，定时器/阻塞任务/文件读写挂起后在 loop 线程恢复并发送，流水线请求按序处理，队列满回 503，异常回 500
+using Clock = std::chrono::steady_clock;
+static const int kServerPort = 18102;
+static HttpServer *g_server = nullptr;
+static BlockingExecutor *g_full = nullptr; // 队列容量为 0，提交总是被拒绝
+static std::string g_file;
+
+static Task<int> Leaf(int v)
+{
+    if (v < 0)
+        throw std::runtime_error("negative");
+    co_return v * 2;
+}
+
+static Task<int> Sum(int n)
+{
+    int total = 0;
+    for (int i = 1; i <= n; ++i)
+        total += co_await Leaf(i);
+    co_return total;
+}
+
+static Task<std::string> Guarded(int v)
+{
+    try
+    {
+        co_await Leaf(v);
+    }
+    catch (const std::exception &e)
+    {
+        co_return std::string("caught ") + e.what();
+    }
+    co_return std::string("ok");
+}
+
+template <typename T>
+static DetachedTask Collect(Task<T> task, std::promise<T> &out)
+{
+    out.set_value(co_await task);
+}
+
+template <typename T>
+static T RunSync(Task<T> task)
+{
+    std::promise<T> p;
+    Collect(std::move(task), p);
+    return p.get_future().get();
+}
+
+static void TestTasks()
+{
+    assert(RunSync(Sum(10)) == 110);
+    assert(RunSync(Guarded(-1)) == "caught negative" && RunSync(Guarded(1)) == "ok");
+
+    // 同一线程上重复执行：帧全部来自空闲链
+    RunSync(Sum(3));
+    FramePool::Stats before = FramePool::ThreadStats();
+    for (int i = 0; i < 100; ++i)
+        RunSync(Sum(3));
+    FramePool::Stats after = FramePool::ThreadStats();
+    assert(after.fresh == before.fresh && after.pooled > before.pooled);
+
+    // 没有执行器时 Offload 在当前线程执行；在非 loop 线程上由工作线程恢复
+    auto inlineTask = []() -> Task<int> { co_return co_await Offload(nullptr, "inline", []() { return 7; }); };
+    assert(RunSync(inlineTask()) == 7);
+    BlockingExecutor executor(1, 4);
+    auto offloaded = [](BlockingExecutor *ex) -> Task<std::thread::id> {
+        co_await Offload(ex, "void", []() {});
+        co_return co_await Offload(ex, "tid", []() { return std::this_thread::get_id(); });
+    };
+    assert(RunSync(offloaded(&executor)) != std::this_thread::get_id());
+}
+
+static HttpResponse Text(const std::string &body)
+{
+    HttpResponse resp(false);
+    resp.SetStatusCode(HttpStatusCode::OK);
+    resp.SetStatusMessage("OK");
+    resp.SetBody(body);
+    return resp;
+}
+
+static Task<HttpResponse> Handle(std::shared_ptr<Connection> conn, HttpRequest &req)
+{
+    std::string url = req.GetUrl();
+    if (url == "/sleep")
+    {
+        co_await SleepFor(0.1);
+        co_return Text("slept " + req.GetQueryValue("id"));
+    }
+    if (url == "/db")
+    {
+        std::thread::id loopThread = std::this_thread::get_id();
+        std::string rows = co_await Offload(g_server->GetBlockingExecutor(), "GET /db", []() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200)); // 模拟慢查询
+            return std::string("rows");
+        });
+        co_return Text(rows + (std::this_thread::get_id() == loopThread ? " on loop" : " elsewhere"));
+    }
+    if (url == "/file")
+    {
+        size_t n = co_await WriteFile(g_server->GetBlockingExecutor(), g_file, 0, "hello coroutine");
+        std::string data = co_await ReadFile(g_server->GetBlockingExecutor(), g_file, 6, 64);
+        co_return Text(std::to_string(n) + " " + data);
+    }
+    if (url == "/writable")
+    {
+        bool ok = co_await Writable(conn);
+        co_return Text(ok ? "writable" : "closed");
+    }
+    if (url == "/busy")
+        co_await Offload(g_full, "GET /busy", []() {});
+    if (url == "/throw")
+        throw std::runtime_error("handler failed");
+    co_return Text("sync");
+}
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    return g_server->RunCoroutine(conn, resp, Handle(conn, req));
+}
+
+static double ElapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static std::string Get(int fd, std::string &pending, const std::string &url, std::string &body)
+{
+    Write(fd, "GET " + url + " HTTP/1.1\r\nHost: x\r\n\r\n");
+    return ReadResponse(fd, pending, body);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    TestTasks();
+
+    char tmpl[] = "/tmp/test_coroutine_XXXXXX";
+    int tmpfd = ::mkstemp(tmpl);
+    assert(tmpfd >= 0);
+    ::close(tmpfd);
+    g_file = tmpl;
+    BlockingExecutor full(1, 0);
+    g_full = &full;
+
+    std::thread([]() {
+        EventLoop loop;
+        HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+        server.SetHttpCallback(OnRequest);
+        server.SetThreadNums(1); // 所有连接在同一个 sub-reactor 上
+        server.SetBlockingExecutor(2, 16);
+        g_server = &server;
+        server.start();
+        loop.loop();
+    }).detach();
+
+    std::string pa, pb, body;
+    int a = Connect(kServerPort);
+    int b = Connect(kServerPort);
+    assert(Get(a, pa, "/sync", body).find("HTTP/1.1 200") == 0 && body == "sync");
+
+    // 阻塞查询挂起期间，同一 loop 上的其它连接照常响应；完成后在 loop 线程恢复
+    Clock::time_point t0 = Clock::now();
+    Write(a, "GET /db HTTP/1.1\r\nHost: x\r\n\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(Get(b, pb, "/sync", body).find("HTTP/1.1 200") == 0 && body == "sync");
+    assert(ElapsedMs(t0) < 150);
+    assert(ReadResponse(a, pa, body).find("HTTP/1.1 200") == 0 && body == "rows on loop");
+    assert(ElapsedMs(t0) >= 200);
+
+    // 定时器；流水线中排在后面的请求在前一个响应发出后处理
+    t0 = Clock::now();
+    Write(a, "GET /sleep?id=1 HTTP/1.1\r\nHost: x\r\n\r\nGET /sync HTTP/1.1\r\nHost: x\r\n\r\n");
+    assert(ReadResponse(a, pa, body).find("HTTP/1.1 200") == 0 && body == "slept 1");
+    assert(ElapsedMs(t0) >= 100);
+    assert(ReadResponse(a, pa, body).find("HTTP/1.1 200") == 0 && body == "sync");
+
+    assert(Get(a, pa, "/file", body).find("HTTP/1.1 200") == 0 && body == "15 coroutine");
+    assert(Get(a, pa, "/writable", body).find("HTTP/1.1 200") == 0 && body == "writable");
+    std::string head = Get(a, pa, "/busy", body);
+    assert(head.find("HTTP/1.1 503") == 0 && head.find("Retry-After: 1") != std::string::npos);
+    assert(Get(a, pa, "/throw", body).find("HTTP/1.1 500") == 0);
+
+    // 客户端要求关闭：挂起的协程完成后回包并关闭
+    Write(a, "GET /sleep?id=2 HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n");
+    head = ReadResponse(a, pa, body);
+    assert(head.find("Connection: close") != std::string::npos && body == "slept 2");
+    char c;
+    assert(::read(a, &c, 1) == 0);
+    ::close(a);
+
+    // 挂起期间客户端断开：协程照常结束，响应被丢弃
+    Write(b, "GET /db HTTP/1.1\r\nHost: x\r\n\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ::close(b);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    b = Connect(kServerPort);
+    pb.clear();
+    assert(Get(b, pb, "/sleep?id=3", body).find("HTTP/1.1 200") == 0 && body == "slept 3");
+    ::close(b);
+    ::unlink(g_file.c_str());
+
+    std::cout << "test_coroutine passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "Db.h"
+#include "DbPool.h"
+#include "Logger.h"
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+
+// 测试：预处理语句（需要本机 MySQL 上的 file_manager 库，连不上时跳过）
+// 各类参数按类型绑定、结果按类型读回；超出初始缓冲的字符串列扩容重取，且不影响后续行；
+// 连接被服务端断开后语句执行失败，连接标记为断开，重连后语句缓存重建，同一 SQL 重新准备后可用
+static const char *kHost = "localhost";
+static const char *kUser = "root";
+static const char *kPassword = "123456";
+static const char *kDbName = "file_manager";
+static const unsigned int kPort = 3306;
+
+static void TestTypedBinds(Db &db)
+{
+    assert(db.exec("CREATE TEMPORARY TABLE stmt_types (id INT AUTO_INCREMENT PRIMARY KEY, i INT, big BIGINT, u BIGINT UNSIGNED, "
+                   "s VARCHAR(64), c VARCHAR(64), n INT NULL, ns VARCHAR(64) NULL, d DECIMAL(12, 2), t DATETIME)"));
+    Statement *insert = db.prepare("INSERT INTO stmt_types (i, big, u, s, c, n, ns, d, t) VALUES (?, ?, ?, ?, ?, ?, ?, 1234.50, '2024-01-02 03:04:05')");
+    assert(insert);
+    std::optional<int> noInt;
+    std::optional<std::string> someText("opt");
+    assert(insert->execute(-7, static_cast<int64_t>(-5000000000LL), static_cast<uint64_t>(18000000000000000000ULL), std::string("it's \"quoted\""), "c-str", noInt, someText));
+    uint64_t first = insert->insertId();
+    assert(first > 0 && insert->affectedRows() == 1);
+    assert(insert->execute(1, static_cast<int64_t>(2), static_cast<uint64_t>(3), std::string(), "", std::optional<int>(42), std::nullopt));
+    assert(insert->insertId() == first + 1);
+    assert(!insert->execute(1, 2)); // 参数个数不符：不执行
+
+    Statement *select = db.prepare("SELECT id, i, big, u, s, c, n, ns, d, t FROM stmt_types WHERE id >= ? ORDER BY id");
+    assert(select && select->query(static_cast<uint64_t>(first)));
+    assert(select->rowCount() == 2);
+    assert(select->fetch());
+    assert(select->getUInt64(0) == first);
+    assert(select->getInt(1) == -7);
+    assert(select->getInt64(2) == -5000000000LL);
+    assert(select->getUInt64(3) == 18000000000000000000ULL);
+    assert(select->getString(4) == "it's \"quoted\"");
+    assert(select->getString(5) == "c-str");
+    assert(select->isNull(6) && select->getInt(6) == 0 && !select->getOptionalInt(6));
+    assert(select->getOptionalString(7) == std::optional<std::string>("opt"));
+    assert(select->getString(8) == "1234.50" && select->getInt64(8) == 1234); // DECIMAL 以文本读回
+    assert(select->getString(9) == "2024-01-02 03:04:05");
+    assert(select->fetch());
+    assert(select->getString(4).empty() && !select->isNull(4));
+    assert(select->getOptionalInt(6) == std::optional<int>(42));
+    assert(select->isNull(7) && select->getString(7).empty());
+    assert(!select->fetch());
+
+    // 同一 SQL 复用同一条语句，再次执行时释放上一次的结果集
+    assert(db.prepare("SELECT id, i, big, u, s, c, n, ns, d, t FROM stmt_types WHERE id >= ? ORDER BY id") == select);
+    assert(select->query(static_cast<uint64_t>(first + 1)) && select->rowCount() == 1);
+    assert(select->fetch() && select->getInt(6) == 42 && !select->fetch());
+}
+
+static void TestTruncatedRefetch(Db &db)
+{
+    assert(db.exec("CREATE TEMPORARY TABLE stmt_text (id INT AUTO_INCREMENT PRIMARY KEY, a MEDIUMTEXT, b VARCHAR(16))"));
+    // 初始缓冲 64 字节：短、长、短、更长，逐行交替
+    const std::string values[] = {"short", std::string(200, 'x'), "tiny", std::string(70000, 'y') + "end"};
+    Statement *insert = db.prepare("INSERT INTO stmt_text (a, b) VALUES (?, ?)");
+    assert(insert);
+    for (size_t i = 0; i < 4; ++i)
+        assert(insert->execute(values[i], "row" + std::to_string(i)));
+    Statement *select = db.prepare("SELECT a, b FROM stmt_text ORDER BY id");
+    assert(select && select->query());
+    for (size_t i = 0; i < 4; ++i)
+    {
+        assert(select->fetch());
+        assert(select->getString(0) == values[i]);
+        assert(select->getString(1) == "row" + std::to_string(i)); // 同一行未截断的列不受影响
+    }
+    assert(!select->fetch());
+    // 扩容后的缓冲在下一次执行中继续使用
+    assert(select->query() && select->fetch() && select->getString(0) == values[0]);
+}
+
+static void TestLostConnection()
+{
+    DbPool pool(kHost, kUser, kPassword, kDbName, kPort, 1);
+    Db killer(kHost, kUser, kPassword, kDbName, kPort);
+    assert(pool.ConnectAll() == 1 && killer.connect());
+    const std::string sql = "SELECT CONNECTION_ID(), ?";
+    uint64_t connectionId = 0;
+    {
+        DbPool::Stmt st = pool.prepare(sql);
+        assert(st && st->query(1) && st->fetch() && st->getInt(1) == 1);
+        connectionId = st->getUInt64(0);
+        // 服务端断开这个连接：语句执行失败，连接标记为断开
+        assert(killer.exec("KILL " + std::to_string(connectionId)));
+        assert(!st->query(2));
+    }
+    // 再次借出时重连，旧连接上的语句随之关闭；同一 SQL 在新连接上重新准备
+    DbPool::Stmt st = pool.prepare(sql);
+    assert(st && st->query(3) && st->fetch());
+    assert(st->getUInt64(0) != connectionId && st->getInt(1) == 3);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    Db db(kHost, kUser, kPassword, kDbName, kPort);
+    if (!db.connect())
+    {
+        std::cout << "test_db_statement skipped: no MySQL at " << kHost << ":" << kPort << "/" << kDbName << std::endl;
+        return 0;
+    }
+    TestTypedBinds(db);
+    TestTruncatedRefetch(db);
+    TestLostConnection();
+    std::cout << "test_db_statement passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// 测试：Expect: 100-continue。请求体到达前预检一次：通过则回 100 Continue 再读请求体，
+// 拒绝则立即回错误并关闭连接；不认识的期望回 417；没有请求体或 HTTP/1.0 的请求不发 100；
+// 流式请求的请求体随头部一起到齐时同样先预检。
+// 设置了阻塞执行器时预检在工作线程上执行，结果相同；执行器队列满时回 503
+static const int kServerPort = 18103;
+static const int kExecutorPort = 18106;
+static std::atomic<int> g_checks(0);
+static std::atomic<int> g_checksOnLoop(0);
+
+// 只有携带令牌且不超过 1MB 的上传放行
+static bool Precheck(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    ++g_checks;
+    if (conn->GetLoop()->isInLoopThread())
+        ++g_checksOnLoop;
+    if (!req.GetHeader("X-Slow").empty())
+        std::this_thread::sleep_for(std::chrono::milliseconds(300)); // 占住执行器
+    if (req.GetHeader("X-Token") != "ok")
+    {
+        *resp = HttpResponse::MakeSimple(true, HttpStatusCode::Unauthorized, "Unauthorized", "401 Unauthorized\n");
+        return false;
+    }
+    if (std::strtoull(req.GetHeader("Content-Length").c_str(), nullptr, 10) > 1024 * 1024)
+    {
+        *resp = HttpResponse::MakeSimple(true, HttpStatusCode::PayloadTooLarge, "Payload Too Large", "413 Payload Too Large\n");
+        return false;
+    }
+    return true;
+}
+
+static bool OnRequest(const std::shared_ptr<Connection> &, HttpRequest &req, HttpResponse *resp)
+{
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetBody("got " + std::to_string(req.GetBody().size()));
+    return true;
+}
+
+static std::string Upload(size_t length, const std::string &extra)
+{
+    return "POST /upload HTTP/1.1\r\nHost: x\r\nContent-Length: " + std::to_string(length) + "\r\n" + extra + "\r\n";
+}
+
+static void StartServer(int port, bool executor)
+{
+    std::thread([port, executor]() {
+        EventLoop loop;
+        HttpServer server(&loop, "127.0.0.1", port, false);
+        server.SetHttpCallback(OnRequest);
+        server.SetBodyPrecheck(Precheck);
+        server.SetThreadNums(1);
+        if (executor)
+            server.SetBlockingExecutor(1, 1);
+        server.start();
+        loop.loop();
+    }).detach();
+}
+
+static void RunChecks(int port)
+{
+    std::string pending, body;
+    {
+        // 预检通过：先收到 100，再发请求体；同一连接上的下一个请求重新预检
+        int fd = Connect(port);
+        for (int round = 0; round < 2; ++round)
+        {
+            int before = g_checks;
+            Write(fd, Upload(1000, "X-Token: ok\r\nExpect: 100-continue\r\n"));
+            assert(ReadHead(fd, pending, 2000) == "HTTP/1.1 100 Continue\r\n\r\n");
+            Write(fd, std::string(400, 'a'));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            Write(fd, std::string(600, 'b'));
+            assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "got 1000");
+            assert(g_checks == before + 1); // 请求体分多次到达也只预检一次
+        }
+        // 没有请求体：不预检也不发 100
+        Write(fd, "GET /x HTTP/1.1\r\nHost: x\r\nExpect: 100-continue\r\n\r\n");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "got 0");
+        ::close(fd);
+    }
+    {
+        // 会话无效：请求体一个字节都没发就得到 401，连接随即关闭
+        int fd = Connect(port);
+        pending.clear();
+        Write(fd, Upload(1ULL << 30, "Expect: 100-continue\r\n"));
+        std::string head = ReadResponse(fd, pending, body);
+        assert(head.find("HTTP/1.1 401") == 0 && head.find("Connection: close") != std::string::npos);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+    {
+        // 超过大小上限：413
+        int fd = Connect(port);
+        pending.clear();
+        Write(fd, Upload(8ULL << 30, "X-Token: ok\r\nExpect: 100-continue\r\n"));
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 413") == 0);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+    {
+        // 不带 Expect 的客户端已经在发请求体：同样提前拒绝，不再读取剩余部分
+        int fd = Connect(port);
+        pending.clear();
+        Write(fd, Upload(1ULL << 20, "") + std::string(1000, 'a'));
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 401") == 0);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+    {
+        // 不认识的期望
+        int fd = Connect(port);
+        pending.clear();
+        Write(fd, Upload(10, "X-Token: ok\r\nExpect: something-else\r\n"));
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 417") == 0);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+    {
+        // HTTP/1.0 客户端不认识 1xx：预检通过后直接读请求体
+        int fd = Connect(port);
+        pending.clear();
+        Write(fd, "POST /upload HTTP/1.0\r\nContent-Length: 5\r\nX-Token: ok\r\nExpect: 100-continue\r\n\r\n");
+        assert(ReadHead(fd, pending, 200).empty());
+        Write(fd, "hello");
+        std::string head = ReadResponse(fd, pending, body);
+        assert(head.find("HTTP/1.1 200") == 0 && body == "got 5");
+        ::close(fd);
+    }
+    {
+        // 流式请求（POST /upload）的请求体随头部一起到齐：仍先预检，之后继续处理流水线中的下一个请求
+        int fd = Connect(port);
+        pending.clear();
+        int before = g_checks;
+        Write(fd, Upload(5, "X-Token: ok\r\n") + "helloGET /x HTTP/1.1\r\nHost: x\r\n\r\n");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "got 5");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "got 0");
+        assert(g_checks == before + 1);
+        // 其他请求的请求体已到齐时不预检
+        Write(fd, "POST /form HTTP/1.1\r\nHost: x\r\nContent-Length: 3\r\n\r\nabc");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "got 3");
+        assert(g_checks == before + 1);
+        ::close(fd);
+        fd = Connect(port);
+        pending.clear();
+        Write(fd, Upload(5, "") + "hello");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 401") == 0);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    StartServer(kServerPort, false);
+    StartServer(kExecutorPort, true);
+
+    RunChecks(kServerPort);
+    assert(g_checks > 0 && g_checksOnLoop == g_checks); // 没有执行器：在 loop 线程上预检
+
+    int onLoop = g_checksOnLoop;
+    RunChecks(kExecutorPort);
+    assert(g_checksOnLoop == onLoop); // 有执行器：预检不占用 loop 线程
+    {
+        // 执行器忙（1 个线程在跑、1 个任务排队）：预检直接回 503 并关闭
+        int running = Connect(kExecutorPort), queued = Connect(kExecutorPort);
+        Write(running, Upload(10, "X-Token: ok\r\nX-Slow: 1\r\nExpect: 100-continue\r\n"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        Write(queued, Upload(10, "X-Token: ok\r\nX-Slow: 1\r\nExpect: 100-continue\r\n"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        int fd = Connect(kExecutorPort);
+        std::string pending, body;
+        Write(fd, Upload(10, "X-Token: ok\r\nExpect: 100-continue\r\n"));
+        std::string head = ReadResponse(fd, pending, body);
+        assert(head.find("HTTP/1.1 503") == 0 && head.find("Retry-After: 1") != std::string::npos);
+        assert(PeerClosed(fd));
+        ::close(fd);
+        // 排队的两个预检稍后照常通过
+        pending.clear();
+        assert(ReadHead(running, pending, 2000) == "HTTP/1.1 100 Continue\r\n\r\n");
+        assert(ReadHead(queued, pending, 2000) == "HTTP/1.1 100 Continue\r\n\r\n");
+        ::close(running);
+        ::close(queued);
+    }
+    std::cout << "test_expect_continue passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "FdCache.h"
+#include "EventLoop.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// 测试：fd 缓存的命中、容量淘汰、失效后在途引用仍可读，以及 inotify 监视目录
+static void WriteFile(const std::string &path, const std::string &content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+static std::string ReadAll(const CachedFile &f)
+{
+    std::string out(f.size, '\0');
+    ssize_t n = ::pread(f.fd, &out[0], out.size(), 0);
+    assert(n == static_cast<ssize_t>(f.size));
+    return out;
+}
+
+static bool WaitFor(const std::function<bool()> &pred)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        if (pred())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+int main()
+{
+    char tmpl[] = "/tmp/test_fdcache_XXXXXX";
+    std::string dir = ::mkdtemp(tmpl);
+    WriteFile(dir + "/a", "hello");
+    WriteFile(dir + "/b", "world!");
+    WriteFile(dir + "/c", "c");
+
+    {
+        FdCache cache(2, 1); // 单分片便于验证 LRU
+        assert(!cache.Open(dir + "/missing"));
+        assert(!cache.Open(dir)); // 目录不缓存
+
+        auto a = cache.Open(dir + "/a");
+        assert(a && a->size == 5 && ReadAll(*a) == "hello");
+        assert(cache.Open(dir + "/a") == a); // 命中返回同一条目
+        assert(cache.Get(dir + "/a") == a);
+        assert(!cache.Get(dir + "/b"));
+        FdCache::Stats st = cache.GetStats();
+        assert(st.hits == 2 && st.misses == 3 && st.entries == 1); // 打开失败也计入未命中
+
+        // 容量 2：打开 b、c 后最久未用的 a 被淘汰，但持有的引用仍可读
+        auto b = cache.Open(dir + "/b");
+        auto c = cache.Open(dir + "/c");
+        assert(cache.GetStats().evictions == 1 && !cache.Get(dir + "/a"));
+        assert(ReadAll(*a) == "hello");
+
+        // 删除后失效：新的查找不再返回旧文件，在途引用仍能读完
+        ::unlink((dir + "/b").c_str());
+        cache.Invalidate(dir + "/b");
+        assert(!cache.Get(dir + "/b") && !cache.Open(dir + "/b"));
+        assert(ReadAll(*b) == "world!");
+        assert(cache.GetStats().invalidations == 1);
+
+        cache.Clear();
+        assert(cache.GetStats().entries == 0 && !cache.Get(dir + "/c"));
+        assert(ReadAll(*c) == "c");
+    }
+
+    // inotify：覆盖、删除、新建子目录中的修改都会失效对应条目
+    // 监视所在的 loop 没有退出接口，cache 与 loop 线程随进程结束
+    FdCache *cache = new FdCache(64, 4);
+    std::atomic<bool> watching(false);
+    ::mkdir((dir + "/static").c_str(), 0755);
+    WriteFile(dir + "/static/index.html", "v1");
+    std::thread([&]() {
+        EventLoop loop;
+        assert(cache->Watch(&loop, dir + "/static"));
+        watching = true;
+        loop.loop();
+    }).detach();
+    assert(WaitFor([&]() { return watching.load(); }));
+
+    std::string index = dir + "/static/index.html";
+    auto v1 = cache->Open(index);
+    assert(v1 && ReadAll(*v1) == "v1");
+    WriteFile(dir + "/static/index.tmp", "version2");
+    ::rename((dir + "/static/index.tmp").c_str(), index.c_str()); // 编辑器常见的原子替换
+    assert(WaitFor([&]() { return !cache->Get(index); }));
+    auto v2 = cache->Open(index);
+    assert(v2 && ReadAll(*v2) == "version2" && ReadAll(*v1) == "v1");
+
+    ::mkdir((dir + "/static/js").c_str(), 0755);
+    std::string js = dir + "/static/js/app.js";
+    WriteFile(js, "1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 等子目录加入监视
+    assert(cache->Open(js));
+    WriteFile(js, "22"); // 原地改写
+    assert(WaitFor([&]() { return !cache->Get(js); }));
+    assert(cache->Open(js)->size == 2);
+
+    ::unlink(index.c_str());
+    assert(WaitFor([&]() { return !cache->Get(index); }));
+    assert(!cache->Open(index));
+
+    std::system(("rm -rf " + dir).c_str());
+    std::cout << "test_fdcache passed" << std::endl;
+    return 0;
+}
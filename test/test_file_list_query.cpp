@@ -0,0 +1,119 @@
+#include "FileListQuery.h"
+#include "Base64Url.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+
+// 测试：文件列表的参数解析、翻页游标的编解码与校验、生成的 SQL（参数个数、keyset 条件方向、排序）
+static size_t Placeholders(const std::string &sql)
+{
+    return static_cast<size_t>(std::count(sql.begin(), sql.end(), '?'));
+}
+
+static bool Contains(const std::string &s, const std::string &part)
+{
+    return s.find(part) != std::string::npos;
+}
+
+int main()
+{
+    // base64url 编解码
+    for (size_t len = 0; len < 40; ++len)
+    {
+        std::string raw;
+        for (size_t i = 0; i < len; ++i)
+            raw.push_back(static_cast<char>(i * 73 + 5));
+        std::string enc = EncodeBase64Url(raw.data(), raw.size());
+        assert(enc.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_") == std::string::npos);
+        std::string dec;
+        assert(DecodeBase64Url(enc, &dec) && dec == raw);
+    }
+    std::string dec;
+    assert(!DecodeBase64Url("a", &dec));
+    assert(!DecodeBase64Url("ab+/", &dec));
+    assert(!DecodeBase64Url("QR", &dec)); // 末尾多余的位不为 0
+
+    FileListQuery::Type type;
+    assert(FileListQuery::ParseType("", &type) && type == FileListQuery::kMine);
+    assert(FileListQuery::ParseType("my", &type) && type == FileListQuery::kMine);
+    assert(FileListQuery::ParseType("shared", &type) && type == FileListQuery::kShared);
+    assert(FileListQuery::ParseType("all", &type) && type == FileListQuery::kAll);
+    assert(!FileListQuery::ParseType("everything", &type));
+
+    FileListQuery::Sort sort;
+    assert(FileListQuery::ParseSort("", &sort) && sort == FileListQuery::kNewest);
+    for (int i = 0; i <= FileListQuery::kSmallest; ++i)
+    {
+        FileListQuery::Sort s = static_cast<FileListQuery::Sort>(i);
+        assert(FileListQuery::ParseSort(FileListQuery::SortName(s), &sort) && sort == s);
+    }
+    assert(!FileListQuery::ParseSort("size; DROP TABLE files", &sort));
+
+    int limit = 0;
+    assert(FileListQuery::ParseLimit("", &limit) && limit == FileListQuery::kDefaultLimit);
+    assert(FileListQuery::ParseLimit("20", &limit) && limit == 20);
+    assert(FileListQuery::ParseLimit("100000", &limit) && limit == FileListQuery::kMaxLimit);
+    assert(!FileListQuery::ParseLimit("0", &limit));
+    assert(!FileListQuery::ParseLimit("-5", &limit));
+    assert(!FileListQuery::ParseLimit("10abc", &limit));
+    assert(!FileListQuery::ParseLimit("99999999999999999999", &limit));
+
+    // 游标：往返、排序方式不符或被篡改时拒绝
+    FileListQuery::Cursor c;
+    std::string cur = FileListQuery::EncodeCursor(FileListQuery::kNewest, "2024-06-10 23:54:09", 4711);
+    assert(FileListQuery::DecodeCursor(cur, FileListQuery::kNewest, &c) && c.key == "2024-06-10 23:54:09" && c.id == 4711);
+    assert(!FileListQuery::DecodeCursor(cur, FileListQuery::kOldest, &c));
+    std::string name = "报告\n第 2 版 (final).pdf";
+    cur = FileListQuery::EncodeCursor(FileListQuery::kNameAsc, name, 9);
+    assert(FileListQuery::DecodeCursor(cur, FileListQuery::kNameAsc, &c) && c.key == name && c.id == 9);
+    cur = FileListQuery::EncodeCursor(FileListQuery::kLargest, "", 1);
+    assert(FileListQuery::DecodeCursor(cur, FileListQuery::kLargest, &c) && c.key.empty() && c.id == 1);
+    assert(!FileListQuery::DecodeCursor("not a cursor!", FileListQuery::kNewest, &c));
+    std::string bad = "newest\nabc\nkey";
+    assert(!FileListQuery::DecodeCursor(EncodeBase64Url(bad.data(), bad.size()), FileListQuery::kNewest, &c));
+    bad = "newest\n\nkey";
+    assert(!FileListQuery::DecodeCursor(EncodeBase64Url(bad.data(), bad.size()), FileListQuery::kNewest, &c));
+    bad = "newest";
+    assert(!FileListQuery::DecodeCursor(EncodeBase64Url(bad.data(), bad.size()), FileListQuery::kNewest, &c));
+
+    assert(FileListQuery::KeyColumn(FileListQuery::kNewest) == 5);
+    assert(FileListQuery::KeyColumn(FileListQuery::kNameDesc) == 2);
+    assert(FileListQuery::KeyColumn(FileListQuery::kSmallest) == 3);
+
+    // SQL：参数个数与头文件中约定的顺序一致
+    for (int i = 0; i <= FileListQuery::kSmallest; ++i)
+    {
+        FileListQuery::Sort s = static_cast<FileListQuery::Sort>(i);
+        assert(Placeholders(FileListQuery::Sql(FileListQuery::kMine, s, false)) == 2);
+        assert(Placeholders(FileListQuery::Sql(FileListQuery::kMine, s, true)) == 5);
+        assert(Placeholders(FileListQuery::Sql(FileListQuery::kShared, s, false)) == 3);
+        assert(Placeholders(FileListQuery::Sql(FileListQuery::kShared, s, true)) == 6);
+        assert(Placeholders(FileListQuery::Sql(FileListQuery::kAll, s, false)) == 6);
+        assert(Placeholders(FileListQuery::Sql(FileListQuery::kAll, s, true)) == 12);
+    }
+
+    std::string sql = FileListQuery::Sql(FileListQuery::kMine, FileListQuery::kNewest, true);
+    assert(Contains(sql, "WHERE f.user_id = ? AND (f.created_at < ? OR (f.created_at = ? AND f.id < ?))"));
+    assert(Contains(sql, "ORDER BY f.created_at DESC, f.id DESC LIMIT ?"));
+    assert(Contains(sql, "LEFT JOIN file_shares fs ON fs.id = (SELECT MIN(s.id) FROM file_shares s WHERE s.file_id = f.id)"));
+    sql = FileListQuery::Sql(FileListQuery::kMine, FileListQuery::kNameAsc, true);
+    assert(Contains(sql, "(f.original_filename > ? OR (f.original_filename = ? AND f.id > ?))"));
+    assert(Contains(sql, "ORDER BY f.original_filename ASC, f.id ASC"));
+    sql = FileListQuery::Sql(FileListQuery::kMine, FileListQuery::kLargest, true);
+    assert(Contains(sql, "(f.file_size < CAST(? AS UNSIGNED) OR (f.file_size = CAST(? AS UNSIGNED) AND f.id < ?))"));
+    sql = FileListQuery::Sql(FileListQuery::kMine, FileListQuery::kOldest, false);
+    assert(!Contains(sql, "f.id >") && Contains(sql, "ORDER BY f.created_at ASC, f.id ASC"));
+
+    // 共享列表不 JOIN 分享表本身（多条分享不会产生重复行）；合并列表由两部分 UNION ALL，各自带 keyset 条件
+    sql = FileListQuery::Sql(FileListQuery::kShared, FileListQuery::kNewest, false);
+    assert(Contains(sql, "WHERE f.user_id != ? AND EXISTS (SELECT 1 FROM file_shares s2"));
+    sql = FileListQuery::Sql(FileListQuery::kAll, FileListQuery::kNewest, true);
+    assert(Contains(sql, " UNION ALL "));
+    size_t first = sql.find("(f.created_at < ?");
+    assert(first != std::string::npos && sql.find("(f.created_at < ?", first + 1) != std::string::npos);
+    assert(!Contains(sql, " OR fs.shared_with_id"));
+
+    std::cout << "test_file_list_query passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// 测试：响应遵循客户端的长连接设置；要求关闭时等响应全部写出后才关闭，且不再处理后续请求；
+// 流水线中的多个大文件响应依次发完，不因上一个正文仍在发送而断开
+static const int kServerPort = 18099;
+static std::shared_ptr<const std::string> g_big;
+static std::string g_bigPath;
+
+static bool OnRequest(const std::shared_ptr<Connection> &conn, HttpRequest &req, HttpResponse *resp)
+{
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetContentType("application/json");
+    if (req.GetUrl() == "/big")
+    {
+        resp->SetBody(*g_big); // 远大于 socket 发送缓冲区，需要多次可写事件才能发完
+    }
+    else if (req.GetUrl() == "/shared")
+    {
+        resp->SetSharedBody(g_big);
+    }
+    else if (req.GetUrl() == "/file")
+    {
+        resp->SetContentType("application/octet-stream");
+        resp->SetBodyType(HttpBodyType::FILE_TYPE);
+        resp->SetContentLength(static_cast<long long>(g_big->size()));
+        resp->SetFileFd(::open(g_bigPath.c_str(), O_RDONLY | O_CLOEXEC));
+    }
+    else if (req.GetUrl() == "/error")
+    {
+        resp->SetStatusCode(HttpStatusCode::BadRequest);
+        resp->SetStatusMessage("Bad Request");
+        resp->SetBody("{\"code\":400}");
+    }
+    else
+    {
+        resp->SetBody("{\"code\":0}");
+    }
+    return true;
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::ERROR);
+    std::string big(4 * 1024 * 1024, 'x');
+    for (size_t i = 0; i < big.size(); i += 4096)
+        big[i] = static_cast<char>('a' + (i / 4096) % 26);
+    g_big = std::make_shared<const std::string>(big);
+    g_bigPath = "./test_keepalive_big";
+    std::ofstream(g_bigPath, std::ios::binary | std::ios::trunc) << big;
+    std::thread([]() {
+        EventLoop loop;
+        HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+        server.SetHttpCallback(OnRequest);
+        server.SetThreadNums(2);
+        server.start();
+        loop.loop();
+    }).detach();
+
+    std::string pending, body;
+    {
+        // 长连接：多个请求（含错误响应）复用同一连接
+        int fd = Connect(kServerPort);
+        for (int i = 0; i < 3; ++i)
+        {
+            Write(fd, "GET /files HTTP/1.1\r\nHost: x\r\n\r\n");
+            std::string head = ReadResponse(fd, pending, body);
+            assert(head.find("HTTP/1.1 200") == 0 && head.find("Connection: Keep-Alive") != std::string::npos);
+            assert(body == "{\"code\":0}");
+            Write(fd, "GET /error HTTP/1.1\r\nHost: x\r\n\r\n");
+            head = ReadResponse(fd, pending, body);
+            assert(head.find("HTTP/1.1 400") == 0 && head.find("Connection: Keep-Alive") != std::string::npos);
+        }
+        // 流水线：两个请求一次发出，按序回包
+        Write(fd, "GET /a HTTP/1.1\r\nHost: x\r\n\r\nGET /big HTTP/1.1\r\nHost: x\r\n\r\n");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "{\"code\":0}");
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == big);
+        ::close(fd);
+    }
+    {
+        // 流水线：两个大文件（sendfile）与共享正文一次发出，后一个正文等前一个发完再发送
+        int fd = Connect(kServerPort);
+        Write(fd, "GET /file HTTP/1.1\r\nHost: x\r\n\r\nGET /file HTTP/1.1\r\nHost: x\r\n\r\n"
+                  "GET /shared HTTP/1.1\r\nHost: x\r\n\r\nGET /a HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 让服务端先填满发送缓冲区
+        for (int i = 0; i < 3; ++i)
+            assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == big);
+        assert(ReadResponse(fd, pending, body).find("HTTP/1.1 200") == 0 && body == "{\"code\":0}");
+        ::close(fd);
+    }
+    {
+        // Connection: close：大响应完整写出后才关闭，之后的流水线请求不再处理
+        int fd = Connect(kServerPort);
+        Write(fd, "GET /big HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\nGET /a HTTP/1.1\r\nHost: x\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 让服务端先填满发送缓冲区
+        std::string head = ReadResponse(fd, pending, body);
+        assert(head.find("Connection: close") != std::string::npos && body == big);
+        assert(pending.empty() && PeerClosed(fd));
+        ::close(fd);
+    }
+    {
+        // 共享正文（BUFFER_TYPE）同样在写完后关闭；HTTP/1.0 默认关闭
+        int fd = Connect(kServerPort);
+        Write(fd, "GET /shared HTTP/1.0\r\n\r\n");
+        std::string head = ReadResponse(fd, pending, body);
+        assert(head.find("Connection: close") != std::string::npos && body == big);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+    {
+        // 无法解析的请求：回 400 后关闭
+        int fd = Connect(kServerPort);
+        Write(fd, "BROKEN\r\n\r\n");
+        std::string head = ReadResponse(fd, pending, body);
+        assert(head.find("HTTP/1.1 400") == 0);
+        assert(PeerClosed(fd));
+        ::close(fd);
+    }
+    std::remove(g_bigPath.c_str());
+    std::cout << "test_keepalive passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "Metrics.h"
+#include "HttpMetrics.h"
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 测试：对数线性分桶与分位数、多线程分片求和（含已退出线程）、同名注册、Prometheus 文本输出与收集器；
+// HttpServer 的 /metrics：按路由模式与状态码类别统计延迟、收发字节、各事件循环的连接数
+static const int kServerPort = 18104;
+
+static bool Contains(const std::string &text, const std::string &line)
+{
+    return text.find(line) != std::string::npos;
+}
+
+// 取 "name{labels} value" 行的数值，找不到返回 -1
+static double Sample(const std::string &text, const std::string &series)
+{
+    size_t pos = text.find("\n" + series + " ");
+    if (pos == std::string::npos)
+        return -1;
+    return std::strtod(text.c_str() + pos + series.size() + 2, nullptr);
+}
+
+static void TestBuckets()
+{
+    // 每个值落在上界大于它的桶里，上界相对误差不超过 25%
+    for (uint64_t v : {0ULL, 1ULL, 3ULL, 4ULL, 5ULL, 7ULL, 8ULL, 100ULL, 1000ULL, 123456ULL, 999999999ULL, (1ULL << 35) + 5})
+    {
+        int b = Metrics::BucketOf(v);
+        assert(b >= 0 && b < Metrics::kBuckets);
+        assert(Metrics::BucketUpper(b) > v);
+        assert(b == 0 || Metrics::BucketUpper(b - 1) <= v);
+        assert(v < 4 || Metrics::BucketUpper(b) - v <= v / 4 + 1);
+    }
+    for (int b = 1; b < Metrics::kBuckets; ++b)
+        assert(Metrics::BucketUpper(b) > Metrics::BucketUpper(b - 1));
+    assert(Metrics::BucketOf(1ULL << 40) == Metrics::kBuckets - 1);
+
+    Metrics::Histogram h = Metrics::GetHistogram("test_quantile_ns", "quantiles");
+    for (uint64_t v = 1; v <= 1000; ++v)
+        h.Record(v * 1000); // 1us .. 1ms
+    Metrics::HistogramSnapshot snap = h.Snapshot();
+    assert(snap.count == 1000 && snap.sum == 500500ULL * 1000);
+    uint64_t p50 = snap.Quantile(0.5), p99 = snap.Quantile(0.99);
+    assert(p50 >= 500000 && p50 <= 625000);
+    assert(p99 >= 990000 && p99 <= 1250000);
+    assert(Metrics::HistogramSnapshot().Quantile(0.5) == 0);
+}
+
+static void TestThreads()
+{
+    Metrics::Counter c = Metrics::GetCounter("test_thread_total", "per-thread shards");
+    Metrics::Gauge g = Metrics::GetGauge("test_thread_gauge", "per-thread deltas");
+    const int kThreads = 4, kIters = 100000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t)
+        threads.emplace_back([&]() {
+            for (int i = 0; i < kIters; ++i)
+                c.Inc();
+            g.Add(5);
+        });
+    for (auto &t : threads)
+        t.join();
+    // 线程已退出，分片仍计入
+    assert(c.Value() == static_cast<uint64_t>(kThreads) * kIters);
+    assert(g.Value() == 5 * kThreads);
+    // 在别的线程减少：总数正确
+    std::thread([&]() { g.Add(-20); }).join();
+    assert(g.Value() == 0);
+
+    // 同名同标签返回同一指标，不同标签各自独立
+    Metrics::Counter same = Metrics::GetCounter("test_thread_total", "per-thread shards");
+    same.Inc(3);
+    assert(c.Value() == static_cast<uint64_t>(kThreads) * kIters + 3);
+    Metrics::Counter other = Metrics::GetCounter("test_thread_total", "per-thread shards", {{"kind", "other"}});
+    assert(other.Value() == 0);
+
+    // 默认构造的句柄写入保留区，不影响任何指标
+    Metrics::Counter unbound;
+    unbound.Inc();
+    Metrics::Histogram unboundHist;
+    unboundHist.Record(12345);
+    assert(c.Value() == static_cast<uint64_t>(kThreads) * kIters + 3);
+}
+
+static void TestRender()
+{
+    Metrics::Counter c = Metrics::GetCounter("test_render_total", "Rendered \"counter\"", {{"path", "/a\"b"}});
+    c.Inc(7);
+    Metrics::Histogram h = Metrics::GetHistogram("test_render_seconds", "Rendered histogram", {{"op", "x"}});
+    h.Record(1500);        // 1.5us
+    h.Record(3000000000);  // 3s
+    int id = Metrics::AddCollector([](Metrics::Writer &w) { w.Gauge("test_collected", "From a collector", {{"src", "cb"}}, 2.5); });
+
+    std::string text = Metrics::Render();
+    assert(Contains(text, "# TYPE test_render_total counter\n"));
+    assert(Contains(text, "test_render_total{path=\"/a\\\"b\"} 7\n"));
+    assert(Contains(text, "# TYPE test_render_seconds histogram\n"));
+    assert(Sample(text, "test_render_seconds_bucket{op=\"x\",le=\"1.024e-06\"}") == 0);
+    assert(Sample(text, "test_render_seconds_bucket{op=\"x\",le=\"2.048e-06\"}") == 1);
+    assert(Sample(text, "test_render_seconds_bucket{op=\"x\",le=\"2.147483648\"}") == 1);
+    assert(Sample(text, "test_render_seconds_bucket{op=\"x\",le=\"4.294967296\"}") == 2);
+    assert(Sample(text, "test_render_seconds_bucket{op=\"x\",le=\"+Inf\"}") == 2);
+    assert(Sample(text, "test_render_seconds_count{op=\"x\"}") == 2);
+    assert(Sample(text, "test_render_seconds_sum{op=\"x\"}") > 3.0);
+    assert(Contains(text, "# TYPE test_collected gauge\ntest_collected{src=\"cb\"} 2.5\n"));
+
+    Metrics::RemoveCollector(id);
+    assert(!Contains(Metrics::Render(), "test_collected"));
+}
+
+static bool OnRequest(const std::shared_ptr<Connection> &, HttpRequest &req, HttpResponse *resp)
+{
+    if (req.GetUrl().rfind("/items/", 0) != 0)
+    {
+        *resp = HttpResponse::MakeSimple(resp->IsCloseConnection(), HttpStatusCode::NotFound, "Not Found", "404 Not Found\n");
+        return true;
+    }
+    // 业务路由自己记下路由模式（应用路由在匹配时设置）
+    req.SetRoute(RouteMetrics::Get("GET", "/items/([0-9]+)"));
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetBody("item " + req.GetUrl().substr(7));
+    return true;
+}
+
+static std::string Get(int fd, std::string &pending, const std::string &url, std::string &body)
+{
+    Write(fd, "GET " + url + " HTTP/1.1\r\nHost: x\r\n\r\n");
+    return ReadResponse(fd, pending, body);
+}
+
+static void TestServer()
+{
+    std::thread([]() {
+        EventLoop loop;
+        HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+        server.SetHttpCallback(OnRequest);
+        server.SetThreadNums(2);
+        server.EnableMetrics();
+        server.start();
+        loop.loop();
+    }).detach();
+
+    int fd = Connect(kServerPort);
+    std::string pending, body;
+    for (int i = 0; i < 3; ++i)
+        assert(Get(fd, pending, "/items/" + std::to_string(i), body).find("HTTP/1.1 200") == 0);
+    assert(Get(fd, pending, "/missing", body).find("HTTP/1.1 404") == 0);
+    int second = Connect(kServerPort);
+
+    std::string head = Get(fd, pending, "/metrics", body);
+    assert(head.find("HTTP/1.1 200") == 0 && head.find("text/plain; version=0.0.4") != std::string::npos);
+    // 标签为路由模式而不是实际路径
+    assert(Sample(body, "http_request_duration_seconds_count{method=\"GET\",route=\"/items/([0-9]+)\",code=\"2xx\"}") == 3);
+    assert(Sample(body, "http_request_duration_seconds_count{method=\"\",route=\"unmatched\",code=\"4xx\"}") == 1);
+    assert(!Contains(body, "/items/1"));
+    // 本次抓取尚未完成，不计入自己
+    assert(Sample(body, "http_request_duration_seconds_count{method=\"GET\",route=\"/metrics\",code=\"2xx\"}") == 0);
+    assert(Sample(body, "http_received_bytes_total") >= 4 * 30);
+    assert(Sample(body, "http_sent_bytes_total") > 0);
+    // 两个连接分到两个 sub-reactor，主循环不持有连接
+    assert(Sample(body, "event_loop_connections{loop=\"0\"}") == 0);
+    assert(Sample(body, "event_loop_connections{loop=\"1\"}") + Sample(body, "event_loop_connections{loop=\"2\"}") == 2);
+    assert(Sample(body, "event_loop_pending_tasks{loop=\"1\"}") >= 0);
+
+    ::close(second);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    Get(fd, pending, "/metrics", body);
+    assert(Sample(body, "event_loop_connections{loop=\"1\"}") + Sample(body, "event_loop_connections{loop=\"2\"}") == 1);
+    assert(Sample(body, "http_request_duration_seconds_count{method=\"GET\",route=\"/metrics\",code=\"2xx\"}") == 1);
+    ::close(fd);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    TestBuckets();
+    TestThreads();
+    TestRender();
+    TestServer();
+    std::cout << "test_metrics passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "MultipartParser.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 测试：multipart 流式解析，覆盖分隔符跨分片、多分段、普通字段
+struct Collected
+{
+    std::vector<MultipartParser::Part> parts;
+    std::vector<std::string> bodies;
+};
+
+static bool ParseInChunks(const std::string &boundary, const std::string &body, const std::vector<size_t> &cuts, Collected &out)
+{
+    MultipartParser parser(boundary);
+    parser.SetPartBeginCallback([&out](const MultipartParser::Part &p) { out.parts.push_back(p); out.bodies.emplace_back(); return true; });
+    parser.SetPartDataCallback([&out](const char *d, size_t n) { out.bodies.back().append(d, n); return true; });
+    parser.SetPartEndCallback([]() { return true; });
+    size_t pos = 0;
+    for (size_t cut : cuts)
+    {
+        if (!parser.Feed(body.data() + pos, cut - pos))
+            return false;
+        pos = cut;
+    }
+    if (!parser.Feed(body.data() + pos, body.size() - pos))
+        return false;
+    return parser.IsComplete();
+}
+
+int main()
+{
+    const std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    // 文件内容中故意放入分隔符的前缀片段
+    std::string fileData = "line1\r\n--" + boundary.substr(0, 10) + "\r\n\r\n--\r\nend";
+    std::string body =
+        "preamble\r\n"
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"desc\"\r\n\r\n"
+        "hello world\r\n"
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"file\"; filename=\"a \\\"b\\\".txt\"\r\n"
+        "Content-Type: text/plain\r\n\r\n" +
+        fileData + "\r\n"
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"empty\"\r\n\r\n"
+        "\r\n"
+        "--" + boundary + "--\r\n"
+        "epilogue";
+
+    // 1. 一次性喂入
+    {
+        Collected c;
+        assert(ParseInChunks(boundary, body, {}, c));
+        assert(c.parts.size() == 3);
+        assert(c.parts[0].name == "desc" && !c.parts[0].isFile());
+        assert(c.bodies[0] == "hello world");
+        assert(c.parts[1].isFile() && c.parts[1].filename == "a \"b\".txt");
+        assert(c.parts[1].contentType == "text/plain");
+        assert(c.bodies[1] == fileData);
+        assert(c.parts[2].name == "empty" && c.bodies[2].empty());
+    }
+
+    // 2. 在每一个位置切成两片
+    for (size_t i = 1; i < body.size(); ++i)
+    {
+        Collected c;
+        assert(ParseInChunks(boundary, body, {i}, c));
+        assert(c.parts.size() == 3);
+        assert(c.bodies[0] == "hello world" && c.bodies[1] == fileData && c.bodies[2].empty());
+    }
+
+    // 3. 逐字节喂入
+    {
+        std::vector<size_t> cuts;
+        for (size_t i = 1; i < body.size(); ++i)
+            cuts.push_back(i);
+        Collected c;
+        assert(ParseInChunks(boundary, body, cuts, c));
+        assert(c.parts.size() == 3 && c.bodies[1] == fileData);
+    }
+
+    // 4. 无前导内容、请求体截断、非法分隔符尾部
+    {
+        Collected c;
+        std::string simple = "--" + boundary + "\r\nContent-Disposition: form-data; name=\"f\"; filename=\"x.bin\"\r\n\r\nABC\r\n--" + boundary + "--";
+        assert(ParseInChunks(boundary, simple, {}, c));
+        assert(c.parts.size() == 1 && c.bodies[0] == "ABC");
+
+        Collected t;
+        assert(!ParseInChunks(boundary, simple.substr(0, simple.size() - 4), {}, t)); // 未出现结束分隔符
+
+        MultipartParser bad(boundary);
+        std::string broken = "--" + boundary + "XX";
+        assert(!bad.Feed(broken.data(), broken.size()) && bad.HasError());
+    }
+
+    // 5. 回调中止
+    {
+        MultipartParser parser(boundary);
+        parser.SetPartDataCallback([](const char *, size_t) { return false; });
+        assert(!parser.Feed(body.data(), body.size()));
+        assert(parser.HasError());
+    }
+
+    // 6. 从 Content-Type 提取 boundary
+    assert(MultipartParser::ExtractBoundary("multipart/form-data; boundary=" + boundary) == boundary);
+    assert(MultipartParser::ExtractBoundary("Multipart/Form-Data; charset=utf-8; boundary=\"abc def\"") == "abc def");
+    assert(MultipartParser::ExtractBoundary("application/json").empty());
+    assert(MultipartParser::ExtractBoundary("multipart/form-data").empty());
+
+    std::cout << "test_multipart PASS" << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "RateLimiter.h"
+#include "HttpServer.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "LoopbackClient.h"
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 测试：令牌桶（GCRA）的突发、补充与等待时间；清理已满的桶不改变结果；桶数上限；多线程取令牌不超发；
+// HttpServer 在业务回调之前回 429 与 Retry-After，按 IP 与按会话分别计量，请求体未到齐的请求在读取请求体之前拒绝
+static const int kServerPort = 18105;
+static const int64_t kSecond = 1000000000;
+static std::atomic<int> g_handled(0);
+
+static void TestBucket()
+{
+    RateLimiter limiter;
+    limiter.AddRule("r", HttpMethod::kInvalid, "", 10, 5); // 10/s，突发 5
+    int64_t wait = 0;
+    int64_t t = 1000 * kSecond;
+    for (int i = 0; i < 5; ++i)
+        assert(limiter.Acquire(0, 42, t, &wait));
+    assert(!limiter.Acquire(0, 42, t, &wait) && wait == kSecond / 10);
+    assert(limiter.Acquire(0, 7, t, &wait)); // 另一个客户端不受影响
+    // 100ms 后补充一个
+    assert(limiter.Acquire(0, 42, t + kSecond / 10, &wait));
+    assert(!limiter.Acquire(0, 42, t + kSecond / 10, &wait));
+
+    // 未满的桶保留，满的删除
+    assert(limiter.Evict(t + kSecond / 10) == 1); // 客户端 7 已补满
+    assert(limiter.GetStats().buckets == 1);
+    assert(limiter.Evict(t + kSecond / 2) == 0);
+    assert(limiter.Evict(t + 10 * kSecond) == 1 && limiter.GetStats().buckets == 0);
+    // 删除后重新建桶，与补满后一致
+    for (int i = 0; i < 5; ++i)
+        assert(limiter.Acquire(0, 42, t + 10 * kSecond, &wait));
+    assert(!limiter.Acquire(0, 42, t + 10 * kSecond, &wait));
+
+    // 超过桶数上限：新客户端不计量，直接放行
+    RateLimiter small(2, 1);
+    small.AddRule("s", HttpMethod::kInvalid, "", 1, 1);
+    for (uint64_t key = 1; key <= 3; ++key)
+        assert(small.Acquire(0, key, t, &wait));
+    assert(small.Acquire(0, 3, t, &wait) && small.GetStats().overflow == 2);
+    assert(!small.Acquire(0, 1, t, &wait));
+}
+
+static void TestConcurrent()
+{
+    // 同一时刻多个线程争用同一个桶：恰好放行 burst 个
+    RateLimiter limiter;
+    limiter.AddRule("c", HttpMethod::kInvalid, "", 1, 1000);
+    std::atomic<int> granted(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&]() {
+            int64_t wait;
+            for (int j = 0; j < 1000; ++j)
+                if (limiter.Acquire(0, 9, 5 * kSecond, &wait))
+                    ++granted;
+        });
+    for (auto &th : threads)
+        th.join();
+    assert(granted == 1000);
+}
+
+static bool OnRequest(const std::shared_ptr<Connection> &, HttpRequest &req, HttpResponse *resp)
+{
+    ++g_handled;
+    resp->SetStatusCode(HttpStatusCode::OK);
+    resp->SetStatusMessage("OK");
+    resp->SetBody("ok " + std::to_string(req.GetBody().size()));
+    return true;
+}
+
+static std::string Get(int fd, std::string &pending, const std::string &url, const std::string &extra = "")
+{
+    Write(fd, "GET " + url + " HTTP/1.1\r\nHost: x\r\n" + extra + "\r\n");
+    return ReadResponse(fd, pending);
+}
+
+static void TestServer()
+{
+    std::thread([]() {
+        EventLoop loop;
+        HttpServer server(&loop, "127.0.0.1", kServerPort, false);
+        server.SetHttpCallback(OnRequest);
+        server.SetThreadNums(1);
+        RateLimiter *limiter = server.EnableRateLimit();
+        limiter->AddRule("limited", HttpMethod::kInvalid, "/limited", 0.5, 2);
+        limiter->AddRule("session", HttpMethod::kGet, "/s/*", 0.5, 1, RateLimiter::kSession);
+        server.start();
+        loop.loop();
+    }).detach();
+
+    int fd = Connect(kServerPort);
+    std::string pending;
+    assert(Get(fd, pending, "/limited").find("HTTP/1.1 200") == 0);
+    assert(Get(fd, pending, "/limited").find("HTTP/1.1 200") == 0);
+    int before = g_handled;
+    std::string head = Get(fd, pending, "/limited");
+    assert(head.find("HTTP/1.1 429") == 0 && head.find("Retry-After: 2") != std::string::npos);
+    assert(g_handled == before); // 没有进入业务回调
+    // 连接保持可用，其他路径不受影响
+    assert(Get(fd, pending, "/other").find("HTTP/1.1 200") == 0);
+    // 同一 IP 的另一条连接共享额度
+    int second = Connect(kServerPort);
+    std::string pending2;
+    assert(Get(second, pending2, "/limited").find("HTTP/1.1 429") == 0);
+
+    // 按会话计量：各会话各自一个桶，没有会话的按 IP
+    assert(Get(fd, pending, "/s/a", "X-Session-ID: alice\r\n").find("HTTP/1.1 200") == 0);
+    assert(Get(fd, pending, "/s/b", "X-Session-ID: alice\r\n").find("HTTP/1.1 429") == 0);
+    assert(Get(fd, pending, "/s/a", "X-Session-ID: bob\r\n").find("HTTP/1.1 200") == 0);
+    assert(Get(fd, pending, "/s/a").find("HTTP/1.1 200") == 0);
+    assert(Get(fd, pending, "/s/a").find("HTTP/1.1 429") == 0);
+
+    // 请求体未到齐：头部到达即拒绝并关闭，不等待请求体
+    Write(second, "POST /limited HTTP/1.1\r\nHost: x\r\nContent-Length: 100000\r\n\r\npartial");
+    assert(ReadResponse(second, pending2).find("HTTP/1.1 429") == 0);
+    assert(PeerClosed(second));
+    ::close(second);
+    ::close(fd);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    TestBucket();
+    TestConcurrent();
+    TestServer();
+    std::cout << "test_rate_limit passed" << std::endl;
+    return 0;
+}
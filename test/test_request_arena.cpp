@@ -0,0 +1,48 @@
+#include "HttpContext.h"
+#include "HttpRequest.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+// 测试：同一 HttpContext 上连续解析请求时原地复用请求对象，arena 在请求之间释放
+// 覆盖：上一个请求的内容不残留、头部超出内联缓冲、拷贝出的请求不依赖 arena
+static HttpRequest *Parse(HttpContext &ctx, const std::string &wire)
+{
+    size_t consumed = 0;
+    assert(ctx.ParseIncremental(wire.data(), wire.size(), consumed));
+    assert(ctx.GetCompleteRequest() && consumed == wire.size());
+    return ctx.GetRequest();
+}
+
+int main()
+{
+    HttpContext ctx;
+    HttpRequest *first = Parse(ctx, "GET /files?type=my&tag=a%20b&tag=c HTTP/1.1\r\nHost: x\r\nX-Session-ID: 6f1c2a9e-5b7d-4c3e-9a8f-0d2e4b6c8a1f\r\n\r\n");
+    assert(first->GetUrl() == "/files" && first->GetQueryValue("type") == "my");
+    assert(first->GetQueryValues("tag").size() == 2 && first->GetQueryValues("tag")[0] == "a b");
+    assert(first->GetHeader("X-Session-ID") == "6f1c2a9e-5b7d-4c3e-9a8f-0d2e4b6c8a1f");
+    HttpRequest copy = *first; // 拷贝使用默认 resource
+    ctx.ResetContextStatus();
+
+    // 头部远超 4KB 内联缓冲（单行不超过 8KB 的限制）
+    std::string cookie(6000, 'c');
+    std::string agent(5000, 'a');
+    HttpRequest *second = Parse(ctx, "POST /share HTTP/1.1\r\nCookie: " + cookie + "\r\nUser-Agent: " + agent + "\r\nContent-Length: 2\r\n\r\n{}");
+    assert(second == first); // 原地复用
+    assert(second->GetMethod() == HttpMethod::kPost && second->GetUrl() == "/share" && second->GetBody() == "{}");
+    assert(second->GetHeader("Cookie") == cookie && second->GetHeader("User-Agent") == agent);
+    assert(second->GetHeader("X-Session-ID").empty() && second->GetQueryValue("type").empty() && second->GetRawQuery().empty());
+    second->SetPathParam("id", "42");
+    ctx.ResetContextStatus();
+
+    HttpRequest *third = Parse(ctx, "HEAD /uploads/abc HTTP/1.0\r\n\r\n");
+    assert(third->GetMethod() == HttpMethod::kHead && third->GetVersion() == HttpVersion::kHttp10);
+    assert(third->GetHeaders().empty() && third->GetPathParams().empty() && third->GetBody().empty());
+
+    // 拷贝在原请求被复用后依然有效
+    assert(copy.GetUrl() == "/files" && copy.GetQueryValues("tag")[1] == "c");
+    assert(copy.GetHeader("X-Session-ID") == "6f1c2a9e-5b7d-4c3e-9a8f-0d2e4b6c8a1f");
+
+    std::cout << "test_request_arena passed" << std::endl;
+    return 0;
+}
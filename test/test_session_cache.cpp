@@ -0,0 +1,171 @@
+#include "SessionCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 测试：会话缓存的命中与过期（取会话剩余时间与 maxAge 的较小者）、否定缓存、写穿与登出失效、
+// 已撤销的条目不被数据库读回覆盖、后台刷新的候选、清理与容量上限，以及并发读写
+static const int64_t kSec = 1000000000LL;
+
+int main()
+{
+    const int64_t t0 = 1000 * kSec;
+    SessionCache::Session alice{7, "alice"};
+    SessionCache::Session out;
+
+    {
+        SessionCache cache(1024, 300, 10, 4);
+        SessionCache::Stats before = cache.GetStats(); // 计数按指标名在实例间共享，比较增量
+        assert(cache.Get("s1", &out, t0) == SessionCache::kMiss);
+        cache.Put("s1", alice, 3600 * kSec, t0);
+        out = SessionCache::Session();
+        assert(cache.Get("s1", &out, t0 + kSec) == SessionCache::kHit);
+        assert(out.userId == 7 && out.username == "alice");
+        // 会话还有 1 小时，但缓存最多保留 maxAge（300 秒）
+        assert(cache.Get("s1", &out, t0 + 299 * kSec) == SessionCache::kHit);
+        assert(cache.Get("s1", &out, t0 + 300 * kSec) == SessionCache::kMiss);
+
+        // 会话剩余时间短于 maxAge：缓存在 expire_time 时到期
+        cache.Put("s2", alice, 30 * kSec, t0);
+        assert(cache.Get("s2", &out, t0 + 29 * kSec) == SessionCache::kHit);
+        assert(cache.Get("s2", &out, t0 + 30 * kSec) == SessionCache::kMiss);
+        cache.Put("s3", alice, 0, t0); // 已到期，按不存在缓存
+        assert(cache.Get("s3", &out, t0) == SessionCache::kUnknown);
+
+        SessionCache::Stats after = cache.GetStats();
+        assert(after.hits - before.hits == 3);
+        assert(after.negativeHits - before.negativeHits == 1);
+        assert(after.misses - before.misses == 3);
+        assert(after.entries == 3);
+    }
+
+    {
+        // 否定缓存：不存在的 ID 在 negativeTtl 内不再查库
+        SessionCache cache(1024, 300, 10, 4);
+        cache.PutUnknown("forged", t0);
+        assert(cache.Get("forged", &out, t0 + 9 * kSec) == SessionCache::kUnknown);
+        assert(cache.Get("forged", &out, t0 + 10 * kSec) == SessionCache::kMiss);
+        // 写穿覆盖否定条目（极少见：ID 先被探测后才创建）
+        cache.PutUnknown("late", t0);
+        cache.Save("late", alice, 3600 * kSec, t0);
+        assert(cache.Get("late", &out, t0 + kSec) == SessionCache::kHit);
+    }
+
+    {
+        // 登出立即失效；与登出并发的查库结果、后台刷新都不能把它读回
+        SessionCache cache(1024, 300, 10, 4);
+        cache.Save("s", alice, 3600 * kSec, t0);
+        assert(cache.Get("s", &out, t0) == SessionCache::kHit);
+        cache.Revoke("s", t0 + kSec);
+        assert(cache.Get("s", &out, t0 + kSec) == SessionCache::kUnknown);
+        cache.Put("s", alice, 3600 * kSec, t0 + 2 * kSec);
+        assert(cache.Get("s", &out, t0 + 2 * kSec) == SessionCache::kUnknown);
+        cache.PutUnknown("s", t0 + 3 * kSec);
+        assert(cache.Get("s", &out, t0 + 3 * kSec) == SessionCache::kUnknown);
+        // 撤销记录保留 maxAge，之后由数据库决定
+        assert(cache.Get("s", &out, t0 + 301 * kSec) == SessionCache::kMiss);
+        cache.Put("s", alice, 3600 * kSec, t0 + 301 * kSec);
+        assert(cache.Get("s", &out, t0 + 302 * kSec) == SessionCache::kHit);
+        // 从未缓存过的会话登出后同样拒绝
+        cache.Revoke("never", t0);
+        assert(cache.Get("never", &out, t0) == SessionCache::kUnknown);
+    }
+
+    {
+        // 后台刷新只挑被命中过、缓存即将到期而会话本身还有效的条目；刷新后重新计时
+        SessionCache cache(1024, 300, 10, 4);
+        cache.Put("hot", alice, 3600 * kSec, t0);
+        cache.Put("cold", alice, 3600 * kSec, t0);
+        cache.Put("ending", alice, 100 * kSec, t0); // 会话本身将到期，不刷新
+        cache.PutUnknown("absent", t0);
+        assert(cache.Get("hot", &out, t0 + kSec) == SessionCache::kHit);
+        assert(cache.Get("ending", &out, t0 + kSec) == SessionCache::kHit);
+        assert(cache.Expiring(20 * kSec, 100, t0 + 100 * kSec).empty()); // 还早
+        std::vector<std::string> ids = cache.Expiring(20 * kSec, 100, t0 + 290 * kSec);
+        assert(ids.size() == 1 && ids[0] == "hot");
+        cache.Put("hot", alice, 3300 * kSec, t0 + 290 * kSec);
+        assert(cache.Expiring(20 * kSec, 100, t0 + 290 * kSec).empty());
+        assert(cache.Get("hot", &out, t0 + 400 * kSec) == SessionCache::kHit);
+        // limit 限制单轮数量
+        for (int i = 0; i < 10; ++i)
+        {
+            std::string id = "h" + std::to_string(i);
+            cache.Put(id, alice, 3600 * kSec, t0);
+            assert(cache.Get(id, &out, t0) == SessionCache::kHit);
+        }
+        assert(cache.Expiring(20 * kSec, 3, t0 + 290 * kSec).size() == 3);
+
+        // 清理：到期条目被删除
+        assert(cache.GetStats().entries == 14);
+        size_t removed = cache.Evict(t0 + 301 * kSec);
+        assert(removed == 13);
+        assert(cache.GetStats().entries == 1); // 只剩刷新过的 hot
+    }
+
+    {
+        // 容量上限：满了不再放入新条目（只影响命中率），已有条目仍可更新
+        SessionCache cache(8, 300, 10, 1);
+        SessionCache::Stats before = cache.GetStats();
+        for (int i = 0; i < 12; ++i)
+            cache.Put("c" + std::to_string(i), alice, 3600 * kSec, t0);
+        SessionCache::Stats st = cache.GetStats();
+        assert(st.entries == 8);
+        assert(st.overflow - before.overflow == 4);
+        assert(cache.Get("c11", &out, t0) == SessionCache::kMiss);
+        cache.Revoke("c0", t0);
+        assert(cache.Get("c0", &out, t0) == SessionCache::kUnknown);
+        cache.Evict(t0 + 400 * kSec);
+        cache.Put("c11", alice, 3600 * kSec, t0 + 400 * kSec);
+        assert(cache.Get("c11", &out, t0 + 400 * kSec) == SessionCache::kHit);
+    }
+
+    {
+        // 并发：读线程与写线程（放入、撤销、清理）同时运行；撤销过的会话之后始终被拒绝
+        SessionCache cache(1 << 12, 300, 10, 8);
+        const int64_t now = SessionCache::Now();
+        for (int i = 0; i < 256; ++i)
+            cache.Put("p" + std::to_string(i), {i, "u" + std::to_string(i)}, 3600 * kSec, now);
+        std::atomic<bool> stop(false);
+        std::atomic<long> wrong(0);
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t)
+            readers.emplace_back([&, t]() {
+                SessionCache::Session s;
+                long i = t;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    int k = static_cast<int>(i++ % 256);
+                    if (cache.Get("p" + std::to_string(k), &s) == SessionCache::kHit && (s.userId != k || s.username != "u" + std::to_string(k)))
+                        ++wrong;
+                }
+            });
+        std::thread writer([&]() {
+            for (int round = 0; round < 200; ++round)
+            {
+                for (int i = 0; i < 256; i += 7)
+                    cache.Put("p" + std::to_string(i), {i, "u" + std::to_string(i)}, 3600 * kSec);
+                cache.Revoke("p" + std::to_string(round % 256));
+                cache.PutUnknown("x" + std::to_string(round));
+                cache.Evict();
+            }
+        });
+        writer.join();
+        stop = true;
+        for (auto &r : readers)
+            r.join();
+        assert(wrong == 0);
+        for (int i = 0; i < 200; ++i)
+        {
+            std::string id = "p" + std::to_string(i % 256);
+            cache.Put(id, {i, "again"}, 3600 * kSec);
+            assert(cache.Get(id, &out) == SessionCache::kUnknown);
+        }
+    }
+
+    std::cout << "test_session_cache passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "SessionTokens.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// 测试：令牌签发与校验、过期、篡改与伪造、密钥轮换（含从密钥文件重读）、撤销集合与清理、并发校验
+static std::string Replace(std::string s, size_t pos, char c)
+{
+    s[pos] = s[pos] == c ? static_cast<char>(c + 1) : c;
+    return s;
+}
+
+static void WriteKeys(const std::string &path, const std::string &content)
+{
+    std::ofstream(path, std::ios::trunc) << content;
+}
+
+int main()
+{
+    const int64_t now = 1700000000;
+    SessionTokens::Claims claims;
+
+    {
+        SessionTokens tokens;
+        assert(!tokens.Enabled());
+        assert(tokens.Issue(1, "alice", 3600, now).empty()); // 没有密钥不签发
+        assert(tokens.AddKey("k1", "secret-one"));
+        assert(tokens.Enabled());
+        assert(!tokens.AddKey("bad.id", "x")); // 密钥 ID 不能含 '.'
+        assert(!tokens.AddKey("k2", ""));
+
+        std::string t = tokens.Issue(42, "张三:with:colons", 3600, now);
+        assert(SessionTokens::LooksLikeToken(t));
+        assert(t.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.") == std::string::npos); // 可放进 URL 与请求头
+        assert(tokens.Verify(t, &claims, now) == SessionTokens::kValid);
+        assert(claims.userId == 42 && claims.username == "张三:with:colons" && claims.expires == now + 3600 && claims.keyId == "k1");
+        assert(claims.tokenId.size() == 16);
+        assert(tokens.Verify(t, &claims, now + 3599) == SessionTokens::kValid);
+        assert(tokens.Verify(t, &claims, now + 3600) == SessionTokens::kExpired);
+
+        // 每次签发的令牌 ID 不同
+        std::set<std::string> ids;
+        for (int i = 0; i < 100; ++i)
+        {
+            assert(tokens.Verify(tokens.Issue(1, "a", 60, now), &claims, now) == SessionTokens::kValid);
+            ids.insert(claims.tokenId);
+        }
+        assert(ids.size() == 100);
+
+        // 篡改任意位置（密钥 ID、载荷、签名）都不通过
+        for (size_t pos = 3; pos < t.size(); ++pos)
+        {
+            if (t[pos] == '.')
+                continue;
+            assert(tokens.Verify(Replace(t, pos, 'A'), &claims, now) == SessionTokens::kInvalid);
+        }
+        assert(tokens.Verify("", &claims, now) == SessionTokens::kInvalid);
+        assert(tokens.Verify("t1.", &claims, now) == SessionTokens::kInvalid);
+        assert(tokens.Verify("t1.k1..", &claims, now) == SessionTokens::kInvalid);
+        assert(tokens.Verify(t + ".x", &claims, now) == SessionTokens::kInvalid);
+        assert(tokens.Verify(t.substr(0, t.size() - 1), &claims, now) == SessionTokens::kInvalid);
+        assert(tokens.Verify("abcdefghijklmnopqrstuvwxyz012345", &claims, now) == SessionTokens::kInvalid); // 数据库会话 ID
+
+        // 其他密钥签的令牌（同一密钥 ID）不通过
+        SessionTokens other;
+        other.AddKey("k1", "another-secret");
+        assert(other.Verify(t, &claims, now) == SessionTokens::kInvalid);
+    }
+
+    {
+        // 轮换：新密钥签发，旧密钥签的令牌在旧密钥移除前仍有效
+        SessionTokens tokens;
+        tokens.AddKey("k1", "secret-one");
+        std::string old = tokens.Issue(1, "alice", 3600, now);
+        tokens.AddKey("k2", "secret-two");
+        std::string fresh = tokens.Issue(2, "bob", 3600, now);
+        assert(tokens.Verify(fresh, &claims, now) == SessionTokens::kValid && claims.keyId == "k2");
+        assert(tokens.Verify(old, &claims, now) == SessionTokens::kValid && claims.keyId == "k1");
+        assert(tokens.RemoveKey("k1"));
+        assert(!tokens.RemoveKey("k1"));
+        assert(tokens.Verify(old, &claims, now) == SessionTokens::kInvalid);
+        assert(tokens.Verify(fresh, &claims, now) == SessionTokens::kValid);
+        assert(tokens.RemoveKey("k2"));
+        assert(!tokens.Enabled());
+    }
+
+    {
+        // 密钥文件：最后一行为签发密钥；修改后重读，文件无效时保留原有密钥
+        std::string path = "/tmp/test_session_tokens_" + std::to_string(getpid()) + ".keys";
+        WriteKeys(path, "# 注释\nk1 secret-one\n\nbad.id ignored\n");
+        SessionTokens tokens;
+        assert(tokens.LoadKeys(path) == 1);
+        std::string t1 = tokens.Issue(1, "alice", 3600, now);
+        assert(tokens.Verify(t1, &claims, now) == SessionTokens::kValid && claims.keyId == "k1");
+        usleep(20000);
+        WriteKeys(path, "k1 secret-one\nk2 secret-two\n");
+        assert(tokens.LoadKeys(path) == 2);
+        assert(tokens.Verify(tokens.Issue(1, "alice", 3600, now), &claims, now) == SessionTokens::kValid && claims.keyId == "k2");
+        assert(tokens.Verify(t1, &claims, now) == SessionTokens::kValid);
+        usleep(20000);
+        WriteKeys(path, "k2 secret-two\n"); // 移除 k1
+        assert(tokens.LoadKeys(path) == 1);
+        assert(tokens.Verify(t1, &claims, now) == SessionTokens::kInvalid);
+        usleep(20000);
+        WriteKeys(path, "# 空\n");
+        assert(tokens.LoadKeys(path) == -1);
+        assert(tokens.Enabled());
+        std::remove(path.c_str());
+        assert(tokens.LoadKeys(path) == -1);
+    }
+
+    {
+        // 撤销：撤销后拒绝，令牌到期后撤销记录被清理
+        SessionTokens tokens;
+        tokens.AddKey("k1", "secret-one");
+        SessionTokens::Stats before = tokens.GetStats(); // 计数按指标名在实例间共享，比较增量
+        std::string a = tokens.Issue(1, "alice", 100, now);
+        std::string b = tokens.Issue(2, "bob", 1000, now);
+        assert(tokens.Verify(a, &claims, now) == SessionTokens::kValid);
+        tokens.Revoke(claims.tokenId, claims.expires);
+        tokens.Revoke(claims.tokenId, claims.expires); // 重复同步
+        assert(tokens.Verify(a, &claims, now) == SessionTokens::kRevoked);
+        assert(claims.userId == 1); // 撤销时仍返回声明，供登出记录
+        assert(tokens.Verify(b, &claims, now) == SessionTokens::kValid);
+        tokens.Revoke(claims.tokenId, claims.expires);
+        assert(tokens.GetStats().revokedEntries == 2);
+        assert(tokens.PurgeRevoked(now + 99) == 0);
+        assert(tokens.PurgeRevoked(now + 100) == 1);
+        assert(tokens.Verify(a, &claims, now + 100) == SessionTokens::kExpired); // 清理后也不会重新生效
+        assert(tokens.Verify(b, &claims, now + 100) == SessionTokens::kRevoked);
+        SessionTokens::Stats after = tokens.GetStats();
+        assert(after.revokedEntries == 1 && after.keys == 1);
+        assert(after.valid - before.valid == 2);
+        assert(after.revoked - before.revoked == 2);
+        assert(after.expired - before.expired == 1);
+    }
+
+    {
+        // 并发：多线程校验的同时轮换密钥、撤销
+        SessionTokens tokens;
+        tokens.AddKey("k1", "secret-one");
+        std::vector<std::string> issued;
+        for (int i = 0; i < 64; ++i)
+            issued.push_back(tokens.Issue(i, "u" + std::to_string(i), 3600));
+        std::vector<std::thread> threads;
+        std::vector<int> wrong(4, 0);
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t]() {
+                SessionTokens::Claims c;
+                for (int i = 0; i < 20000; ++i)
+                {
+                    int k = (i + t) % 64;
+                    if (tokens.Verify(issued[static_cast<size_t>(k)], &c) == SessionTokens::kValid && (c.userId != k || c.username != "u" + std::to_string(k)))
+                        ++wrong[static_cast<size_t>(t)];
+                }
+            });
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 200; ++i)
+            {
+                tokens.AddKey("r" + std::to_string(i % 4), "rotating-" + std::to_string(i));
+                tokens.Revoke("x" + std::to_string(i), SessionTokens::Now() + 60);
+            }
+        });
+        for (auto &th : threads)
+            th.join();
+        for (int w : wrong)
+            assert(w == 0);
+        assert(tokens.Verify(issued[0], &claims) == SessionTokens::kValid);
+    }
+
+    std::cout << "test_session_tokens passed" << std::endl;
+    return 0;
+}
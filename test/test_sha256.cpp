@@ -0,0 +1,97 @@
+#include "Sha256.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+// 测试：SHA-256 标准向量，以及任意分片方式增量更新与一次性计算结果一致
+// 可移植实现与硬件实现（CPU 支持时）各跑一遍，并交叉比对；HMAC-SHA256 取 RFC 4231 的向量
+static std::string HmacHex(const std::string &key, const std::string &data)
+{
+    uint8_t mac[HmacSha256::kMacSize];
+    HmacSha256::Compute(key, data.data(), data.size(), mac);
+    return Sha256::Hex(mac, sizeof(mac));
+}
+
+static void RunVectors()
+{
+    assert(Sha256::HexOf("", 0) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    assert(Sha256::HexOf("abc", 3) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    std::string two = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    assert(Sha256::HexOf(two.data(), two.size()) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // 一百万个 'a'，分块喂入
+    {
+        Sha256 h;
+        std::string chunk(1000, 'a');
+        for (int i = 0; i < 1000; ++i)
+            h.Update(chunk.data(), chunk.size());
+        assert(h.HexDigest() == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+
+    // 填充边界附近的长度与所有切分点
+    std::string data;
+    for (int i = 0; i < 300; ++i)
+        data.push_back(static_cast<char>(i * 37 + 11));
+    for (size_t len : {55u, 56u, 63u, 64u, 65u, 119u, 120u, 128u, 300u})
+    {
+        std::string whole = Sha256::HexOf(data.data(), len);
+        for (size_t cut = 0; cut <= len; ++cut)
+        {
+            Sha256 h;
+            h.Update(data.data(), cut);
+            h.Update(data.data() + cut, len - cut);
+            assert(h.HexDigest() == whole);
+        }
+        Sha256 h;
+        for (size_t i = 0; i < len; ++i)
+            h.Update(data.data() + i, 1);
+        assert(h.HexDigest() == whole);
+    }
+
+    assert(Sha256::ValidHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    assert(!Sha256::ValidHex("E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855"));
+    assert(!Sha256::ValidHex("../etc/passwd"));
+
+    assert(HmacHex(std::string(20, '\x0b'), "Hi There") == "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+    assert(HmacHex("Jefe", "what do ya want for nothing?") == "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    assert(HmacHex(std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First") ==
+           "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+    // 复用同一实例：Final 后自动复位
+    {
+        HmacSha256 h("Jefe");
+        uint8_t a[HmacSha256::kMacSize], b[HmacSha256::kMacSize];
+        h.Update("what do ya ", 11);
+        h.Update("want for nothing?", 17);
+        h.Final(a);
+        h.Update("what do ya want for nothing?", 28);
+        h.Final(b);
+        assert(HmacSha256::Equal(a, b, sizeof(a)));
+        assert(Sha256::Hex(a, sizeof(a)) == "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+        b[31] ^= 1;
+        assert(!HmacSha256::Equal(a, b, sizeof(a)));
+    }
+}
+
+int main()
+{
+    bool hardware = Sha256::SetHardwareAcceleration(true);
+    RunVectors();
+    Sha256::SetHardwareAcceleration(false);
+    assert(std::string(Sha256::Implementation()) == "portable");
+    RunVectors();
+
+    // 两种实现对多块输入结果一致
+    std::string big(1 << 20, '\0');
+    uint32_t x = 12345;
+    for (char &c : big)
+    {
+        x = x * 1103515245 + 12345;
+        c = static_cast<char>(x >> 16);
+    }
+    std::string portable = Sha256::HexOf(big.data(), big.size());
+    Sha256::SetHardwareAcceleration(true);
+    assert(Sha256::HexOf(big.data(), big.size()) == portable);
+
+    std::cout << "test_sha256 passed (" << (hardware ? "sha-ni" : "portable only") << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "StaticAssets.h"
+#include "EventLoop.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Buffer.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <zlib.h>
+#include <sys/stat.h>
+
+// 测试：静态资源的预加载与预压缩、Accept-Encoding 协商、ETag / 304，以及目录变化后的重新加载
+static void WriteFile(const std::string &path, const std::string &content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+static bool WaitFor(const std::function<bool()> &pred)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        if (pred())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+static std::string Head(HttpResponse &resp)
+{
+    Buffer buf;
+    resp.AppendToBuffer(&buf);
+    return buf.PeekAllAsString();
+}
+
+static std::string Gunzip(const std::string &in)
+{
+    z_stream zs{};
+    assert(inflateInit2(&zs, 15 + 16) == Z_OK);
+    std::string out(1 << 20, '\0');
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    assert(inflate(&zs, Z_FINISH) == Z_STREAM_END);
+    out.resize(zs.total_out);
+    inflateEnd(&zs);
+    return out;
+}
+
+int main()
+{
+    // 协商：q 值相同时优先 br，q=0 表示拒绝，未列出的编码取 * 的值
+    bool all[StaticAsset::kEncodingCount] = {true, true, true};
+    bool gzipOnly[StaticAsset::kEncodingCount] = {true, true, false};
+    assert(StaticAssets::Negotiate("gzip, deflate, br", all) == StaticAsset::kBrotli);
+    assert(StaticAssets::Negotiate("gzip, deflate, br", gzipOnly) == StaticAsset::kGzip);
+    assert(StaticAssets::Negotiate("gzip;q=1.0, br;q=0.5", all) == StaticAsset::kGzip);
+    assert(StaticAssets::Negotiate("br;q=0, gzip;q=0", all) == StaticAsset::kIdentity);
+    assert(StaticAssets::Negotiate("*", all) == StaticAsset::kBrotli);
+    assert(StaticAssets::Negotiate("", all) == StaticAsset::kIdentity);
+    assert(StaticAssets::Negotiate("identity", all) == StaticAsset::kIdentity);
+
+    assert(StaticAssets::EtagMatches("\"abc\"", "\"abc\""));
+    assert(StaticAssets::EtagMatches("W/\"abc\"", "\"abc\""));
+    assert(StaticAssets::EtagMatches("\"x\", \"abc\"", "\"abc\""));
+    assert(StaticAssets::EtagMatches("*", "\"abc\""));
+    assert(!StaticAssets::EtagMatches("\"abc-gz\"", "\"abc\""));
+
+    char tmpl[] = "/tmp/test_static_assets_XXXXXX";
+    std::string dir = ::mkdtemp(tmpl);
+    std::string page;
+    for (int i = 0; i < 200; ++i)
+        page += "<p>line " + std::to_string(i) + "</p>\n";
+    WriteFile(dir + "/index.html", page);
+    WriteFile(dir + "/logo.png", std::string(1000, 'p'));
+    WriteFile(dir + "/.index.html.swp", "x");
+    WriteFile(dir + "/big.js", std::string(5000, 'b'));
+    ::mkdir((dir + "/js").c_str(), 0755);
+    WriteFile(dir + "/js/app.js", "var a = 1;");
+
+    StaticAssets *assets = new StaticAssets(dir, 4096); // 监视所在的 loop 没有退出接口，随进程结束
+    assert(assets->Load() == 3); // 跳过隐藏文件与超过上限的文件
+    assert(!assets->Find("big.js") && !assets->Find(".index.html.swp"));
+
+    auto index = assets->Find("index.html");
+    assert(index && index->contentType == "text/html; charset=utf-8");
+    assert(*index->body[StaticAsset::kIdentity] == page);
+    assert(index->body[StaticAsset::kGzip] && index->body[StaticAsset::kBrotli]);
+    assert(index->body[StaticAsset::kBrotli]->size() < index->body[StaticAsset::kGzip]->size());
+    assert(Gunzip(*index->body[StaticAsset::kGzip]) == page);
+    // 图片不压缩，过小的文件也不压缩
+    auto png = assets->Find("logo.png");
+    assert(png && png->contentType == "image/png" && !png->body[StaticAsset::kGzip] && !png->body[StaticAsset::kBrotli]);
+    auto app = assets->Find("js/app.js");
+    assert(app && app->contentType == "application/javascript" && !app->body[StaticAsset::kGzip]);
+
+    {
+        HttpRequest req;
+        req.AddHeader("Accept-Encoding", "gzip, br");
+        HttpResponse resp(false);
+        assets->Respond(*index, req, &resp);
+        assert(resp.GetBodyType() == BUFFER_TYPE && resp.GetSharedBody() == index->body[StaticAsset::kBrotli]);
+        std::string head = Head(resp);
+        assert(head.find("HTTP/1.1 200") == 0);
+        assert(head.find("Content-Encoding: br\r\n") != std::string::npos);
+        assert(head.find("Vary: Accept-Encoding\r\n") != std::string::npos);
+        assert(head.find("ETag: " + index->etag[StaticAsset::kBrotli] + "\r\n") != std::string::npos);
+        assert(head.find("Connection: Keep-Alive\r\n") != std::string::npos);
+    }
+    {
+        // 客户端缓存了 br 版本：同样的 Accept-Encoding 回 304，换成只接受 gzip 则回 200
+        HttpRequest req;
+        req.AddHeader("Accept-Encoding", "gzip, br");
+        req.AddHeader("If-None-Match", index->etag[StaticAsset::kBrotli]);
+        HttpResponse resp(false);
+        assets->Respond(*index, req, &resp);
+        std::string head = Head(resp);
+        assert(head.find("HTTP/1.1 304 Not Modified\r\n") == 0);
+        assert(head.find("Content-Length: 0\r\n") != std::string::npos && head.find("Content-Encoding") == std::string::npos);
+
+        req.AddHeader("Accept-Encoding", "gzip");
+        HttpResponse resp2(false);
+        assets->Respond(*index, req, &resp2);
+        assert(Head(resp2).find("HTTP/1.1 200") == 0 && resp2.GetSharedBody() == index->body[StaticAsset::kGzip]);
+    }
+    {
+        HttpRequest req;
+        HttpResponse resp(false);
+        assets->Respond(*png, req, &resp);
+        std::string head = Head(resp);
+        assert(head.find("Content-Type: image/png\r\n") != std::string::npos && head.find("Vary") == std::string::npos);
+        assert(resp.GetContentLength() == 1000);
+    }
+    StaticAssets::Stats st = assets->GetStats();
+    assert(st.assets == 3 && st.served == 3 && st.notModified == 1);
+
+    // 监视目录：修改、新建、删除后重新加载
+    std::atomic<bool> watching(false);
+    std::thread([&]() {
+        EventLoop loop;
+        assert(assets->Watch(&loop));
+        watching = true;
+        loop.loop();
+    }).detach();
+    assert(WaitFor([&]() { return watching.load(); }));
+
+    std::string oldTag = index->etag[StaticAsset::kIdentity];
+    WriteFile(dir + "/index.html", "<h1>v2</h1>");
+    assert(WaitFor([&]() { return assets->Find("index.html")->etag[StaticAsset::kIdentity] != oldTag; }));
+    assert(*assets->Find("index.html")->body[StaticAsset::kIdentity] == "<h1>v2</h1>");
+    assert(*index->body[StaticAsset::kIdentity] == page); // 旧条目的持有者不受影响
+
+    WriteFile(dir + "/js/new.css", "body {}");
+    assert(WaitFor([&]() { return assets->Find("js/new.css") != nullptr; }));
+    assert(assets->Find("js/new.css")->contentType == "text/css");
+
+    ::unlink((dir + "/logo.png").c_str());
+    assert(WaitFor([&]() { return assets->Find("logo.png") == nullptr; }));
+
+    ::mkdir((dir + "/img").c_str(), 0755);
+    WriteFile(dir + "/img/a.svg", "<svg/>");
+    assert(WaitFor([&]() { return assets->Find("img/a.svg") != nullptr; }));
+    assert(assets->GetStats().reloads >= 3);
+
+    std::system(("rm -rf " + dir).c_str());
+    std::cout << "test_static_assets passed" << std::endl;
+    return 0;
+}
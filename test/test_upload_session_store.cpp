@@ -0,0 +1,278 @@
+#include "UploadSessionStore.h"
+#include "UploadWriter.h"
+#include "Logger.h"
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 测试：断点续传会话（不经 HTTP 与数据库，直接驱动 UploadSessionStore 与 UploadWriter）
+// 偏移不符与并发 PATCH 被拒且会话不变、中断的 PATCH 保留已落盘的数据、重启后以数据文件长度恢复偏移、空闲会话过期；
+// 分片上传：长度不是整片或同一分片并发写被拒、有分片在写或缺失时不能完成、缺失分片列表、分片状态重启后保留
+static uint64_t FileSize(const std::string &path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
+
+static bool Exists(const std::string &path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+static void Drain(DiskIoThread &io)
+{
+    std::promise<void> done;
+    io.Submit([&done]() { done.set_value(); });
+    done.get_future().wait();
+}
+
+// 与 ResumableUploadHandler 相同的一次完整 PATCH：准入、写入、落盘后推进偏移
+static void Patch(UploadSessionStore &store, DiskIoThread &io, const std::shared_ptr<UploadSession> &s, const std::string &data)
+{
+    uint64_t offset = s->offset;
+    UploadSessionStore::Admission admitted = store.admitPatch(s, offset, data.size());
+    assert(admitted == UploadSessionStore::kAdmitted);
+    auto writer = std::make_shared<UploadWriter>(&io, store.dataPath(s->id), "");
+    bool opened = writer->Open(data.size(), offset, false);
+    assert(opened);
+    writer->Append(data.data(), data.size());
+    std::promise<bool> synced;
+    writer->Sync([&synced](bool ok) { synced.set_value(ok); });
+    bool ok = synced.get_future().get();
+    assert(ok);
+    ::truncate(store.dataPath(s->id).c_str(), static_cast<off_t>(offset + data.size())); // 去掉预分配
+    store.release(s, offset + data.size());
+}
+
+// 与 ResumableUploadHandler 相同的一个分片 PUT：分片落盘后才记为完成
+static void PutPart(UploadSessionStore &store, DiskIoThread &io, const std::shared_ptr<UploadSession> &s, uint64_t index, char fill)
+{
+    std::string data(s->partLength(index), fill);
+    UploadSessionStore::Admission admitted = store.admitPart(s, index, data.size());
+    assert(admitted == UploadSessionStore::kAdmitted);
+    auto writer = std::make_shared<UploadWriter>(&io, store.dataPath(s->id), "");
+    bool opened = writer->Open(0, s->partOffset(index), false);
+    assert(opened);
+    writer->Append(data.data(), data.size());
+    std::promise<bool> synced;
+    writer->Sync([&synced](bool ok) { synced.set_value(ok); });
+    bool ok = synced.get_future().get();
+    assert(ok);
+    store.releasePart(s, index, true);
+}
+
+static void TestAdmission(UploadSessionStore &store, DiskIoThread &io)
+{
+    auto s = store.create(7, "a.bin", 1000, "");
+    assert(s && s->offset == 0 && !s->busy);
+    Patch(store, io, s, std::string(400, 'a'));
+    assert(s->offset == 400 && !s->busy && FileSize(store.dataPath(s->id)) == 400);
+
+    // 偏移不符：拒绝且不占用，处理器按 s->offset 回 409 与当前偏移
+    assert(store.admitPatch(s, 0, 100) == UploadSessionStore::kOffsetMismatch);
+    assert(store.admitPatch(s, 500, 100) == UploadSessionStore::kOffsetMismatch);
+    assert(s->offset == 400 && !s->busy);
+    // 超出文件大小
+    assert(store.admitPatch(s, 400, 601) == UploadSessionStore::kBadLength);
+    assert(!s->busy);
+
+    // 已有 PATCH 在写：第二个请求无论偏移是否正确都回 409
+    assert(store.admitPatch(s, 400, 600) == UploadSessionStore::kAdmitted);
+    assert(s->busy);
+    assert(store.admitPatch(s, 400, 600) == UploadSessionStore::kBusy);
+    assert(store.admitPatch(s, 0, 10) == UploadSessionStore::kBusy);
+    assert(!store.acquire(s));
+    store.release(s, s->offset);
+    assert(!s->busy && s->offset == 400);
+}
+
+static void TestInterruptAndRestart(const std::string &dir, DiskIoThread &io)
+{
+    std::string id;
+    {
+        UploadSessionStore store(dir, 3600);
+        store.load();
+        auto s = store.create(7, "b.bin", 10000, "");
+        id = s->id;
+        Patch(store, io, s, std::string(1000, 'b'));
+
+        // 声明 5000 字节，只收到 3000 就断开：上下文析构后已收到的数据落盘并成为新偏移
+        UploadSessionStore::Admission admitted = store.admitPatch(s, 1000, 5000);
+        assert(admitted == UploadSessionStore::kAdmitted);
+        auto patch = std::make_shared<ResumablePatchContext>();
+        patch->session = s;
+        patch->store = &store;
+        patch->startOffset = 1000;
+        patch->writer = std::make_shared<UploadWriter>(&io, store.dataPath(id), "");
+        bool opened = patch->writer->Open(5000, 1000, false);
+        assert(opened);
+        std::string part(3000, 'c');
+        patch->writer->Append(part.data(), part.size());
+        patch.reset();
+        Drain(io);
+        assert(!s->busy && s->offset == 4000);
+        assert(FileSize(store.dataPath(id)) == 4000); // 预分配的尾部已截掉
+
+        // 从新偏移继续
+        assert(store.admitPatch(s, 1000, 100) == UploadSessionStore::kOffsetMismatch);
+        Patch(store, io, s, std::string(500, 'd'));
+        assert(s->offset == 4500);
+    }
+
+    // 重启：偏移取自数据文件长度
+    {
+        UploadSessionStore store(dir, 3600);
+        store.load();
+        auto s = store.get(id);
+        assert(s && s->offset == 4500 && s->size == 10000 && s->userId == 7 && s->filename == "b.bin" && !s->busy);
+    }
+    // 元数据之后写入的数据未落盘（尾部丢失）：以磁盘上实际的长度为准
+    ::truncate((dir + "/" + id + ".data").c_str(), 4321);
+    {
+        UploadSessionStore store(dir, 3600);
+        store.load();
+        auto s = store.get(id);
+        assert(s && s->offset == 4321);
+        assert(store.admitPatch(s, 4500, 10) == UploadSessionStore::kOffsetMismatch);
+        Patch(store, io, s, std::string(10000 - 4321, 'e'));
+        assert(s->offset == s->size && FileSize(store.dataPath(id)) == 10000);
+        store.remove(id);
+        assert(!store.get(id) && !Exists(store.dataPath(id)) && !Exists(store.metaPath(id)));
+    }
+}
+
+static void TestExpiry(const std::string &dir)
+{
+    UploadSessionStore store(dir, 60);
+    store.load();
+    auto idle = store.create(1, "idle.bin", 100, "");
+    auto recent = store.create(1, "recent.bin", 100, "");
+    auto writing = store.create(1, "writing.bin", 100, "");
+    int64_t old = static_cast<int64_t>(time(nullptr)) - 100;
+    idle->updatedAt = old;
+    assert(store.admitPatch(writing, 0, 100) == UploadSessionStore::kAdmitted);
+    writing->updatedAt = old; // 长时间的 PATCH 不会被清理
+
+    assert(store.expireStale() == 1);
+    assert(!store.get(idle->id) && !Exists(store.dataPath(idle->id)) && !Exists(store.metaPath(idle->id)));
+    assert(store.get(recent->id) && store.get(writing->id));
+
+    store.release(writing, 0); // 释放时刷新活动时间
+    assert(store.expireStale() == 0 && store.get(writing->id));
+
+    // 已清理的会话重启后不再出现
+    UploadSessionStore reloaded(dir, 60);
+    reloaded.load();
+    assert(!reloaded.get(idle->id) && reloaded.get(recent->id) && reloaded.get(writing->id));
+}
+
+static void TestParts(const std::string &dir, DiskIoThread &io)
+{
+    std::string id;
+    {
+        UploadSessionStore store(dir, 3600);
+        store.load();
+        auto s = store.create(7, "m.bin", 2500, "", 1000); // 分片 0、1 各 1000 字节，分片 2 为 500 字节
+        assert(s && s->partCount() == 3 && FileSize(store.dataPath(s->id)) == 2500);
+        id = s->id;
+        assert(UploadSessionStore::joinParts(store.missingParts(s)) == "0,1,2");
+
+        // 不是整片、序号越界
+        assert(store.admitPart(s, 0, 999) == UploadSessionStore::kBadLength);
+        assert(store.admitPart(s, 0, 1001) == UploadSessionStore::kBadLength);
+        assert(store.admitPart(s, 2, 1000) == UploadSessionStore::kBadLength);
+        assert(store.admitPart(s, 3, 500) == UploadSessionStore::kBadLength);
+        assert(s->activeParts == 0);
+
+        // 同一分片并发写被拒，不同分片可以并行
+        assert(store.admitPart(s, 0, 1000) == UploadSessionStore::kAdmitted);
+        assert(store.admitPart(s, 0, 1000) == UploadSessionStore::kBusy);
+        assert(store.admitPart(s, 1, 1000) == UploadSessionStore::kAdmitted);
+        assert(s->activeParts == 2);
+
+        // 有分片在写时不能完成，也不能开始顺序 PATCH
+        std::vector<uint64_t> missing;
+        assert(store.admitComplete(s, &missing) == UploadSessionStore::kBusy);
+        assert(store.admitPatch(s, 0, 10) == UploadSessionStore::kBusy);
+        assert(!s->busy);
+
+        // 分片 0 落盘完成；分片 1 只收到一半就断开，记为缺失
+        store.releasePart(s, 0, false);
+        store.releasePart(s, 1, false);
+        PutPart(store, io, s, 0, 'a');
+        assert(store.admitPart(s, 1, 1000) == UploadSessionStore::kAdmitted);
+        auto patch = std::make_shared<ResumablePatchContext>();
+        patch->session = s;
+        patch->store = &store;
+        patch->part = 1;
+        patch->startOffset = s->partOffset(1);
+        patch->writer = std::make_shared<UploadWriter>(&io, store.dataPath(id), "");
+        bool opened = patch->writer->Open(0, s->partOffset(1), false);
+        assert(opened);
+        patch->writer->Append(std::string(500, 'x').data(), 500);
+        patch.reset();
+        Drain(io);
+        assert(s->activeParts == 0 && s->offset == 1000);
+
+        // 缺失分片时拒绝完成并列出缺失的分片，会话不被占用
+        assert(store.admitComplete(s, &missing) == UploadSessionStore::kIncomplete);
+        assert(UploadSessionStore::joinParts(missing) == "1,2" && !s->busy);
+        assert(UploadSessionStore::joinParts(store.missingParts(s)) == "1,2"); // HEAD 的 Upload-Missing-Parts
+
+        // 分片 2 写入中时重启：只有已完成的分片被保留
+        assert(store.admitPart(s, 2, 500) == UploadSessionStore::kAdmitted);
+    }
+    UploadSessionStore store(dir, 3600);
+    store.load();
+    auto s = store.get(id);
+    assert(s && s->isMultipart() && s->partSize == 1000 && s->activeParts == 0 && s->offset == 1000);
+    assert(UploadSessionStore::joinParts(store.missingParts(s)) == "1,2");
+
+    PutPart(store, io, s, 2, 'c');
+    assert(UploadSessionStore::joinParts(store.missingParts(s)) == "1");
+    PutPart(store, io, s, 1, 'b');
+    assert(store.missingParts(s).empty() && s->offset == 2500);
+
+    // 全部完成：占用会话，完成期间分片与重复的完成请求都被拒
+    std::vector<uint64_t> missing;
+    assert(store.admitComplete(s, &missing) == UploadSessionStore::kAdmitted && s->busy);
+    assert(store.admitComplete(s, &missing) == UploadSessionStore::kBusy);
+    assert(store.admitPart(s, 1, 1000) == UploadSessionStore::kBusy);
+    std::ifstream in(store.dataPath(id), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(content == std::string(1000, 'a') + std::string(1000, 'b') + std::string(500, 'c'));
+    store.release(s, s->offset);
+
+    // 数据文件长度不符（被截断）时同样拒绝完成
+    ::truncate(store.dataPath(id).c_str(), 2000);
+    assert(store.admitComplete(s, &missing) == UploadSessionStore::kIncomplete && missing.empty() && !s->busy);
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    char tmpl[] = "/tmp/test_upload_session_store_XXXXXX";
+    std::string dir = ::mkdtemp(tmpl);
+    DiskIoThread io;
+
+    UploadSessionStore store(dir + "/admission", 3600);
+    store.load();
+    TestAdmission(store, io);
+    TestInterruptAndRestart(dir + "/restart", io);
+    TestExpiry(dir + "/expiry");
+    TestParts(dir + "/parts", io);
+
+    std::string cmd = "rm -rf " + dir;
+    if (std::system(cmd.c_str()) != 0)
+        std::cerr << "failed to remove " << dir << std::endl;
+    std::cout << "test_upload_session_store passed" << std::endl;
+    return 0;
+}
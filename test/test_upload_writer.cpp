@@ -0,0 +1,279 @@
+#include "UploadWriter.h"
+#include "Logger.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 测试：UploadWriter 提交时截掉未用完的预分配、数据落盘后才把 .part 改名为最终文件、
+// 写盘/摘要队列满时的背压与回落通知、放弃时删除临时文件（直接写目标文件时保留数据）、写盘出错后提交报告失败
+static bool Exists(const std::string &path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+static std::string ReadAll(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::string Pattern(size_t len)
+{
+    std::string s(len, '\0');
+    for (size_t i = 0; i < len; ++i)
+        s[i] = static_cast<char>(i * 131 + 7);
+    return s;
+}
+
+// 等 I/O 线程执行完此前投递的任务
+static void Drain(DiskIoThread &io)
+{
+    std::promise<void> done;
+    io.Submit([&done]() { done.set_value(); });
+    done.get_future().wait();
+}
+
+static bool CommitAndWait(const std::shared_ptr<UploadWriter> &writer)
+{
+    std::promise<bool> done;
+    writer->Commit([&done](bool ok) { done.set_value(ok); });
+    return done.get_future().get();
+}
+
+// 任务阻塞在 I/O 线程上，直到 Open 被调用
+struct Gate
+{
+    std::promise<void> promise;
+    std::shared_future<void> opened = promise.get_future().share();
+
+    void Block(DiskIoThread &io)
+    {
+        std::shared_future<void> f = opened;
+        io.Submit([f]() { f.wait(); });
+    }
+    void Open() { promise.set_value(); }
+};
+
+static void TestPreallocationTrimmed(DiskIoThread &io, const std::string &dir)
+{
+    std::string final = dir + "/prealloc", tmp = final + ".part";
+    auto writer = std::make_shared<UploadWriter>(&io, final, tmp);
+    const uint64_t reserve = 8 * 1024 * 1024;
+    bool opened = writer->Open(reserve);
+    assert(opened);
+    std::string data = Pattern(100 * 1000);
+    writer->Append(data.data(), data.size());
+    writer->Flush();
+    Drain(io);
+    struct stat st;
+    assert(::stat(tmp.c_str(), &st) == 0 && static_cast<size_t>(st.st_size) == data.size());
+    bool preallocated = static_cast<uint64_t>(st.st_blocks) * 512 >= reserve; // 文件系统不支持 fallocate 时只检查长度
+
+    bool committed = CommitAndWait(writer);
+    assert(committed);
+    assert(::stat(final.c_str(), &st) == 0 && static_cast<size_t>(st.st_size) == data.size());
+    if (preallocated)
+        assert(static_cast<uint64_t>(st.st_blocks) * 512 < reserve / 2);
+    assert(ReadAll(final) == data);
+}
+
+static void TestRenameAfterSync(DiskIoThread &io, const std::string &dir)
+{
+    std::string final = dir + "/renamed", tmp = final + ".part";
+    auto writer = std::make_shared<UploadWriter>(&io, final, tmp);
+    bool opened = writer->Open(0);
+    assert(opened);
+    std::string data = Pattern(UploadWriter::kBufferSize * 2 + 12345);
+    writer->Append(data.data(), data.size());
+
+    // 写盘与提交都排在闸门之后：回调之前最终文件不存在，数据只在 .part 中
+    Gate gate;
+    gate.Block(io);
+    std::promise<bool> committed;
+    writer->Commit([&committed](bool ok) { committed.set_value(ok); });
+    std::future<bool> result = committed.get_future();
+    assert(result.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+    assert(Exists(tmp) && !Exists(final));
+    gate.Open();
+    bool ok = result.get();
+    assert(ok);
+    assert(!Exists(tmp) && ReadAll(final) == data);
+    assert(writer->BytesAppended() == data.size());
+
+    // 断点续传：不带临时文件，Sync 只刷盘，文件保留原名继续追加
+    std::string resumable = dir + "/resumable";
+    auto first = std::make_shared<UploadWriter>(&io, resumable, "");
+    opened = first->Open(0);
+    assert(opened);
+    first->Append(data.data(), 1000);
+    std::promise<bool> synced;
+    first->Sync([&synced](bool ok) { synced.set_value(ok); });
+    ok = synced.get_future().get();
+    assert(ok);
+    assert(ReadAll(resumable) == data.substr(0, 1000));
+    auto second = std::make_shared<UploadWriter>(&io, resumable, "");
+    opened = second->Open(0, 1000, false);
+    assert(opened);
+    second->Append(data.data() + 1000, 500);
+    ok = CommitAndWait(second);
+    assert(ok && ReadAll(resumable) == data.substr(0, 1500));
+}
+
+static void TestBackpressure(const std::string &dir)
+{
+    DiskIoThread io(4);
+    DiskIoThread hash(4);
+    auto writer = std::make_shared<UploadWriter>(&io, dir + "/backpressure", dir + "/backpressure.part");
+    bool opened = writer->Open(0);
+    assert(opened);
+    writer->EnableHash(&hash);
+    std::string chunk = Pattern(UploadWriter::kBufferSize);
+
+    // 写盘线程被挡住：每写满一个缓冲区排一个任务，到上限后报告背压
+    Gate gate;
+    gate.Block(io);
+    assert(!writer->Backpressured());
+    int appended = 0;
+    while (!writer->Backpressured())
+    {
+        writer->Append(chunk.data(), chunk.size());
+        ++appended;
+        assert(appended <= 4);
+    }
+    assert(io.Full() && io.QueueDepth() == 4);
+
+    std::atomic<int> notified(0);
+    writer->NotifyWhenDrained([&notified]() { ++notified; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(notified == 0);
+    gate.Open();
+    Drain(io);
+    Drain(hash);
+    assert(notified == 1 && !writer->Backpressured());
+
+    // 已回落时立即回调
+    writer->NotifyWhenDrained([&notified]() { ++notified; });
+    assert(notified == 2);
+
+    // 摘要线程被挡住同样算背压，两个队列都回落才通知
+    Gate hashGate;
+    hashGate.Block(hash);
+    while (!hash.Full())
+        writer->Append(chunk.data(), chunk.size());
+    assert(writer->Backpressured());
+    writer->NotifyWhenDrained([&notified]() { ++notified; });
+    Drain(io);
+    assert(notified == 2);
+    hashGate.Open();
+    Drain(hash);
+    Drain(io);
+    assert(notified == 3);
+
+    bool committed = CommitAndWait(writer);
+    assert(committed);
+    assert(writer->Digest() == Sha256::HexOf(ReadAll(dir + "/backpressure").data(), static_cast<size_t>(writer->BytesAppended())));
+}
+
+static void TestAbort(DiskIoThread &io, const std::string &dir)
+{
+    std::string final = dir + "/aborted", tmp = final + ".part";
+    auto writer = std::make_shared<UploadWriter>(&io, final, tmp);
+    bool opened = writer->Open(4 * 1024 * 1024);
+    assert(opened);
+    std::string data = Pattern(UploadWriter::kBufferSize + 100);
+    writer->Append(data.data(), data.size());
+    Drain(io);
+    assert(Exists(tmp));
+    writer->Abort();
+    Drain(io);
+    assert(!Exists(tmp) && !Exists(final));
+
+    // 放弃后的追加与提交不再生效
+    writer->Append(data.data(), 10);
+    writer->Commit([](bool) { assert(false); });
+    Drain(io);
+    assert(!Exists(tmp) && !Exists(final));
+
+    // 没有临时文件时直接写目标文件（断点续传的数据文件）：放弃只停止写入，已有的数据保留
+    std::string direct = dir + "/aborted_direct";
+    auto first = std::make_shared<UploadWriter>(&io, direct, "");
+    opened = first->Open(0);
+    assert(opened);
+    first->Append(data.data(), 100);
+    bool committed = CommitAndWait(first);
+    assert(committed);
+    auto other = std::make_shared<UploadWriter>(&io, direct, "");
+    opened = other->Open(0, 100, false);
+    assert(opened);
+    other->Append(data.data(), 100);
+    other->Abort();
+    Drain(io);
+    assert(Exists(direct) && ReadAll(direct).compare(0, 100, data, 0, 100) == 0);
+}
+
+static void TestWriteError(DiskIoThread &io, const std::string &dir)
+{
+    // 文件长度上限 1MB：第二个缓冲区的 pwrite 失败（EFBIG）
+    std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit saved;
+    ::getrlimit(RLIMIT_FSIZE, &saved);
+    struct rlimit limit = saved;
+    limit.rlim_cur = UploadWriter::kBufferSize;
+    int rc = ::setrlimit(RLIMIT_FSIZE, &limit);
+    assert(rc == 0);
+
+    std::string final = dir + "/failed", tmp = final + ".part";
+    auto writer = std::make_shared<UploadWriter>(&io, final, tmp);
+    bool opened = writer->Open(0);
+    assert(opened);
+    std::string data = Pattern(UploadWriter::kBufferSize * 2);
+    writer->Append(data.data(), data.size());
+    Drain(io);
+    assert(writer->Failed());
+    bool ok = CommitAndWait(writer);
+    ::setrlimit(RLIMIT_FSIZE, &saved);
+
+    // 提交报告失败，不产生最终文件，临时文件被删除
+    assert(!ok);
+    assert(!Exists(final) && !Exists(tmp));
+
+    // 打开失败
+    auto missing = std::make_shared<UploadWriter>(&io, dir + "/no/such/dir/file", "");
+    opened = missing->Open(0);
+    assert(!opened && missing->Failed());
+}
+
+int main()
+{
+    Logger::SetLogLevel(Logger::FATAL);
+    char tmpl[] = "/tmp/test_upload_writer_XXXXXX";
+    std::string dir = ::mkdtemp(tmpl);
+    DiskIoThread io;
+
+    TestPreallocationTrimmed(io, dir);
+    TestRenameAfterSync(io, dir);
+    TestBackpressure(dir);
+    TestAbort(io, dir);
+    TestWriteError(io, dir);
+
+    std::string cmd = "rm -rf " + dir;
+    if (std::system(cmd.c_str()) != 0)
+        std::cerr << "failed to remove " << dir << std::endl;
+    std::cout << "test_upload_writer passed" << std::endl;
+    return 0;
+}
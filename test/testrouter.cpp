@@ -1,4 +1,6 @@
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <cstdlib>
@@ -16,7 +18,55 @@ struct Check {
     }
 };
 
-int main() {
+// 基准：按接近应用路由表的规模注册，混合命中静态段、参数段、通配与未命中，分别测 findRoute 与 match 的耗时
+static void bench(int rounds) {
+    RouteTrie router;
+    const char *statics[] = {"/favicon.ico", "/register", "/login", "/", "/index.html", "/share.html", "/register.html",
+                             "/upload", "/upload/instant", "/uploads", "/files", "/share", "/users/search", "/logout"};
+    for (const char *p : statics) router.addRoute(p, "GET", p);
+    router.addRoute("/static/**", "GET", "Static");
+    router.addRoute("/share/:code", "GET", "ShareAccess");
+    router.addRoute("/share/download/:filename", "GET", "ShareDownload");
+    router.addRoute("/share/info/:code", "GET", "ShareInfo");
+    router.addRoute("/uploads/:id", "HEAD", "UploadHead");
+    router.addRoute("/uploads/:id", "PATCH", "UploadPatch");
+    router.addRoute("/uploads/:id", "DELETE", "UploadCancel");
+    router.addRoute("/uploads/:id/parts/:part", "PUT", "UploadPart");
+    router.addRoute("/uploads/:id/complete", "POST", "UploadComplete");
+    router.addRoute("/download/:filename", "GET", "Download");
+    router.addRoute("/delete/:filename", "DELETE", "Delete");
+
+    struct Sample { const char *method; const char *path; };
+    const Sample samples[] = {
+        {"GET", "/"}, {"GET", "/static/js/player.js"}, {"GET", "/files?type=my"},
+        {"GET", "/download/8d2f6c1e0a4b-report.pdf"}, {"PUT", "/uploads/5b7c9e21f3a8/parts/17"},
+        {"HEAD", "/uploads/5b7c9e21f3a8"}, {"GET", "/share/download/8d2f6c1e0a4b-report.pdf"},
+        {"GET", "/logout"}, {"GET", "/no/such/route"}, {"POST", "/uploads/5b7c9e21f3a8/complete"},
+    };
+    const size_t n = sizeof(samples) / sizeof(samples[0]);
+    std::vector<std::string> paths, methods;
+    for (const auto &s : samples) { paths.push_back(s.path); methods.push_back(s.method); }
+
+    size_t hits = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < n; ++i)
+            hits += !router.findRoute(paths[i], methods[i]).handler.empty();
+    auto t1 = std::chrono::steady_clock::now();
+    RouteTrie::MatchView view;
+    for (int r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < n; ++i)
+            hits += router.match(paths[i], methods[i], view);
+    auto t2 = std::chrono::steady_clock::now();
+
+    double ops = static_cast<double>(rounds) * n;
+    std::cout << "\nbench (" << hits << " hits): findRoute "
+              << std::chrono::duration<double, std::nano>(t1 - t0).count() / ops << " ns/op, match "
+              << std::chrono::duration<double, std::nano>(t2 - t1).count() / ops << " ns/op\n";
+}
+
+// 用法: testrouter [基准轮数=100000]，0 表示只跑用例
+int main(int argc, char *argv[]) {
     RouteTrie router;
     Check ck;
 
@@ -66,6 +116,54 @@ int main() {
         ck.expect(m.handler.empty(), "GET /nope -> not found");
     }
 
+    // 7) 优先级：静态 > 参数 > 通配
+    router.addRoute("/users/me", "GET", "UserMe");
+    router.addRoute("/users/**", "GET", "UsersAny");
+    router.addRoute("/users/:id", "POST", "UserUpdate");
+    {
+        ck.expect(router.findRoute("/users/me", "GET").handler == "UserMe", "static beats param");
+        ck.expect(router.findRoute("/users/7", "GET").handler == "UserShow", "param beats wildcard");
+        RouteMatch m = router.findRoute("/users/7/posts", "GET");
+        ck.expect(m.handler == "UsersAny" && m.params["*"] == "7/posts", "wildcard takes the rest");
+    }
+
+    // 8) 静态段没有该方法时回退到参数段
+    {
+        RouteMatch m = router.findRoute("/users/me", "POST");
+        ck.expect(m.handler == "UserUpdate" && m.params["id"] == "me", "POST /users/me -> UserUpdate(id=me)");
+    }
+
+    // 9) 通配在中间：吞 0..N 段后继续匹配
+    router.addRoute("/files/**/raw", "GET", "RawFile");
+    {
+        RouteMatch m = router.findRoute("/files/a/b/raw", "GET");
+        ck.expect(m.handler == "RawFile" && m.params["*"] == "a/b", "GET /files/a/b/raw -> RawFile(* = a/b)");
+        m = router.findRoute("/files/raw", "GET");
+        ck.expect(m.handler == "RawFile" && m.params.empty(), "GET /files/raw -> RawFile without capture");
+        ck.expect(router.findRoute("/files/a/b", "GET").handler.empty(), "GET /files/a/b -> not found");
+    }
+
+    // 10) 无分配接口与 findRoute 一致，且忽略多余的 '/'
+    {
+        RouteTrie::MatchView v;
+        ck.expect(router.match("//users/42/", "GET", v) && v.handler == "UserShow" && v.paramCount == 1 &&
+                      v.params[0].first == "id" && v.params[0].second == "42",
+                  "match //users/42/ -> UserShow(id=42)");
+        ck.expect(!router.match("/users", "DELETE", v) && v.paramCount == 0, "match miss leaves no params");
+    }
+
+    // 11) 段数超过上限的路由拒绝注册
+    {
+        std::string deep;
+        for (size_t i = 0; i <= RouteTrie::kMaxDepth; ++i) deep += "/x";
+        bool thrown = false;
+        try { router.addRoute(deep, "GET", "Deep"); } catch (const std::invalid_argument &) { thrown = true; }
+        ck.expect(thrown, "route deeper than kMaxDepth is rejected");
+    }
+
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 100000;
+    if (rounds > 0) bench(rounds);
+
     std::cout << "\nSummary: " << (ck.fails == 0 ? "ALL PASSED" : std::to_string(ck.fails) + " FAILED") << "\n";
     return ck.fails == 0 ? 0 : 1;
 }